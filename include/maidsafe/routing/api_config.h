@@ -19,8 +19,12 @@
 #ifndef MAIDSAFE_ROUTING_API_CONFIG_H_
 #define MAIDSAFE_ROUTING_API_CONFIG_H_
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "boost/asio/ip/udp.hpp"
@@ -110,6 +114,48 @@ struct MessageAndCachingFunctors {
   StoreCacheDataFunctor store_cache_data;
 };
 
+// Counters of the routing layer's own chunk cache (see Parameters::routing_layer_cache).
+// bytes_served is the volume of data answered locally instead of being fetched further along the
+// route.
+struct CacheStatistics {
+  CacheStatistics()
+      : hits(0), misses(0), insertions(0), evictions(0), rejections(0), bytes_served(0),
+        entry_count(0), size_in_bytes(0) {}
+  double hit_ratio() const {
+    return (hits + misses) == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses);
+  }
+  uint64_t hits, misses, insertions, evictions, rejections, bytes_served, entry_count,
+      size_in_bytes;
+};
+
+// Distribution of recorded latencies.  Each bucket holds the number of values no greater than its
+// upper bound and greater than the previous bucket's; the bounds are within 1/8 of each other, so
+// percentiles are accurate to about 12%.  Empty buckets are omitted.
+struct LatencyHistogram {
+  LatencyHistogram() : count(0), sum(0), buckets() {}
+  // Upper bound of the bucket holding the value at 'quantile' (0.0 to 1.0), or zero if empty.
+  std::chrono::microseconds Percentile(double quantile) const {
+    uint64_t rank(static_cast<uint64_t>(quantile * count + 0.5)), seen(0);
+    for (const auto& bucket : buckets) {
+      seen += bucket.second;
+      if (seen >= rank && seen != 0)
+        return bucket.first;
+    }
+    return buckets.empty() ? std::chrono::microseconds(0) : buckets.back().first;
+  }
+  uint64_t count;
+  std::chrono::microseconds sum;
+  std::vector<std::pair<std::chrono::microseconds, uint64_t>> buckets;  // upper bound, count
+};
+
+// Counters and latency histograms kept by a node (see Routing::GetMetrics), keyed by name in the
+// Prometheus form, e.g. routing_messages_received_total{type="ping"}.
+struct RoutingMetrics {
+  RoutingMetrics() : counters(), histograms() {}
+  std::map<std::string, uint64_t> counters;
+  std::map<std::string, LatencyHistogram> histograms;
+};
+
 // Note : Provide TypedMessageAndCachingFunctor for typed message API and MessageAndCachingFunctor
 // for string type message API. Providing both (TypedMessageAndCachingFunctor &
 // MessageAndCachingFunctor) is not allowed.
@@ -19,7 +19,10 @@
 #ifndef MAIDSAFE_ROUTING_BOOTSTRAP_FILE_OPERATIONS_H_
 #define MAIDSAFE_ROUTING_BOOTSTRAP_FILE_OPERATIONS_H_
 
+#include <list>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "boost/asio/ip/udp.hpp"
@@ -41,15 +44,65 @@ BootstrapContact ParseBootstrapContact(const std::string& serialised_bootstrap_c
 std::string SerialiseBootstrapContacts(const BootstrapContacts& bootstrap_contacts);
 BootstrapContacts ParseBootstrapContacts(const std::string& serialised_bootstrap_contacts);
 
+// A bootstrap file is a base list of contacts in the BootstrapContacts format, plus a journal of
+// add and remove records appended to "<bootstrap file>.journal".  Updates which change the
+// contacts are single appends to the journal, which is folded into the base once it holds more
+// records than the base holds contacts.  A bootstrap file without a journal (as written before the
+// journal was introduced) is read as it stands.  Each record carries a checksum, and a record torn
+// or corrupted by a crash is truncated from the journal when the file is next read.
+
+// Returns the contacts, most recently added first.  Throws if the base file doesn't exist.
 BootstrapContacts ReadBootstrapFile(const boost::filesystem::path& bootstrap_file_path);
 
+// Replaces the base file and discards the journal.
 void WriteBootstrapFile(const BootstrapContacts& bootstrap_contacts,
                         const boost::filesystem::path& bootstrap_file_path);
 
+// Adds or removes the contact via a BootstrapFile, so adding a contact which is already present,
+// or removing one which isn't, writes nothing.  Throws if the base file doesn't exist.  Reads the
+// whole file each time; a long-lived BootstrapFile makes repeated updates cheaper.
 void UpdateBootstrapFile(const BootstrapContact& bootstrap_contact,
                          const boost::filesystem::path& bootstrap_file_path,
                          bool remove);
 
+boost::filesystem::path BootstrapJournalPath(const boost::filesystem::path& bootstrap_file_path);
+
+struct BootstrapContactHash {
+  size_t operator()(const BootstrapContact& bootstrap_contact) const;
+};
+
+// Holds a bootstrap file's contacts in memory, so that membership checks need no file access and
+// only updates which change the contacts are appended to the journal.  Assumes no other writer is
+// updating the same file.
+class BootstrapFile {
+ public:
+  // A missing base file is treated as empty.
+  explicit BootstrapFile(const boost::filesystem::path& bootstrap_file_path);
+  // Returns the contacts, most recently added first.
+  BootstrapContacts Contacts() const;
+  bool Contains(const BootstrapContact& bootstrap_contact) const;
+  // Each returns false if the contact was already present or absent respectively.
+  bool Add(const BootstrapContact& bootstrap_contact);
+  bool Remove(const BootstrapContact& bootstrap_contact);
+  // Rewrites the base file with the current contacts and discards the journal.
+  void Compact();
+  size_t journal_record_count() const;
+
+ private:
+  BootstrapFile(const BootstrapFile&);
+  BootstrapFile& operator=(const BootstrapFile&);
+  void Append(const BootstrapContact& bootstrap_contact, bool remove);
+  void CompactIfJournalTooLarge(std::unique_lock<std::mutex>& lock);
+  void Compact(std::unique_lock<std::mutex>& lock);
+
+  const boost::filesystem::path kBootstrapFilePath_;
+  mutable std::mutex mutex_;
+  std::list<BootstrapContact> contacts_;  // oldest first
+  std::unordered_map<BootstrapContact, std::list<BootstrapContact>::iterator,
+                     BootstrapContactHash> index_;
+  size_t journal_record_count_;
+};
+
 }  // namespace routing
 
 }  // namespace maidsafe
@@ -0,0 +1,102 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_CLOCK_H_
+#define MAIDSAFE_ROUTING_CLOCK_H_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include "boost/asio/io_service.hpp"
+#include "boost/asio/steady_timer.hpp"
+#include "boost/system/error_code.hpp"
+
+namespace maidsafe {
+
+namespace routing {
+
+class VirtualScheduler;
+
+// The clock read by all routing timers.  This is the steady clock unless virtual time is enabled,
+// in which case it is a process-wide virtual clock which only moves when advanced, jumping from one
+// timer's deadline to the next.  Timers falling due fire in deadline order (and in the order they
+// were waited on for equal deadlines), and the clock isn't advanced further until the handlers of
+// those timers, and any work they pass on through Post, have completed.
+class Clock {
+ public:
+  typedef std::chrono::steady_clock::duration duration;
+  typedef std::chrono::steady_clock::time_point time_point;
+
+  static time_point now();
+  // Only affects SteadyTimers constructed afterwards, so should be called before any routing
+  // object is constructed, and disabled only once they are all destroyed.  The virtual clock
+  // starts at the steady clock's current time.
+  static void EnableVirtualTime();
+  static void DisableVirtualTime();
+  static bool virtual_time_enabled();
+  // Waits for the handlers of timers which have already fallen due, then moves the virtual clock to
+  // the earliest pending deadline and fires all timers due by then.  Returns false, leaving the
+  // clock unchanged, if no timer is pending.
+  static bool AdvanceToNextDeadline();
+  // Advances the virtual clock deadline by deadline until 'duration' has passed.
+  static void Advance(const duration& duration);
+  // Posts 'handler' to 'io_service'.  In virtual time, the clock isn't advanced while the handler
+  // is pending or running.
+  static void Post(boost::asio::io_service& io_service, const std::function<void()>& handler);
+
+ private:
+  Clock();
+  ~Clock();
+  Clock(const Clock&);
+  Clock& operator=(const Clock&);
+};
+
+// A timer with the subset of boost::asio::steady_timer's interface used by routing, measuring time
+// by Clock.  Handlers are invoked via the timer's io_service with a success error code on expiry,
+// or boost::asio::error::operation_aborted if cancelled, which also happens on destruction.
+class SteadyTimer {
+ public:
+  typedef std::function<void(const boost::system::error_code&)> WaitHandler;
+
+  explicit SteadyTimer(boost::asio::io_service& io_service);
+  SteadyTimer(boost::asio::io_service& io_service, const Clock::duration& expiry_time);
+  ~SteadyTimer();
+  // Both cancel any pending waits, returning the number cancelled.
+  std::size_t expires_from_now(const Clock::duration& expiry_time);
+  std::size_t cancel();
+  void async_wait(WaitHandler handler);
+
+ private:
+  friend class VirtualScheduler;
+  struct VirtualTimer;
+
+  SteadyTimer(const SteadyTimer&);
+  SteadyTimer& operator=(const SteadyTimer&);
+
+  std::unique_ptr<boost::asio::steady_timer> steady_timer_;
+  std::unique_ptr<VirtualTimer> virtual_timer_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_CLOCK_H_
@@ -0,0 +1,82 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_INSTRUMENTED_MUTEX_H_
+#define MAIDSAFE_ROUTING_INSTRUMENTED_MUTEX_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "maidsafe/routing/api_config.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+#ifdef ROUTING_LOCK_PROFILING
+
+struct LockStatistics;
+
+// Mutex recording, under its name, how often it is acquired, how often it is contended, and how
+// long each acquisition waited for and held it.  All mutexes of the same name in the process, e.g.
+// those of each node, share statistics.
+class InstrumentedMutex {
+ public:
+  explicit InstrumentedMutex(const char* name);
+  void lock();
+  bool try_lock();
+  void unlock();
+
+ private:
+  InstrumentedMutex(const InstrumentedMutex&);
+  InstrumentedMutex& operator=(const InstrumentedMutex&);
+
+  std::mutex mutex_;
+  LockStatistics& statistics_;
+  std::chrono::steady_clock::time_point acquired_;  // only accessed by the holder
+};
+
+typedef std::unique_lock<InstrumentedMutex> InstrumentedUniqueLock;
+typedef std::condition_variable_any InstrumentedConditionVariable;
+
+#else
+
+// Without ROUTING_LOCK_PROFILING defined, a plain std::mutex which ignores its name.
+class InstrumentedMutex : public std::mutex {
+ public:
+  explicit InstrumentedMutex(const char* /*name*/) {}
+};
+
+typedef std::unique_lock<std::mutex> InstrumentedUniqueLock;
+typedef std::condition_variable InstrumentedConditionVariable;
+
+#endif
+
+// Adds the statistics of every named mutex in the process to 'metrics', as the counters
+// routing_lock_acquisitions_total{lock="<name>"} and routing_lock_contentions_total{lock="<name>"}
+// and the histograms routing_lock_wait_seconds{lock="<name>"} and
+// routing_lock_hold_seconds{lock="<name>"}.  Adds nothing without ROUTING_LOCK_PROFILING defined.
+void AddLockMetrics(RoutingMetrics& metrics);
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_INSTRUMENTED_MUTEX_H_
@@ -0,0 +1,58 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_INTERNED_PUBLIC_KEY_H_
+#define MAIDSAFE_ROUTING_INTERNED_PUBLIC_KEY_H_
+
+#include <cstddef>
+#include <memory>
+
+#include "maidsafe/common/rsa.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Handle to a public key which is held once in the process however many handles refer to it, so
+// that copying a NodeInfo copies a reference count rather than the key itself.  Keys are interned
+// by their encoding when assigned, and released when their last handle is destroyed.  Interning
+// encodes the key and takes a process-wide lock, so a key already held by a handle should be passed
+// on as that handle rather than as the key itself.  Converts to asymm::PublicKey, so can be passed
+// wherever the key itself is expected; a default constructed handle refers to an empty, invalid
+// key.
+class InternedPublicKey {
+ public:
+  InternedPublicKey();
+  InternedPublicKey(const asymm::PublicKey& public_key);  // NOLINT (Fraser)
+  InternedPublicKey& operator=(const asymm::PublicKey& public_key);
+
+  const asymm::PublicKey& get() const;
+  operator const asymm::PublicKey&() const { return get(); }  // NOLINT (Fraser)
+  // Number of distinct keys currently interned in the process.
+  static size_t InternedCount();
+
+ private:
+  std::shared_ptr<const asymm::PublicKey> public_key_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_INTERNED_PUBLIC_KEY_H_
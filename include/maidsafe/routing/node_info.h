@@ -19,15 +19,17 @@
 #ifndef MAIDSAFE_ROUTING_NODE_INFO_H_
 #define MAIDSAFE_ROUTING_NODE_INFO_H_
 
+#include <chrono>
 #include <cstdint>
 #include <vector>
 
 #include "maidsafe/common/node_id.h"
-#include "maidsafe/common/rsa.h"
 #include "maidsafe/common/tagged_value.h"
 
 #include "maidsafe/rudp/nat_type.h"
 
+#include "maidsafe/routing/interned_public_key.h"
+
 namespace maidsafe {
 
 namespace routing {
@@ -46,11 +48,12 @@ struct NodeInfo {
 
   NodeId node_id;
   NodeId connection_id;  // Id of a node as far as rudp is concerned
-  asymm::PublicKey public_key;
+  InternedPublicKey public_key;  // shared by all copies
   int32_t rank;
   int32_t bucket;
   rudp::NatType nat_type;
   std::vector<int32_t> dimension_list;
+  std::chrono::microseconds round_trip_time;  // smoothed, zero until measured
 
   static const int32_t kInvalidBucket;
 };
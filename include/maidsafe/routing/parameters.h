@@ -22,6 +22,7 @@
 #include <chrono>
 #include <cstdint>
 #include "boost/date_time/posix_time/posix_time_duration.hpp"
+#include "boost/filesystem/path.hpp"
 
 namespace maidsafe {
 
@@ -40,14 +41,50 @@ struct Parameters {
   static uint16_t max_routing_table_size_for_client;  // max size of RoutingTable owned by client
   static uint16_t max_client_routing_table_size;      // max size of ClientRoutingTable
   static uint16_t bucket_target_size;
+  // Adapts a vault's routing table size and per-bucket target to the estimated network size,
+  // aiming to reach any close group in about target_routing_hops hops.  The adapted size is kept
+  // within the given bounds; the static sizes above apply while this is unset.  Off by default, as
+  // in simulation it takes more hops than the static table in networks of around 1000 vaults.
+  static bool adaptive_routing_table_size;
+  static uint16_t min_adaptive_routing_table_size;
+  static uint16_t max_adaptive_routing_table_size;
+  static uint16_t target_routing_hops;
+  // Among the peers in the same half of the destination's bucket as the closest peer, sends to the
+  // one with the lowest measured round trip time.  Round trip times are measured from message sends
+  // and from pings sent every round_trip_time_ping_interval.
+  static bool proximity_routing;
+  static std::chrono::seconds round_trip_time_ping_interval;
   static uint32_t max_data_size;
   static std::chrono::steady_clock::duration default_response_timeout;
   static std::chrono::seconds find_node_interval;
   static std::chrono::seconds recovery_time_lag;
   static std::chrono::seconds re_bootstrap_time_lag;
   static std::chrono::seconds find_close_node_interval;
+  // How long ZeroStateJoin waits for the other zero state peer to be added to the routing table.
+  static std::chrono::steady_clock::duration zero_state_join_timeout;
+  // File, conventionally beside the bootstrap file, holding the connect latency and success rate
+  // of bootstrap contacts.  The data is not persisted if this is empty.
+  static boost::filesystem::path bootstrap_contact_quality_path;
+  // Number of best-ranked bootstrap contacts bootstrapped to concurrently, the first to connect
+  // being kept, and the delay before each next attempt is started if no earlier one has completed.
+  // Contacts are tried one at a time if this is less than 2, the default.
+  static uint16_t bootstrap_probe_count;
+  static std::chrono::steady_clock::duration bootstrap_probe_stagger;
+  // Completes each new connection with the ConnectSuccess messages exchanged as rudp validation
+  // data, rather than with a further ConnectSuccessAcknowledgement each way.  Peers without this
+  // set fall back to the full handshake.  Off by default.
+  static bool pipelined_connect_handshake;
   static uint16_t find_node_repeats_per_num_requested;
+  // Bounds on the cache of peers' public keys obtained through RequestPublicKeyFunctor, and the
+  // directory in which each node persists its cache.  The cache is not persisted if this is empty.
+  static uint16_t public_key_cache_size;
+  static std::chrono::system_clock::duration public_key_cache_ttl;
+  static boost::filesystem::path public_key_cache_path;
   static uint16_t maximum_find_close_node_failures;
+  // Number of FindNodes requests an iterative node lookup keeps in flight, and how long it waits
+  // for each response.
+  static uint16_t node_lookup_alpha;
+  static std::chrono::steady_clock::duration node_lookup_timeout;
   static uint16_t max_route_history;
   static uint16_t hops_to_live;
   static uint16_t greedy_fraction;
@@ -59,6 +96,40 @@ struct Parameters {
   static bool append_maidsafe_local_endpoints;
   static bool append_local_live_port_endpoint;
   static bool caching;
+  // Enables the routing layer's own chunk cache, bounded by num_chunks_to_cache entries and
+  // max_cache_size_bytes in total.
+  static bool routing_layer_cache;
+  static uint32_t max_cache_size_bytes;
+  // Only admits a chunk to the routing layer cache when it is requested more frequently than the
+  // entry it would evict.
+  static bool cache_admission_filter;
+  // Period at which a summary of the routing layer cache is sent to the closest peers.
+  static std::chrono::seconds cache_summary_interval;
+  // Number of peers closest to a cacheable GET's destination which are checked for a cached copy
+  // before falling back to the normal next hop.  Zero disables cache-aware routing and the sending
+  // of cache summaries.
+  static uint16_t cache_aware_routing_candidates;
+  // Directory holding the persistent second tier of the routing layer cache; each node uses its own
+  // subdirectory.  The disk tier is disabled if this is empty.
+  static boost::filesystem::path disk_cache_path;
+  static uint64_t max_disk_cache_size;
+  // Directory holding each vault's snapshot of its routing table, used to reconnect to the same
+  // peers after a restart.  Snapshots are disabled if this is empty.
+  static boost::filesystem::path routing_table_snapshot_path;
+  static std::chrono::seconds routing_table_snapshot_interval;
+  // Directory in which each node writes its metrics every metrics_export_interval, in the format
+  // read by the Prometheus node_exporter text file collector.  Metrics aren't exported if this is
+  // empty.
+  static boost::filesystem::path metrics_export_path;
+  static std::chrono::seconds metrics_export_interval;
+  // Fraction of the node level messages sent by this node which record their hops, and the
+  // directory in which each node appends the traces of messages delivered to or dropped by it.
+  // Traces are read by the routing_trace tool.  Not collected if the path is empty.
+  static double message_trace_sample_rate;
+  static boost::filesystem::path message_trace_path;
+  // Minimum period between sends of changed group matrices to the network viewer, in TESTING
+  // builds with the viewer running.  Only each node's latest matrix is sent.
+  static std::chrono::milliseconds network_viewer_update_interval;
 
  private:
   Parameters();
@@ -32,6 +32,7 @@
 #define MAIDSAFE_ROUTING_ROUTING_API_H_
 
 #include <condition_variable>
+#include <cstdint>
 #include <future>
 #include <memory>
 #include <mutex>
@@ -152,6 +153,10 @@ class Routing {
   // Returns the closest nodes to info_id
   std::future<std::vector<NodeId>> GetGroup(const NodeId& group_id);
 
+  // Returns the estimated number of vaults in the network, based on the recent average distance to
+  // the furthest member of a group.  Returns 0 until this node has learned enough peers.
+  uint64_t EstimateNetworkSize() const;
+
   // Returns this node's id.
   NodeId kNodeId() const;
 
@@ -167,6 +172,15 @@ class Routing {
   // Checks if client routing table contains given node id
   bool IsConnectedClient(const NodeId& node_id);
 
+  // Returns hit ratio, bytes served and related counters of the routing layer cache.  All zero if
+  // Parameters::routing_layer_cache is disabled or this is a client node.
+  CacheStatistics cache_statistics();
+
+  // Returns a snapshot of this node's message, send, routing table and cache counters, and of its
+  // send and message handling latencies.  If built with ROUTING_LOCK_PROFILING, also includes the
+  // contention of routing's mutexes, summed over every node in the process.
+  RoutingMetrics GetMetrics();
+
   friend class test::GenericNode;
 
  private:
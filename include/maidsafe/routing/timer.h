@@ -19,6 +19,7 @@
 #ifndef MAIDSAFE_ROUTING_TIMER_H_
 #define MAIDSAFE_ROUTING_TIMER_H_
 
+#include <atomic>
 #include <condition_variable>
 #include <chrono>
 #include <cstdint>
@@ -28,7 +29,6 @@
 #include <memory>
 #include <mutex>
 
-#include "boost/asio/steady_timer.hpp"
 #include "boost/asio/error.hpp"
 
 #include "maidsafe/common/asio_service.h"
@@ -36,6 +36,9 @@
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/instrumented_mutex.h"
+
 namespace maidsafe {
 
 namespace routing {
@@ -69,11 +72,13 @@ class Timer {
   void AddResponse(TaskId task_id, const Response& response);
 
   TaskId NewTaskId();
+  // Number of tasks which have reached their deadline before receiving all expected responses.
+  uint64_t timeout_count() const { return timeout_count_; }
 
   friend class test::TimerTest;
 
   void PrintTaskIds() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     LOG(kVerbose) << "This timer containing following tasks : ";
     for (auto& task : tasks_) {
       LOG(kVerbose) << "      task id   ---   " << task.first;
@@ -87,7 +92,7 @@ class Timer {
     Task(Task&& other);
     Task& operator=(Task&& other);
 
-    std::unique_ptr<boost::asio::steady_timer> timer;
+    std::unique_ptr<SteadyTimer> timer;
     ResponseFunctor functor;
     int outstanding_response_count;
 
@@ -105,9 +110,10 @@ class Timer {
 
   AsioService& asio_service_;
   TaskId new_task_id_;
-  std::mutex mutex_;
-  std::condition_variable cond_var_;
+  InstrumentedMutex mutex_;
+  InstrumentedConditionVariable cond_var_;
   std::map<TaskId, Task> tasks_;
+  std::atomic<uint64_t> timeout_count_;
 };
 
 // ==================== Implementation =============================================================
@@ -115,7 +121,7 @@ template <typename Response>
 Timer<Response>::Task::Task(boost::asio::io_service& io_service,
                             const std::chrono::steady_clock::duration& timeout,
                             ResponseFunctor functor_in, int expected_response_count)
-    : timer(new boost::asio::steady_timer(io_service, timeout)),
+    : timer(new SteadyTimer(io_service, timeout)),
       functor(std::move(functor_in)),
       outstanding_response_count(expected_response_count) {}
 
@@ -135,12 +141,17 @@ typename Timer<Response>::Task& Timer<Response>::Task::operator=(Task&& other) {
 
 template <typename Response>
 Timer<Response>::Timer(AsioService& asio_service)
-    : asio_service_(asio_service), new_task_id_(RandomInt32()), mutex_(), cond_var_(), tasks_() {}
+    : asio_service_(asio_service),
+      new_task_id_(RandomInt32()),
+      mutex_("timer"),
+      cond_var_(),
+      tasks_(),
+      timeout_count_(0) {}
 
 template <typename Response>
 Timer<Response>::~Timer() {
   LOG(kVerbose) << "Timer<Response>::Destructor";
-  std::unique_lock<std::mutex> lock(mutex_);
+  InstrumentedUniqueLock lock(mutex_);
   LOG(kVerbose) << "Timer<Response>::Destructor process destruction " << tasks_.size();
   for (const auto& task : tasks_)
     task.second.timer->cancel();
@@ -159,7 +170,7 @@ void Timer<Response>::AddTask(const std::chrono::steady_clock::duration& timeout
                 << " incorrect expected_response_count";
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
   }
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   LOG(kVerbose) << "Timer<Response>::AddTask process adding task " << task_id;
   auto result(tasks_.insert(std::move(
       std::make_pair(task_id, std::move(Task(asio_service_.service(), timeout, response_functor,
@@ -176,7 +187,7 @@ void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code
   ResponseFunctor functor;
   LOG(kVerbose) << "Timer<Response>::FinishTask finish task " << task_id;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     LOG(kVerbose) << "Timer<Response>::FinishTask process finishing task " << task_id;
     auto itr(tasks_.find(task_id));
     if (itr == std::end(tasks_)) {
@@ -196,6 +207,7 @@ void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code
     switch (error.value()) {
       case boost::system::errc::success:  // Task's timer has expired
         LOG(kWarning) << "Timed out waiting for task " << task_id;
+        ++timeout_count_;
         break;
       case boost::asio::error::operation_aborted:  // Cancelled via CancelTask
         LOG(kInfo) << "Cancelled task " << task_id;
@@ -214,7 +226,7 @@ void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code
 template <typename Response>
 void Timer<Response>::CancelTask(TaskId task_id) {
   LOG(kVerbose) << "Timer<Response>::CancelTask task " << task_id << " is to be canceled";
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   LOG(kVerbose) << "Timer<Response>::CancelTask process cancelling task " << task_id;
   auto itr(tasks_.find(task_id));
   if (itr == std::end(tasks_)) {
@@ -230,7 +242,7 @@ void Timer<Response>::AddResponse(TaskId task_id, const Response& response) {
   ResponseFunctor functor;
   LOG(kVerbose) << "Timer<Response>::AddResponse add response to task " << task_id;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     LOG(kVerbose) << "Timer<Response>::AddResponse process adding response to task " << task_id;
     auto itr(tasks_.find(task_id));
     if (itr == std::end(tasks_)) {
@@ -255,7 +267,7 @@ void Timer<Response>::AddResponse(TaskId task_id, const Response& response) {
 template <typename Response>
 TaskId Timer<Response>::NewTaskId() {
   LOG(kVerbose) << "Timer<Response>::NewTaskId";
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   LOG(kVerbose) << "Timer<Response>::NewTaskId completed";
   return new_task_id_++;
 }
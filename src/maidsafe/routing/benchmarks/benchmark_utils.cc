@@ -0,0 +1,61 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/benchmarks/benchmark_utils.h"
+
+#include "maidsafe/routing/tests/test_utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+const size_t kBenchmarkNodeCount(128);
+const size_t kBenchmarkTargetCount(1024);
+
+}  // unnamed namespace
+
+const std::vector<NodeInfo>& BenchmarkNodes() {
+  static const std::vector<NodeInfo> nodes([] {
+    std::vector<NodeInfo> generated_nodes;
+    for (size_t i(0); i != kBenchmarkNodeCount; ++i)
+      generated_nodes.push_back(MakeNode());
+    return generated_nodes;
+  }());
+  return nodes;
+}
+
+const std::vector<NodeId>& BenchmarkTargets() {
+  static const std::vector<NodeId> targets([] {
+    std::vector<NodeId> generated_targets;
+    for (size_t i(0); i != kBenchmarkTargetCount; ++i)
+      generated_targets.push_back(NodeId(NodeId::kRandomId));
+    return generated_targets;
+  }());
+  return targets;
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,48 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_BENCHMARKS_BENCHMARK_UTILS_H_
+#define MAIDSAFE_ROUTING_BENCHMARKS_BENCHMARK_UTILS_H_
+
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/node_info.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+// Nodes with valid and distinct keys, generated on first use and shared by all benchmarks, since
+// key generation would otherwise dwarf the operations being measured.
+const std::vector<NodeInfo>& BenchmarkNodes();
+
+// Random ids, for use as the targets of lookups.
+const std::vector<NodeId>& BenchmarkTargets();
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_BENCHMARKS_BENCHMARK_UTILS_H_
@@ -0,0 +1,157 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/benchmarks/benchmark_utils.h"
+#include "maidsafe/routing/group_matrix.h"
+#include "maidsafe/routing/matrix_change.h"
+#include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+std::vector<NodeInfo> MakeRow() {
+  std::vector<NodeInfo> row(Parameters::closest_nodes_size);
+  for (auto& node : row)
+    node.node_id = NodeId(NodeId::kRandomId);
+  return row;
+}
+
+// A matrix with the requested number of connected peers, each with a full row of random nodes.
+struct FilledGroupMatrix {
+  explicit FilledGroupMatrix(size_t connected_peer_count)
+      : node_id(NodeId::kRandomId), group_matrix(node_id, false), connected_peers() {
+    for (size_t i(0); i != connected_peer_count; ++i) {
+      NodeInfo peer;
+      peer.node_id = NodeId(NodeId::kRandomId);
+      group_matrix.AddConnectedPeer(peer, MakeRow());
+      connected_peers.push_back(peer);
+    }
+  }
+
+  NodeId node_id;
+  GroupMatrix group_matrix;
+  std::vector<NodeInfo> connected_peers;
+};
+
+void ConnectedPeerCounts(benchmark::internal::Benchmark* benchmark) {
+  for (int count(Parameters::closest_nodes_size / 2); count <= Parameters::closest_nodes_size * 2;
+       count *= 2) {
+    benchmark->Arg(count);
+  }
+}
+
+std::vector<NodeId> RandomIds(size_t count) {
+  std::vector<NodeId> ids;
+  for (size_t i(0); i != count; ++i)
+    ids.push_back(NodeId(NodeId::kRandomId));
+  return ids;
+}
+
+}  // unnamed namespace
+
+class MatrixChangeBenchmark {
+ public:
+  static MatrixChange Make(const NodeId& node_id, const std::vector<NodeId>& old_matrix,
+                           const std::vector<NodeId>& new_matrix) {
+    return MatrixChange(node_id, old_matrix, new_matrix);
+  }
+};
+
+void BM_GroupMatrixUpdateFromConnectedPeer(benchmark::State& state) {
+  FilledGroupMatrix matrix(static_cast<size_t>(state.range(0)));
+  const NodeId peer_id(matrix.connected_peers.front().node_id);
+  const std::vector<NodeInfo> rows[] = { MakeRow(), MakeRow() };
+  size_t index(0);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(matrix.group_matrix.UpdateFromConnectedPeer(
+        peer_id, rows[index++ % 2], matrix.group_matrix.GetUniqueNodeIds()));
+  }
+}
+BENCHMARK(BM_GroupMatrixUpdateFromConnectedPeer)->Apply(ConnectedPeerCounts);
+
+void BM_GroupMatrixIsNodeIdInGroupRange(benchmark::State& state) {
+  FilledGroupMatrix matrix(static_cast<size_t>(state.range(0)));
+  const std::vector<NodeId>& targets(BenchmarkTargets());
+  size_t index(0);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(matrix.group_matrix.IsNodeIdInGroupRange(
+        targets[index++ % targets.size()], matrix.node_id));
+  }
+}
+BENCHMARK(BM_GroupMatrixIsNodeIdInGroupRange)->Apply(ConnectedPeerCounts);
+
+void BM_GroupMatrixGetBetterNodeForSendingMessage(benchmark::State& state) {
+  FilledGroupMatrix matrix(static_cast<size_t>(state.range(0)));
+  const std::vector<NodeId>& targets(BenchmarkTargets());
+  const std::vector<std::string> exclude;
+  size_t index(0);
+  while (state.KeepRunning()) {
+    NodeInfo closest_peer(matrix.connected_peers.front());
+    matrix.group_matrix.GetBetterNodeForSendingMessage(targets[index++ % targets.size()],
+                                                       exclude, false, closest_peer);
+    benchmark::DoNotOptimize(closest_peer);
+  }
+}
+BENCHMARK(BM_GroupMatrixGetBetterNodeForSendingMessage)->Apply(ConnectedPeerCounts);
+
+// The matrices hold the unique nodes of a group matrix; the new one has lost one node and gained
+// another.
+void BM_MatrixChangeConstruct(benchmark::State& state) {
+  const NodeId node_id(NodeId::kRandomId);
+  const std::vector<NodeId> old_matrix(RandomIds(static_cast<size_t>(state.range(0))));
+  std::vector<NodeId> new_matrix(old_matrix.begin() + 1, old_matrix.end());
+  new_matrix.push_back(NodeId(NodeId::kRandomId));
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(MatrixChangeBenchmark::Make(node_id, old_matrix, new_matrix));
+}
+BENCHMARK(BM_MatrixChangeConstruct)->Range(Parameters::closest_nodes_size,
+                                           Parameters::closest_nodes_size * 16);
+
+void BM_MatrixChangeCheckHolders(benchmark::State& state) {
+  const NodeId node_id(NodeId::kRandomId);
+  const std::vector<NodeId> old_matrix(RandomIds(static_cast<size_t>(state.range(0))));
+  std::vector<NodeId> new_matrix(old_matrix.begin() + 1, old_matrix.end());
+  new_matrix.push_back(NodeId(NodeId::kRandomId));
+  const MatrixChange matrix_change(MatrixChangeBenchmark::Make(node_id, old_matrix, new_matrix));
+  const std::vector<NodeId>& targets(BenchmarkTargets());
+  size_t index(0);
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(matrix_change.CheckHolders(targets[index++ % targets.size()]));
+}
+BENCHMARK(BM_MatrixChangeCheckHolders)->Range(Parameters::closest_nodes_size,
+                                              Parameters::closest_nodes_size * 16);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
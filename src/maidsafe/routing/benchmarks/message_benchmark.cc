@@ -0,0 +1,90 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+// A node level request carrying a payload of the given size, with the fields set as they are on a
+// message part way along its route.
+protobuf::Message MakeMessage(size_t payload_size) {
+  protobuf::Message message;
+  message.set_source_id(NodeId(NodeId::kRandomId).string());
+  message.set_destination_id(NodeId(NodeId::kRandomId).string());
+  message.set_last_id(NodeId(NodeId::kRandomId).string());
+  message.set_routing_message(false);
+  message.add_data(RandomString(payload_size));
+  message.set_direct(true);
+  message.set_replication(1);
+  message.set_type(100);
+  message.set_id(RandomInt32());
+  message.set_client_node(false);
+  message.set_request(true);
+  message.set_hops_to_live(Parameters::hops_to_live);
+  for (int i(0); i != Parameters::max_route_history; ++i)
+    message.add_route_history(NodeId(NodeId::kRandomId).string());
+  return message;
+}
+
+void PayloadSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Arg(64)->Arg(1024)->Arg(64 * 1024)->Arg(1024 * 1024);
+}
+
+}  // unnamed namespace
+
+void BM_MessageSerialise(benchmark::State& state) {
+  const protobuf::Message message(MakeMessage(static_cast<size_t>(state.range(0))));
+  std::string serialised_message;
+  while (state.KeepRunning()) {
+    message.SerializeToString(&serialised_message);
+    benchmark::DoNotOptimize(serialised_message);
+  }
+  state.SetBytesProcessed(state.iterations() * serialised_message.size());
+}
+BENCHMARK(BM_MessageSerialise)->Apply(PayloadSizes);
+
+void BM_MessageParse(benchmark::State& state) {
+  const std::string serialised_message(
+      MakeMessage(static_cast<size_t>(state.range(0))).SerializeAsString());
+  protobuf::Message message;
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(message.ParseFromString(serialised_message));
+  state.SetBytesProcessed(state.iterations() * serialised_message.size());
+}
+BENCHMARK(BM_MessageParse)->Apply(PayloadSizes);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,140 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+
+#include "maidsafe/routing/benchmarks/benchmark_utils.h"
+#include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_table.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+// A vault's routing table filled from the shared node pool up to the requested size.  Nodes from
+// the pool which weren't added are kept as candidates for the add benchmarks.  A node evicted to
+// make space for an added one is kept in evicted_node, so that it can be restored.
+struct FilledRoutingTable {
+  explicit FilledRoutingTable(size_t size)
+      : node_id(NodeId::kRandomId),
+        network_statistics(node_id),
+        routing_table(new RoutingTable(false, node_id, asymm::GenerateKeyPair(),
+                                       network_statistics)),
+        spare_nodes(),
+        evicted_node() {
+    routing_table->InitialiseFunctors(
+        nullptr, [this](const NodeInfo& node, bool) { evicted_node = node; }, [] {}, nullptr,
+        nullptr);
+    for (const auto& node : BenchmarkNodes()) {
+      if (routing_table->size() == size || !routing_table->AddNode(node))
+        spare_nodes.push_back(node);
+    }
+  }
+
+  NodeId node_id;
+  NetworkStatistics network_statistics;
+  std::unique_ptr<RoutingTable> routing_table;
+  std::vector<NodeInfo> spare_nodes;
+  NodeInfo evicted_node;
+};
+
+void TableSizes(benchmark::internal::Benchmark* benchmark) {
+  for (int size(8); size <= Parameters::max_routing_table_size; size *= 2)
+    benchmark->Arg(size);
+}
+
+}  // unnamed namespace
+
+void BM_RoutingTableAddNode(benchmark::State& state) {
+  FilledRoutingTable table(static_cast<size_t>(state.range(0)));
+  size_t index(0);
+  while (state.KeepRunning()) {
+    const NodeInfo& node(table.spare_nodes[index++ % table.spare_nodes.size()]);
+    benchmark::DoNotOptimize(table.routing_table->AddNode(node));
+    state.PauseTiming();
+    table.routing_table->DropNode(node.node_id, true);
+    if (!table.evicted_node.node_id.IsZero()) {
+      table.routing_table->AddNode(table.evicted_node);
+      table.evicted_node = NodeInfo();
+    }
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_RoutingTableAddNode)->Apply(TableSizes);
+
+void BM_RoutingTableDropNode(benchmark::State& state) {
+  FilledRoutingTable table(static_cast<size_t>(state.range(0)));
+  std::vector<NodeInfo> nodes(table.routing_table->GetNodes());
+  size_t index(0);
+  while (state.KeepRunning()) {
+    const NodeInfo& node(nodes[index++ % nodes.size()]);
+    benchmark::DoNotOptimize(table.routing_table->DropNode(node.node_id, true));
+    state.PauseTiming();
+    table.routing_table->AddNode(node);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_RoutingTableDropNode)->Apply(TableSizes);
+
+void BM_RoutingTableGetClosestNode(benchmark::State& state) {
+  FilledRoutingTable table(static_cast<size_t>(state.range(0)));
+  const std::vector<NodeId>& targets(BenchmarkTargets());
+  size_t index(0);
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(
+        table.routing_table->GetClosestNode(targets[index++ % targets.size()]));
+}
+BENCHMARK(BM_RoutingTableGetClosestNode)->Apply(TableSizes);
+
+void BM_RoutingTableGetNodeForSendingMessage(benchmark::State& state) {
+  FilledRoutingTable table(static_cast<size_t>(state.range(0)));
+  const std::vector<NodeId>& targets(BenchmarkTargets());
+  const std::vector<std::string> exclude;
+  size_t index(0);
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(table.routing_table->GetNodeForSendingMessage(
+        targets[index++ % targets.size()], exclude));
+}
+BENCHMARK(BM_RoutingTableGetNodeForSendingMessage)->Apply(TableSizes);
+
+// Copies out every node, as the paths which snapshot the table for sending do.
+void BM_RoutingTableGetNodes(benchmark::State& state) {
+  FilledRoutingTable table(static_cast<size_t>(state.range(0)));
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(table.routing_table->GetNodes());
+}
+BENCHMARK(BM_RoutingTableGetNodes)->Apply(TableSizes);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
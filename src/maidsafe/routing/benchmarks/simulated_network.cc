@@ -0,0 +1,269 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/benchmarks/simulated_network.h"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/return_codes.h"
+#include "maidsafe/routing/transport.h"
+#include "maidsafe/routing/tests/test_utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+typedef boost::asio::ip::udp::endpoint Endpoint;
+
+const int kNetworkThreadCount(4);
+const uint16_t kZeroStatePort(5483);
+const size_t kJoinBatchSize(50);
+const std::chrono::seconds kJoinTimeout(60);
+const std::chrono::milliseconds kPollInterval(50);
+const size_t kBootstrapContactCount(4);
+// Bootstrap contacts reported once this many are held replace random earlier ones.
+const size_t kMaxBootstrapContacts(1024);
+
+}  // unnamed namespace
+
+struct SimulatedNetwork::Vault {
+  explicit Vault(const passport::Pmid& pmid)
+      : node_id(pmid.name()->string()), public_key(pmid.public_key()), routing(new Routing(pmid)) {}
+  NodeId node_id;
+  asymm::PublicKey public_key;
+  std::unique_ptr<Routing> routing;
+};
+
+SimulatedNetwork::SimulatedNetwork(const NetworkConditions& conditions)
+    : network_(conditions, kNetworkThreadCount),
+      mutex_(),
+      public_keys_(),
+      matrix_changed_(),
+      bootstrap_contacts_(),
+      vaults_(),
+      requests_received_(0) {
+  SetTransportFactory(network_.transport_factory());
+}
+
+SimulatedNetwork::~SimulatedNetwork() {
+  vaults_.clear();
+  SetTransportFactory(TransportFactory());
+}
+
+void SimulatedNetwork::set_matrix_changed_functor(
+    const VaultMatrixChangedFunctor& matrix_changed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  matrix_changed_ = matrix_changed;
+}
+
+bool SimulatedNetwork::Grow(size_t vault_count) {
+  if (vault_count <= vaults_.size())
+    return true;
+  auto vaults(MakeVaults(vault_count - vaults_.size()));
+  auto next_vault(vaults.begin());
+  if (vaults_.empty()) {
+    if (vault_count < 2)
+      return false;
+    Vault& vault0(**next_vault++);
+    Vault& vault1(**next_vault++);
+    const Endpoint kEndpoint0(boost::asio::ip::address_v4::loopback(), kZeroStatePort);
+    const Endpoint kEndpoint1(boost::asio::ip::address_v4::loopback(), kZeroStatePort + 1);
+    NodeInfo node_info0, node_info1;
+    node_info0.node_id = node_info0.connection_id = vault0.node_id;
+    node_info0.public_key = vault0.public_key;
+    node_info1.node_id = node_info1.connection_id = vault1.node_id;
+    node_info1.public_key = vault1.public_key;
+    Functors functors0(MakeFunctors(vault0.node_id)), functors1(MakeFunctors(vault1.node_id));
+    auto join0(std::async(std::launch::async, [&] {
+      return vault0.routing->ZeroStateJoin(functors0, kEndpoint0, kEndpoint1, node_info1);
+    }));
+    auto join1(std::async(std::launch::async, [&] {
+      return vault1.routing->ZeroStateJoin(functors1, kEndpoint1, kEndpoint0, node_info0);
+    }));
+    // The joins may need the virtual clock to move on
+    while (join0.wait_for(std::chrono::seconds(0)) != std::future_status::ready ||
+           join1.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      Run(kPollInterval);
+    }
+    int result0(join0.get()), result1(join1.get());
+    if (result0 != kSuccess || result1 != kSuccess) {
+      LOG(kError) << "Zero state join failed: " << result0 << ", " << result1;
+      return false;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      bootstrap_contacts_.push_back(kEndpoint0);
+      bootstrap_contacts_.push_back(kEndpoint1);
+    }
+    vaults_.push_back(std::move(vaults.front()));
+    vaults_.push_back(std::move(vaults.at(1)));
+  }
+
+  while (next_vault != vaults.end()) {
+    size_t first_index(vaults_.size());
+    for (size_t i(0); i != kJoinBatchSize && next_vault != vaults.end(); ++i, ++next_vault) {
+      (*next_vault)->routing->Join(MakeFunctors((*next_vault)->node_id),
+                                   RandomBootstrapContacts());
+      vaults_.push_back(std::move(*next_vault));
+    }
+    if (!WaitForJoin(first_index))
+      return false;
+  }
+  return true;
+}
+
+void SimulatedNetwork::AddVault() {
+  auto vaults(MakeVaults(1));
+  vaults.front()->routing->Join(MakeFunctors(vaults.front()->node_id), RandomBootstrapContacts());
+  vaults_.push_back(std::move(vaults.front()));
+}
+
+void SimulatedNetwork::RemoveVault(size_t index) {
+  vaults_.erase(vaults_.begin() + index);
+}
+
+void SimulatedNetwork::Run(const Clock::duration& duration) const {
+  if (Clock::virtual_time_enabled())
+    Clock::Advance(duration);
+  else
+    std::this_thread::sleep_for(duration);
+}
+
+Routing& SimulatedNetwork::vault(size_t index) { return *vaults_.at(index)->routing; }
+
+NodeId SimulatedNetwork::vault_id(size_t index) const { return vaults_.at(index)->node_id; }
+
+uint64_t SimulatedNetwork::SumCounter(const std::string& name) {
+  uint64_t sum(0);
+  for (const auto& vault : vaults_) {
+    RoutingMetrics metrics(vault->routing->GetMetrics());
+    auto itr(metrics.counters.find(name));
+    if (itr != metrics.counters.end())
+      sum += itr->second;
+  }
+  return sum;
+}
+
+std::vector<std::unique_ptr<SimulatedNetwork::Vault>> SimulatedNetwork::MakeVaults(size_t count) {
+  // Key generation dominates the setup of a large network, so is spread over all cores.
+  const size_t kThreadCount(std::max(1U, std::thread::hardware_concurrency()));
+  std::vector<std::future<std::vector<std::unique_ptr<Vault>>>> futures;
+  for (size_t i(0); i != kThreadCount; ++i) {
+    size_t share(count / kThreadCount + (i < count % kThreadCount ? 1 : 0));
+    futures.push_back(std::async(std::launch::async, [share] {
+      std::vector<std::unique_ptr<Vault>> vaults;
+      for (size_t j(0); j != share; ++j)
+        vaults.emplace_back(new Vault(MakePmid()));
+      return vaults;
+    }));
+  }
+  std::vector<std::unique_ptr<Vault>> vaults;
+  for (auto& future : futures) {
+    auto share(future.get());
+    std::move(share.begin(), share.end(), std::back_inserter(vaults));
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& vault : vaults)
+    public_keys_.insert(std::make_pair(vault->node_id, vault->public_key));
+  return vaults;
+}
+
+Functors SimulatedNetwork::MakeFunctors(const NodeId& vault_id) {
+  Functors functors;
+  functors.request_public_key = [this](NodeId node_id, GivePublicKeyFunctor give_public_key) {
+    asymm::PublicKey public_key;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto itr(public_keys_.find(node_id));
+      if (itr == public_keys_.end())
+        return;
+      public_key = itr->second;
+    }
+    give_public_key(public_key);
+  };
+  functors.message_and_caching.message_received = [this](const std::string& message,
+                                                         ReplyFunctor reply_functor) {
+    ++requests_received_;
+    reply_functor(message);
+  };
+  functors.matrix_changed = [this, vault_id](std::shared_ptr<MatrixChange> matrix_change) {
+    VaultMatrixChangedFunctor matrix_changed;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      matrix_changed = matrix_changed_;
+    }
+    if (matrix_changed)
+      matrix_changed(vault_id, matrix_change);
+  };
+  functors.new_bootstrap_contact = [this](const BootstrapContact& bootstrap_contact) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (bootstrap_contacts_.size() < kMaxBootstrapContacts)
+      bootstrap_contacts_.push_back(bootstrap_contact);
+    else
+      bootstrap_contacts_.at(RandomUint32() % kMaxBootstrapContacts) = bootstrap_contact;
+  };
+  return functors;
+}
+
+std::vector<Endpoint> SimulatedNetwork::RandomBootstrapContacts() {
+  std::vector<Endpoint> bootstrap_contacts;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i(0); i != kBootstrapContactCount; ++i) {
+    bootstrap_contacts.push_back(
+        bootstrap_contacts_.at(RandomUint32() % bootstrap_contacts_.size()));
+  }
+  return bootstrap_contacts;
+}
+
+bool SimulatedNetwork::WaitForJoin(size_t first_index) const {
+  const int kExpectedHealth(
+      static_cast<int>(std::min(static_cast<size_t>(Parameters::closest_nodes_size),
+                                vaults_.size() - 1) * 100 / Parameters::max_routing_table_size));
+  const auto kDeadline(Clock::now() + kJoinTimeout);
+  for (size_t index(first_index); index != vaults_.size(); ++index) {
+    while (vaults_.at(index)->routing->network_status() < kExpectedHealth) {
+      if (Clock::now() > kDeadline) {
+        LOG(kError) << "Vault " << DebugId(vaults_.at(index)->node_id) << " failed to join.";
+        return false;
+      }
+      Run(kPollInterval);
+    }
+  }
+  return true;
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
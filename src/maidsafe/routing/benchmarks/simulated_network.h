@@ -0,0 +1,108 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_BENCHMARKS_SIMULATED_NETWORK_H_
+#define MAIDSAFE_ROUTING_BENCHMARKS_SIMULATED_NETWORK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "boost/asio/ip/udp.hpp"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+
+#include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/in_memory_transport.h"
+#include "maidsafe/routing/matrix_change.h"
+#include "maidsafe/routing/routing_api.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+// Runs full vaults in this process over an InMemoryNetwork.  While it exists, every transport made
+// by routing is an in-memory one, so only one SimulatedNetwork may exist at a time.  Each vault
+// answers requests by echoing them back, and validates peers from the keys of all simulated vaults.
+// The network runs in virtual time if Clock::EnableVirtualTime is called before it is constructed,
+// in which case the clock is advanced whenever the network is left to run.
+class SimulatedNetwork {
+ public:
+  typedef std::function<void(const NodeId& /*vault_id*/, std::shared_ptr<MatrixChange>)>
+      VaultMatrixChangedFunctor;
+
+  explicit SimulatedNetwork(const NetworkConditions& conditions);
+  ~SimulatedNetwork();
+  // Invoked on every change of any vault's group matrix, on the vault's threads.
+  void set_matrix_changed_functor(const VaultMatrixChangedFunctor& matrix_changed);
+  // Adds vaults until there are 'vault_count'.  The first two join in zero state and the rest join
+  // in batches, each bootstrapping off vaults which have already joined.  Returns false if a batch
+  // fails to fill its vaults' close groups in time.
+  bool Grow(size_t vault_count);
+  // Adds a vault, which bootstraps off vaults already in the network, without waiting for it to
+  // join.  Requires the network to have been grown.
+  void AddVault();
+  // Stops the vault, which leaves the network without notifying its peers.
+  void RemoveVault(size_t index);
+  // Lets the network run for 'duration'.
+  void Run(const Clock::duration& duration) const;
+  size_t size() const { return vaults_.size(); }
+  Routing& vault(size_t index);
+  NodeId vault_id(size_t index) const;
+  // Sum over all vaults of the counter 'name' reported by Routing::GetMetrics.
+  uint64_t SumCounter(const std::string& name);
+  uint64_t requests_received() const { return requests_received_; }
+  InMemoryNetwork& network() { return network_; }
+
+ private:
+  struct Vault;
+
+  SimulatedNetwork(const SimulatedNetwork&);
+  SimulatedNetwork& operator=(const SimulatedNetwork&);
+
+  std::vector<std::unique_ptr<Vault>> MakeVaults(size_t count);
+  Functors MakeFunctors(const NodeId& vault_id);
+  std::vector<boost::asio::ip::udp::endpoint> RandomBootstrapContacts();
+  bool WaitForJoin(size_t first_index) const;
+
+  InMemoryNetwork network_;
+  std::mutex mutex_;
+  std::map<NodeId, asymm::PublicKey> public_keys_;
+  VaultMatrixChangedFunctor matrix_changed_;
+  std::vector<boost::asio::ip::udp::endpoint> bootstrap_contacts_;
+  std::vector<std::unique_ptr<Vault>> vaults_;
+  std::atomic<uint64_t> requests_received_;
+};
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_BENCHMARKS_SIMULATED_NETWORK_H_
@@ -0,0 +1,112 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/benchmarks/simulated_network.h"
+#include "maidsafe/routing/in_memory_transport.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+const int kRequestCount(10000);
+const size_t kRequestSize(1024);
+const char kNodeLevelReceivedCounter[] = "routing_messages_received_total{type=\"node_level\"}";
+
+}  // unnamed namespace
+
+// Sends requests between random vaults of a network of the given size, each answered by its
+// destination, and reports the mean hops taken by each delivered request and response, the
+// fraction of requests answered and the CPU time used per vault.  Building the network isn't
+// timed.  Hops are counted from the vaults' node level receive counters, so also include those of
+// any request or response lost part way.
+void BM_SimulatedNetwork(benchmark::State& state) {
+  NetworkConditions conditions;
+  conditions.min_latency = std::chrono::milliseconds(5);
+  conditions.max_latency = std::chrono::milliseconds(50);
+  conditions.loss_rate = 0.001;
+  SimulatedNetwork network(conditions);
+  if (!network.Grow(static_cast<size_t>(state.range(0)))) {
+    state.SkipWithError("Failed to build the network.");
+    return;
+  }
+
+  const std::string kRequest(RandomString(kRequestSize));
+  while (state.KeepRunning()) {
+    const uint64_t kHopsBefore(network.SumCounter(kNodeLevelReceivedCounter));
+    const uint64_t kRequestsReceivedBefore(network.requests_received());
+    std::atomic<uint64_t> response_count(0);
+    std::mutex mutex;
+    std::condition_variable cond_var;
+    int completed_count(0);
+    const std::clock_t kCpuStart(std::clock());
+    for (int i(0); i != kRequestCount; ++i) {
+      size_t sender(RandomUint32() % network.size());
+      size_t receiver((sender + 1 + RandomUint32() % (network.size() - 1)) % network.size());
+      network.vault(sender).SendDirect(network.vault_id(receiver), kRequest, false,
+                                       [&](std::string response) {
+        if (!response.empty())
+          ++response_count;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (++completed_count == kRequestCount)
+          cond_var.notify_one();
+      });
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond_var.wait(lock, [&] { return completed_count == kRequestCount; });
+    }
+    const double kCpuSeconds(static_cast<double>(std::clock() - kCpuStart) / CLOCKS_PER_SEC);
+
+    const uint64_t kDeliveredCount(network.requests_received() - kRequestsReceivedBefore +
+                                   response_count);
+    const uint64_t kHops(network.SumCounter(kNodeLevelReceivedCounter) - kHopsBefore);
+    state.counters["hops"] =
+        kDeliveredCount == 0 ? 0.0 : static_cast<double>(kHops) / kDeliveredCount;
+    state.counters["delivery_rate"] = static_cast<double>(response_count) / kRequestCount;
+    state.counters["cpu_per_node_us"] = kCpuSeconds * 1e6 / network.size();
+  }
+}
+BENCHMARK(BM_SimulatedNetwork)
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Arg(10000)
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,59 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <chrono>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/asio_service.h"
+
+#include "maidsafe/routing/timer.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+// Each iteration adds a task expecting the given number of responses and then responds to it,
+// which is the path taken by every request sent through Routing::Send.
+void BM_TimerAddAndRespond(benchmark::State& state) {
+  AsioService asio_service(2);
+  {
+    Timer<std::string> timer(asio_service);
+    const int kExpectedResponseCount(static_cast<int>(state.range(0)));
+    const std::string kResponse("response");
+    auto response_functor([](std::string response) { benchmark::DoNotOptimize(response); });
+    while (state.KeepRunning()) {
+      TaskId task_id(timer.NewTaskId());
+      timer.AddTask(std::chrono::seconds(10), response_functor, kExpectedResponseCount, task_id);
+      for (int i(0); i != kExpectedResponseCount; ++i)
+        timer.AddResponse(task_id, kResponse);
+    }
+  }
+  asio_service.Stop();
+}
+BENCHMARK(BM_TimerAddAndRespond)->Arg(1)->Arg(4);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
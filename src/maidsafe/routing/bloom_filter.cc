@@ -0,0 +1,108 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/bloom_filter.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "maidsafe/common/error.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const size_t kHeaderSize(4 + 1 + 4);
+
+void AppendUint32(uint32_t value, std::string& out) {
+  for (int i(0); i != 4; ++i)
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+uint32_t ReadUint32(const std::string& in, size_t offset) {
+  uint32_t value(0);
+  for (int i(0); i != 4; ++i)
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(in[offset + i])) << (8 * i);
+  return value;
+}
+
+}  // unnamed namespace
+
+BloomFilter::BloomFilter(uint32_t bit_count, uint8_t hash_count)
+    : bit_count_(std::max(bit_count, uint32_t(8))),
+      hash_count_(std::max(hash_count, uint8_t(1))),
+      added_count_(0),
+      bits_((bit_count_ + 7) / 8, 0) {}
+
+BloomFilter::BloomFilter(const std::string& serialised)
+    : bit_count_(0), hash_count_(0), added_count_(0), bits_() {
+  if (serialised.size() < kHeaderSize)
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  bit_count_ = ReadUint32(serialised, 0);
+  hash_count_ = static_cast<uint8_t>(serialised[4]);
+  added_count_ = ReadUint32(serialised, 5);
+  if (bit_count_ == 0 || hash_count_ == 0 ||
+      serialised.size() != kHeaderSize + (static_cast<size_t>(bit_count_) + 7) / 8)
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  bits_.assign(serialised.begin() + kHeaderSize, serialised.end());
+}
+
+BloomFilter BloomFilter::ForEntries(size_t expected_entries) {
+  // ~9.6 bits and 7 hashes per entry give a false positive rate of about 1%.
+  return BloomFilter(static_cast<uint32_t>(std::max(size_t(64), expected_entries * 10)), 7);
+}
+
+template <typename Functor>
+void BloomFilter::ForEachBit(const std::string& key, Functor functor) const {
+  uint64_t h1(std::hash<std::string>()(key));
+  uint64_t h2((h1 ^ (h1 >> 33)) * 0xc4ceb9fe1a85ec53ULL);
+  h2 = (h2 ^ (h2 >> 29)) | 1;
+  for (uint8_t i(0); i != hash_count_; ++i)
+    functor(static_cast<uint32_t>((h1 + i * h2) % bit_count_));
+}
+
+void BloomFilter::Add(const std::string& key) {
+  ForEachBit(key, [this](uint32_t bit) { bits_[bit / 8] |= static_cast<uint8_t>(1 << (bit % 8)); });
+  ++added_count_;
+}
+
+bool BloomFilter::ProbablyContains(const std::string& key) const {
+  if (added_count_ == 0)
+    return false;
+  bool contains(true);
+  ForEachBit(key, [this, &contains](uint32_t bit) {
+    contains = contains && (bits_[bit / 8] & (1 << (bit % 8))) != 0;
+  });
+  return contains;
+}
+
+std::string BloomFilter::Serialise() const {
+  std::string serialised;
+  serialised.reserve(kHeaderSize + bits_.size());
+  AppendUint32(bit_count_, serialised);
+  serialised.push_back(static_cast<char>(hash_count_));
+  AppendUint32(added_count_, serialised);
+  serialised.append(bits_.begin(), bits_.end());
+  return serialised;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,59 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_BLOOM_FILTER_H_
+#define MAIDSAFE_ROUTING_BLOOM_FILTER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace maidsafe {
+
+namespace routing {
+
+// Fixed-size Bloom filter used to advertise a compact summary of a node's cached chunks to its
+// peers.  ProbablyContains never gives false negatives, but may give false positives.
+class BloomFilter {
+ public:
+  BloomFilter(uint32_t bit_count, uint8_t hash_count);
+  // Constructs a filter from the output of Serialise.  Throws if serialised is malformed.
+  explicit BloomFilter(const std::string& serialised);
+  // Returns a filter sized to give roughly a 1% false positive rate for expected_entries.
+  static BloomFilter ForEntries(size_t expected_entries);
+
+  void Add(const std::string& key);
+  bool ProbablyContains(const std::string& key) const;
+  bool empty() const { return added_count_ == 0; }
+  std::string Serialise() const;
+
+ private:
+  template <typename Functor>
+  void ForEachBit(const std::string& key, Functor functor) const;
+
+  uint32_t bit_count_;
+  uint8_t hash_count_;
+  uint32_t added_count_;
+  std::vector<uint8_t> bits_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_BLOOM_FILTER_H_
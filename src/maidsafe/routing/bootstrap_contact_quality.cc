@@ -0,0 +1,231 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/bootstrap_contact_quality.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <string>
+
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+// Records older than this are ignored, as the contact has likely gone offline or changed address.
+const std::chrono::hours kStaleAge(24 * 7);
+
+}  // unnamed namespace
+
+BootstrapContactQuality::BootstrapContactQuality() : mutex_(), records_() {}
+
+void BootstrapContactQuality::RecordSuccess(const BootstrapContact& contact,
+                                            std::chrono::milliseconds latency) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Record& record(records_[contact]);
+  // Smooth latency so that a single slow connect doesn't demote a usually fast contact.
+  record.latency = (record.successes == 0) ? latency : (record.latency * 3 + latency) / 4;
+  ++record.attempts;
+  ++record.successes;
+  record.last_seen = std::chrono::system_clock::now();
+}
+
+void BootstrapContactQuality::RecordFailure(const BootstrapContact& contact) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++records_[contact].attempts;
+}
+
+BootstrapContacts BootstrapContactQuality::Order(const BootstrapContacts& contacts,
+                                                 std::chrono::system_clock::time_point now) const {
+  struct Rank {
+    double success_rate;
+    std::chrono::milliseconds latency;
+  };
+  std::map<BootstrapContact, Rank> ranks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& contact : contacts) {
+      // Unknown contacts rank between those which usually succeed and those which usually fail.
+      Rank rank = { 0.5, std::chrono::milliseconds::max() };
+      auto itr(records_.find(contact));
+      if (itr != records_.end() && now - itr->second.last_seen < kStaleAge) {
+        rank.success_rate = (itr->second.successes + 1.0) / (itr->second.attempts + 2.0);
+        rank.latency = itr->second.latency;
+      } else if (itr != records_.end() && itr->second.successes == 0) {
+        rank.success_rate = 1.0 / (itr->second.attempts + 2.0);
+      }
+      ranks[contact] = rank;
+    }
+  }
+  BootstrapContacts ordered(contacts);
+  std::stable_sort(ordered.begin(), ordered.end(),
+                   [&ranks](const BootstrapContact& lhs, const BootstrapContact& rhs) {
+    const Rank& lhs_rank(ranks[lhs]), &rhs_rank(ranks[rhs]);
+    if (lhs_rank.success_rate != rhs_rank.success_rate)
+      return lhs_rank.success_rate > rhs_rank.success_rate;
+    return lhs_rank.latency < rhs_rank.latency;
+  });
+  return ordered;
+}
+
+void BootstrapContactQuality::Load(const boost::filesystem::path& file_path) {
+  protobuf::BootstrapContactQuality proto_quality;
+  try {
+    if (!proto_quality.ParseFromString(ReadFile(file_path).string())) {
+      LOG(kWarning) << "Failed to parse bootstrap contact quality file " << file_path;
+      return;
+    }
+  }
+  catch (const std::exception& e) {
+    LOG(kVerbose) << "No bootstrap contact quality file at " << file_path << ": " << e.what();
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  records_.clear();
+  for (const auto& proto_record : proto_quality.records()) {
+    Record record;
+    record.attempts = proto_record.attempts();
+    record.successes = proto_record.successes();
+    record.latency = std::chrono::milliseconds(proto_record.latency_ms());
+    record.last_seen = std::chrono::system_clock::time_point(
+        std::chrono::seconds(proto_record.last_seen()));
+    records_[GetEndpointFromProtobuf(proto_record.endpoint())] = record;
+  }
+}
+
+void BootstrapContactQuality::Save(const boost::filesystem::path& file_path) const {
+  protobuf::BootstrapContactQuality proto_quality;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& record : records_) {
+      auto proto_record(proto_quality.add_records());
+      SetProtobufEndpoint(record.first, proto_record->mutable_endpoint());
+      proto_record->set_attempts(record.second.attempts);
+      proto_record->set_successes(record.second.successes);
+      proto_record->set_latency_ms(static_cast<uint32_t>(record.second.latency.count()));
+      proto_record->set_last_seen(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::seconds>(
+              record.second.last_seen.time_since_epoch()).count()));
+    }
+  }
+  if (!WriteFile(file_path, proto_quality.SerializeAsString()))
+    LOG(kWarning) << "Failed to write bootstrap contact quality file " << file_path;
+}
+
+BootstrapContact ProbeBootstrapContacts(
+    const BootstrapContacts& contacts, uint16_t max_concurrent,
+    std::chrono::steady_clock::duration stagger,
+    const std::function<bool(const BootstrapContact&)>& probe, BootstrapContactQuality& quality,
+    std::vector<std::future<void>>& outstanding_probes) {
+  struct ProbeState {
+    ProbeState() : mutex(), cond_var(), winner(), finished(0), done() {}
+    std::mutex mutex;
+    std::condition_variable cond_var;
+    BootstrapContact winner;
+    size_t finished;
+    std::vector<bool> done;  // per probe, set just before it returns
+  };
+  auto state(std::make_shared<ProbeState>());
+  std::vector<std::future<void>> probes;
+  auto start_probe([&](const BootstrapContact& contact) {
+    size_t index(probes.size());
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->done.push_back(false);
+    }
+    probes.push_back(std::async(std::launch::async, [state, index, contact, probe, &quality] {
+      auto start(std::chrono::steady_clock::now());
+      bool succeeded(false);
+      try {
+        succeeded = probe(contact);
+      }
+      catch (const std::exception& e) {
+        LOG(kWarning) << "Probing bootstrap contact " << contact << " threw: " << e.what();
+      }
+      if (succeeded) {
+        quality.RecordSuccess(contact, std::chrono::duration_cast<std::chrono::milliseconds>(
+                                           std::chrono::steady_clock::now() - start));
+      } else {
+        quality.RecordFailure(contact);
+      }
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        ++state->finished;
+        state->done[index] = true;
+        if (succeeded && state->winner.address().is_unspecified())
+          state->winner = contact;
+      }
+      state->cond_var.notify_all();
+    }));
+  });
+
+  max_concurrent = std::max(max_concurrent, uint16_t(1));
+  size_t next(0);
+  {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    auto have_winner([&state] { return !state->winner.address().is_unspecified(); });
+    while (!have_winner()) {
+      if (next == contacts.size()) {
+        // All started; wait for a success or for the rest to fail.
+        state->cond_var.wait(lock, [&] { return have_winner() || state->finished == next; });
+        break;
+      }
+      if (next - state->finished < max_concurrent) {
+        lock.unlock();
+        start_probe(contacts[next++]);
+        lock.lock();
+      }
+      size_t finished_before(state->finished);
+      state->cond_var.wait_for(lock, stagger, [&] {
+        return have_winner() || state->finished != finished_before;
+      });
+    }
+  }
+
+  outstanding_probes.erase(
+      std::remove_if(outstanding_probes.begin(), outstanding_probes.end(),
+                     [](const std::future<void>& probe_future) {
+                       return !probe_future.valid() ||
+                              probe_future.wait_for(std::chrono::seconds(0)) ==
+                                  std::future_status::ready;
+                     }),
+      outstanding_probes.end());
+  std::unique_lock<std::mutex> lock(state->mutex);
+  for (size_t i(0); i != probes.size(); ++i) {
+    if (state->done[i]) {
+      lock.unlock();
+      probes[i].wait();  // only returning
+      lock.lock();
+    } else {
+      outstanding_probes.push_back(std::move(probes[i]));
+    }
+  }
+  return state->winner;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
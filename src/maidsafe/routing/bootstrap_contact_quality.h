@@ -0,0 +1,86 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_BOOTSTRAP_CONTACT_QUALITY_H_
+#define MAIDSAFE_ROUTING_BOOTSTRAP_CONTACT_QUALITY_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "boost/filesystem/path.hpp"
+
+#include "maidsafe/routing/bootstrap_file_operations.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Connect latency, success rate and last-seen time of each bootstrap contact, used to try the most
+// reliable and responsive contacts first.
+class BootstrapContactQuality {
+ public:
+  BootstrapContactQuality();
+  void RecordSuccess(const BootstrapContact& contact, std::chrono::milliseconds latency);
+  void RecordFailure(const BootstrapContact& contact);
+  // Returns contacts sorted best first: by success rate, then by latency.  Contacts with no record,
+  // or not seen successfully within the last week, are ranked as unknown, and unknown contacts keep
+  // their relative order.
+  BootstrapContacts Order(
+      const BootstrapContacts& contacts,
+      std::chrono::system_clock::time_point now = std::chrono::system_clock::now()) const;
+  // Neither throws; a missing or corrupt file leaves the store empty.
+  void Load(const boost::filesystem::path& file_path);
+  void Save(const boost::filesystem::path& file_path) const;
+
+ private:
+  struct Record {
+    Record() : attempts(0), successes(0), latency(0), last_seen() {}
+    uint32_t attempts, successes;
+    std::chrono::milliseconds latency;
+    std::chrono::system_clock::time_point last_seen;
+  };
+
+  BootstrapContactQuality(const BootstrapContactQuality&);
+  BootstrapContactQuality& operator=(const BootstrapContactQuality&);
+
+  mutable std::mutex mutex_;
+  std::map<BootstrapContact, Record> records_;
+};
+
+// Probes contacts in order, happy-eyeballs style: the next contact is started once stagger has
+// elapsed without a result, or as soon as an earlier probe fails, with at most max_concurrent
+// probes running.  Returns the first contact whose probe succeeds, or an unspecified endpoint if
+// all fail.  The outcome of each probe is recorded in quality.  Probes still running on return are
+// appended to outstanding_probes, from which those since finished are removed; quality must outlive
+// them.
+BootstrapContact ProbeBootstrapContacts(
+    const BootstrapContacts& contacts, uint16_t max_concurrent,
+    std::chrono::steady_clock::duration stagger,
+    const std::function<bool(const BootstrapContact&)>& probe, BootstrapContactQuality& quality,
+    std::vector<std::future<void>>& outstanding_probes);
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_BOOTSTRAP_CONTACT_QUALITY_H_
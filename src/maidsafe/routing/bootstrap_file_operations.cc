@@ -18,8 +18,15 @@
 
 #include "maidsafe/routing/bootstrap_file_operations.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
 #include <string>
 
+#include "boost/crc.hpp"
+#include "boost/filesystem/operations.hpp"
+
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/utils.h"
 
@@ -33,9 +40,166 @@ namespace maidsafe {
 namespace routing {
 
 namespace {
-  typedef boost::asio::ip::udp::endpoint Endpoint;
+
+typedef boost::asio::ip::udp::endpoint Endpoint;
+
+// Each journal record is preceded by its size and CRC-32, both little-endian, so that a record
+// torn or corrupted by a crash is detected rather than misparsed.
+const size_t kFrameHeaderSize(8);
+// A record holds a single serialised endpoint, so anything larger than this is corrupt.
+const uint32_t kMaxJournalRecordSize(1024);
+
+void AppendUint32(uint32_t value, std::string& output) {
+  for (int i(0); i != 4; ++i)
+    output.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+uint32_t ReadUint32(const std::string& input, size_t offset) {
+  uint32_t value(0);
+  for (int i(0); i != 4; ++i)
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(input[offset + i])) << (8 * i);
+  return value;
+}
+
+uint32_t Crc32(const char* data, size_t size) {
+  boost::crc_32_type crc;
+  crc.process_bytes(data, size);
+  return crc.checksum();
+}
+
+std::string SerialiseJournalRecord(const BootstrapContact& bootstrap_contact, bool remove) {
+  protobuf::BootstrapJournalRecord record;
+  record.set_serialised_bootstrap_contact(SerialiseBootstrapContact(bootstrap_contact));
+  record.set_remove(remove);
+  std::string serialised_record(record.SerializeAsString());
+  std::string framed_record;
+  AppendUint32(static_cast<uint32_t>(serialised_record.size()), framed_record);
+  AppendUint32(Crc32(serialised_record.data(), serialised_record.size()), framed_record);
+  return framed_record + serialised_record;
+}
+
+void AppendToJournal(const fs::path& journal_path, const std::string& framed_records) {
+  std::ofstream journal(journal_path.string(), std::ios::binary | std::ios::app);
+  journal.write(framed_records.data(), framed_records.size());
+  journal.flush();
+  if (!journal) {
+    LOG(kError) << "Could not append to bootstrap journal at : " << journal_path;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+}
+
+// Invokes functor for each record in the journal, if any, and returns the number of records.  A
+// record torn or corrupted by a crash while being appended ends the journal, and is truncated from
+// it so that later appends aren't lost behind it.
+size_t ReplayJournal(const fs::path& journal_path,
+                     const std::function<void(const BootstrapContact&, bool)>& functor) {
+  std::string journal;
+  if (!fs::exists(journal_path) || !ReadFile(journal_path, &journal))
+    return 0;
+  size_t offset(0), record_count(0);
+  while (offset != journal.size()) {
+    protobuf::BootstrapJournalRecord record;
+    bool intact(journal.size() - offset >= kFrameHeaderSize);
+    uint32_t size(intact ? ReadUint32(journal, offset) : 0);
+    intact = intact && size <= kMaxJournalRecordSize &&
+             journal.size() - offset - kFrameHeaderSize >= size;
+    if (intact) {
+      const char* data(journal.data() + offset + kFrameHeaderSize);
+      intact = Crc32(data, size) == ReadUint32(journal, offset + 4) &&
+               record.ParseFromArray(data, static_cast<int>(size));
+    }
+    if (!intact) {
+      LOG(kWarning) << "Truncating torn record at end of bootstrap journal " << journal_path;
+      boost::system::error_code error_code;
+      fs::resize_file(journal_path, offset, error_code);
+      if (error_code) {
+        LOG(kError) << "Could not truncate bootstrap journal at : " << journal_path;
+        BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+      }
+      break;
+    }
+    offset += kFrameHeaderSize + size;
+    ++record_count;
+    try {
+      functor(ParseBootstrapContact(record.serialised_bootstrap_contact()), record.remove());
+    }
+    catch (const std::exception& e) {
+      LOG(kWarning) << "Ignoring invalid bootstrap journal record: " << e.what();
+    }
+  }
+  return record_count;
+}
+
+// Applies add and remove records to a list of contacts, oldest first.
+class ContactList {
+ public:
+  explicit ContactList(const BootstrapContacts& contacts) : contacts_(), index_() {
+    for (const auto& contact : contacts)
+      Apply(contact, false);
+  }
+  ContactList(ContactList&& other)
+      : contacts_(std::move(other.contacts_)), index_(std::move(other.index_)) {}
+  bool Apply(const BootstrapContact& contact, bool remove) {
+    auto itr(index_.find(contact));
+    if (remove) {
+      if (itr == index_.end())
+        return false;
+      contacts_.erase(itr->second);
+      index_.erase(itr);
+    } else {
+      if (itr != index_.end())
+        return false;
+      index_[contact] = contacts_.insert(contacts_.end(), contact);
+    }
+    return true;
+  }
+  BootstrapContacts MostRecentFirst() const {
+    return BootstrapContacts(contacts_.rbegin(), contacts_.rend());
+  }
+  std::list<BootstrapContact>& contacts() { return contacts_; }
+  std::unordered_map<BootstrapContact, std::list<BootstrapContact>::iterator,
+                     BootstrapContactHash>& index() { return index_; }
+
+ private:
+  // Copying would leave the index referring to the original list.
+  ContactList(const ContactList&);
+  ContactList& operator=(const ContactList&);
+
+  std::list<BootstrapContact> contacts_;
+  std::unordered_map<BootstrapContact, std::list<BootstrapContact>::iterator,
+                     BootstrapContactHash> index_;
+};
+
+// Sets journal_record_count, if given, to the number of records replayed from the journal.
+ContactList ReadContactList(const fs::path& bootstrap_file_path,
+                            size_t* journal_record_count = nullptr) {
+  // The base file is empty if it was last written with no contacts.
+  std::string serialised_bootstrap_contacts;
+  if (!ReadFile(bootstrap_file_path, &serialised_bootstrap_contacts)) {
+    LOG(kError) << "Could not read bootstrap file at : " << bootstrap_file_path;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  ContactList contact_list(ParseBootstrapContacts(serialised_bootstrap_contacts));
+  size_t record_count(ReplayJournal(BootstrapJournalPath(bootstrap_file_path),
+                                    [&contact_list](const BootstrapContact& contact, bool remove) {
+                                      contact_list.Apply(contact, remove);
+                                    }));
+  if (journal_record_count)
+    *journal_record_count = record_count;
+  return contact_list;
+}
+
 }  // unnamed namespace
 
+size_t BootstrapContactHash::operator()(const BootstrapContact& bootstrap_contact) const {
+  return std::hash<std::string>()(bootstrap_contact.address().to_string()) * 31 +
+         bootstrap_contact.port();
+}
+
+fs::path BootstrapJournalPath(const fs::path& bootstrap_file_path) {
+  return bootstrap_file_path.string() + ".journal";
+}
+
 std::string SerialiseBootstrapContact(const BootstrapContact& bootstrap_contact) {
   protobuf::BootstrapContact protobuf_bootstrap_contact;
   SetProtobufEndpoint(bootstrap_contact, protobuf_bootstrap_contact.mutable_endpoint());
@@ -89,10 +253,7 @@ BootstrapContacts ParseBootstrapContacts(const std::string& serialised_bootstrap
 // TODO(Team) : Consider timestamp in forming the list. If offline for more than a week, then
 // list new nodes first
 BootstrapContacts ReadBootstrapFile(const fs::path& bootstrap_file_path) {
-  auto bootstrap_contacts(ParseBootstrapContacts(ReadFile(bootstrap_file_path).string()));
-
-  std::reverse(std::begin(bootstrap_contacts), std::end(bootstrap_contacts));
-  return bootstrap_contacts;
+  return ReadContactList(bootstrap_file_path).MostRecentFirst();
 }
 
 void WriteBootstrapFile(const BootstrapContacts& bootstrap_contacts,
@@ -102,6 +263,12 @@ void WriteBootstrapFile(const BootstrapContacts& bootstrap_contacts,
     LOG(kError) << "Could not write bootstrap file at : " << bootstrap_file_path;
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
   }
+  boost::system::error_code error_code;
+  fs::remove(BootstrapJournalPath(bootstrap_file_path), error_code);
+  if (error_code) {
+    LOG(kError) << "Could not remove bootstrap journal for : " << bootstrap_file_path;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
 }
 
 void UpdateBootstrapFile(const BootstrapContact& bootstrap_contact,
@@ -111,24 +278,94 @@ void UpdateBootstrapFile(const BootstrapContact& bootstrap_contact,
     LOG(kWarning) << "Invalid Endpoint" << bootstrap_contact;
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
   }
-  auto bootstrap_contacts(ParseBootstrapContacts(ReadFile(bootstrap_file_path).string()));
-  auto itr(std::find(std::begin(bootstrap_contacts), std::end(bootstrap_contacts),
-                     bootstrap_contact));
-  if (remove) {
-    if (itr != std::end(bootstrap_contacts)) {
-      bootstrap_contacts.erase(itr);
-      WriteBootstrapFile(bootstrap_contacts, bootstrap_file_path);
-    } else {
-      LOG(kVerbose) << "Can't find endpoint to remove : " << bootstrap_contact;
-    }
-  } else {
-    if (itr == std::end(bootstrap_contacts)) {
-      bootstrap_contacts.push_back(bootstrap_contact);
-      WriteBootstrapFile(bootstrap_contacts, bootstrap_file_path);
-    }  else {
-      LOG(kVerbose) << "Endpoint already in the list : " << bootstrap_contact;
-    }
+  if (!fs::exists(bootstrap_file_path)) {
+    LOG(kError) << "No bootstrap file at : " << bootstrap_file_path;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  BootstrapFile bootstrap_file(bootstrap_file_path);
+  if (remove)
+    bootstrap_file.Remove(bootstrap_contact);
+  else
+    bootstrap_file.Add(bootstrap_contact);
+}
+
+BootstrapFile::BootstrapFile(const fs::path& bootstrap_file_path)
+    : kBootstrapFilePath_(bootstrap_file_path),
+      mutex_(),
+      contacts_(),
+      index_(),
+      journal_record_count_(0) {
+  ContactList contact_list(fs::exists(kBootstrapFilePath_)
+                               ? ReadContactList(kBootstrapFilePath_, &journal_record_count_)
+                               : ContactList(BootstrapContacts()));
+  contacts_.swap(contact_list.contacts());
+  index_.swap(contact_list.index());
+}
+
+BootstrapContacts BootstrapFile::Contacts() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return BootstrapContacts(contacts_.rbegin(), contacts_.rend());
+}
+
+bool BootstrapFile::Contains(const BootstrapContact& bootstrap_contact) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.count(bootstrap_contact) != 0;
+}
+
+bool BootstrapFile::Add(const BootstrapContact& bootstrap_contact) {
+  if (bootstrap_contact.address().is_unspecified()) {
+    LOG(kWarning) << "Invalid Endpoint" << bootstrap_contact;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
   }
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (index_.count(bootstrap_contact) != 0)
+    return false;
+  Append(bootstrap_contact, false);
+  index_[bootstrap_contact] = contacts_.insert(contacts_.end(), bootstrap_contact);
+  CompactIfJournalTooLarge(lock);
+  return true;
+}
+
+bool BootstrapFile::Remove(const BootstrapContact& bootstrap_contact) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto itr(index_.find(bootstrap_contact));
+  if (itr == index_.end())
+    return false;
+  Append(bootstrap_contact, true);
+  contacts_.erase(itr->second);
+  index_.erase(itr);
+  CompactIfJournalTooLarge(lock);
+  return true;
+}
+
+void BootstrapFile::Compact() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Compact(lock);
+}
+
+size_t BootstrapFile::journal_record_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return journal_record_count_;
+}
+
+void BootstrapFile::Append(const BootstrapContact& bootstrap_contact, bool remove) {
+  if (!fs::exists(kBootstrapFilePath_))
+    WriteBootstrapFile(BootstrapContacts(contacts_.begin(), contacts_.end()), kBootstrapFilePath_);
+  AppendToJournal(BootstrapJournalPath(kBootstrapFilePath_),
+                  SerialiseJournalRecord(bootstrap_contact, remove));
+  ++journal_record_count_;
+}
+
+void BootstrapFile::CompactIfJournalTooLarge(std::unique_lock<std::mutex>& lock) {
+  // Compacting once the journal holds more records than the base holds contacts keeps the cost of
+  // updates amortised O(1).
+  if (journal_record_count_ > std::max(contacts_.size(), size_t(64)))
+    Compact(lock);
+}
+
+void BootstrapFile::Compact(std::unique_lock<std::mutex>& /*lock*/) {
+  WriteBootstrapFile(BootstrapContacts(contacts_.begin(), contacts_.end()), kBootstrapFilePath_);
+  journal_record_count_ = 0;
 }
 
 }  // namespace routing
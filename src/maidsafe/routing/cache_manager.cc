@@ -20,6 +20,9 @@
 
 #include "maidsafe/routing/cache_manager.h"
 
+#include "maidsafe/common/crypto.h"
+
+#include "maidsafe/routing/bloom_filter.h"
 #include "maidsafe/routing/network_utils.h"
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/routing.pb.h"
@@ -34,14 +37,43 @@ CacheManager::CacheManager(const NodeId& node_id, NetworkUtils &network)
     : kNodeId_(node_id),
       network_(network),
       message_and_caching_functors_(),
-      typed_message_and_caching_functors_() {}
+      typed_message_and_caching_functors_(),
+      frequency_sketch_(Parameters::routing_layer_cache && Parameters::cache_admission_filter
+                            ? new FrequencySketch(Parameters::num_chunks_to_cache)
+                            : nullptr),
+      lru_cache_(),
+      disk_cache_() {
+  if (!Parameters::routing_layer_cache)
+    return;
+  LruCache::AdmissionFunctor admission_functor;
+  if (frequency_sketch_) {
+    // A new chunk only displaces the least-recently-used one if it has been requested more often
+    // recently; this stops a burst of one-off chunks from flushing the popular ones.
+    admission_functor = [this](const std::string& candidate, const std::string& victim) {
+      return frequency_sketch_->Estimate(candidate) > frequency_sketch_->Estimate(victim);
+    };
+  }
+  lru_cache_.reset(new LruCache(Parameters::num_chunks_to_cache, Parameters::max_cache_size_bytes,
+                                8, admission_functor));
+  if (Parameters::disk_cache_path.empty())
+    return;
+  try {
+    disk_cache_.reset(new DiskCache(
+        Parameters::disk_cache_path / kNodeId_.ToStringEncoded(NodeId::EncodingType::kHex),
+        Parameters::max_disk_cache_size));
+  }
+  catch (const std::exception& e) {
+    LOG(kError) << "Failed to open disk cache in " << Parameters::disk_cache_path << ": "
+                << e.what() << ".  Continuing with the in-memory cache only.";
+  }
+}
 
 void CacheManager::InitialiseFunctors(const MessageAndCachingFunctors&
                                       message_and_caching_functors) {
 #ifndef TESTING
   assert(message_and_caching_functors.message_received);
-  assert(message_and_caching_functors.have_cache_data);
-  assert(message_and_caching_functors.store_cache_data);
+  assert(lru_cache_ || message_and_caching_functors.have_cache_data);
+  assert(lru_cache_ || message_and_caching_functors.store_cache_data);
 #endif
   message_and_caching_functors_ = message_and_caching_functors;
 }
@@ -56,6 +88,16 @@ void CacheManager::InitialiseFunctors(const TypedMessageAndCachingFunctor&
 
 void CacheManager::AddToCache(const protobuf::Message& message) {
 //  assert(!message.request());
+  // Cacheable GETs carry the SHA512 hash of the content which the matching PUT carries.
+  if (lru_cache_ && message.data_size() != 0 && !message.data(0).empty()) {
+    std::string key(crypto::Hash<crypto::SHA512>(message.data(0)).string());
+    lru_cache_->Put(key, message.data(0));
+    // The disk tier deliberately bypasses the admission filter: it is much larger, is written
+    // sequentially and drops whole segments oldest first, so there is no single victim to weigh
+    // the new chunk against.  It keeps chunks the memory tier declined, for later promotion.
+    if (disk_cache_)
+      disk_cache_->Put(key, message.data(0));
+  }
   if (message_and_caching_functors_.store_cache_data) {
     message_and_caching_functors_.store_cache_data(message.data(0));
   } else {
@@ -97,6 +139,25 @@ void CacheManager::TypedMessageAddtoCache(const protobuf::Message& message) {
 bool CacheManager::HandleGetFromCache(protobuf::Message& message) {
   assert(IsRequest(message));
   assert(IsCacheableGet(message));
+  if (lru_cache_) {
+    if (frequency_sketch_)
+      frequency_sketch_->Increment(message.data(0));
+    std::string cached_data;
+    if (lru_cache_->Get(message.data(0), cached_data)) {
+      LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] answering " << MessageTypeString(message)
+                    << " from routing layer cache (id: " << message.id() << ")";
+      SendCachedResponse(message, cached_data);
+      return true;
+    }
+    DiskCache::Value value;
+    if (disk_cache_ && disk_cache_->Get(message.data(0), value)) {
+      LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] answering " << MessageTypeString(message)
+                    << " from disk cache (id: " << message.id() << ")";
+      SendCachedResponse(message, value.data(), value.size());
+      lru_cache_->Put(message.data(0), value.string());
+      return true;
+    }
+  }
   auto cache_hit(std::make_shared<std::promise<bool>>());
   auto future(cache_hit->get_future());
   if (message_and_caching_functors_.have_cache_data) {
@@ -114,33 +175,7 @@ bool CacheManager::HandleGetFromCache(protobuf::Message& message) {
 
           LOG(kVerbose) << "Cache contents: " << reply_message;
 
-          //  Responding with cached response
-          protobuf::Message message_out;
-          message_out.set_request(false);
-          message_out.set_hops_to_live(Parameters::hops_to_live);
-          message_out.set_destination_id(message.source_id());
-          message_out.set_type(message.type());
-          message_out.set_direct(true);
-          message_out.clear_data();
-          message_out.set_client_node(message.client_node());
-          message_out.set_routing_message(message.routing_message());
-          message_out.add_data(reply_message);
-          message_out.set_last_id(kNodeId_.string());
-          message_out.set_source_id(kNodeId_.string());
-          if (message.has_cacheable())
-            message_out.set_cacheable(static_cast<int32_t>(Cacheable::kPut));
-          if (message.has_id())
-            message_out.set_id(message.id());
-          else
-            LOG(kInfo) << "Message to be sent back had no ID.";
-
-          if (message.has_relay_id())
-            message_out.set_relay_id(message.relay_id());
-
-          if (message.has_relay_connection_id()) {
-            message_out.set_relay_connection_id(message.relay_connection_id());
-          }
-          network_.SendToClosestNode(message_out);
+          SendCachedResponse(message, reply_message);
           cache_hit->set_value(true);
       };
 
@@ -155,6 +190,56 @@ bool CacheManager::HandleGetFromCache(protobuf::Message& message) {
   return future.get();
 }
 
+void CacheManager::SendCachedResponse(const protobuf::Message& request,
+                                      const std::string& data) {
+  SendCachedResponse(request, data.data(), data.size());
+}
+
+// Takes a raw buffer so that disk tier hits are copied straight from the mapped segment into the
+// outgoing message.
+void CacheManager::SendCachedResponse(const protobuf::Message& request, const char* data,
+                                      size_t size) {
+  protobuf::Message message_out;
+  message_out.set_request(false);
+  message_out.set_hops_to_live(Parameters::hops_to_live);
+  message_out.set_destination_id(request.source_id());
+  message_out.set_type(request.type());
+  message_out.set_direct(true);
+  message_out.clear_data();
+  message_out.set_client_node(request.client_node());
+  message_out.set_routing_message(request.routing_message());
+  message_out.add_data(data, size);
+  message_out.set_last_id(kNodeId_.string());
+  message_out.set_source_id(kNodeId_.string());
+  if (request.has_cacheable())
+    message_out.set_cacheable(static_cast<int32_t>(Cacheable::kPut));
+  if (request.has_id())
+    message_out.set_id(request.id());
+  else
+    LOG(kInfo) << "Message to be sent back had no ID.";
+
+  if (request.has_relay_id())
+    message_out.set_relay_id(request.relay_id());
+
+  if (request.has_relay_connection_id()) {
+    message_out.set_relay_connection_id(request.relay_connection_id());
+  }
+  network_.SendToClosestNode(message_out);
+}
+
+CacheStatistics CacheManager::cache_statistics() const {
+  return lru_cache_ ? lru_cache_->GetStatistics() : CacheStatistics();
+}
+
+std::string CacheManager::CacheSummary() const {
+  if (!lru_cache_)
+    return std::string();
+  BloomFilter cache_summary(BloomFilter::ForEntries(Parameters::num_chunks_to_cache));
+  for (const auto& key : lru_cache_->Keys())
+    cache_summary.Add(key);
+  return cache_summary.Serialise();
+}
+
 bool CacheManager::TypedMessageHandleGetFromCache(protobuf::Message& message) {
   assert(!(message.has_relay_id() || message.has_relay_connection_id()));
   if ((!message.has_group_source() && !message.has_group_destination()) &&
@@ -19,9 +19,13 @@
 #ifndef MAIDSAFE_ROUTING_CACHE_MANAGER_H_
 #define MAIDSAFE_ROUTING_CACHE_MANAGER_H_
 
+#include <memory>
 #include <string>
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/disk_cache.h"
+#include "maidsafe/routing/frequency_sketch.h"
+#include "maidsafe/routing/lru_cache.h"
 
 namespace maidsafe {
 
@@ -41,6 +45,11 @@ class CacheManager {
   void InitialiseFunctors(const TypedMessageAndCachingFunctor& typed_message_and_caching_functors);
   void AddToCache(const protobuf::Message& message);
   bool HandleGetFromCache(protobuf::Message& message);
+  // Returns default-constructed statistics if the routing layer cache is disabled.
+  CacheStatistics cache_statistics() const;
+  // Returns a serialised BloomFilter of the keys held in the routing layer cache, or an empty
+  // string if the cache is disabled.
+  std::string CacheSummary() const;
 
  private:
   CacheManager(const CacheManager&);
@@ -49,11 +58,16 @@ class CacheManager {
 
   void TypedMessageAddtoCache(const protobuf::Message& message);
   bool TypedMessageHandleGetFromCache(protobuf::Message& message);
+  void SendCachedResponse(const protobuf::Message& request, const std::string& data);
+  void SendCachedResponse(const protobuf::Message& request, const char* data, size_t size);
 
   const NodeId kNodeId_;
   NetworkUtils& network_;
   MessageAndCachingFunctors message_and_caching_functors_;
   TypedMessageAndCachingFunctor typed_message_and_caching_functors_;
+  std::unique_ptr<FrequencySketch> frequency_sketch_;
+  std::unique_ptr<LruCache> lru_cache_;
+  std::unique_ptr<DiskCache> disk_cache_;
 };
 
 }  // namespace routing
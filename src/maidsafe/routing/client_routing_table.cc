@@ -34,7 +34,7 @@ typedef boost::asio::ip::udp::endpoint Endpoint;
 }  // unnamed namespace
 
 ClientRoutingTable::ClientRoutingTable(NodeId node_id)
-    : kNodeId_(std::move(node_id)), nodes_(), mutex_() {}
+    : kNodeId_(std::move(node_id)), nodes_(), mutex_("client_routing_table") {}
 
 bool ClientRoutingTable::AddNode(NodeInfo& node, const NodeId& furthest_close_node_id) {
   return AddOrCheckNode(node, furthest_close_node_id, true);
@@ -48,7 +48,7 @@ bool ClientRoutingTable::AddOrCheckNode(NodeInfo& node, const NodeId& furthest_c
                                         bool add) {
   if (node.node_id == kNodeId_)
     return false;
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   if (CheckRangeForNodeToBeAdded(node, furthest_close_node_id, add)) {
     if (add) {
       nodes_.push_back(node);
@@ -62,7 +62,7 @@ bool ClientRoutingTable::AddOrCheckNode(NodeInfo& node, const NodeId& furthest_c
 
 std::vector<NodeInfo> ClientRoutingTable::DropNodes(const NodeId& node_to_drop) {
   std::vector<NodeInfo> nodes_info;
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   uint16_t i(0);
   while (i < nodes_.size()) {
     if (nodes_.at(i).node_id == node_to_drop) {
@@ -77,7 +77,7 @@ std::vector<NodeInfo> ClientRoutingTable::DropNodes(const NodeId& node_to_drop)
 
 NodeInfo ClientRoutingTable::DropConnection(const NodeId& connection_to_drop) {
   NodeInfo node_info;
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   for (auto it = nodes_.begin(); it != nodes_.end(); ++it) {
     if ((*it).connection_id == connection_to_drop) {
       node_info = *it;
@@ -90,7 +90,7 @@ NodeInfo ClientRoutingTable::DropConnection(const NodeId& connection_to_drop) {
 
 std::vector<NodeInfo> ClientRoutingTable::GetNodesInfo(const NodeId& node_id) const {
   std::vector<NodeInfo> nodes_info;
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   for (const auto& elem : nodes_) {
     if ((elem).node_id == node_id)
       nodes_info.push_back(elem);
@@ -99,7 +99,7 @@ std::vector<NodeInfo> ClientRoutingTable::GetNodesInfo(const NodeId& node_id) co
 }
 
 bool ClientRoutingTable::Contains(const NodeId& node_id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   return std::find_if(nodes_.begin(), nodes_.end(), [node_id](const NodeInfo & node_info) {
            return node_info.node_id == node_id;
          }) != nodes_.end();
@@ -108,7 +108,7 @@ bool ClientRoutingTable::Contains(const NodeId& node_id) const {
 bool ClientRoutingTable::IsConnected(const NodeId& node_id) const { return Contains(node_id); }
 
 size_t ClientRoutingTable::size() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   return nodes_.size();
 }
 
@@ -30,6 +30,7 @@
 #include "maidsafe/common/rsa.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/instrumented_mutex.h"
 
 namespace maidsafe {
 
@@ -81,7 +82,7 @@ class ClientRoutingTable {
 
   const NodeId kNodeId_;
   std::vector<NodeInfo> nodes_;
-  mutable std::mutex mutex_;
+  mutable InstrumentedMutex mutex_;
 };
 
 }  // namespace routing
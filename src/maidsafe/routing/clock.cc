@@ -0,0 +1,283 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/clock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "boost/asio/error.hpp"
+
+namespace maidsafe {
+
+namespace routing {
+
+struct SteadyTimer::VirtualTimer {
+  explicit VirtualTimer(boost::asio::io_service& io_service_in)
+      : io_service(io_service_in), expiry(), wait_keys() {}
+  boost::asio::io_service& io_service;
+  Clock::time_point expiry;
+  // Keys of this timer's pending waits in VirtualScheduler::waits_.
+  std::vector<std::pair<Clock::time_point, uint64_t>> wait_keys;
+};
+
+// Holds the virtual clock and the pending waits of all virtual timers.
+class VirtualScheduler {
+ public:
+  typedef SteadyTimer::VirtualTimer VirtualTimer;
+
+  static VirtualScheduler& Instance() {
+    static VirtualScheduler virtual_scheduler;
+    return virtual_scheduler;
+  }
+
+  void Enable();
+  void Disable() { enabled_ = false; }
+  bool enabled() const { return enabled_; }
+  Clock::time_point now();
+  std::size_t SetExpiry(VirtualTimer& timer, const Clock::duration& expiry_time);
+  std::size_t Cancel(VirtualTimer& timer);
+  void Wait(VirtualTimer& timer, const SteadyTimer::WaitHandler& handler);
+  bool AdvanceToNextDeadline();
+  void Advance(const Clock::duration& duration);
+  void Post(boost::asio::io_service& io_service, const std::function<void()>& handler);
+
+ private:
+  typedef std::pair<Clock::time_point, uint64_t> WaitKey;
+  struct PendingWait {
+    PendingWait(VirtualTimer* timer_in, SteadyTimer::WaitHandler handler_in)
+        : timer(timer_in), handler(std::move(handler_in)) {}
+    VirtualTimer* timer;
+    SteadyTimer::WaitHandler handler;
+  };
+  // Marks the end of a posted handler when destroyed, i.e. once it has run or been discarded along
+  // with its io_service.
+  struct HandlerGuard {
+    explicit HandlerGuard(VirtualScheduler& scheduler_in) : scheduler(scheduler_in) {}
+    ~HandlerGuard() { scheduler.HandlerDone(); }
+    VirtualScheduler& scheduler;
+  };
+
+  VirtualScheduler()
+      : enabled_(false),
+        mutex_(),
+        now_(),
+        next_sequence_(0),
+        waits_(),
+        handler_mutex_(),
+        handler_cond_var_(),
+        running_handler_count_(0) {}
+  VirtualScheduler(const VirtualScheduler&);
+  VirtualScheduler& operator=(const VirtualScheduler&);
+
+  // These require 'mutex_' to be held.
+  std::size_t DoCancel(VirtualTimer& timer);
+  void FireDueWaits();
+
+  void PostWaitHandler(boost::asio::io_service& io_service,
+                       const SteadyTimer::WaitHandler& handler,
+                       const boost::system::error_code& error);
+  void WaitForHandlers();
+  void HandlerDone();
+
+  std::atomic<bool> enabled_;
+  std::mutex mutex_;
+  Clock::time_point now_;
+  uint64_t next_sequence_;
+  std::map<WaitKey, PendingWait> waits_;
+  // Separate from 'mutex_', since a handler's guard may be released while 'mutex_' is held.
+  std::mutex handler_mutex_;
+  std::condition_variable handler_cond_var_;
+  int running_handler_count_;
+};
+
+void VirtualScheduler::Enable() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  now_ = std::chrono::steady_clock::now();
+  enabled_ = true;
+}
+
+Clock::time_point VirtualScheduler::now() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return now_;
+}
+
+std::size_t VirtualScheduler::SetExpiry(VirtualTimer& timer, const Clock::duration& expiry_time) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  timer.expiry = now_ + expiry_time;
+  return DoCancel(timer);
+}
+
+std::size_t VirtualScheduler::Cancel(VirtualTimer& timer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return DoCancel(timer);
+}
+
+void VirtualScheduler::Wait(VirtualTimer& timer, const SteadyTimer::WaitHandler& handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (timer.expiry <= now_)
+    return PostWaitHandler(timer.io_service, handler, boost::system::error_code());
+  WaitKey key(timer.expiry, next_sequence_++);
+  waits_.insert(std::make_pair(key, PendingWait(&timer, handler)));
+  timer.wait_keys.push_back(key);
+}
+
+bool VirtualScheduler::AdvanceToNextDeadline() {
+  WaitForHandlers();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (waits_.empty())
+    return false;
+  now_ = std::max(now_, waits_.begin()->first.first);
+  FireDueWaits();
+  return true;
+}
+
+void VirtualScheduler::Advance(const Clock::duration& duration) {
+  const Clock::time_point kTarget(now() + duration);
+  for (;;) {
+    WaitForHandlers();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (waits_.empty() || waits_.begin()->first.first > kTarget) {
+      now_ = std::max(now_, kTarget);
+      return;
+    }
+    now_ = std::max(now_, waits_.begin()->first.first);
+    FireDueWaits();
+  }
+}
+
+void VirtualScheduler::PostWaitHandler(boost::asio::io_service& io_service,
+                                       const SteadyTimer::WaitHandler& handler,
+                                       const boost::system::error_code& error) {
+  Post(io_service, [handler, error] { handler(error); });
+}
+
+std::size_t VirtualScheduler::DoCancel(VirtualTimer& timer) {
+  const std::size_t kCancelledCount(timer.wait_keys.size());
+  for (const auto& key : timer.wait_keys) {
+    auto itr(waits_.find(key));
+    PostWaitHandler(timer.io_service, itr->second.handler, boost::asio::error::operation_aborted);
+    waits_.erase(itr);
+  }
+  timer.wait_keys.clear();
+  return kCancelledCount;
+}
+
+void VirtualScheduler::Post(boost::asio::io_service& io_service,
+                            const std::function<void()>& handler) {
+  {
+    std::lock_guard<std::mutex> lock(handler_mutex_);
+    ++running_handler_count_;
+  }
+  std::shared_ptr<HandlerGuard> guard(std::make_shared<HandlerGuard>(*this));
+  io_service.post([guard, handler] { handler(); });
+}
+
+void VirtualScheduler::FireDueWaits() {
+  while (!waits_.empty() && waits_.begin()->first.first <= now_) {
+    auto itr(waits_.begin());
+    std::vector<WaitKey>& wait_keys(itr->second.timer->wait_keys);
+    wait_keys.erase(std::find(wait_keys.begin(), wait_keys.end(), itr->first));
+    PostWaitHandler(itr->second.timer->io_service, itr->second.handler,
+                    boost::system::error_code());
+    waits_.erase(itr);
+  }
+}
+
+void VirtualScheduler::WaitForHandlers() {
+  std::unique_lock<std::mutex> lock(handler_mutex_);
+  handler_cond_var_.wait(lock, [this] { return running_handler_count_ == 0; });
+}
+
+void VirtualScheduler::HandlerDone() {
+  {
+    std::lock_guard<std::mutex> lock(handler_mutex_);
+    --running_handler_count_;
+  }
+  handler_cond_var_.notify_all();
+}
+
+Clock::time_point Clock::now() {
+  VirtualScheduler& virtual_scheduler(VirtualScheduler::Instance());
+  return virtual_scheduler.enabled() ? virtual_scheduler.now() : std::chrono::steady_clock::now();
+}
+
+void Clock::EnableVirtualTime() { VirtualScheduler::Instance().Enable(); }
+
+void Clock::DisableVirtualTime() { VirtualScheduler::Instance().Disable(); }
+
+bool Clock::virtual_time_enabled() { return VirtualScheduler::Instance().enabled(); }
+
+bool Clock::AdvanceToNextDeadline() { return VirtualScheduler::Instance().AdvanceToNextDeadline(); }
+
+void Clock::Advance(const duration& duration) { VirtualScheduler::Instance().Advance(duration); }
+
+void Clock::Post(boost::asio::io_service& io_service, const std::function<void()>& handler) {
+  VirtualScheduler& virtual_scheduler(VirtualScheduler::Instance());
+  if (virtual_scheduler.enabled())
+    virtual_scheduler.Post(io_service, handler);
+  else
+    io_service.post(handler);
+}
+
+SteadyTimer::SteadyTimer(boost::asio::io_service& io_service)
+    : steady_timer_(), virtual_timer_() {
+  if (Clock::virtual_time_enabled())
+    virtual_timer_.reset(new VirtualTimer(io_service));
+  else
+    steady_timer_.reset(new boost::asio::steady_timer(io_service));
+}
+
+SteadyTimer::SteadyTimer(boost::asio::io_service& io_service, const Clock::duration& expiry_time)
+    : SteadyTimer(io_service) {
+  expires_from_now(expiry_time);
+}
+
+SteadyTimer::~SteadyTimer() {
+  if (virtual_timer_)
+    VirtualScheduler::Instance().Cancel(*virtual_timer_);
+}
+
+std::size_t SteadyTimer::expires_from_now(const Clock::duration& expiry_time) {
+  if (steady_timer_)
+    return steady_timer_->expires_from_now(expiry_time);
+  return VirtualScheduler::Instance().SetExpiry(*virtual_timer_, expiry_time);
+}
+
+std::size_t SteadyTimer::cancel() {
+  if (steady_timer_)
+    return steady_timer_->cancel();
+  return VirtualScheduler::Instance().Cancel(*virtual_timer_);
+}
+
+void SteadyTimer::async_wait(WaitHandler handler) {
+  if (steady_timer_)
+    return steady_timer_->async_wait(handler);
+  VirtualScheduler::Instance().Wait(*virtual_timer_, handler);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
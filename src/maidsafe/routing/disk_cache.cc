@@ -0,0 +1,417 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/disk_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/log.h"
+
+namespace fs = boost::filesystem;
+namespace bi = boost::interprocess;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const uint32_t kRecordMagic(0x4d534443);  // "MSDC"
+const char kSegmentPrefix[] = "segment_";
+// Segments are created and sized under this prefix, then renamed, so a crash part way through
+// creating one can't leave a segment file which is too short to map.
+const char kNewSegmentPrefix[] = "new_segment_";
+
+struct RecordHeader {
+  uint32_t magic, key_size, value_size, checksum;
+};
+
+const uint32_t kHeaderSize(static_cast<uint32_t>(sizeof(RecordHeader)));
+// Most bytes of live records compaction copies before taking the lock to repoint the index at
+// them, so that it checks for shutdown and yields to Puts regularly.
+const uint32_t kCompactionChunkSize(1024 * 1024);
+
+// FNV-1a over the sizes, key and value.
+uint32_t Checksum(uint32_t key_size, uint32_t value_size, const char* key, const char* value) {
+  uint32_t hash(2166136261U);
+  auto add([&hash](const char* data, size_t size) {
+    for (size_t i(0); i != size; ++i) {
+      hash ^= static_cast<uint8_t>(data[i]);
+      hash *= 16777619U;
+    }
+  });
+  add(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+  add(reinterpret_cast<const char*>(&value_size), sizeof(value_size));
+  add(key, key_size);
+  add(value, value_size);
+  return hash;
+}
+
+}  // unnamed namespace
+
+struct DiskCache::Segment {
+  Segment(uint32_t id_in, const fs::path& path_in)
+      : id(id_in),
+        path(path_in),
+        mapping(path.string().c_str(), bi::read_write),
+        region(mapping, bi::read_write),
+        capacity(static_cast<uint32_t>(region.get_size())),
+        write_offset(0),
+        live_bytes(0),
+        remove_on_destruction(false) {}
+  ~Segment() {
+    if (remove_on_destruction) {
+      boost::system::error_code error_code;
+      fs::remove(path, error_code);
+    }
+  }
+  char* base() const { return static_cast<char*>(region.get_address()); }
+
+  const uint32_t id;
+  const fs::path path;
+  bi::file_mapping mapping;
+  bi::mapped_region region;
+  const uint32_t capacity;
+  uint32_t write_offset;
+  uint64_t live_bytes;
+  bool remove_on_destruction;
+};
+
+const uint32_t DiskCache::kDefaultSegmentSize;
+
+DiskCache::DiskCache(const fs::path& directory, uint64_t max_bytes, uint32_t segment_size)
+    : kDirectory_(directory),
+      kSegmentSize_(std::max(segment_size, uint32_t(4096))),
+      kMaxSegments_(static_cast<size_t>(std::max(uint64_t(2), max_bytes / kSegmentSize_))),
+      mutex_(),
+      cond_var_(),
+      stopping_(false),
+      write_disabled_(false),
+      segments_(),
+      active_segment_(),
+      index_(),
+      compaction_thread_() {
+  boost::system::error_code error_code;
+  if (!fs::exists(kDirectory_, error_code) && !fs::create_directories(kDirectory_, error_code)) {
+    LOG(kError) << "Failed to create disk cache directory " << kDirectory_ << ": "
+                << error_code.message();
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  Recover();
+  compaction_thread_ = std::thread([this] { CompactionLoop(); });
+}
+
+DiskCache::~DiskCache() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cond_var_.notify_all();
+  compaction_thread_.join();
+  Flush();
+}
+
+void DiskCache::Recover() {
+  std::vector<uint32_t> segment_ids;
+  std::vector<fs::path> unusable_files;
+  for (fs::directory_iterator itr(kDirectory_); itr != fs::directory_iterator(); ++itr) {
+    std::string file_name(itr->path().filename().string());
+    if (file_name.compare(0, sizeof(kNewSegmentPrefix) - 1, kNewSegmentPrefix) == 0) {
+      unusable_files.push_back(itr->path());
+      continue;
+    }
+    if (file_name.compare(0, sizeof(kSegmentPrefix) - 1, kSegmentPrefix) != 0)
+      continue;
+    boost::system::error_code error_code;
+    if (fs::file_size(itr->path(), error_code) < kHeaderSize || error_code) {
+      unusable_files.push_back(itr->path());
+      continue;
+    }
+    try {
+      segment_ids.push_back(
+          static_cast<uint32_t>(std::stoul(file_name.substr(sizeof(kSegmentPrefix) - 1))));
+    }
+    catch (const std::exception&) {
+      LOG(kWarning) << "Ignoring unexpected file " << itr->path() << " in disk cache directory.";
+    }
+  }
+  for (const auto& path : unusable_files) {
+    LOG(kWarning) << "Removing incomplete segment " << path << " from disk cache directory.";
+    boost::system::error_code error_code;
+    fs::remove(path, error_code);
+  }
+  std::sort(segment_ids.begin(), segment_ids.end());
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (uint32_t segment_id : segment_ids) {
+    auto segment(OpenSegment(segment_id, false));
+    // Registered before scanning, so that a key repeated within this segment is marked dead here.
+    segments_[segment_id] = segment;
+    uint32_t offset(0);
+    while (offset + kHeaderSize <= segment->capacity) {
+      const char* record(segment->base() + offset);
+      RecordHeader header;
+      std::memcpy(&header, record, kHeaderSize);
+      if (header.magic != kRecordMagic ||
+          static_cast<uint64_t>(kHeaderSize) + header.key_size + header.value_size >
+              segment->capacity - offset)
+        break;
+      const char* key(record + kHeaderSize);
+      if (Checksum(header.key_size, header.value_size, key, key + header.key_size) !=
+          header.checksum) {
+        LOG(kWarning) << "Discarding torn record at offset " << offset << " of " << segment->path;
+        break;
+      }
+      uint32_t record_size(kHeaderSize + header.key_size + header.value_size);
+      std::string key_string(key, header.key_size);
+      auto existing(index_.find(key_string));
+      if (existing != index_.end())
+        MarkDead(existing->second);
+      index_[key_string] = Location(segment_id, offset, record_size);
+      segment->live_bytes += record_size;
+      offset += record_size;
+    }
+    segment->write_offset = offset;
+  }
+  if (!segments_.empty())
+    active_segment_ = segments_.rbegin()->second;
+  while (segments_.size() > kMaxSegments_)
+    EvictOldestSegment(lock);
+  LOG(kInfo) << "Recovered " << index_.size() << " cached chunks from " << segments_.size()
+             << " segments in " << kDirectory_;
+}
+
+std::shared_ptr<DiskCache::Segment> DiskCache::OpenSegment(uint32_t segment_id, bool create) {
+  fs::path path(kDirectory_ / (kSegmentPrefix + std::to_string(segment_id)));
+  if (create) {
+    fs::path new_path(kDirectory_ / (kNewSegmentPrefix + std::to_string(segment_id)));
+    std::ofstream(new_path.string().c_str(), std::ios::binary | std::ios::trunc);
+    fs::resize_file(new_path, kSegmentSize_);
+    fs::rename(new_path, path);
+  }
+  return std::make_shared<Segment>(segment_id, path);
+}
+
+bool DiskCache::Put(const std::string& key, const std::string& value) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (write_disabled_)
+    return false;
+  return Append(key, value.data(), value.size(), lock);
+}
+
+bool DiskCache::Append(const std::string& key, const char* value, size_t value_size,
+                       std::unique_lock<std::mutex>& lock) {
+  uint64_t record_size(static_cast<uint64_t>(kHeaderSize) + key.size() + value_size);
+  if (record_size > kSegmentSize_)
+    return false;
+  if ((!active_segment_ ||
+       active_segment_->write_offset + record_size > active_segment_->capacity) &&
+      !StartNewSegment(lock)) {
+    return false;
+  }
+
+  Segment& segment(*active_segment_);
+  char* record(segment.base() + segment.write_offset);
+  RecordHeader header;
+  header.magic = kRecordMagic;
+  header.key_size = static_cast<uint32_t>(key.size());
+  header.value_size = static_cast<uint32_t>(value_size);
+  std::memcpy(record + kHeaderSize, key.data(), key.size());
+  std::memcpy(record + kHeaderSize + key.size(), value, value_size);
+  header.checksum = Checksum(header.key_size, header.value_size, key.data(), value);
+  std::memcpy(record, &header, kHeaderSize);
+  // Clear the following header slot so that recovery stops here, whatever a previous crash left.
+  if (segment.write_offset + record_size + kHeaderSize <= segment.capacity)
+    std::memset(record + record_size, 0, kHeaderSize);
+
+  auto existing(index_.find(key));
+  if (existing != index_.end())
+    MarkDead(existing->second);
+  index_[key] = Location(segment.id, segment.write_offset, static_cast<uint32_t>(record_size));
+  segment.write_offset += static_cast<uint32_t>(record_size);
+  segment.live_bytes += record_size;
+  return true;
+}
+
+bool DiskCache::StartNewSegment(std::unique_lock<std::mutex>& lock) {
+  uint32_t segment_id(segments_.empty() ? 0 : segments_.rbegin()->first + 1);
+  try {
+    active_segment_ = OpenSegment(segment_id, true);
+  }
+  catch (const std::exception& e) {
+    // E.g. the disk is full.  The existing segments remain readable.
+    LOG(kError) << "Failed to create disk cache segment " << segment_id << " in " << kDirectory_
+                << ": " << e.what() << ".  Disabling writes to the disk cache.";
+    write_disabled_ = true;
+    return false;
+  }
+  segments_[segment_id] = active_segment_;
+  while (segments_.size() > kMaxSegments_)
+    EvictOldestSegment(lock);
+  cond_var_.notify_one();
+  return true;
+}
+
+void DiskCache::EvictOldestSegment(std::unique_lock<std::mutex>& /*lock*/) {
+  auto oldest(segments_.begin());
+  if (oldest->second == active_segment_)
+    return;
+  for (auto itr(index_.begin()); itr != index_.end();) {
+    if (itr->second.segment_id == oldest->first)
+      itr = index_.erase(itr);
+    else
+      ++itr;
+  }
+  oldest->second->remove_on_destruction = true;
+  segments_.erase(oldest);
+}
+
+void DiskCache::MarkDead(const Location& location) {
+  auto segment(segments_.find(location.segment_id));
+  if (segment != segments_.end())
+    segment->second->live_bytes -= location.record_size;
+}
+
+bool DiskCache::Get(const std::string& key, Value& value) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(index_.find(key));
+  if (itr == index_.end())
+    return false;
+  auto segment(segments_.find(itr->second.segment_id));
+  assert(segment != segments_.end());
+  value.segment_ = segment->second;
+  value.size_ = itr->second.record_size - kHeaderSize - key.size();
+  value.data_ = segment->second->base() + itr->second.offset + kHeaderSize + key.size();
+  return true;
+}
+
+bool DiskCache::Contains(const std::string& key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.find(key) != index_.end();
+}
+
+void DiskCache::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& segment : segments_)
+    segment.second->region.flush();
+}
+
+size_t DiskCache::entry_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.size();
+}
+
+size_t DiskCache::segment_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return segments_.size();
+}
+
+void DiskCache::CompactionLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    if (!CompactOneSegment(lock) && !stopping_)
+      cond_var_.wait(lock);
+  }
+}
+
+std::shared_ptr<DiskCache::Segment> DiskCache::CompactionVictim() const {
+  std::shared_ptr<Segment> victim;
+  for (const auto& segment : segments_) {
+    if (segment.second != active_segment_ &&
+        segment.second->live_bytes * 2 < segment.second->capacity &&
+        (!victim || segment.second->live_bytes < victim->live_bytes))
+      victim = segment.second;
+  }
+  return victim;
+}
+
+bool DiskCache::CompactOneSegment(std::unique_lock<std::mutex>& lock) {
+  std::shared_ptr<Segment> victim(CompactionVictim());
+  if (!victim)
+    return false;
+
+  std::vector<std::pair<std::string, Location>> live_records;
+  for (const auto& entry : index_) {
+    if (entry.second.segment_id == victim->id)
+      live_records.push_back(entry);
+  }
+  // Records are moved a chunk at a time: space is reserved at the end of the active segment, the
+  // records are copied there verbatim without the lock, and then those not overwritten or evicted
+  // in the meantime are repointed at their copies.
+  size_t moved(0);
+  auto next(live_records.begin());
+  while (next != live_records.end()) {
+    if (stopping_ || write_disabled_)
+      return false;
+    if ((!active_segment_ ||
+         active_segment_->write_offset + next->second.record_size > active_segment_->capacity) &&
+        !StartNewSegment(lock)) {
+      return false;
+    }
+    std::shared_ptr<Segment> destination(active_segment_);
+    const uint32_t kChunkOffset(destination->write_offset);
+    uint32_t chunk_size(0);
+    auto chunk_end(next);
+    while (chunk_end != live_records.end() && chunk_size < kCompactionChunkSize &&
+           kChunkOffset + chunk_size + chunk_end->second.record_size <= destination->capacity) {
+      chunk_size += chunk_end->second.record_size;
+      ++chunk_end;
+    }
+    destination->write_offset += chunk_size;
+    if (destination->write_offset + kHeaderSize <= destination->capacity)
+      std::memset(destination->base() + destination->write_offset, 0, kHeaderSize);
+
+    lock.unlock();
+    uint32_t offset(kChunkOffset);
+    for (auto itr(next); itr != chunk_end; ++itr) {
+      std::memcpy(destination->base() + offset, victim->base() + itr->second.offset,
+                  itr->second.record_size);
+      offset += itr->second.record_size;
+    }
+    lock.lock();
+
+    bool destination_present(segments_.count(destination->id) != 0);
+    for (offset = kChunkOffset; next != chunk_end; offset += (next++)->second.record_size) {
+      auto entry(index_.find(next->first));
+      if (!destination_present || entry == index_.end() ||
+          entry->second.segment_id != victim->id || entry->second.offset != next->second.offset)
+        continue;
+      MarkDead(entry->second);
+      entry->second = Location(destination->id, offset, next->second.record_size);
+      destination->live_bytes += next->second.record_size;
+      ++moved;
+    }
+  }
+  if (segments_.erase(victim->id) != 0)
+    victim->remove_on_destruction = true;
+  LOG(kVerbose) << "Compacted disk cache segment " << victim->path << ", moved " << moved
+                << " live records.";
+  return true;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,126 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_DISK_CACHE_H_
+#define MAIDSAFE_ROUTING_DISK_CACHE_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "boost/filesystem/path.hpp"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+class DiskCacheTest_BEH_Compaction_Test;
+}
+
+// Persistent second tier for the routing layer cache.  Chunks are appended to fixed-size,
+// memory-mapped segment files in directory and located via an in-memory index, which is rebuilt
+// by scanning the segments when the cache is reopened.  Every record carries a checksum, so a
+// record torn by a crash is detected on recovery and it and anything after it in that segment are
+// discarded.  Once the segments exceed max_bytes the oldest is dropped, and a background thread
+// rewrites the live records of mostly-overwritten segments so their space can be reclaimed.
+class DiskCache {
+ private:
+  struct Segment;
+
+ public:
+  // A view of a cached value directly in the mapped segment.  It keeps the segment mapped for as
+  // long as it exists, even if the segment is compacted or evicted in the meantime.
+  class Value {
+   public:
+    Value() : segment_(), data_(nullptr), size_(0) {}
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string string() const { return std::string(data_, size_); }
+
+   private:
+    friend class DiskCache;
+    std::shared_ptr<Segment> segment_;
+    const char* data_;
+    size_t size_;
+  };
+
+  static const uint32_t kDefaultSegmentSize = 16 * 1024 * 1024;
+
+  // Opens the cache in directory, creating it if necessary, and recovers any existing segments.
+  // Throws if directory cannot be created or an existing segment cannot be mapped.
+  DiskCache(const boost::filesystem::path& directory, uint64_t max_bytes,
+            uint32_t segment_size = kDefaultSegmentSize);
+  ~DiskCache();
+  // Returns false if the record doesn't fit in a single segment, or if writing has been disabled
+  // after a new segment couldn't be created.
+  bool Put(const std::string& key, const std::string& value);
+  bool Get(const std::string& key, Value& value) const;
+  bool Contains(const std::string& key) const;
+  // Writes dirty pages of all segments to disk.
+  void Flush();
+  size_t entry_count() const;
+  size_t segment_count() const;
+
+  friend class test::DiskCacheTest_BEH_Compaction_Test;
+
+ private:
+  struct Location {
+    Location() : segment_id(0), offset(0), record_size(0) {}
+    Location(uint32_t segment_id_in, uint32_t offset_in, uint32_t record_size_in)
+        : segment_id(segment_id_in), offset(offset_in), record_size(record_size_in) {}
+    uint32_t segment_id, offset, record_size;
+  };
+
+  DiskCache(const DiskCache&);
+  DiskCache& operator=(const DiskCache&);
+  void Recover();
+  std::shared_ptr<Segment> OpenSegment(uint32_t segment_id, bool create);
+  bool Append(const std::string& key, const char* value, size_t value_size,
+              std::unique_lock<std::mutex>& lock);
+  bool StartNewSegment(std::unique_lock<std::mutex>& lock);
+  void EvictOldestSegment(std::unique_lock<std::mutex>& lock);
+  void MarkDead(const Location& location);
+  void CompactionLoop();
+  // The sealed segment with the least live data, provided at least half of it is dead.  Requires
+  // mutex_ to be held.
+  std::shared_ptr<Segment> CompactionVictim() const;
+  bool CompactOneSegment(std::unique_lock<std::mutex>& lock);
+
+  const boost::filesystem::path kDirectory_;
+  const uint32_t kSegmentSize_;
+  const size_t kMaxSegments_;
+  mutable std::mutex mutex_;
+  std::condition_variable cond_var_;
+  bool stopping_, write_disabled_;
+  std::map<uint32_t, std::shared_ptr<Segment>> segments_;
+  std::shared_ptr<Segment> active_segment_;
+  std::unordered_map<std::string, Location> index_;
+  std::thread compaction_thread_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_DISK_CACHE_H_
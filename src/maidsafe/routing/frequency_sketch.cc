@@ -0,0 +1,97 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/frequency_sketch.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+size_t TableWidth(size_t expected_entries) {
+  size_t width(64);
+  while (width < expected_entries)
+    width <<= 1;
+  return width;
+}
+
+}  // unnamed namespace
+
+const uint8_t FrequencySketch::kMaxCount;
+const size_t FrequencySketch::kDepth;
+
+FrequencySketch::FrequencySketch(size_t expected_entries)
+    : mutex_(),
+      kWidthMask_(TableWidth(expected_entries) - 1),
+      kSampleSize_(10 * std::max(size_t(1), expected_entries)),
+      increments_(0),
+      table_(kDepth * TableWidth(expected_entries), 0) {}
+
+void FrequencySketch::Indices(const std::string& key, size_t (&indices)[kDepth]) const {
+  // Double hashing: row i uses h1 + i * h2, with h2 forced odd so rows never collapse.
+  uint64_t h1(std::hash<std::string>()(key));
+  uint64_t h2((h1 ^ (h1 >> 33)) * 0xff51afd7ed558ccdULL);
+  h2 = (h2 ^ (h2 >> 33)) | 1;
+  for (size_t i(0); i != kDepth; ++i)
+    indices[i] = i * (kWidthMask_ + 1) + static_cast<size_t>((h1 + i * h2) & kWidthMask_);
+}
+
+void FrequencySketch::Increment(const std::string& key) {
+  size_t indices[kDepth];
+  Indices(key, indices);
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool incremented(false);
+  for (size_t index : indices) {
+    if (table_[index] < kMaxCount) {
+      ++table_[index];
+      incremented = true;
+    }
+  }
+  if (incremented && ++increments_ >= kSampleSize_)
+    Age();
+}
+
+uint8_t FrequencySketch::Estimate(const std::string& key) const {
+  size_t indices[kDepth];
+  Indices(key, indices);
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint8_t estimate(kMaxCount);
+  for (size_t index : indices)
+    estimate = std::min(estimate, table_[index]);
+  return estimate;
+}
+
+void FrequencySketch::Age() {
+  for (auto& counter : table_)
+    counter >>= 1;
+  increments_ /= 2;
+}
+
+void FrequencySketch::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::fill(table_.begin(), table_.end(), 0);
+  increments_ = 0;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
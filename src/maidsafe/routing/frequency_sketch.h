@@ -0,0 +1,68 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_FREQUENCY_SKETCH_H_
+#define MAIDSAFE_ROUTING_FREQUENCY_SKETCH_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+class FrequencySketchTest_BEH_Aging_Test;
+}
+
+// Count-Min sketch of small saturating counters, used to estimate how often a key has been seen
+// recently.  Once the number of recorded increments reaches the sample size all counters are
+// halved, so that the estimates follow changes in popularity.
+class FrequencySketch {
+ public:
+  static const uint8_t kMaxCount = 15;
+
+  explicit FrequencySketch(size_t expected_entries);
+  void Increment(const std::string& key);
+  uint8_t Estimate(const std::string& key) const;
+  void Clear();
+
+  friend class test::FrequencySketchTest_BEH_Aging_Test;
+
+ private:
+  static const size_t kDepth = 4;
+
+  FrequencySketch(const FrequencySketch&);
+  FrequencySketch& operator=(const FrequencySketch&);
+  void Indices(const std::string& key, size_t (&indices)[kDepth]) const;
+  void Age();
+
+  mutable std::mutex mutex_;
+  const size_t kWidthMask_;
+  const size_t kSampleSize_;
+  size_t increments_;
+  std::vector<uint8_t> table_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_FREQUENCY_SKETCH_H_
@@ -0,0 +1,584 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/in_memory_transport.h"
+
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "boost/asio/error.hpp"
+
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/utils.h"
+#include "maidsafe/rudp/return_codes.h"
+
+#include "maidsafe/routing/return_codes.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+typedef boost::asio::ip::udp::endpoint Endpoint;
+
+const uint16_t kPort(5483);
+// How long a connection added at only one end waits for the other, and how long a zero state node
+// waits for its peer to start listening.
+const std::chrono::seconds kConnectTimeout(10);
+const std::chrono::seconds kZeroStateBootstrapTimeout(10);
+
+// Multiple producer, single consumer queue of messages (Dmitry Vyukov's intrusive MPSC queue).
+// Pushing never blocks; Pop may fail while a Push is part way through linking its item.
+class Mailbox {
+ public:
+  Mailbox() : stub_(), head_(&stub_), tail_(&stub_) {}
+
+  ~Mailbox() {
+    std::string message;
+    while (Pop(message)) {}
+  }
+
+  void Push(std::string message) { Push(new Item(std::move(message))); }
+
+  bool Pop(std::string& message) {
+    Item* tail(tail_);
+    Item* next(tail->next.load(std::memory_order_acquire));
+    if (tail == &stub_) {
+      if (!next)
+        return false;
+      tail_ = tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (!next) {
+      if (tail != head_.load(std::memory_order_acquire))
+        return false;
+      stub_.next.store(nullptr, std::memory_order_relaxed);
+      Push(&stub_);
+      next = tail->next.load(std::memory_order_acquire);
+      if (!next)
+        return false;
+    }
+    tail_ = next;
+    message = std::move(tail->message);
+    delete tail;
+    return true;
+  }
+
+ private:
+  struct Item {
+    Item() : next(nullptr), message() {}
+    explicit Item(std::string message_in) : next(nullptr), message(std::move(message_in)) {}
+    std::atomic<Item*> next;
+    std::string message;
+  };
+
+  Mailbox(const Mailbox&);
+  Mailbox& operator=(const Mailbox&);
+
+  void Push(Item* item) {
+    Item* previous(head_.exchange(item, std::memory_order_acq_rel));
+    previous->next.store(item, std::memory_order_release);
+  }
+
+  Item stub_;
+  std::atomic<Item*> head_;
+  Item* tail_;
+};
+
+}  // unnamed namespace
+
+struct InMemoryNetwork::Peer {
+  struct Connection {
+    Connection()
+        : peer(), created(Clock::now()), established(false), added(false),
+          validated(false), validation_sent(false), validation_data() {}
+    // A connection added at only this end is dropped if the other end doesn't add it in time.
+    bool Expired() const {
+      return !established && Clock::now() - created > kConnectTimeout;
+    }
+    std::weak_ptr<Peer> peer;
+    Clock::time_point created;
+    bool established, added, validated, validation_sent;
+    std::string validation_data;
+  };
+
+  Peer()
+      : mutex(),
+        node_id(),
+        endpoint(),
+        connections(),
+        pending_connects(),
+        callback_mutex(),
+        open(true),
+        message_received(),
+        connection_lost(),
+        mailbox(),
+        pending_message_count(0) {}
+
+  std::mutex mutex;
+  NodeId node_id;
+  Endpoint endpoint;
+  std::map<NodeId, Connection> connections;
+  std::map<NodeId, Clock::time_point> pending_connects;
+  // Functors are only invoked under callback_mutex while the transport is open, so none is invoked
+  // once the transport has been destroyed.
+  std::mutex callback_mutex;
+  bool open;
+  rudp::MessageReceivedFunctor message_received;
+  rudp::ConnectionLostFunctor connection_lost;
+  Mailbox mailbox;
+  // Messages pushed but not yet handled; whoever raises this from zero drains the mailbox.
+  std::atomic<uint32_t> pending_message_count;
+};
+
+class InMemoryTransport : public Transport {
+ public:
+  explicit InMemoryTransport(InMemoryNetwork& network);
+  virtual ~InMemoryTransport();
+  virtual int Bootstrap(const std::vector<Endpoint>& bootstrap_endpoints,
+                        const rudp::MessageReceivedFunctor& message_received_functor,
+                        const rudp::ConnectionLostFunctor& connection_lost_functor,
+                        const NodeId& this_node_id,
+                        std::shared_ptr<asymm::PrivateKey> private_key,
+                        std::shared_ptr<asymm::PublicKey> public_key,
+                        NodeId& chosen_bootstrap_peer, rudp::NatType& nat_type,
+                        Endpoint local_endpoint);
+  virtual int GetAvailableEndpoint(const NodeId& peer_id,
+                                   const rudp::EndpointPair& peer_endpoint_pair,
+                                   rudp::EndpointPair& this_endpoint_pair,
+                                   rudp::NatType& this_nat_type);
+  virtual int Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
+                  const std::string& validation_data);
+  virtual int MarkConnectionAsValid(const NodeId& peer_id, Endpoint& new_bootstrap_endpoint);
+  virtual void Remove(const NodeId& peer_id);
+  virtual void Send(const NodeId& peer_id, const std::string& message,
+                    const rudp::MessageSentFunctor& message_sent_functor);
+
+ private:
+  typedef InMemoryNetwork::Peer Peer;
+
+  InMemoryTransport(const InMemoryTransport&);
+  InMemoryTransport& operator=(const InMemoryTransport&);
+
+  InMemoryNetwork& network_;
+  std::shared_ptr<Peer> peer_;
+};
+
+InMemoryTransport::InMemoryTransport(InMemoryNetwork& network)
+    : network_(network), peer_(std::make_shared<Peer>()) {}
+
+InMemoryTransport::~InMemoryTransport() {
+  {
+    std::lock_guard<std::mutex> lock(peer_->callback_mutex);
+    peer_->open = false;
+    peer_->message_received = nullptr;
+    peer_->connection_lost = nullptr;
+  }
+  network_.Unregister(peer_);
+  std::vector<NodeId> peer_ids;
+  {
+    std::lock_guard<std::mutex> lock(peer_->mutex);
+    for (const auto& connection : peer_->connections)
+      peer_ids.push_back(connection.first);
+  }
+  for (const auto& peer_id : peer_ids)
+    network_.RemoveConnection(peer_, peer_id);
+}
+
+int InMemoryTransport::Bootstrap(const std::vector<Endpoint>& bootstrap_endpoints,
+                                 const rudp::MessageReceivedFunctor& message_received_functor,
+                                 const rudp::ConnectionLostFunctor& connection_lost_functor,
+                                 const NodeId& this_node_id,
+                                 std::shared_ptr<asymm::PrivateKey> /*private_key*/,
+                                 std::shared_ptr<asymm::PublicKey> /*public_key*/,
+                                 NodeId& chosen_bootstrap_peer, rudp::NatType& nat_type,
+                                 Endpoint local_endpoint) {
+  {
+    std::lock_guard<std::mutex> lock(peer_->callback_mutex);
+    peer_->message_received = message_received_functor;
+    peer_->connection_lost = connection_lost_functor;
+  }
+  {
+    std::lock_guard<std::mutex> lock(peer_->mutex);
+    peer_->node_id = this_node_id;
+  }
+  if (!network_.Register(peer_, local_endpoint)) {
+    LOG(kError) << "Local endpoint " << local_endpoint << " is already in use.";
+    return kNoOnlineBootstrapContacts;
+  }
+
+  // A zero state node's peer may not have started listening yet.
+  const auto kDeadline(std::chrono::steady_clock::now() +
+                       (local_endpoint.address().is_unspecified()
+                            ? std::chrono::steady_clock::duration()
+                            : std::chrono::steady_clock::duration(kZeroStateBootstrapTimeout)));
+  for (;;) {
+    for (const auto& endpoint : bootstrap_endpoints) {
+      auto bootstrap_peer(network_.FindPeer(endpoint));
+      if (!bootstrap_peer || bootstrap_peer == peer_)
+        continue;
+      network_.ConnectForBootstrap(peer_, bootstrap_peer);
+      std::lock_guard<std::mutex> lock(bootstrap_peer->mutex);
+      chosen_bootstrap_peer = bootstrap_peer->node_id;
+      nat_type = rudp::NatType::kOther;
+      return kSuccess;
+    }
+    if (std::chrono::steady_clock::now() >= kDeadline)
+      return kNoOnlineBootstrapContacts;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+int InMemoryTransport::GetAvailableEndpoint(const NodeId& peer_id,
+                                            const rudp::EndpointPair& /*peer_endpoint_pair*/,
+                                            rudp::EndpointPair& this_endpoint_pair,
+                                            rudp::NatType& this_nat_type) {
+  std::lock_guard<std::mutex> lock(peer_->mutex);
+  if (peer_->endpoint.address().is_unspecified())
+    return rudp::kInvalidConnection;
+  this_endpoint_pair.local = this_endpoint_pair.external = peer_->endpoint;
+  this_nat_type = rudp::NatType::kOther;
+  auto itr(peer_->connections.find(peer_id));
+  if (itr != peer_->connections.end() && itr->second.Expired()) {
+    peer_->connections.erase(itr);
+    itr = peer_->connections.end();
+  }
+  if (itr != peer_->connections.end()) {
+    if (itr->second.validated)
+      return rudp::kConnectionAlreadyExists;
+    return itr->second.added ? rudp::kUnvalidatedConnectionAlreadyExists
+                             : rudp::kBootstrapConnectionAlreadyExists;
+  }
+  const auto kNow(Clock::now());
+  auto pending(peer_->pending_connects.find(peer_id));
+  if (pending != peer_->pending_connects.end() && kNow - pending->second < kConnectTimeout)
+    return rudp::kConnectAttemptAlreadyRunning;
+  peer_->pending_connects[peer_id] = kNow;
+  return kSuccess;
+}
+
+int InMemoryTransport::Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
+                           const std::string& validation_data) {
+  std::shared_ptr<Peer> remote_peer;
+  {
+    std::lock_guard<std::mutex> lock(peer_->mutex);
+    peer_->pending_connects.erase(peer_id);
+    auto itr(peer_->connections.find(peer_id));
+    if (itr != peer_->connections.end()) {
+      if (itr->second.Expired())
+        peer_->connections.erase(itr);
+      else
+        remote_peer = itr->second.peer.lock();
+    }
+  }
+  if (!remote_peer) {
+    remote_peer = network_.FindPeer(peer_endpoint_pair.external.address().is_unspecified()
+                                        ? peer_endpoint_pair.local
+                                        : peer_endpoint_pair.external);
+  }
+  if (!remote_peer || remote_peer == peer_)
+    return rudp::kInvalidConnection;
+  return network_.AddConnection(peer_, remote_peer, peer_id, validation_data);
+}
+
+int InMemoryTransport::MarkConnectionAsValid(const NodeId& peer_id,
+                                             Endpoint& new_bootstrap_endpoint) {
+  std::shared_ptr<Peer> remote_peer;
+  {
+    std::lock_guard<std::mutex> lock(peer_->mutex);
+    auto itr(peer_->connections.find(peer_id));
+    if (itr == peer_->connections.end() || !itr->second.established)
+      return rudp::kInvalidConnection;
+    if (!itr->second.validated)
+      remote_peer = itr->second.peer.lock();
+    itr->second.validated = true;
+  }
+  // Every peer is directly connectable, so, as rudp does for such peers, each newly validated one
+  // is reported as a bootstrap contact.
+  if (remote_peer) {
+    std::lock_guard<std::mutex> lock(remote_peer->mutex);
+    new_bootstrap_endpoint = remote_peer->endpoint;
+  }
+  return kSuccess;
+}
+
+void InMemoryTransport::Remove(const NodeId& peer_id) { network_.RemoveConnection(peer_, peer_id); }
+
+void InMemoryTransport::Send(const NodeId& peer_id, const std::string& message,
+                             const rudp::MessageSentFunctor& message_sent_functor) {
+  std::shared_ptr<Peer> receiver;
+  {
+    std::lock_guard<std::mutex> lock(peer_->mutex);
+    auto itr(peer_->connections.find(peer_id));
+    if (itr != peer_->connections.end())
+      receiver = itr->second.peer.lock();
+  }
+  network_.Send(peer_, receiver, message, message_sent_functor, true);
+}
+
+InMemoryNetwork::InMemoryNetwork(const NetworkConditions& conditions, int thread_count)
+    : mutex_(),
+      conditions_(conditions),
+      peers_(),
+      next_address_(0),
+      messages_delivered_(0),
+      messages_lost_(0),
+      next_timer_id_(0),
+      latency_timers_(),
+      asio_service_(thread_count) {}
+
+InMemoryNetwork::~InMemoryNetwork() {
+  std::map<uint64_t, std::unique_ptr<SteadyTimer>> latency_timers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latency_timers.swap(latency_timers_);
+  }
+  latency_timers.clear();
+  asio_service_.Stop();
+}
+
+std::unique_ptr<Transport> InMemoryNetwork::MakeTransport() {
+  return std::unique_ptr<Transport>(new InMemoryTransport(*this));
+}
+
+TransportFactory InMemoryNetwork::transport_factory() {
+  return [this] { return MakeTransport(); };  // NOLINT
+}
+
+void InMemoryNetwork::set_conditions(const NetworkConditions& conditions) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  conditions_ = conditions;
+}
+
+bool InMemoryNetwork::Register(std::shared_ptr<Peer> peer, Endpoint endpoint) {
+  std::lock_guard<std::mutex> peer_lock(peer->mutex);
+  if (!peer->endpoint.address().is_unspecified())
+    return true;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (endpoint.address().is_unspecified()) {
+    do {
+      endpoint = Endpoint(boost::asio::ip::address_v4(0x0A000000 + ++next_address_), kPort);
+    } while (peers_.count(endpoint) != 0);
+  } else if (!peers_[endpoint].expired()) {
+    return false;
+  }
+  peers_[endpoint] = peer;
+  peer->endpoint = endpoint;
+  return true;
+}
+
+void InMemoryNetwork::Unregister(std::shared_ptr<Peer> peer) {
+  std::lock_guard<std::mutex> peer_lock(peer->mutex);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(peers_.find(peer->endpoint));
+  if (itr != peers_.end() && itr->second.lock() == peer)
+    peers_.erase(itr);
+}
+
+std::shared_ptr<InMemoryNetwork::Peer> InMemoryNetwork::FindPeer(const Endpoint& endpoint) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(peers_.find(endpoint));
+  return itr == peers_.end() ? std::shared_ptr<Peer>() : itr->second.lock();
+}
+
+void InMemoryNetwork::ConnectForBootstrap(std::shared_ptr<Peer> peer,
+                                          std::shared_ptr<Peer> bootstrap_peer) {
+  std::unique_lock<std::mutex> peer_lock(peer->mutex, std::defer_lock),
+      bootstrap_peer_lock(bootstrap_peer->mutex, std::defer_lock);
+  std::lock(peer_lock, bootstrap_peer_lock);
+  auto& connection(peer->connections[bootstrap_peer->node_id]);
+  connection.peer = bootstrap_peer;
+  connection.established = true;
+  auto& reverse_connection(bootstrap_peer->connections[peer->node_id]);
+  reverse_connection.peer = peer;
+  reverse_connection.established = true;
+}
+
+int InMemoryNetwork::AddConnection(std::shared_ptr<Peer> peer, std::shared_ptr<Peer> remote_peer,
+                                   const NodeId& remote_peer_id,
+                                   const std::string& validation_data) {
+  std::vector<std::pair<std::shared_ptr<Peer>, std::string>> validations_to_send;
+  {
+    std::unique_lock<std::mutex> peer_lock(peer->mutex, std::defer_lock),
+        remote_peer_lock(remote_peer->mutex, std::defer_lock);
+    std::lock(peer_lock, remote_peer_lock);
+    if (remote_peer->node_id != remote_peer_id)
+      return rudp::kInvalidConnection;
+    auto& connection(peer->connections[remote_peer_id]);
+    if (connection.added)
+      return rudp::kConnectionAlreadyExists;
+    connection.peer = remote_peer;
+    connection.added = true;
+    connection.validation_data = validation_data;
+    // Once both ends are present the connection is up, and each end's validation data is sent.
+    auto reverse_connection(remote_peer->connections.find(peer->node_id));
+    if (reverse_connection != remote_peer->connections.end()) {
+      connection.established = reverse_connection->second.established = true;
+      connection.validation_sent = true;
+      validations_to_send.push_back(std::make_pair(remote_peer, validation_data));
+      if (reverse_connection->second.added && !reverse_connection->second.validation_sent) {
+        reverse_connection->second.validation_sent = true;
+        validations_to_send.push_back(
+            std::make_pair(peer, reverse_connection->second.validation_data));
+      }
+    }
+  }
+  for (const auto& validation : validations_to_send) {
+    Send(validation.first == peer ? remote_peer : peer, validation.first, validation.second,
+         rudp::MessageSentFunctor(), false);
+  }
+  return kSuccess;
+}
+
+void InMemoryNetwork::RemoveConnection(std::shared_ptr<Peer> peer, const NodeId& remote_peer_id) {
+  std::shared_ptr<Peer> remote_peer;
+  NodeId peer_id;
+  {
+    std::lock_guard<std::mutex> lock(peer->mutex);
+    auto itr(peer->connections.find(remote_peer_id));
+    if (itr == peer->connections.end())
+      return;
+    remote_peer = itr->second.peer.lock();
+    peer->connections.erase(itr);
+    peer_id = peer->node_id;
+  }
+  if (!remote_peer)
+    return;
+  bool connected(false);
+  {
+    // The remote peer's connection may since have been replaced by one from another transport
+    // under the same id.
+    std::lock_guard<std::mutex> lock(remote_peer->mutex);
+    auto itr(remote_peer->connections.find(peer_id));
+    if (itr != remote_peer->connections.end() && itr->second.peer.lock() == peer) {
+      remote_peer->connections.erase(itr);
+      connected = true;
+    }
+  }
+  if (connected)
+    Clock::Post(asio_service_.service(), [=] { ConnectionLost(remote_peer, peer_id); });  // NOLINT
+}
+
+void InMemoryNetwork::Send(std::shared_ptr<Peer> sender, std::shared_ptr<Peer> receiver,
+                           const std::string& message,
+                           const rudp::MessageSentFunctor& message_sent_functor,
+                           bool may_be_lost) {
+  if (!receiver) {
+    Clock::Post(asio_service_.service(), [=] {
+      MessageSent(sender, message_sent_functor, rudp::kInvalidConnection);
+    });
+    return;
+  }
+  NetworkConditions conditions;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    conditions = conditions_;
+  }
+  if (may_be_lost && conditions.loss_rate > 0.0 &&
+      RandomUint32() < conditions.loss_rate * std::numeric_limits<uint32_t>::max()) {
+    ++messages_lost_;
+    Clock::Post(asio_service_.service(), [=] {
+      MessageSent(sender, message_sent_functor, rudp::kSendFailure);
+    });
+    return;
+  }
+  std::chrono::microseconds latency(conditions.min_latency);
+  if (conditions.max_latency > conditions.min_latency)
+    latency += std::chrono::microseconds(
+        RandomUint32() % (conditions.max_latency - conditions.min_latency).count());
+  if (latency == std::chrono::microseconds(0)) {
+    Clock::Post(asio_service_.service(),
+                [=] { Deliver(sender, receiver, message, message_sent_functor); });  // NOLINT
+    return;
+  }
+  std::unique_ptr<SteadyTimer> timer(new SteadyTimer(asio_service_.service(), latency));
+  SteadyTimer& latency_timer(*timer);
+  uint64_t timer_id(0);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    timer_id = next_timer_id_++;
+    latency_timers_.insert(std::make_pair(timer_id, std::move(timer)));
+  }
+  latency_timer.async_wait([=](const boost::system::error_code& error_code) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      latency_timers_.erase(timer_id);
+    }
+    if (error_code != boost::asio::error::operation_aborted)
+      Deliver(sender, receiver, message, message_sent_functor);
+  });
+}
+
+void InMemoryNetwork::Deliver(std::shared_ptr<Peer> sender, std::shared_ptr<Peer> receiver,
+                              const std::string& message,
+                              const rudp::MessageSentFunctor& message_sent_functor) {
+  NodeId sender_id;
+  {
+    std::lock_guard<std::mutex> lock(sender->mutex);
+    sender_id = sender->node_id;
+  }
+  bool connected(false);
+  {
+    std::lock_guard<std::mutex> lock(receiver->mutex);
+    connected = receiver->connections.count(sender_id) != 0;
+  }
+  if (!connected) {
+    MessageSent(sender, message_sent_functor, rudp::kInvalidConnection);
+    return;
+  }
+  receiver->mailbox.Push(message);
+  ++messages_delivered_;
+  if (receiver->pending_message_count++ == 0)
+    Clock::Post(asio_service_.service(), [=] { Drain(receiver); });  // NOLINT
+  MessageSent(sender, message_sent_functor, kSuccess);
+}
+
+void InMemoryNetwork::Drain(std::shared_ptr<Peer> peer) {
+  std::string message;
+  do {
+    while (!peer->mailbox.Pop(message))
+      std::this_thread::yield();
+    std::lock_guard<std::mutex> lock(peer->callback_mutex);
+    if (peer->open && peer->message_received)
+      peer->message_received(message);
+  } while (--peer->pending_message_count != 0);
+}
+
+void InMemoryNetwork::MessageSent(std::shared_ptr<Peer> sender,
+                                  const rudp::MessageSentFunctor& message_sent_functor,
+                                  int result) {
+  if (!message_sent_functor)
+    return;
+  std::lock_guard<std::mutex> lock(sender->callback_mutex);
+  if (sender->open)
+    message_sent_functor(result);
+}
+
+void InMemoryNetwork::ConnectionLost(std::shared_ptr<Peer> peer, const NodeId& lost_peer_id) {
+  std::lock_guard<std::mutex> lock(peer->callback_mutex);
+  if (peer->open && peer->connection_lost)
+    peer->connection_lost(lost_peer_id);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,113 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_IN_MEMORY_TRANSPORT_H_
+#define MAIDSAFE_ROUTING_IN_MEMORY_TRANSPORT_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "boost/asio/ip/udp.hpp"
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/rudp/managed_connections.h"
+
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/transport.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Applied to every message sent over an InMemoryNetwork.  Each message is delayed by a latency
+// drawn uniformly from [min_latency, max_latency], measured by Clock, and is lost with probability
+// loss_rate, in which case its sender sees rudp::kSendFailure as it would once rudp gave up
+// retransmitting it.
+struct NetworkConditions {
+  NetworkConditions() : min_latency(0), max_latency(0), loss_rate(0.0) {}
+  std::chrono::microseconds min_latency, max_latency;
+  double loss_rate;
+};
+
+// Connects the transports it makes to each other in this process, without sockets or the rudp
+// handshake, so that thousands of nodes can be run in one simulation.  Each transport is given its
+// own endpoint when it bootstraps (or the local endpoint passed to Bootstrap), and a lock-free
+// mailbox into which other transports deliver its messages.  Messages are delivered on the
+// network's own threads; those from one peer may be reordered if the latency varies.  The network
+// must outlive the transports it makes.
+class InMemoryNetwork {
+ public:
+  InMemoryNetwork(const NetworkConditions& conditions, int thread_count);
+  ~InMemoryNetwork();
+  std::unique_ptr<Transport> MakeTransport();
+  TransportFactory transport_factory();
+  void set_conditions(const NetworkConditions& conditions);
+  uint64_t messages_delivered() const { return messages_delivered_; }
+  uint64_t messages_lost() const { return messages_lost_; }
+
+ private:
+  friend class InMemoryTransport;
+  struct Peer;
+
+  InMemoryNetwork(const InMemoryNetwork&);
+  InMemoryNetwork& operator=(const InMemoryNetwork&);
+
+  // Registers 'peer' at 'endpoint', or at a newly allocated endpoint if that is unspecified.  Does
+  // nothing if the peer is already registered.  Returns false if the endpoint is taken.
+  bool Register(std::shared_ptr<Peer> peer, boost::asio::ip::udp::endpoint endpoint);
+  void Unregister(std::shared_ptr<Peer> peer);
+  std::shared_ptr<Peer> FindPeer(const boost::asio::ip::udp::endpoint& endpoint) const;
+  void ConnectForBootstrap(std::shared_ptr<Peer> peer, std::shared_ptr<Peer> bootstrap_peer);
+  int AddConnection(std::shared_ptr<Peer> peer, std::shared_ptr<Peer> remote_peer,
+                    const NodeId& remote_peer_id, const std::string& validation_data);
+  void RemoveConnection(std::shared_ptr<Peer> peer, const NodeId& remote_peer_id);
+  // Delivers 'message' to 'receiver' after the latency, unless it is lost or 'receiver' no longer
+  // holds a connection to 'sender'.  Validation data is never lost.
+  void Send(std::shared_ptr<Peer> sender, std::shared_ptr<Peer> receiver,
+            const std::string& message, const rudp::MessageSentFunctor& message_sent_functor,
+            bool may_be_lost);
+  void Deliver(std::shared_ptr<Peer> sender, std::shared_ptr<Peer> receiver,
+               const std::string& message, const rudp::MessageSentFunctor& message_sent_functor);
+  void Drain(std::shared_ptr<Peer> peer);
+  void MessageSent(std::shared_ptr<Peer> sender,
+                   const rudp::MessageSentFunctor& message_sent_functor, int result);
+  void ConnectionLost(std::shared_ptr<Peer> peer, const NodeId& lost_peer_id);
+
+  mutable std::mutex mutex_;
+  NetworkConditions conditions_;
+  std::map<boost::asio::ip::udp::endpoint, std::weak_ptr<Peer>> peers_;
+  uint32_t next_address_;
+  std::atomic<uint64_t> messages_delivered_, messages_lost_;
+  // Timers of messages awaiting delivery, destroyed along with the network.
+  uint64_t next_timer_id_;
+  std::map<uint64_t, std::unique_ptr<SteadyTimer>> latency_timers_;
+  AsioService asio_service_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_IN_MEMORY_TRANSPORT_H_
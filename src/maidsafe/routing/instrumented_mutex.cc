@@ -0,0 +1,119 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/instrumented_mutex.h"
+
+#ifdef ROUTING_LOCK_PROFILING
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "maidsafe/routing/metrics.h"
+#endif
+
+namespace maidsafe {
+
+namespace routing {
+
+#ifdef ROUTING_LOCK_PROFILING
+
+struct LockStatistics {
+  LockStatistics() : acquisitions(0), contentions(0), wait(), hold() {}
+  std::atomic<uint64_t> acquisitions, contentions;
+  AtomicLatencyHistogram wait, hold;
+};
+
+namespace {
+
+struct LockRegistry {
+  LockRegistry() : mutex(), statistics() {}
+  std::mutex mutex;
+  std::map<std::string, std::unique_ptr<LockStatistics>> statistics;
+};
+
+// Never destroyed, as mutexes with static storage duration may be used after it would have been.
+LockRegistry& Registry() {
+  static LockRegistry* registry(new LockRegistry);
+  return *registry;
+}
+
+LockStatistics& NamedLockStatistics(const char* name) {
+  LockRegistry& registry(Registry());
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::unique_ptr<LockStatistics>& statistics(registry.statistics[name]);
+  if (!statistics)
+    statistics.reset(new LockStatistics);
+  return *statistics;
+}
+
+}  // unnamed namespace
+
+InstrumentedMutex::InstrumentedMutex(const char* name)
+    : mutex_(), statistics_(NamedLockStatistics(name)), acquired_() {}
+
+void InstrumentedMutex::lock() {
+  auto start(std::chrono::steady_clock::now());
+  if (!mutex_.try_lock()) {
+    mutex_.lock();
+    statistics_.contentions.fetch_add(1, std::memory_order_relaxed);
+  }
+  acquired_ = std::chrono::steady_clock::now();
+  statistics_.acquisitions.fetch_add(1, std::memory_order_relaxed);
+  statistics_.wait.Record(acquired_ - start);
+}
+
+bool InstrumentedMutex::try_lock() {
+  if (!mutex_.try_lock())
+    return false;
+  acquired_ = std::chrono::steady_clock::now();
+  statistics_.acquisitions.fetch_add(1, std::memory_order_relaxed);
+  statistics_.wait.Record(std::chrono::steady_clock::duration(0));
+  return true;
+}
+
+void InstrumentedMutex::unlock() {
+  statistics_.hold.Record(std::chrono::steady_clock::now() - acquired_);
+  mutex_.unlock();
+}
+
+void AddLockMetrics(RoutingMetrics& metrics) {
+  LockRegistry& registry(Registry());
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& statistics : registry.statistics) {
+    const std::string kLabel("{lock=\"" + statistics.first + "\"}");
+    metrics.counters["routing_lock_acquisitions_total" + kLabel] =
+        statistics.second->acquisitions.load(std::memory_order_relaxed);
+    metrics.counters["routing_lock_contentions_total" + kLabel] =
+        statistics.second->contentions.load(std::memory_order_relaxed);
+    metrics.histograms["routing_lock_wait_seconds" + kLabel] = statistics.second->wait.Snapshot();
+    metrics.histograms["routing_lock_hold_seconds" + kLabel] = statistics.second->hold.Snapshot();
+  }
+}
+
+#else
+
+void AddLockMetrics(RoutingMetrics& /*metrics*/) {}
+
+#endif
+
+}  // namespace routing
+
+}  // namespace maidsafe
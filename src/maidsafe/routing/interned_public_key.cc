@@ -0,0 +1,98 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/interned_public_key.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+struct KeyStore {
+  KeyStore() : mutex(), keys() {}
+  std::mutex mutex;
+  std::unordered_map<std::string, std::weak_ptr<const asymm::PublicKey>> keys;  // by encoding
+};
+
+// Never destroyed, as handles with static storage duration may outlive it otherwise.
+KeyStore& Store() {
+  static KeyStore* store(new KeyStore);
+  return *store;
+}
+
+void Release(const std::string& encoded_key, const asymm::PublicKey* public_key) {
+  {
+    KeyStore& store(Store());
+    std::lock_guard<std::mutex> lock(store.mutex);
+    auto itr(store.keys.find(encoded_key));
+    // The key may have been interned afresh since its last handle was released.
+    if (itr != store.keys.end() && itr->second.expired())
+      store.keys.erase(itr);
+  }
+  delete public_key;
+}
+
+std::shared_ptr<const asymm::PublicKey> Intern(const asymm::PublicKey& public_key) {
+  // An invalid key can't be encoded, so is held by this handle and its copies alone.
+  if (!asymm::ValidateKey(public_key))
+    return std::make_shared<const asymm::PublicKey>(public_key);
+  std::string encoded_key(asymm::EncodeKey(public_key)->string());
+  KeyStore& store(Store());
+  std::lock_guard<std::mutex> lock(store.mutex);
+  std::weak_ptr<const asymm::PublicKey>& interned(store.keys[encoded_key]);
+  std::shared_ptr<const asymm::PublicKey> shared_key(interned.lock());
+  if (!shared_key) {
+    shared_key.reset(new asymm::PublicKey(public_key),
+                     [encoded_key](const asymm::PublicKey* key) { Release(encoded_key, key); });
+    interned = shared_key;
+  }
+  return shared_key;
+}
+
+}  // unnamed namespace
+
+InternedPublicKey::InternedPublicKey() : public_key_() {}
+
+InternedPublicKey::InternedPublicKey(const asymm::PublicKey& public_key)
+    : public_key_(Intern(public_key)) {}
+
+InternedPublicKey& InternedPublicKey::operator=(const asymm::PublicKey& public_key) {
+  public_key_ = Intern(public_key);
+  return *this;
+}
+
+const asymm::PublicKey& InternedPublicKey::get() const {
+  static const asymm::PublicKey kEmptyKey{};
+  return public_key_ ? *public_key_ : kEmptyKey;
+}
+
+size_t InternedPublicKey::InternedCount() {
+  KeyStore& store(Store());
+  std::lock_guard<std::mutex> lock(store.mutex);
+  return store.keys.size();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
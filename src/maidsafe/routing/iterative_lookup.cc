@@ -0,0 +1,156 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/iterative_lookup.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "maidsafe/common/log.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+IterativeLookup::IterativeLookup(const NodeId& target_id, const NodeId& this_node_id,
+                                 uint16_t alpha, uint16_t result_size,
+                                 FindNodesFunctor find_nodes_functor,
+                                 LookupFinishedFunctor lookup_finished_functor)
+    : kTargetId_(target_id),
+      kThisNodeId_(this_node_id),
+      kAlpha_(std::max(alpha, uint16_t(1))),
+      kResultSize_(std::max(result_size, uint16_t(1))),
+      find_nodes_functor_(find_nodes_functor),
+      lookup_finished_functor_(lookup_finished_functor),
+      mutex_(),
+      shortlist_(),
+      in_flight_count_(0),
+      request_count_(0),
+      finished_(false) {
+  assert(find_nodes_functor_ && lookup_finished_functor_);
+}
+
+void IterativeLookup::Start(const std::vector<NodeId>& initial_peers) {
+  std::vector<NodeId> peers;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const auto& peer : initial_peers)
+      AddCandidate(peer, lock);
+    if (shortlist_.empty()) {
+      ++in_flight_count_;
+      peers.push_back(kTargetId_);
+    } else {
+      peers = NextRequests(lock);
+    }
+  }
+  SendRequests(peers);
+}
+
+size_t IterativeLookup::request_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return request_count_;
+}
+
+void IterativeLookup::AddCandidate(const NodeId& node_id, std::unique_lock<std::mutex>& /*lock*/) {
+  if (node_id.IsZero() || node_id == kThisNodeId_)
+    return;
+  auto itr(std::lower_bound(shortlist_.begin(), shortlist_.end(), node_id,
+                            [this](const Candidate& candidate, const NodeId& new_id) {
+                              return NodeId::CloserToTarget(candidate.node_id, new_id, kTargetId_);
+                            }));
+  if (itr == shortlist_.end() || itr->node_id != node_id)
+    shortlist_.insert(itr, Candidate(node_id));
+}
+
+std::vector<NodeId> IterativeLookup::NextRequests(std::unique_lock<std::mutex>& lock) {
+  std::vector<NodeId> peers;
+  if (finished_)
+    return peers;
+  // Only the closest kResultSize_ candidates which haven't failed are worth querying.
+  uint16_t considered(0);
+  for (auto& candidate : shortlist_) {
+    if (considered == kResultSize_ || in_flight_count_ == kAlpha_)
+      break;
+    if (candidate.state == State::kFailed)
+      continue;
+    ++considered;
+    if (candidate.state == State::kNotQueried) {
+      candidate.state = State::kInFlight;
+      ++in_flight_count_;
+      peers.push_back(candidate.node_id);
+    }
+  }
+  if (peers.empty() && in_flight_count_ == 0)
+    Finish(lock);
+  return peers;
+}
+
+void IterativeLookup::SendRequests(const std::vector<NodeId>& peers) {
+  // Each outstanding request keeps the lookup alive until its response functor is invoked.
+  std::shared_ptr<IterativeLookup> self(shared_from_this());
+  for (const auto& peer : peers) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++request_count_;
+    }
+    find_nodes_functor_(peer, kTargetId_, [self, peer](const std::vector<NodeId>& nodes) {
+      self->HandleResponse(peer, nodes);
+    });
+  }
+}
+
+void IterativeLookup::HandleResponse(const NodeId& peer_id, const std::vector<NodeId>& nodes) {
+  std::vector<NodeId> peers;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (finished_)
+      return;
+    --in_flight_count_;
+    auto itr(std::find_if(shortlist_.begin(), shortlist_.end(),
+                          [&peer_id](const Candidate& candidate) {
+                            return candidate.node_id == peer_id;
+                          }));
+    if (itr != shortlist_.end())
+      itr->state = nodes.empty() ? State::kFailed : State::kResponded;
+    for (const auto& node : nodes)
+      AddCandidate(node, lock);
+    peers = NextRequests(lock);
+  }
+  SendRequests(peers);
+}
+
+void IterativeLookup::Finish(std::unique_lock<std::mutex>& lock) {
+  finished_ = true;
+  std::vector<NodeId> closest_nodes;
+  for (const auto& candidate : shortlist_) {
+    if (candidate.state == State::kResponded)
+      closest_nodes.push_back(candidate.node_id);
+    if (closest_nodes.size() == kResultSize_)
+      break;
+  }
+  LOG(kVerbose) << "Lookup for " << DebugId(kTargetId_) << " finished after " << request_count_
+                << " requests with " << closest_nodes.size() << " nodes.";
+  auto lookup_finished_functor(lookup_finished_functor_);
+  lock.unlock();
+  lookup_finished_functor(closest_nodes);
+  lock.lock();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
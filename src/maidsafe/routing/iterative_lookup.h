@@ -0,0 +1,96 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_ITERATIVE_LOOKUP_H_
+#define MAIDSAFE_ROUTING_ITERATIVE_LOOKUP_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Kademlia-style iterative search for the nodes closest to a target.  A shortlist of candidates is
+// kept sorted by distance to the target, and FindNodes requests are sent to up to alpha of the
+// closest unqueried candidates at a time.  Each response may add closer candidates, and a new
+// request is sent as soon as any outstanding one completes, so the lookup takes about log(N)
+// round trips rather than a fixed number of timer periods.  It finishes once the closest
+// result_size responsive candidates have all been queried.
+class IterativeLookup : public std::enable_shared_from_this<IterativeLookup> {
+ public:
+  // Must be invoked exactly once per request, with an empty vector if the request failed or timed
+  // out.
+  typedef std::function<void(const std::vector<NodeId>& /*nodes*/)> FindNodesResponseFunctor;
+  // Sends a FindNodes for target_id to peer_id.  If peer_id is the target itself, the request is
+  // answered by whichever node is closest to it.
+  typedef std::function<void(const NodeId& /*peer_id*/, const NodeId& /*target_id*/,
+                             const FindNodesResponseFunctor& /*response_functor*/)>
+      FindNodesFunctor;
+  // Invoked once with the closest nodes which responded, sorted by distance to the target.
+  typedef std::function<void(const std::vector<NodeId>& /*closest_nodes*/)> LookupFinishedFunctor;
+
+  // this_node_id is never added to the shortlist.
+  IterativeLookup(const NodeId& target_id, const NodeId& this_node_id, uint16_t alpha,
+                  uint16_t result_size, FindNodesFunctor find_nodes_functor,
+                  LookupFinishedFunctor lookup_finished_functor);
+  // Starts querying initial_peers.  If this is empty, the first request is sent to the target
+  // itself.
+  void Start(const std::vector<NodeId>& initial_peers);
+  // Number of FindNodes requests sent so far.
+  size_t request_count() const;
+
+ private:
+  enum class State { kNotQueried, kInFlight, kResponded, kFailed };
+  struct Candidate {
+    Candidate(const NodeId& node_id_in) : node_id(node_id_in), state(State::kNotQueried) {}
+    NodeId node_id;
+    State state;
+  };
+
+  IterativeLookup(const IterativeLookup&);
+  IterativeLookup& operator=(const IterativeLookup&);
+  void AddCandidate(const NodeId& node_id, std::unique_lock<std::mutex>& lock);
+  // Marks the next requests as in flight and returns their peers, or sets finished_ if there is
+  // nothing left to query.
+  std::vector<NodeId> NextRequests(std::unique_lock<std::mutex>& lock);
+  void SendRequests(const std::vector<NodeId>& peers);
+  void HandleResponse(const NodeId& peer_id, const std::vector<NodeId>& nodes);
+  void Finish(std::unique_lock<std::mutex>& lock);
+
+  const NodeId kTargetId_, kThisNodeId_;
+  const uint16_t kAlpha_, kResultSize_;
+  FindNodesFunctor find_nodes_functor_;
+  LookupFinishedFunctor lookup_finished_functor_;
+  mutable std::mutex mutex_;
+  std::vector<Candidate> shortlist_;
+  uint16_t in_flight_count_;
+  size_t request_count_;
+  bool finished_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_ITERATIVE_LOOKUP_H_
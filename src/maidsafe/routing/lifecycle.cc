@@ -0,0 +1,63 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/lifecycle.h"
+
+#include <chrono>
+#include <thread>
+
+namespace maidsafe {
+
+namespace routing {
+
+const uint64_t Lifecycle::kStopped;
+const uint64_t Lifecycle::kOperation;
+
+Lifecycle::Operation::Operation(Lifecycle& lifecycle)
+    : lifecycle_(lifecycle), admitted_(lifecycle.Begin()) {}
+
+Lifecycle::Operation::~Operation() {
+  if (admitted_)
+    lifecycle_.End();
+}
+
+Lifecycle::Lifecycle() : state_(0) {}
+
+bool Lifecycle::Begin() {
+  // The count and the stopped bit share one atomic, so an operation is either counted before Stop
+  // sets the bit, and waited for, or sees the bit and is refused.
+  if ((state_.fetch_add(kOperation, std::memory_order_acquire) & kStopped) == 0)
+    return true;
+  End();
+  return false;
+}
+
+// Touches nothing but 'state_', as the lifecycle may be destroyed as soon as the count drops.
+void Lifecycle::End() { state_.fetch_sub(kOperation, std::memory_order_release); }
+
+void Lifecycle::Stop() {
+  state_.fetch_or(kStopped, std::memory_order_acq_rel);
+  // Stopping is rare, so it polls rather than have every operation signal a condition variable.
+  while (state_.load(std::memory_order_acquire) != kStopped)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
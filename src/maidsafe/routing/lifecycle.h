@@ -0,0 +1,73 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_LIFECYCLE_H_
+#define MAIDSAFE_ROUTING_LIFECYCLE_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace maidsafe {
+
+namespace routing {
+
+// Running state of an object whose operations may race with its shutdown.  Operations are admitted
+// without locking while the object is running; Stop refuses any further ones and waits for those
+// already admitted to finish, after which the object's members can safely be torn down.
+class Lifecycle {
+ public:
+  // Counts as in flight from construction to destruction, unless refused because the lifecycle
+  // has been stopped, in which case it converts to false.  Operations may be nested.
+  class Operation {
+   public:
+    explicit Operation(Lifecycle& lifecycle);
+    ~Operation();
+    explicit operator bool() const { return admitted_; }
+
+   private:
+    Operation(const Operation&);
+    Operation& operator=(const Operation&);
+
+    Lifecycle& lifecycle_;
+    const bool admitted_;
+  };
+
+  Lifecycle();
+  bool running() const { return (state_.load(std::memory_order_acquire) & kStopped) == 0; }
+  // Blocks until the operations in flight have finished.  Must not be called within an operation.
+  void Stop();
+
+ private:
+  Lifecycle(const Lifecycle&);
+  Lifecycle& operator=(const Lifecycle&);
+
+  bool Begin();
+  void End();
+
+  // The lowest bit of 'state_' is set once stopped; the rest count operations in flight.
+  static const uint64_t kStopped = 1;
+  static const uint64_t kOperation = 2;
+  std::atomic<uint64_t> state_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_LIFECYCLE_H_
@@ -0,0 +1,160 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/lru_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace maidsafe {
+
+namespace routing {
+
+LruCache::LruCache(size_t max_entries, uint64_t max_bytes, size_t shard_count,
+                   AdmissionFunctor admission_functor)
+    : kMaxEntriesPerShard_(std::max(size_t(1), max_entries / std::max(size_t(1), shard_count))),
+      kMaxBytesPerShard_(static_cast<size_t>(
+          std::max(uint64_t(1), max_bytes / std::max(size_t(1), shard_count)))),
+      shards_(new Shard[std::max(size_t(1), shard_count)]),
+      kShardCount_(std::max(size_t(1), shard_count)),
+      admission_functor_(admission_functor),
+      hits_(0),
+      misses_(0),
+      insertions_(0),
+      evictions_(0),
+      rejections_(0),
+      bytes_served_(0) {}
+
+LruCache::Shard& LruCache::GetShard(const std::string& key) const {
+  return shards_[std::hash<std::string>()(key) % kShardCount_];
+}
+
+bool LruCache::Get(const std::string& key, std::string& value) {
+  Shard& shard(GetShard(key));
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto itr(shard.index.find(key));
+  if (itr == shard.index.end()) {
+    ++misses_;
+    return false;
+  }
+  shard.entries.splice(shard.entries.begin(), shard.entries, itr->second);
+  value = itr->second->second;
+  ++hits_;
+  bytes_served_ += value.size();
+  return true;
+}
+
+bool LruCache::Put(const std::string& key, const std::string& value) {
+  uint64_t entry_size(key.size() + value.size());
+  if (entry_size > kMaxBytesPerShard_)
+    return false;
+  Shard& shard(GetShard(key));
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto itr(shard.index.find(key));
+  if (admission_functor_) {
+    // An existing entry for key is replaced, so doesn't count towards the shard being full, and
+    // isn't the entry the new value must be admitted over.
+    size_t replaced_entries(0);
+    uint64_t replaced_bytes(0);
+    if (itr != shard.index.end()) {
+      replaced_entries = 1;
+      replaced_bytes = itr->second->first.size() + itr->second->second.size();
+    }
+    if (shard.entries.size() - replaced_entries >= kMaxEntriesPerShard_ ||
+        shard.size_in_bytes - replaced_bytes + entry_size > kMaxBytesPerShard_) {
+      auto victim(shard.entries.rbegin());
+      if (victim->first == key)
+        ++victim;
+      if (victim != shard.entries.rend() && !admission_functor_(key, victim->first)) {
+        ++rejections_;
+        return false;
+      }
+    }
+  }
+  if (itr != shard.index.end()) {
+    shard.size_in_bytes -= itr->second->first.size() + itr->second->second.size();
+    shard.entries.erase(itr->second);
+    shard.index.erase(itr);
+  }
+  EvictFromShard(shard, entry_size);
+  shard.entries.push_front(std::make_pair(key, value));
+  shard.index.insert(std::make_pair(key, shard.entries.begin()));
+  shard.size_in_bytes += entry_size;
+  ++insertions_;
+  return true;
+}
+
+bool LruCache::IsFull(const Shard& shard, uint64_t bytes_needed) const {
+  return shard.entries.size() >= kMaxEntriesPerShard_ ||
+         shard.size_in_bytes + bytes_needed > kMaxBytesPerShard_;
+}
+
+void LruCache::EvictFromShard(Shard& shard, uint64_t bytes_needed) {
+  while (!shard.entries.empty() && IsFull(shard, bytes_needed)) {
+    const Entry& victim(shard.entries.back());
+    shard.size_in_bytes -= victim.first.size() + victim.second.size();
+    shard.index.erase(victim.first);
+    shard.entries.pop_back();
+    ++evictions_;
+  }
+}
+
+bool LruCache::Contains(const std::string& key) const {
+  Shard& shard(GetShard(key));
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return shard.index.find(key) != shard.index.end();
+}
+
+std::vector<std::string> LruCache::Keys() const {
+  std::vector<std::string> keys;
+  for (size_t i(0); i != kShardCount_; ++i) {
+    std::lock_guard<std::mutex> lock(shards_[i].mutex);
+    for (const auto& entry : shards_[i].entries)
+      keys.push_back(entry.first);
+  }
+  return keys;
+}
+
+void LruCache::Clear() {
+  for (size_t i(0); i != kShardCount_; ++i) {
+    std::lock_guard<std::mutex> lock(shards_[i].mutex);
+    shards_[i].entries.clear();
+    shards_[i].index.clear();
+    shards_[i].size_in_bytes = 0;
+  }
+}
+
+CacheStatistics LruCache::GetStatistics() const {
+  CacheStatistics statistics;
+  statistics.hits = hits_;
+  statistics.misses = misses_;
+  statistics.insertions = insertions_;
+  statistics.evictions = evictions_;
+  statistics.rejections = rejections_;
+  statistics.bytes_served = bytes_served_;
+  for (size_t i(0); i != kShardCount_; ++i) {
+    std::lock_guard<std::mutex> lock(shards_[i].mutex);
+    statistics.entry_count += shards_[i].entries.size();
+    statistics.size_in_bytes += shards_[i].size_in_bytes;
+  }
+  return statistics;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
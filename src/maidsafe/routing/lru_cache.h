@@ -0,0 +1,88 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_LRU_CACHE_H_
+#define MAIDSAFE_ROUTING_LRU_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "maidsafe/routing/api_config.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Thread-safe least-recently-used store of cacheable chunks, keyed by the SHA512 hash of the
+// content.  Entries are spread over independently locked shards to keep contention low on busy
+// nodes.  Both the number of entries and the total bytes held are bounded; whichever limit is hit
+// first causes the least-recently-used entries of the affected shard to be evicted.  If an
+// admission functor is provided, a new entry which would cause an eviction is only stored if the
+// functor prefers it over the shard's least-recently-used entry.
+class LruCache {
+ public:
+  typedef std::function<bool(const std::string& /*candidate*/, const std::string& /*victim*/)>
+      AdmissionFunctor;
+
+  LruCache(size_t max_entries, uint64_t max_bytes, size_t shard_count = 8,
+           AdmissionFunctor admission_functor = AdmissionFunctor());
+  // Returns false if the key is absent, otherwise sets value and marks the entry most recently used.
+  bool Get(const std::string& key, std::string& value);
+  // Returns false if the value is larger than a single shard's byte budget or is not admitted.
+  bool Put(const std::string& key, const std::string& value);
+  bool Contains(const std::string& key) const;
+  std::vector<std::string> Keys() const;
+  void Clear();
+  CacheStatistics GetStatistics() const;
+
+ private:
+  typedef std::pair<std::string, std::string> Entry;
+  struct Shard {
+    Shard() : mutex(), entries(), index(), size_in_bytes(0) {}
+    mutable std::mutex mutex;
+    std::list<Entry> entries;  // front is most recently used
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    uint64_t size_in_bytes;
+  };
+
+  LruCache(const LruCache&);
+  LruCache& operator=(const LruCache&);
+  Shard& GetShard(const std::string& key) const;
+  bool IsFull(const Shard& shard, uint64_t bytes_needed) const;
+  void EvictFromShard(Shard& shard, uint64_t bytes_needed);
+
+  const size_t kMaxEntriesPerShard_, kMaxBytesPerShard_;
+  std::unique_ptr<Shard[]> shards_;
+  const size_t kShardCount_;
+  AdmissionFunctor admission_functor_;
+  std::atomic<uint64_t> hits_, misses_, insertions_, evictions_, rejections_, bytes_served_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_LRU_CACHE_H_
@@ -26,7 +26,9 @@
 #include "maidsafe/routing/client_routing_table.h"
 #include "maidsafe/routing/group_change_handler.h"
 #include "maidsafe/routing/message.h"
+#include "maidsafe/routing/metrics.h"
 #include "maidsafe/routing/network_utils.h"
+#include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/service.h"
@@ -37,6 +39,17 @@ namespace maidsafe {
 
 namespace routing {
 
+namespace {
+
+boost::filesystem::path MessageTracePath(const NodeId& node_id) {
+  if (Parameters::message_trace_path.empty())
+    return boost::filesystem::path();
+  return Parameters::message_trace_path /
+         (node_id.ToStringEncoded(NodeId::EncodingType::kHex) + ".trace");
+}
+
+}  // unnamed namespace
+
 MessageHandler::MessageHandler(RoutingTable& routing_table,
                                ClientRoutingTable& client_routing_table, NetworkUtils& network,
                                Timer<std::string>& timer, RemoveFurthestNode& remove_furthest_node,
@@ -56,7 +69,10 @@ MessageHandler::MessageHandler(RoutingTable& routing_table,
                                             group_change_handler)),
       service_(new Service(routing_table, client_routing_table, network_)),
       message_received_functor_(),
-      typed_message_received_functors_() {}
+      typed_message_received_functors_(),
+      trace_log_(MessageTracePath(routing_table_.kNodeId())) {
+  service_->set_cache_summary_functor([this]() { return cache_summary(); });
+}
 
 void MessageHandler::HandleRoutingMessage(protobuf::Message& message) {
   bool request(message.request());
@@ -68,10 +84,16 @@ void MessageHandler::HandleRoutingMessage(protobuf::Message& message) {
       message.request() ? service_->Connect(message) : response_handler_->Connect(message);
       break;
     case MessageType::kFindNodes:
-      message.request() ? service_->FindNodes(message) : response_handler_->FindNodes(message);
+      if (message.request()) {
+        service_->FindNodes(message);
+      } else {
+        response_handler_->FindNodes(message);
+        response_handler_->FindNodesLookup(timer_, message);
+      }
       break;
     case MessageType::kConnectSuccess:
-      service_->ConnectSuccess(message);
+      if (!response_handler_->PipelinedConnectSuccess(message))
+        service_->ConnectSuccess(message);
       break;
     case MessageType::kConnectSuccessAcknowledgement:
       response_handler_->ConnectSuccessAcknowledgement(message);
@@ -135,6 +157,8 @@ void MessageHandler::HandleNodeLevelMessageForThisNode(protobuf::Message& messag
       message_out.set_client_node(message.client_node());
       message_out.set_routing_message(message.routing_message());
       message_out.add_data(reply_message);
+      if (message.has_trace())  // the response continues the request's trace
+        *message_out.mutable_trace() = message.trace();
       if (IsCacheableGet(message))
         message_out.set_cacheable(static_cast<int32_t>(Cacheable::kPut));
       message_out.set_last_id(routing_table_.kNodeId().string());
@@ -201,6 +225,8 @@ void MessageHandler::HandleMessageForThisNode(protobuf::Message& message) {
   if (RelayDirectMessageIfNeeded(message))
     return;
 
+  routing_table_.metrics().Increment(MetricCounter::kMessagesDelivered);
+  trace_log_.Record(message, "delivered");
   LOG(kVerbose) << "Message for this node."
                 << " id: " << message.id();
   if (IsRoutingMessage(message))
@@ -360,14 +386,18 @@ void MessageHandler::HandleMessageAsFarNode(protobuf::Message& message) {
                 << "] is not in closest proximity to this message destination ID [ "
                 << HexSubstr(message.destination_id()) << " ]; sending on."
                 << " id: " << message.id();
+  routing_table_.metrics().Increment(MetricCounter::kMessagesForwarded);
   network_.SendToClosestNode(message);
 }
 
 void MessageHandler::HandleMessage(protobuf::Message& message) {
+  routing_table_.metrics().MessageReceived(message.type());
+  ScopedLatency handling_latency(routing_table_.metrics(), MetricHistogram::kMessageHandling);
   LOG(kVerbose) << "[" << DebugId(routing_table_.kNodeId()) << "]"
                 << " MessageHandler::HandleMessage handle message with id: " << message.id();
   if (!ValidateMessage(message)) {
     LOG(kWarning) << "Validate message failed， id: " << message.id();
+    trace_log_.Record(message, "dropped");
     BOOST_ASSERT_MSG((message.hops_to_live() > 0),
                      "Message has traversed maximum number of hops allowed");
     return;
@@ -702,6 +732,24 @@ void MessageHandler::set_request_public_key_functor(
   service_->set_request_public_key_functor(request_public_key_functor);
 }
 
+CacheStatistics MessageHandler::cache_statistics() const {
+  return cache_manager_ ? cache_manager_->cache_statistics() : CacheStatistics();
+}
+
+std::string MessageHandler::cache_summary() const {
+  return cache_manager_ ? cache_manager_->CacheSummary() : std::string();
+}
+
+void MessageHandler::ReconnectToPeers(const std::vector<RoutingTableSnapshot::Peer>& peers) {
+  response_handler_->ReconnectToPeers(peers);
+}
+
+void MessageHandler::ConnectionLost(const NodeId& connection_id) {
+  response_handler_->ConnectionLost(connection_id);
+}
+
+PublicKeyCache& MessageHandler::public_key_cache() { return response_handler_->public_key_cache(); }
+
 bool MessageHandler::HandleCacheLookup(protobuf::Message& message) {
   assert(!routing_table_.client_mode());
   assert(IsCacheableGet(message));
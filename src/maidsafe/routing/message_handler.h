@@ -25,6 +25,7 @@
 
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/cache_manager.h"
+#include "maidsafe/routing/message_trace.h"
 #include "maidsafe/routing/response_handler.h"
 #include "maidsafe/routing/service.h"
 #include "maidsafe/routing/timer.h"
@@ -87,6 +88,11 @@ class MessageHandler {
   void set_typed_message_and_caching_functor(TypedMessageAndCachingFunctor functors);
   void set_message_and_caching_functor(MessageAndCachingFunctors functors);
   void set_request_public_key_functor(RequestPublicKeyFunctor request_public_key_functor);
+  CacheStatistics cache_statistics() const;
+  std::string cache_summary() const;
+  void ReconnectToPeers(const std::vector<RoutingTableSnapshot::Peer>& peers);
+  void ConnectionLost(const NodeId& connection_id);
+  PublicKeyCache& public_key_cache();
 
  private:
   MessageHandler(const MessageHandler&);
@@ -135,6 +141,7 @@ class MessageHandler {
   std::shared_ptr<Service> service_;
   MessageReceivedFunctor message_received_functor_;
   detail::TypedMessageRecievedFunctors typed_message_received_functors_;
+  MessageTraceLog trace_log_;
 };
 
 }  // namespace routing
@@ -0,0 +1,172 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/message_trace.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+// Enough to tell apart the nodes on a message's path, while keeping each hop small.
+const size_t kTraceNodeIdBytes(4);
+
+std::string TraceNode(const NodeId& node_id) {
+  return node_id.string().substr(0, kTraceNodeIdBytes);
+}
+
+uint64_t MicrosecondsSinceEpoch(std::chrono::system_clock::time_point time) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count());
+}
+
+}  // unnamed namespace
+
+void StartMessageTrace(protobuf::Message& message, const NodeId& this_node_id) {
+  if (Parameters::message_trace_sample_rate <= 0.0 ||
+      RandomUint32() >= Parameters::message_trace_sample_rate * 4294967296.0)
+    return;
+  auto trace(message.mutable_trace());
+  trace->set_trace_id((static_cast<uint64_t>(RandomUint32()) << 32) | RandomUint32());
+  trace->clear_hops();
+  AddMessageTraceHop(message, this_node_id, std::chrono::microseconds(0));
+}
+
+void AddMessageTraceHop(protobuf::Message& message, const NodeId& this_node_id,
+                        std::chrono::microseconds queueing_delay) {
+  if (!message.has_trace())
+    return;
+  auto hop(message.mutable_trace()->add_hops());
+  hop->set_node(TraceNode(this_node_id));
+  hop->set_received(MicrosecondsSinceEpoch(std::chrono::system_clock::now() - queueing_delay));
+  hop->set_queueing_delay(static_cast<uint32_t>(queueing_delay.count()));
+  hop->set_request(message.request());
+}
+
+void SetMessageTraceForwarded(protobuf::Message& message, const NodeId& this_node_id) {
+  if (!message.has_trace())
+    return;
+  const std::string kNode(TraceNode(this_node_id));
+  for (int i(message.trace().hops_size() - 1); i >= 0; --i) {
+    if (message.trace().hops(i).node() == kNode) {
+      message.mutable_trace()->mutable_hops(i)->set_forwarded(
+          MicrosecondsSinceEpoch(std::chrono::system_clock::now()));
+      return;
+    }
+  }
+}
+
+MessageTrace GetMessageTrace(const protobuf::Message& message, const std::string& outcome) {
+  MessageTrace trace;
+  trace.trace_id = message.trace().trace_id();
+  trace.outcome = outcome;
+  for (const auto& protobuf_hop : message.trace().hops()) {
+    MessageTrace::Hop hop;
+    hop.node = HexEncode(protobuf_hop.node());
+    hop.received = protobuf_hop.received();
+    hop.forwarded = protobuf_hop.forwarded();
+    hop.queueing_delay = protobuf_hop.queueing_delay();
+    hop.request = protobuf_hop.request();
+    trace.hops.push_back(hop);
+  }
+  return trace;
+}
+
+std::string SerialiseMessageTrace(const MessageTrace& trace) {
+  std::ostringstream line;
+  line << std::hex << std::setw(16) << std::setfill('0') << trace.trace_id << std::dec << ' '
+       << trace.outcome;
+  for (const auto& hop : trace.hops) {
+    line << ' ' << hop.node << ':' << hop.received << ':' << hop.forwarded << ':'
+         << hop.queueing_delay << ':' << (hop.request ? 1 : 0);
+  }
+  return line.str();
+}
+
+MessageTrace ParseMessageTrace(const std::string& line) {
+  MessageTrace trace;
+  std::istringstream stream(line);
+  if (!(stream >> std::hex >> trace.trace_id >> std::dec >> trace.outcome))
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  std::string field;
+  while (stream >> field) {
+    std::replace(field.begin(), field.end(), ':', ' ');
+    std::istringstream hop_stream(field);
+    MessageTrace::Hop hop;
+    int request(0);
+    if (!(hop_stream >> hop.node >> hop.received >> hop.forwarded >> hop.queueing_delay >>
+          request))
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+    hop.request = (request != 0);
+    trace.hops.push_back(hop);
+  }
+  return trace;
+}
+
+std::vector<MessageTrace> ReadMessageTraces(const fs::path& file_path) {
+  std::vector<MessageTrace> traces;
+  std::ifstream stream(file_path.string().c_str());
+  std::string line;
+  while (std::getline(stream, line)) {
+    try {
+      traces.push_back(ParseMessageTrace(line));
+    }
+    catch (const std::exception& e) {
+      LOG(kWarning) << "Skipping malformed trace in " << file_path << " : " << e.what();
+    }
+  }
+  return traces;
+}
+
+MessageTraceLog::MessageTraceLog(const fs::path& file_path)
+    : kFilePath_(file_path), mutex_(), stream_() {}
+
+void MessageTraceLog::Record(const protobuf::Message& message, const std::string& outcome) {
+  if (!message.has_trace() || kFilePath_.empty())
+    return;
+  std::string line(SerialiseMessageTrace(GetMessageTrace(message, outcome)));
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!stream_.is_open()) {
+    stream_.open(kFilePath_.string().c_str(), std::ios::app);
+    if (!stream_) {
+      LOG(kWarning) << "Could not open message trace file " << kFilePath_;
+      return;
+    }
+  }
+  // Flushed per line so that a trace can be read while the node is running.
+  stream_ << line << std::endl;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
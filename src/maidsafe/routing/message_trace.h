@@ -0,0 +1,103 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_MESSAGE_TRACE_H_
+#define MAIDSAFE_ROUTING_MESSAGE_TRACE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem/path.hpp"
+
+#include "maidsafe/common/node_id.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace protobuf {
+class Message;
+}
+
+// The hops of a traced message, as recorded by a node at which the message was delivered or
+// dropped.  A request's trace continues in its responses, so a delivered response holds the whole
+// round trip.
+struct MessageTrace {
+  struct Hop {
+    Hop() : node(), received(0), forwarded(0), queueing_delay(0), request(true) {}
+    std::string node;  // hex of the leading bytes of the node's id
+    // Microseconds since epoch by the node's own clock; forwarded is 0 if the node didn't send on.
+    uint64_t received, forwarded;
+    uint32_t queueing_delay;  // microseconds between receipt and handling
+    bool request;
+  };
+
+  MessageTrace() : trace_id(0), outcome(), hops() {}
+  uint64_t trace_id;
+  std::string outcome;  // "delivered" or "dropped"
+  std::vector<Hop> hops;
+};
+
+// Starts a trace of a message originating at this node, if it is sampled at
+// Parameters::message_trace_sample_rate.
+void StartMessageTrace(protobuf::Message& message, const NodeId& this_node_id);
+
+// Appends this node's hop to a traced message which it has received.
+void AddMessageTraceHop(protobuf::Message& message, const NodeId& this_node_id,
+                        std::chrono::microseconds queueing_delay);
+
+// Stamps this node's last hop of a traced message as it is sent on.
+void SetMessageTraceForwarded(protobuf::Message& message, const NodeId& this_node_id);
+
+MessageTrace GetMessageTrace(const protobuf::Message& message, const std::string& outcome);
+
+// One line per trace: the trace id in hex, the outcome, then each hop as
+// node:received:forwarded:queueing_delay:request.
+std::string SerialiseMessageTrace(const MessageTrace& trace);
+// Throws if 'line' isn't a serialised trace.
+MessageTrace ParseMessageTrace(const std::string& line);
+
+// Traces in a file written by MessageTraceLog, skipping any malformed lines.
+std::vector<MessageTrace> ReadMessageTraces(const boost::filesystem::path& file_path);
+
+// Appends the traces of messages delivered to or dropped by this node to a file, which is opened on
+// the first traced message.  Disabled if 'file_path' is empty.
+class MessageTraceLog {
+ public:
+  explicit MessageTraceLog(const boost::filesystem::path& file_path);
+  void Record(const protobuf::Message& message, const std::string& outcome);
+
+ private:
+  MessageTraceLog(const MessageTraceLog&);
+  MessageTraceLog& operator=(const MessageTraceLog&);
+
+  const boost::filesystem::path kFilePath_;
+  std::mutex mutex_;
+  std::ofstream stream_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_MESSAGE_TRACE_H_
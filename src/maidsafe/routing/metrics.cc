@@ -0,0 +1,250 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/metrics.h"
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/message_handler.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const size_t kSubBucketBits(3);
+const size_t kSubBucketCount(1 << kSubBucketBits);
+
+const char* const kCounterNames[] = {
+    "routing_messages_forwarded_total", "routing_messages_delivered_total",
+    "routing_send_retries_total",       "routing_send_drops_total",
+    "routing_table_adds_total",         "routing_table_drops_total",
+    "routing_matrix_changes_total"};
+
+const char* const kHistogramNames[] = {"routing_send_latency_seconds",
+                                       "routing_message_handling_seconds"};
+
+// Indexed by MessageTypeSlot.
+const char* const kMessageTypeNames[] = {
+    "unknown", "ping", "connect", "find_nodes", "connect_success",
+    "connect_success_acknowledgement", "remove", "closest_nodes_update", "get_group", "node_level"};
+
+size_t MessageTypeSlot(int32_t message_type) {
+  if (message_type >= static_cast<int32_t>(MessageType::kPing) &&
+      message_type <= static_cast<int32_t>(MessageType::kGetGroup))
+    return static_cast<size_t>(message_type);
+  if (message_type == static_cast<int32_t>(MessageType::kNodeLevel))
+    return Metrics::kMessageTypeSlots - 1;
+  return 0;
+}
+
+// Splits e.g. 'name{type="ping"}' into 'name' and 'type="ping"'.
+std::pair<std::string, std::string> SplitLabels(const std::string& key) {
+  auto brace(key.find('{'));
+  if (brace == std::string::npos)
+    return std::make_pair(key, std::string());
+  return std::make_pair(key.substr(0, brace), key.substr(brace + 1, key.size() - brace - 2));
+}
+
+std::string Labels(const std::string& node_label, const std::string& labels) {
+  return "{" + node_label + (labels.empty() ? "" : "," + labels) + "}";
+}
+
+std::string Seconds(std::chrono::microseconds duration) {
+  std::ostringstream stream;
+  stream << std::setprecision(9) << duration.count() / 1e6;
+  return stream.str();
+}
+
+}  // unnamed namespace
+
+const size_t AtomicLatencyHistogram::kBucketCount;
+
+AtomicLatencyHistogram::AtomicLatencyHistogram() : buckets_(), count_(0), sum_(0) {
+  for (auto& bucket : buckets_)
+    bucket = 0;
+}
+
+void AtomicLatencyHistogram::Record(std::chrono::steady_clock::duration latency) {
+  auto microseconds(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+  uint64_t value(microseconds < 0 ? 0 : static_cast<uint64_t>(microseconds));
+  buckets_[LatencyBucket(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+LatencyHistogram AtomicLatencyHistogram::Snapshot() const {
+  LatencyHistogram histogram;
+  for (size_t bucket(0); bucket != kBucketCount; ++bucket) {
+    uint64_t count(buckets_[bucket].load(std::memory_order_relaxed));
+    if (count == 0)
+      continue;
+    histogram.buckets.push_back(
+        std::make_pair(std::chrono::microseconds(LatencyBucketUpperBound(bucket)), count));
+    histogram.count += count;
+  }
+  // Summed separately from the buckets, so may include a value recorded since they were read.
+  histogram.sum = std::chrono::microseconds(sum_.load(std::memory_order_relaxed));
+  return histogram;
+}
+
+const size_t Metrics::kShardCount;
+const size_t Metrics::kMessageTypeSlots;
+const size_t Metrics::kBucketCount;
+
+Metrics::Metrics() : shards_(), histograms_() {
+  for (auto& shard : shards_) {
+    for (auto& counter : shard.counters)
+      counter = 0;
+  }
+}
+
+void Metrics::Add(size_t slot) {
+  // Threads of the same io_service hash to different shards with high probability.
+  auto& shard(shards_[std::hash<std::thread::id>()(std::this_thread::get_id()) % kShardCount]);
+  shard.counters[slot].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::Increment(MetricCounter counter) { Add(static_cast<size_t>(counter)); }
+
+void Metrics::MessageReceived(int32_t message_type) {
+  Add(static_cast<size_t>(MetricCounter::kCount) + MessageTypeSlot(message_type));
+}
+
+void Metrics::MessageSent(int32_t message_type) {
+  Add(static_cast<size_t>(MetricCounter::kCount) + kMessageTypeSlots +
+      MessageTypeSlot(message_type));
+}
+
+void Metrics::RecordLatency(MetricHistogram histogram,
+                            std::chrono::steady_clock::duration latency) {
+  histograms_[static_cast<size_t>(histogram)].Record(latency);
+}
+
+RoutingMetrics Metrics::Snapshot() const {
+  std::array<uint64_t, kCounterSlots> totals;
+  totals.fill(0);
+  for (const auto& shard : shards_) {
+    for (size_t i(0); i != kCounterSlots; ++i)
+      totals[i] += shard.counters[i].load(std::memory_order_relaxed);
+  }
+
+  RoutingMetrics metrics;
+  const size_t kTypeOffset(static_cast<size_t>(MetricCounter::kCount));
+  for (size_t i(0); i != kTypeOffset; ++i)
+    metrics.counters[kCounterNames[i]] = totals[i];
+  for (size_t i(0); i != kMessageTypeSlots; ++i) {
+    std::string label(std::string("{type=\"") + kMessageTypeNames[i] + "\"}");
+    metrics.counters["routing_messages_received_total" + label] = totals[kTypeOffset + i];
+    metrics.counters["routing_messages_sent_total" + label] =
+        totals[kTypeOffset + kMessageTypeSlots + i];
+  }
+
+  for (size_t i(0); i != histograms_.size(); ++i)
+    metrics.histograms[kHistogramNames[i]] = histograms_[i].Snapshot();
+  return metrics;
+}
+
+size_t LatencyBucket(uint64_t microseconds) {
+  if (microseconds < kSubBucketCount)
+    return static_cast<size_t>(microseconds);
+  size_t exponent(0);
+  while (exponent != 63 && (microseconds >> (exponent + 1)) != 0)
+    ++exponent;
+  size_t shift(exponent - kSubBucketBits);
+  size_t bucket((exponent - kSubBucketBits + 1) * kSubBucketCount +
+                static_cast<size_t>(microseconds >> shift) - kSubBucketCount);
+  return std::min(bucket, Metrics::kBucketCount - 1);
+}
+
+uint64_t LatencyBucketUpperBound(size_t bucket) {
+  if (bucket < kSubBucketCount)
+    return bucket;
+  size_t shift(bucket / kSubBucketCount - 1);
+  return ((static_cast<uint64_t>(bucket % kSubBucketCount + kSubBucketCount + 1)) << shift) - 1;
+}
+
+std::string PrometheusText(const RoutingMetrics& metrics, const std::string& node_id) {
+  const std::string kNodeLabel("node=\"" + node_id + "\"");
+  std::ostringstream text;
+  std::set<std::string> typed_names;
+  for (const auto& counter : metrics.counters) {
+    auto name_and_labels(SplitLabels(counter.first));
+    if (typed_names.insert(name_and_labels.first).second)
+      text << "# TYPE " << name_and_labels.first << " counter\n";
+    text << name_and_labels.first << Labels(kNodeLabel, name_and_labels.second) << ' '
+         << counter.second << '\n';
+  }
+  for (const auto& histogram : metrics.histograms) {
+    auto name_and_labels(SplitLabels(histogram.first));
+    const std::string& name(name_and_labels.first);
+    const std::string& labels(name_and_labels.second);
+    const std::string kBucketLabels(labels.empty() ? "" : labels + ",");
+    if (typed_names.insert(name).second)
+      text << "# TYPE " << name << " histogram\n";
+    uint64_t cumulative_count(0);
+    for (const auto& bucket : histogram.second.buckets) {
+      cumulative_count += bucket.second;
+      text << name << "_bucket"
+           << Labels(kNodeLabel, kBucketLabels + "le=\"" + Seconds(bucket.first) + "\"") << ' '
+           << cumulative_count << '\n';
+    }
+    text << name << "_bucket" << Labels(kNodeLabel, kBucketLabels + "le=\"+Inf\"") << ' '
+         << histogram.second.count << '\n';
+    text << name << "_sum" << Labels(kNodeLabel, labels) << ' ' << Seconds(histogram.second.sum)
+         << '\n';
+    text << name << "_count" << Labels(kNodeLabel, labels) << ' ' << histogram.second.count
+         << '\n';
+  }
+  return text.str();
+}
+
+void WritePrometheusFile(const RoutingMetrics& metrics, const std::string& node_id,
+                         const fs::path& file_path) {
+  // The collector may read the file at any time, so it must never see a partial write.
+  fs::path temp_path(file_path.string() + ".tmp");
+  boost::system::error_code error_code;
+  if (!WriteFile(temp_path, PrometheusText(metrics, node_id))) {
+    LOG(kError) << "Could not write metrics at : " << temp_path;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  fs::rename(temp_path, file_path, error_code);
+  if (error_code) {
+    LOG(kError) << "Could not move metrics to " << file_path << " : " << error_code.message();
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,137 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_METRICS_H_
+#define MAIDSAFE_ROUTING_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "boost/filesystem/path.hpp"
+
+#include "maidsafe/routing/api_config.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+enum class MetricCounter : int {
+  kMessagesForwarded = 0,  // passed on towards a destination this node isn't close to
+  kMessagesDelivered,      // addressed to this node
+  kSendRetries,            // re-sent by RecursiveSendOn after a failed send
+  kSendDrops,              // abandoned for want of a peer to send to
+  kRoutingTableAdds,
+  kRoutingTableDrops,
+  kMatrixChanges,
+  kCount
+};
+
+enum class MetricHistogram : int {
+  kSendLatency = 0,  // from a send to rudp's acknowledgement, small messages only
+  kMessageHandling,  // time spent in MessageHandler::HandleMessage
+  kCount
+};
+
+// Lock-free latency histogram with log-linear buckets, eight per power of two.
+class AtomicLatencyHistogram {
+ public:
+  AtomicLatencyHistogram();
+  void Record(std::chrono::steady_clock::duration latency);
+  LatencyHistogram Snapshot() const;
+
+  static const size_t kBucketCount = 280;
+
+ private:
+  AtomicLatencyHistogram(const AtomicLatencyHistogram&);
+  AtomicLatencyHistogram& operator=(const AtomicLatencyHistogram&);
+
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+  std::atomic<uint64_t> count_, sum_;
+};
+
+// Lock-free registry of a node's counters and latency histograms.  Counters are updated in one of
+// kShardCount shards chosen by the calling thread, so concurrent threads rarely share a cache line;
+// Snapshot sums the shards.
+class Metrics {
+ public:
+  Metrics();
+  void Increment(MetricCounter counter);
+  void MessageReceived(int32_t message_type);
+  void MessageSent(int32_t message_type);
+  void RecordLatency(MetricHistogram histogram, std::chrono::steady_clock::duration latency);
+  RoutingMetrics Snapshot() const;
+
+  static const size_t kShardCount = 8;
+  static const size_t kMessageTypeSlots = 10;
+  static const size_t kBucketCount = AtomicLatencyHistogram::kBucketCount;
+
+ private:
+  Metrics(const Metrics&);
+  Metrics& operator=(const Metrics&);
+
+  static const size_t kCounterSlots =
+      static_cast<size_t>(MetricCounter::kCount) + 2 * kMessageTypeSlots;
+  struct Shard {
+    std::array<std::atomic<uint64_t>, kCounterSlots> counters;
+    char padding[64];  // keeps neighbouring shards off each other's cache lines
+  };
+  void Add(size_t slot);
+
+  std::array<Shard, kShardCount> shards_;
+  std::array<AtomicLatencyHistogram, static_cast<size_t>(MetricHistogram::kCount)> histograms_;
+};
+
+// Records the time from its construction to its destruction in a histogram.
+class ScopedLatency {
+ public:
+  ScopedLatency(Metrics& metrics, MetricHistogram histogram)
+      : metrics_(metrics), kHistogram_(histogram), kStart_(std::chrono::steady_clock::now()) {}
+  ~ScopedLatency() {
+    metrics_.RecordLatency(kHistogram_, std::chrono::steady_clock::now() - kStart_);
+  }
+
+ private:
+  ScopedLatency(const ScopedLatency&);
+  ScopedLatency& operator=(const ScopedLatency&);
+
+  Metrics& metrics_;
+  const MetricHistogram kHistogram_;
+  const std::chrono::steady_clock::time_point kStart_;
+};
+
+// Bucket of the log-linear histogram holding 'microseconds', and the largest value it holds.
+size_t LatencyBucket(uint64_t microseconds);
+uint64_t LatencyBucketUpperBound(size_t bucket);
+
+// Renders the metrics in the Prometheus text exposition format, labelling each sample with node_id.
+std::string PrometheusText(const RoutingMetrics& metrics, const std::string& node_id);
+
+// Writes the metrics for the node_exporter text file collector, replacing the file atomically.
+// Throws on failure.
+void WritePrometheusFile(const RoutingMetrics& metrics, const std::string& node_id,
+                         const boost::filesystem::path& file_path);
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_METRICS_H_
@@ -20,6 +20,9 @@
 
 #include <string>
 #include <algorithm>
+#include <limits>
+
+#include "maidsafe/common/crypto.h"
 
 #include "maidsafe/routing/parameters.h"
 
@@ -27,8 +30,37 @@ namespace maidsafe {
 
 namespace routing {
 
+namespace {
+
+const uint32_t kDecayShift(4);
+
+// Distances are compared by their most significant 64 bits, enough to tell apart the group
+// distances of networks of up to 2^60 or so nodes.
+uint64_t LeadingBits(const NodeId& distance) {
+  const std::string& bytes(distance.string());
+  uint64_t leading_bits(0);
+  for (size_t i(0); i != sizeof(leading_bits); ++i)
+    leading_bits = (leading_bits << 8) | static_cast<uint8_t>(bytes[i]);
+  return leading_bits;
+}
+
+// The group_size'th closest of n uniformly distributed ids is expected at a distance of
+// group_size / (n + 1) of the id space.
+uint64_t NetworkSizeFromAverageDistance(uint64_t average_distance) {
+  uint64_t group_fraction(average_distance / Parameters::group_size);
+  if (group_fraction == 0)
+    return average_distance == 0 ? 0 : std::numeric_limits<uint64_t>::max();
+  return std::numeric_limits<uint64_t>::max() / group_fraction - 1;
+}
+
+}  // unnamed namespace
+
 NetworkStatistics::NetworkStatistics(NodeId node_id)
-    : mutex_(), kNodeId_(std::move(node_id)), distance_(), network_distance_data_() {}
+    : mutex_("network_statistics"),
+      kNodeId_(std::move(node_id)),
+      distance_(),
+      network_distance_data_(),
+      network_size_estimate_(0) {}
 
 void NetworkStatistics::UpdateLocalAverageDistance(std::vector<NodeId>& unique_nodes) {
   if (unique_nodes.size() < Parameters::group_size)
@@ -49,33 +81,49 @@ void NetworkStatistics::UpdateLocalAverageDistance(std::vector<NodeId>& unique_n
   NodeId furthest_group_node(unique_nodes.at(
       std::min(Parameters::group_size - 1, static_cast<int>(unique_nodes.size()))));
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     distance_ = furthest_group_node ^ kNodeId_;
   }
+  AddDistanceSample(furthest_group_node ^ kNodeId_, true);
 }
 
 void NetworkStatistics::UpdateNetworkAverageDistance(const NodeId& distance) {
-  if (distance == NodeId())
+  AddDistanceSample(distance, false);
+}
+
+void NetworkStatistics::AddDistanceSample(const NodeId& distance, bool local) {
+  uint64_t sample(LeadingBits(distance));
+  if (sample == 0)
     return;
-  crypto::BigInt distance_integer(
-      (distance.ToStringEncoded(NodeId::EncodingType::kHex) + 'h').c_str());
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    network_distance_data_.total_distance += distance_integer;
-    auto average(network_distance_data_.total_distance /
-                 ++network_distance_data_.contributors_count);
-    std::string average_str(NodeId::kSize, '\0');
-    for (auto index(NodeId::kSize - 1); index >= 0; --index)
-      average_str[NodeId::kSize - 1 - index] = average.GetByte(index);
-    network_distance_data_.average_distance = NodeId(average_str);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
+  if (local) {
+    if (!network_distance_data_.local_sample_due)
+      return;
+    network_distance_data_.local_sample_due = false;
+    network_distance_data_.peer_samples_since_local = 0;
+  } else if (++network_distance_data_.peer_samples_since_local >= (1U << kDecayShift)) {
+    network_distance_data_.local_sample_due = true;
   }
+  if (network_distance_data_.sample_count < (1U << kDecayShift))
+    ++network_distance_data_.sample_count;
+  uint64_t& average(network_distance_data_.average_distance);
+  if (sample >= average)
+    average += (sample - average) / network_distance_data_.sample_count;
+  else
+    average -= (average - sample) / network_distance_data_.sample_count;
+  network_size_estimate_.store(NetworkSizeFromAverageDistance(average),
+                               std::memory_order_relaxed);
+}
+
+uint64_t NetworkStatistics::EstimateNetworkSize() const {
+  return network_size_estimate_.load(std::memory_order_relaxed);
 }
 
 // FIXME(Prakash) handle the case of sender_id == info_id
 bool NetworkStatistics::EstimateInGroup(const NodeId& sender_id, const NodeId& info_id) {
   NodeId local_distance;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     local_distance = distance_;
   }
   return crypto::BigInt(
@@ -19,11 +19,13 @@
 #ifndef MAIDSAFE_ROUTING_NETWORK_STATISTICS_H_
 #define MAIDSAFE_ROUTING_NETWORK_STATISTICS_H_
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 
-#include "maidsafe/common/crypto.h"
-
 #include "maidsafe/common/node_id.h"
+#include "maidsafe/routing/instrumented_mutex.h"
 #include "maidsafe/routing/node_info.h"
 
 namespace maidsafe {
@@ -33,31 +35,50 @@ namespace routing {
 namespace test {
 class NetworkStatisticsTest_BEH_AverageDistance_Test;
 class NetworkStatisticsTest_BEH_IsIdInGroupRange_Test;
+class NetworkStatisticsTest_BEH_EstimateNetworkSize_Test;
 }
 
 class NetworkStatistics {
  public:
   explicit NetworkStatistics(NodeId node_id);
   void UpdateLocalAverageDistance(std::vector<NodeId>& unique_nodes);
+  // Adds a group distance reported by a peer to the network average.
   void UpdateNetworkAverageDistance(const NodeId& distance);
   bool EstimateInGroup(const NodeId& sender_id, const NodeId& info_id);
   NodeId GetDistance();
+  // Estimates the number of vaults in the network from the average group distance, assuming ids
+  // are uniformly distributed.  Returns 0 until a group distance has been observed.  The estimate
+  // is updated as each distance is added, so reading it takes no lock.
+  uint64_t EstimateNetworkSize() const;
 
   friend class test::NetworkStatisticsTest_BEH_AverageDistance_Test;
   friend class test::NetworkStatisticsTest_BEH_IsIdInGroupRange_Test;
+  friend class test::NetworkStatisticsTest_BEH_EstimateNetworkSize_Test;
 
  private:
   NetworkStatistics(const NetworkStatistics&);
   NetworkStatistics& operator=(const NetworkStatistics&);
+  void AddDistanceSample(const NodeId& distance, bool local);
+
+  // Average of the most significant 64 bits of recent group distances, both this node's and those
+  // reported by peers.  Each sample is weighted 1 / sample_count until sample_count reaches
+  // 2^kDecayShift, after which older samples decay exponentially.  This node's own distance is
+  // recalculated on every routing table change, so is only added once 2^kDecayShift peer samples
+  // have been added since the last time, to keep it from swamping theirs.
   struct NetworkDistanceData {
-    NetworkDistanceData() : contributors_count(), total_distance(), average_distance() {}
-    crypto::BigInt contributors_count, total_distance;
-    NodeId average_distance;
+    NetworkDistanceData()
+        : sample_count(0), average_distance(0), local_sample_due(true),
+          peer_samples_since_local(0) {}
+    uint32_t sample_count;
+    uint64_t average_distance;
+    bool local_sample_due;
+    uint32_t peer_samples_since_local;
   };
-  std::mutex mutex_;
+  mutable InstrumentedMutex mutex_;
   const NodeId kNodeId_;
   NodeId distance_;
   NetworkDistanceData network_distance_data_;
+  std::atomic<uint64_t> network_size_estimate_;
 };
 
 }  // namespace routing
@@ -18,6 +18,8 @@
 
 #include "maidsafe/routing/network_utils.h"
 
+#include <atomic>
+
 #include "boost/date_time/posix_time/posix_time_config.hpp"
 
 #include "maidsafe/common/log.h"
@@ -27,6 +29,8 @@
 #include "maidsafe/routing/bootstrap_file_operations.h"
 #include "maidsafe/routing/bootstrap_utils.h"
 #include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/message_trace.h"
+#include "maidsafe/routing/metrics.h"
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
@@ -43,13 +47,14 @@ typedef boost::asio::ip::udp::endpoint Endpoint;
 typedef boost::shared_lock<boost::shared_mutex> SharedLock;
 typedef boost::unique_lock<boost::shared_mutex> UniqueLock;
 
+const int kMaxTimedMessageSize(4096);
+
 }  // anonymous namespace
 
 namespace routing {
 
 NetworkUtils::NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table)
-    : running_(true),
-      running_mutex_(),
+    : lifecycle_(),
       bootstrap_attempt_(0),
       bootstrap_contacts_(),
       bootstrap_connection_id_(),
@@ -58,22 +63,25 @@ NetworkUtils::NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& clie
       client_routing_table_(client_routing_table),
       nat_type_(rudp::NatType::kUnknown),
       new_bootstrap_contact_(),
-      rudp_() {}
-
-NetworkUtils::~NetworkUtils() {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  running_ = false;
-}
+      cache_summaries_mutex_("network_utils_cache_summaries"),
+      peer_cache_summaries_(),
+      peer_endpoints_mutex_("network_utils_peer_endpoints"),
+      peer_endpoints_(),
+      pipelined_connections_mutex_("network_utils_pipelined_connections"),
+      pipelined_connections_(),
+      bootstrap_contact_quality_(),
+      bootstrap_probes_(),
+      transport_(MakeTransport()) {}
+
+NetworkUtils::~NetworkUtils() { lifecycle_.Stop(); }
 
 int NetworkUtils::Bootstrap(const BootstrapContacts& bootstrap_contacts,
                             const rudp::MessageReceivedFunctor& message_received_functor,
                             const rudp::ConnectionLostFunctor& connection_lost_functor,
                             Endpoint local_endpoint) {
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return kNetworkShuttingDown;
-  }
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return kNetworkShuttingDown;
 
   assert(connection_lost_functor && "Must provide a valid functor");
   assert(bootstrap_connection_id_.IsZero() && "bootstrap_connection_id_ must be empty");
@@ -103,9 +111,33 @@ int NetworkUtils::Bootstrap(const BootstrapContacts& bootstrap_contacts,
   if (bootstrap_contacts_.empty())
     return kInvalidBootstrapContacts;
 
-  int result(rudp_.Bootstrap(/* sorted_ */ bootstrap_contacts_, message_received_functor,
-                             connection_lost_functor, routing_table_.kConnectionId(), private_key,
-                             public_key, bootstrap_connection_id_, nat_type_, local_endpoint));
+  if (bootstrap_attempt_ == 0 && !Parameters::bootstrap_contact_quality_path.empty())
+    bootstrap_contact_quality_.Load(Parameters::bootstrap_contact_quality_path);
+  bootstrap_contacts_ = bootstrap_contact_quality_.Order(bootstrap_contacts_);
+  int result(kNoOnlineBootstrapContacts);
+  // Zero state nodes bootstrap from a fixed local endpoint to a single known peer, so aren't probed.
+  if (local_endpoint.address().is_unspecified() && bootstrap_contacts_.size() > 1 &&
+      Parameters::bootstrap_probe_count > 1) {
+    if (ProbeBootstrapContacts(message_received_functor, connection_lost_functor, private_key,
+                               public_key)) {
+      result = kSuccess;
+    }
+    if (!Parameters::bootstrap_contact_quality_path.empty())
+      bootstrap_contact_quality_.Save(Parameters::bootstrap_contact_quality_path);
+    if (result != kSuccess &&
+        static_cast<size_t>(Parameters::bootstrap_probe_count) >= bootstrap_contacts_.size()) {
+      ++bootstrap_attempt_;
+      LOG(kError) << "No Online Bootstrap Node found.";
+      return kNoOnlineBootstrapContacts;
+    }
+  }
+
+  if (result != kSuccess) {
+    result = transport_->Bootstrap(/* sorted_ */ bootstrap_contacts_, message_received_functor,
+                                   connection_lost_functor, routing_table_.kConnectionId(),
+                                   private_key, public_key, bootstrap_connection_id_, nat_type_,
+                                   local_endpoint);
+  }
   ++bootstrap_attempt_;
   // RUDP will return a kZeroId for zero state !!
   if (result != kSuccess || bootstrap_connection_id_.IsZero()) {
@@ -119,36 +151,112 @@ int NetworkUtils::Bootstrap(const BootstrapContacts& bootstrap_contacts,
   return kSuccess;
 }
 
+bool NetworkUtils::ProbeBootstrapContacts(
+    const rudp::MessageReceivedFunctor& message_received_functor,
+    const rudp::ConnectionLostFunctor& connection_lost_functor,
+    std::shared_ptr<asymm::PrivateKey> private_key, std::shared_ptr<asymm::PublicKey> public_key) {
+  size_t probe_count(std::min(bootstrap_contacts_.size(),
+                              static_cast<size_t>(Parameters::bootstrap_probe_count)));
+  BootstrapContacts candidates(bootstrap_contacts_.begin(),
+                               bootstrap_contacts_.begin() + probe_count);
+  // Each probe bootstraps a transport of its own.  The first to connect is kept, and its functors
+  // forward to routing once it has replaced transport_; the others are dropped as they finish.
+  struct Connected {
+    Connected()
+        : mutex(), transport(), bootstrap_connection_id(), nat_type(rudp::NatType::kUnknown),
+          forward() {}
+    std::mutex mutex;
+    std::unique_ptr<Transport> transport;
+    NodeId bootstrap_connection_id;
+    rudp::NatType nat_type;
+    std::shared_ptr<std::atomic<bool>> forward;
+  };
+  auto connected(std::make_shared<Connected>());
+  const NodeId kConnectionId(routing_table_.kConnectionId());
+  auto probe([=](const BootstrapContact& contact) {
+    auto forward(std::make_shared<std::atomic<bool>>(false));
+    std::unique_ptr<Transport> probe_transport(MakeTransport());
+    NodeId peer_id;
+    rudp::NatType nat_type(rudp::NatType::kUnknown);
+    int result(probe_transport->Bootstrap(
+        BootstrapContacts(1, contact),
+        [forward, message_received_functor](const std::string& message) {
+          if (*forward)
+            message_received_functor(message);
+        },
+        [forward, connection_lost_functor](const NodeId& lost_peer_id) {
+          if (*forward)
+            connection_lost_functor(lost_peer_id);
+        },
+        kConnectionId, private_key, public_key, peer_id, nat_type, Endpoint()));
+    if (result != kSuccess || peer_id.IsZero())
+      return false;
+    std::lock_guard<std::mutex> lock(connected->mutex);
+    if (!connected->transport) {
+      connected->transport = std::move(probe_transport);
+      connected->bootstrap_connection_id = peer_id;
+      connected->nat_type = nat_type;
+      connected->forward = forward;
+    }
+    return true;
+  });
+  auto start(std::chrono::steady_clock::now());
+  BootstrapContact winner(routing::ProbeBootstrapContacts(
+      candidates, Parameters::bootstrap_probe_count, Parameters::bootstrap_probe_stagger, probe,
+      bootstrap_contact_quality_, bootstrap_probes_));
+  if (winner.address().is_unspecified()) {
+    LOG(kWarning) << "None of the best " << probe_count << " bootstrap contacts answered";
+    // Try the rest before retrying these.
+    std::rotate(bootstrap_contacts_.begin(), bootstrap_contacts_.begin() + probe_count,
+                bootstrap_contacts_.end());
+    return false;
+  }
+  LOG(kVerbose) << "Bootstrapped to " << winner << " after "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start).count() << " ms";
+  auto itr(std::find(bootstrap_contacts_.begin(), bootstrap_contacts_.end(), winner));
+  std::rotate(bootstrap_contacts_.begin(), itr, itr + 1);
+  // A probe has connected by the time any is reported as the winner.
+  std::lock_guard<std::mutex> lock(connected->mutex);
+  transport_ = std::move(connected->transport);
+  bootstrap_connection_id_ = connected->bootstrap_connection_id;
+  nat_type_ = connected->nat_type;
+  *connected->forward = true;
+  return true;
+}
+
 int NetworkUtils::GetAvailableEndpoint(const NodeId& peer_id,
                                        const rudp::EndpointPair& peer_endpoint_pair,
                                        rudp::EndpointPair& this_endpoint_pair,
                                        rudp::NatType& this_nat_type) {
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return kNetworkShuttingDown;
-  }
-  return rudp_.GetAvailableEndpoint(peer_id, peer_endpoint_pair, this_endpoint_pair, this_nat_type);
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return kNetworkShuttingDown;
+  return transport_->GetAvailableEndpoint(peer_id, peer_endpoint_pair, this_endpoint_pair,
+                                         this_nat_type);
 }
 
 int NetworkUtils::Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
                       const std::string& validation_data) {
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return kNetworkShuttingDown;
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return kNetworkShuttingDown;
+  int result(transport_->Add(peer_id, peer_endpoint_pair, validation_data));
+  if (result == kSuccess) {
+    std::lock_guard<InstrumentedMutex> lock(peer_endpoints_mutex_);
+    peer_endpoints_[peer_id] = peer_endpoint_pair.external.address().is_unspecified()
+                                   ? peer_endpoint_pair.local
+                                   : peer_endpoint_pair.external;
   }
-  return rudp_.Add(peer_id, peer_endpoint_pair, validation_data);
+  return result;
 }
 
 int NetworkUtils::MarkConnectionAsValid(const NodeId& peer_id) {
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return kNetworkShuttingDown;
-  }
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return kNetworkShuttingDown;
   Endpoint new_bootstrap_endpoint;
-  int ret_val(rudp_.MarkConnectionAsValid(peer_id, new_bootstrap_endpoint));
+  int ret_val(transport_->MarkConnectionAsValid(peer_id, new_bootstrap_endpoint));
   if ((ret_val == kSuccess) && !new_bootstrap_endpoint.address().is_unspecified()) {
     LOG(kVerbose) << "Found usable endpoint for bootstrapping : " << new_bootstrap_endpoint;
     // TODO(Prakash): Is separate thread needed here ?
@@ -159,22 +267,46 @@ int NetworkUtils::MarkConnectionAsValid(const NodeId& peer_id) {
 }
 
 void NetworkUtils::Remove(const NodeId& peer_id) {
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return;
+    std::lock_guard<InstrumentedMutex> lock(peer_endpoints_mutex_);
+    peer_endpoints_.erase(peer_id);
   }
-  rudp_.Remove(peer_id);
+  TakePipelinedConnectSuccessSent(peer_id);
+  transport_->Remove(peer_id);
+}
+
+void NetworkUtils::MarkPipelinedConnectSuccessSent(const NodeId& peer_connection_id) {
+  std::lock_guard<InstrumentedMutex> lock(pipelined_connections_mutex_);
+  pipelined_connections_.insert(peer_connection_id);
+}
+
+bool NetworkUtils::TakePipelinedConnectSuccessSent(const NodeId& peer_connection_id) {
+  std::lock_guard<InstrumentedMutex> lock(pipelined_connections_mutex_);
+  return pipelined_connections_.erase(peer_connection_id) != 0;
+}
+
+Endpoint NetworkUtils::PeerEndpoint(const NodeId& peer_connection_id) const {
+  std::lock_guard<InstrumentedMutex> lock(peer_endpoints_mutex_);
+  auto itr(peer_endpoints_.find(peer_connection_id));
+  return itr == peer_endpoints_.end() ? Endpoint() : itr->second;
 }
 
 void NetworkUtils::RudpSend(const NodeId& peer_id, const protobuf::Message& message,
                             const rudp::MessageSentFunctor& message_sent_functor) {
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return;
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
+  routing_table_.metrics().MessageSent(message.type());
+  if (message.has_trace()) {
+    protobuf::Message traced_message(message);
+    SetMessageTraceForwarded(traced_message, routing_table_.kNodeId());
+    transport_->Send(peer_id, traced_message.SerializeAsString(), message_sent_functor);
+  } else {
+    transport_->Send(peer_id, message.SerializeAsString(), message_sent_functor);
   }
-  rudp_.Send(peer_id, message.SerializeAsString(), message_sent_functor);
   LOG(kVerbose) << "  [" << DebugId(routing_table_.kNodeId())
                 << "] send : " << MessageTypeString(message) << " to   " << DebugId(peer_id)
                 << "   (id: " << message.id() << ")"
@@ -222,6 +354,7 @@ void NetworkUtils::SendToClosestNode(const protobuf::Message& message) {
     } else if (routing_table_.size() > 0) {  // getting closer nodes from routing table
       RecursiveSendOn(message);
     } else {
+      routing_table_.metrics().Increment(MetricCounter::kSendDrops);
       LOG(kError) << " No endpoint to send to; aborting send.  Attempt to send a type "
                   << MessageTypeString(message) << " message to " << HexSubstr(message.source_id())
                   << " from " << DebugId(routing_table_.kNodeId()) << " id: " << message.id();
@@ -236,6 +369,7 @@ void NetworkUtils::SendToClosestNode(const protobuf::Message& message) {
     SendTo(relay_message, NodeId(relay_message.relay_id()),
            NodeId(relay_message.relay_connection_id()));
   } else {
+    routing_table_.metrics().Increment(MetricCounter::kSendDrops);
     LOG(kError) << "Unable to work out destination; aborting send."
                 << " id: " << message.id() << " message.has_relay_id() ; " << std::boolalpha
                 << message.has_relay_id() << " Isresponse(message) : " << std::boolalpha
@@ -247,8 +381,13 @@ void NetworkUtils::SendToClosestNode(const protobuf::Message& message) {
 void NetworkUtils::SendTo(const protobuf::Message& message, const NodeId& peer_node_id,
                           const NodeId& peer_connection_id) {
   const std::string kThisId(routing_table_.kNodeId().string());
+  const auto kSendTime(TimedSendStart(message));
   rudp::MessageSentFunctor message_sent_functor = [=](int message_sent) {
+    Lifecycle::Operation operation(lifecycle_);
+    if (!operation)
+      return;
     if (rudp::kSuccess == message_sent) {
+      UpdateRoundTripTime(peer_node_id, kSendTime);
       LOG(kVerbose) << "  [" << HexSubstr(kThisId) << "] sent : " << MessageTypeString(message)
                     << " to   " << DebugId(peer_node_id) << "   (id: " << message.id() << ")";
     } else {
@@ -263,27 +402,20 @@ void NetworkUtils::SendTo(const protobuf::Message& message, const NodeId& peer_n
 
 void NetworkUtils::RecursiveSendOn(protobuf::Message message, NodeInfo last_node_attempted,
                                    int attempt_count) {
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return;
-  }
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
   if (attempt_count >= 3) {
     LOG(kWarning) << " Retry attempts failed to send to ["
                   << HexSubstr(last_node_attempted.node_id.string())
                   << "] will drop this node now and try with another node."
                   << " id: " << message.id();
     attempt_count = 0;
-    {
-      std::lock_guard<std::mutex> lock(running_mutex_);
-      if (!running_)
-        return;
-      rudp_.Remove(last_node_attempted.connection_id);
-      LOG(kWarning) << " Routing -> removing connection " << last_node_attempted.node_id.string();
-      // FIXME Should we remove this node or let rudp handle that?
-      routing_table_.DropNode(last_node_attempted.connection_id, false);
-      client_routing_table_.DropConnection(last_node_attempted.connection_id);
-    }
+    transport_->Remove(last_node_attempted.connection_id);
+    LOG(kWarning) << " Routing -> removing connection " << last_node_attempted.node_id.string();
+    // FIXME Should we remove this node or let rudp handle that?
+    routing_table_.DropNode(last_node_attempted.connection_id, false);
+    client_routing_table_.DropConnection(last_node_attempted.connection_id);
   }
 
   if (attempt_count > 0)
@@ -293,39 +425,37 @@ void NetworkUtils::RecursiveSendOn(protobuf::Message message, NodeInfo last_node
   bool ignore_exact_match(!IsDirect(message));
   std::vector<std::string> route_history;
   NodeInfo peer;
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return;
-    if (message.route_history().size() > 1)
-      route_history = std::vector<std::string>(
-          message.route_history().begin(),
-          message.route_history().end() -
-              static_cast<size_t>(!(message.has_visited() && message.visited())));
-    else if ((message.route_history().size() == 1) &&
-             (message.route_history(0) != routing_table_.kNodeId().string()))
-      route_history.push_back(message.route_history(0));
-
-    peer = routing_table_.GetNodeForSendingMessage(NodeId(message.destination_id()), route_history,
-                                                   ignore_exact_match);
-    if (peer.node_id == NodeId() && routing_table_.size() != 0) {
-      peer = routing_table_.GetNodeForSendingMessage(
-          NodeId(message.destination_id()), std::vector<std::string>(), ignore_exact_match);
-    }
-    if (peer.node_id == NodeId()) {
-      LOG(kError) << "This node's routing table is empty now.  Need to re-bootstrap.";
-      return;
-    }
-    AdjustRouteHistory(message);
+  if (message.route_history().size() > 1)
+    route_history = std::vector<std::string>(
+        message.route_history().begin(),
+        message.route_history().end() -
+            static_cast<size_t>(!(message.has_visited() && message.visited())));
+  else if ((message.route_history().size() == 1) &&
+           (message.route_history(0) != routing_table_.kNodeId().string()))
+    route_history.push_back(message.route_history(0));
+
+  peer = routing_table_.GetNodeForSendingMessage(NodeId(message.destination_id()), route_history,
+                                                 ignore_exact_match);
+  if (peer.node_id == NodeId() && routing_table_.size() != 0) {
+    peer = routing_table_.GetNodeForSendingMessage(
+        NodeId(message.destination_id()), std::vector<std::string>(), ignore_exact_match);
   }
+  if (peer.node_id == NodeId()) {
+    routing_table_.metrics().Increment(MetricCounter::kSendDrops);
+    LOG(kError) << "This node's routing table is empty now.  Need to re-bootstrap.";
+    return;
+  }
+  if (attempt_count == 0 && IsRequest(message) && IsCacheableGet(message))
+    peer = CacheAwareNextHop(message, peer, route_history);
+  AdjustRouteHistory(message);
 
+  const auto kSendTime(TimedSendStart(message));
   rudp::MessageSentFunctor message_sent_functor = [=](int message_sent) {
-    {
-      std::lock_guard<std::mutex> lock(running_mutex_);
-      if (!running_)
-        return;
-    }
+    Lifecycle::Operation operation(lifecycle_);
+    if (!operation)
+      return;
     if (rudp::kSuccess == message_sent) {
+      UpdateRoundTripTime(peer.node_id, kSendTime);
       LOG(kVerbose) << "  [" << HexSubstr(kThisId) << "] sent : " << MessageTypeString(message)
                     << " to   " << HexSubstr(peer.node_id.string()) << "   (id: " << message.id()
                     << ")"
@@ -337,6 +467,7 @@ void NetworkUtils::RecursiveSendOn(protobuf::Message message, NodeInfo last_node
                   << HexSubstr(message.destination_id()) << " failed with code " << message_sent
                   << ".  Will retry to Send.  Attempt count = " << attempt_count + 1
                   << " id: " << message.id();
+      routing_table_.metrics().Increment(MetricCounter::kSendRetries);
       RecursiveSendOn(message, peer, attempt_count + 1);
     } else {
       LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
@@ -344,15 +475,11 @@ void NetworkUtils::RecursiveSendOn(protobuf::Message message, NodeInfo last_node
                   << " with destination ID " << HexSubstr(message.destination_id())
                   << " failed with code " << message_sent << "  Will remove node."
                   << " message id: " << message.id();
-      {
-        std::lock_guard<std::mutex> lock(running_mutex_);
-        if (!running_)
-          return;
-        rudp_.Remove(last_node_attempted.connection_id);
-      }
+      transport_->Remove(last_node_attempted.connection_id);
       LOG(kWarning) << " Routing-> removing connection " << DebugId(peer.connection_id);
       routing_table_.DropNode(peer.node_id, false);
       client_routing_table_.DropConnection(peer.connection_id);
+      routing_table_.metrics().Increment(MetricCounter::kSendRetries);
       RecursiveSendOn(message);
     }
   };
@@ -360,6 +487,101 @@ void NetworkUtils::RecursiveSendOn(protobuf::Message message, NodeInfo last_node
   RudpSend(peer.connection_id, message, message_sent_functor);
 }
 
+NodeInfo NetworkUtils::CacheAwareNextHop(const protobuf::Message& message,
+                                         const NodeInfo& closest_peer,
+                                         const std::vector<std::string>& exclude) {
+  if (message.data_size() == 0 || Parameters::cache_aware_routing_candidates == 0)
+    return closest_peer;
+  {
+    std::lock_guard<InstrumentedMutex> lock(cache_summaries_mutex_);
+    if (peer_cache_summaries_.empty())
+      return closest_peer;
+  }
+  const NodeId kDestinationId(message.destination_id());
+  // Only peers which are themselves closer to the destination than this node are considered, so a
+  // false positive costs at most a slightly longer route, never a loop.  The routing table isn't
+  // called into while holding cache_summaries_mutex_.
+  std::vector<NodeId> candidate_ids;
+  for (const auto& candidate_id : routing_table_.GetClosestNodes(
+           kDestinationId, Parameters::cache_aware_routing_candidates)) {
+    if (std::find(exclude.begin(), exclude.end(), candidate_id.string()) == exclude.end() &&
+        NodeId::CloserToTarget(candidate_id, routing_table_.kNodeId(), kDestinationId))
+      candidate_ids.push_back(candidate_id);
+  }
+  NodeId chosen_id;
+  {
+    std::lock_guard<InstrumentedMutex> lock(cache_summaries_mutex_);
+    for (const auto& candidate_id : candidate_ids) {
+      auto summary(peer_cache_summaries_.find(candidate_id));
+      if (summary != peer_cache_summaries_.end() &&
+          summary->second.ProbablyContains(message.data(0))) {
+        chosen_id = candidate_id;
+        break;
+      }
+    }
+  }
+  NodeInfo candidate;
+  if (chosen_id.IsZero() || chosen_id == closest_peer.node_id ||
+      !routing_table_.GetNodeInfo(chosen_id, candidate))
+    return closest_peer;
+  LOG(kVerbose) << "[" << DebugId(routing_table_.kNodeId()) << "] sending cacheable get to "
+                << DebugId(chosen_id) << " which advertises a cached copy, instead of "
+                << DebugId(closest_peer.node_id) << " id: " << message.id();
+  return candidate;
+}
+
+// rudp reports a reliable send as complete once the peer has acknowledged it, so the time taken is
+// close to one round trip for small messages.  Larger ones are not timed, as their transfer time
+// would dominate.
+std::chrono::steady_clock::time_point NetworkUtils::TimedSendStart(
+    const protobuf::Message& message) const {
+  return message.ByteSize() <= kMaxTimedMessageSize ? std::chrono::steady_clock::now()
+                                                    : std::chrono::steady_clock::time_point();
+}
+
+void NetworkUtils::UpdateRoundTripTime(const NodeId& peer_node_id,
+                                       std::chrono::steady_clock::time_point send_time) {
+  if (send_time == std::chrono::steady_clock::time_point())
+    return;
+  const auto kRoundTripTime(std::chrono::steady_clock::now() - send_time);
+  routing_table_.metrics().RecordLatency(MetricHistogram::kSendLatency, kRoundTripTime);
+  routing_table_.UpdateRoundTripTime(
+      peer_node_id, std::chrono::duration_cast<std::chrono::microseconds>(kRoundTripTime));
+}
+
+void NetworkUtils::UpdatePeerCacheSummary(const NodeId& peer_id,
+                                          const std::string& serialised_summary) {
+  if (!routing_table_.Contains(peer_id))
+    return;
+  try {
+    BloomFilter summary(serialised_summary);
+    // Once there are more summaries than peers, some are of departed peers.  The routing table
+    // isn't called into while holding cache_summaries_mutex_.
+    const size_t kPeerCount(routing_table_.size());
+    std::vector<NodeId> summarised_peers;
+    {
+      std::lock_guard<InstrumentedMutex> lock(cache_summaries_mutex_);
+      if (peer_cache_summaries_.size() > kPeerCount) {
+        for (const auto& peer_cache_summary : peer_cache_summaries_)
+          summarised_peers.push_back(peer_cache_summary.first);
+      }
+    }
+    std::vector<NodeId> departed_peers;
+    for (const auto& summarised_peer : summarised_peers) {
+      if (!routing_table_.Contains(summarised_peer))
+        departed_peers.push_back(summarised_peer);
+    }
+    std::lock_guard<InstrumentedMutex> lock(cache_summaries_mutex_);
+    for (const auto& departed_peer : departed_peers)
+      peer_cache_summaries_.erase(departed_peer);
+    peer_cache_summaries_.erase(peer_id);
+    peer_cache_summaries_.insert(std::make_pair(peer_id, summary));
+  }
+  catch (const std::exception& e) {
+    LOG(kWarning) << "Invalid cache summary from " << DebugId(peer_id) << " : " << e.what();
+  }
+}
+
 void NetworkUtils::AdjustRouteHistory(protobuf::Message& message) {
   if (Parameters::hops_to_live == message.hops_to_live() &&
       NodeId(message.source_id()) == routing_table_.kNodeId())
@@ -392,7 +614,7 @@ void NetworkUtils::clear_bootstrap_connection_info() {
 }
 
 maidsafe::NodeId NetworkUtils::bootstrap_connection_id() const {
-  if (running_)
+  if (lifecycle_.running())
     return bootstrap_connection_id_;
   return NodeId();
 }
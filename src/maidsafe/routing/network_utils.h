@@ -19,7 +19,12 @@
 #ifndef MAIDSAFE_ROUTING_NETWORK_UTILS_H_
 #define MAIDSAFE_ROUTING_NETWORK_UTILS_H_
 
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -29,8 +34,13 @@
 #include "maidsafe/rudp/managed_connections.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/bloom_filter.h"
+#include "maidsafe/routing/bootstrap_contact_quality.h"
+#include "maidsafe/routing/instrumented_mutex.h"
+#include "maidsafe/routing/lifecycle.h"
 #include "maidsafe/routing/node_info.h"
 #include "maidsafe/routing/timer.h"
+#include "maidsafe/routing/transport.h"
 
 namespace maidsafe {
 
@@ -44,6 +54,7 @@ class ClientRoutingTable;
 class RoutingTable;
 
 namespace test {
+class CacheRoutingSimulation;
 class GenericNode;
 class MockNetworkUtils;
 }
@@ -76,12 +87,22 @@ class NetworkUtils {
   // response message
   virtual void SendToClosestNode(const protobuf::Message& message);
   void AddToBootstrapFile(const boost::asio::ip::udp::endpoint& endpoint);
+  // Returns the endpoint a peer was connected on, or an unspecified endpoint if it isn't known.
+  boost::asio::ip::udp::endpoint PeerEndpoint(const NodeId& peer_connection_id) const;
+  // Records the cache summary advertised by a peer in the routing table.  Summaries of peers which
+  // have since left the routing table are discarded once there are more summaries than peers.
+  void UpdatePeerCacheSummary(const NodeId& peer_id, const std::string& serialised_summary);
+  // Records that this node sent a pipelined ConnectSuccess on a connection.  The second returns
+  // whether it did, and forgets it.
+  void MarkPipelinedConnectSuccessSent(const NodeId& peer_connection_id);
+  bool TakePipelinedConnectSuccessSent(const NodeId& peer_connection_id);
   void clear_bootstrap_connection_info();
   void set_new_bootstrap_contact_functor(NewBootstrapContactFunctor new_bootstrap_contact);
   NodeId bootstrap_connection_id() const;
   NodeId this_node_relay_connection_id() const;
   rudp::NatType nat_type() const;
 
+  friend class test::CacheRoutingSimulation;
   friend class test::GenericNode;
   friend class test::MockNetworkUtils;
 
@@ -97,9 +118,21 @@ class NetworkUtils {
   void RecursiveSendOn(protobuf::Message message, NodeInfo last_node_attempted = NodeInfo(),
                        int attempt_count = 0);
   void AdjustRouteHistory(protobuf::Message& message);
-
-  bool running_;
-  std::mutex running_mutex_;
+  NodeInfo CacheAwareNextHop(const protobuf::Message& message, const NodeInfo& closest_peer,
+                             const std::vector<std::string>& exclude);
+  // Returns the time a send of message starts, or a default time_point if it isn't to be timed.
+  std::chrono::steady_clock::time_point TimedSendStart(const protobuf::Message& message) const;
+  void UpdateRoundTripTime(const NodeId& peer_node_id,
+                           std::chrono::steady_clock::time_point send_time);
+  // Bootstraps to the best-ranked bootstrap contacts concurrently, keeping the transport of the
+  // first to connect.  Returns false if none connected, having moved them to the back of
+  // bootstrap_contacts_.
+  bool ProbeBootstrapContacts(const rudp::MessageReceivedFunctor& message_received_functor,
+                              const rudp::ConnectionLostFunctor& connection_lost_functor,
+                              std::shared_ptr<asymm::PrivateKey> private_key,
+                              std::shared_ptr<asymm::PublicKey> public_key);
+
+  Lifecycle lifecycle_;
   uint16_t bootstrap_attempt_;
   BootstrapContacts bootstrap_contacts_;
   NodeId bootstrap_connection_id_;
@@ -108,7 +141,17 @@ class NetworkUtils {
   ClientRoutingTable& client_routing_table_;
   rudp::NatType nat_type_;
   NewBootstrapContactFunctor new_bootstrap_contact_;
-  rudp::ManagedConnections rudp_;
+  InstrumentedMutex cache_summaries_mutex_;
+  std::map<NodeId, BloomFilter> peer_cache_summaries_;
+  mutable InstrumentedMutex peer_endpoints_mutex_;
+  std::map<NodeId, boost::asio::ip::udp::endpoint> peer_endpoints_;
+  InstrumentedMutex pipelined_connections_mutex_;
+  std::set<NodeId> pipelined_connections_;
+  // Probes which were still running when bootstrapping completed; these are joined on destruction,
+  // before bootstrap_contact_quality_ which they update.
+  BootstrapContactQuality bootstrap_contact_quality_;
+  std::vector<std::future<void>> bootstrap_probes_;
+  std::unique_ptr<Transport> transport_;
 };
 
 }  // namespace routing
@@ -0,0 +1,174 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/network_viewer_publisher.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/tools/network_viewer.h"
+
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+struct SharedPublisher {
+  SharedPublisher() : mutex(), publisher() {}
+  std::mutex mutex;
+  std::weak_ptr<NetworkViewerPublisher> publisher;
+};
+
+// Never destroyed, as nodes with static storage duration may be destroyed after it would have been.
+SharedPublisher& Shared() {
+  static SharedPublisher* shared(new SharedPublisher);
+  return *shared;
+}
+
+}  // unnamed namespace
+
+std::shared_ptr<NetworkViewerPublisher> NetworkViewerPublisher::Get() {
+  SharedPublisher& shared(Shared());
+  std::lock_guard<std::mutex> lock(shared.mutex);
+  std::shared_ptr<NetworkViewerPublisher> publisher(shared.publisher.lock());
+  if (!publisher) {
+    try {
+      publisher = std::make_shared<NetworkViewerPublisher>(
+          network_viewer::kMessageQueueName, Parameters::network_viewer_update_interval);
+    }
+    catch (const std::exception&) {
+      return nullptr;
+    }
+    shared.publisher = publisher;
+  }
+  return publisher;
+}
+
+NetworkViewerPublisher::NetworkViewerPublisher(const std::string& queue_name,
+                                               std::chrono::steady_clock::duration update_interval)
+    : kUpdateInterval_(update_interval),
+      message_queue_(boost::interprocess::open_only, queue_name.c_str()),
+      mutex_(),
+      cond_var_(),
+      stopping_(false),
+      pending_(),
+      sent_(),
+      publish_thread_() {
+  if (static_cast<uint16_t>(message_queue_.get_max_msg_size()) <
+      (Parameters::closest_nodes_size + 1) * Parameters::closest_nodes_size * 2 * NodeId::kSize) {
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+  publish_thread_ = std::thread([this] { PublishLoop(); });
+}
+
+NetworkViewerPublisher::~NetworkViewerPublisher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cond_var_.notify_all();
+  publish_thread_.join();
+}
+
+void NetworkViewerPublisher::Publish(const NodeId& node_id, std::vector<NodeId> matrix,
+                                     std::vector<NodeId> close) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Matrix& pending(pending_[node_id]);
+    pending.matrix = std::move(matrix);
+    pending.close = std::move(close);
+  }
+  cond_var_.notify_one();
+}
+
+void NetworkViewerPublisher::Remove(const NodeId& node_id) {
+  Publish(node_id, std::vector<NodeId>(), std::vector<NodeId>());
+}
+
+void NetworkViewerPublisher::PublishLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    if (pending_.empty()) {
+      cond_var_.wait(lock);
+      continue;
+    }
+    SendPending(lock);
+    cond_var_.wait_for(lock, kUpdateInterval_, [this] { return stopping_; });
+  }
+  SendPending(lock);
+}
+
+void NetworkViewerPublisher::SendPending(std::unique_lock<std::mutex>& lock) {
+  std::map<NodeId, Matrix> pending, unsent;
+  pending.swap(pending_);
+  lock.unlock();
+  for (auto& node : pending) {
+    const NodeId& node_id(node.first);
+    std::vector<NodeId>& close(node.second.close);
+    network_viewer::MatrixRecord matrix_record(node_id);
+    for (const auto& matrix_element : node.second.matrix)
+      matrix_record.AddElement(matrix_element, network_viewer::ChildType::kMatrix);
+
+    std::sort(std::begin(close), std::end(close), [&](const NodeId & lhs, const NodeId & rhs) {
+      return NodeId::CloserToTarget(lhs, rhs, node_id);
+    });
+
+    const size_t kGroupSize(std::min(static_cast<size_t>(Parameters::group_size), close.size()));
+    for (size_t index(0); index < close.size(); ++index) {
+      matrix_record.AddElement(close[index], index < kGroupSize
+                                                 ? network_viewer::ChildType::kGroup
+                                                 : network_viewer::ChildType::kClosest);
+    }
+
+    std::string serialised_matrix(matrix_record.Serialise());
+    auto sent(sent_.find(node_id));
+    if (sent != sent_.end() && sent->second == serialised_matrix)
+      continue;
+    if (!message_queue_.try_send(serialised_matrix.c_str(), serialised_matrix.size(), 0)) {
+      unsent.insert(std::move(node));
+      continue;
+    }
+
+    std::string printout("\tMatrix sent by: " + DebugId(node_id) + "\n");
+    for (const auto& matrix_element : node.second.matrix)
+      printout += "\t\t" + DebugId(matrix_element) + " - kMatrix\n";
+    for (size_t index(0); index < close.size(); ++index) {
+      printout += "\t\t" + DebugId(close[index]) +
+                  (index < kGroupSize ? " - kGroup\n" : " - kClosest\n");
+    }
+    LOG(kInfo) << printout << '\n';
+    if (node.second.matrix.empty() && close.empty())
+      sent_.erase(node_id);
+    else
+      sent_[node_id] = std::move(serialised_matrix);
+  }
+  lock.lock();
+  // Anything published while sending supersedes what couldn't be sent.
+  for (auto& node : unsent)
+    pending_.insert(std::move(node));
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
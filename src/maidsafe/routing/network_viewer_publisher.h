@@ -0,0 +1,87 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_NETWORK_VIEWER_PUBLISHER_H_
+#define MAIDSAFE_ROUTING_NETWORK_VIEWER_PUBLISHER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/interprocess/ipc/message_queue.hpp"
+
+#include "maidsafe/common/node_id.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Sends nodes' group matrices to the network viewer's message queue from a background thread, so
+// that a change of matrix never waits on the interprocess queue.  Only the latest matrix of each
+// node is kept until it is sent, sends are at least update_interval apart, and a matrix is only
+// sent if it differs from the one last sent for that node.  A matrix which doesn't fit in the
+// queue is retried on the next send unless superseded.
+class NetworkViewerPublisher {
+ public:
+  // Returns the publisher shared by all nodes in the process, or nullptr if the network viewer
+  // isn't running.  The publisher stops once the last node holding it is destroyed.
+  static std::shared_ptr<NetworkViewerPublisher> Get();
+
+  // Opens the existing message queue queue_name.  Throws if it can't be opened, or if its messages
+  // are too small to hold a full matrix.
+  NetworkViewerPublisher(const std::string& queue_name,
+                         std::chrono::steady_clock::duration update_interval);
+  // Sends any pending matrices before returning.
+  ~NetworkViewerPublisher();
+  // Replaces any unsent matrix of node_id.  'close' holds node_id's connected close peers.
+  void Publish(const NodeId& node_id, std::vector<NodeId> matrix, std::vector<NodeId> close);
+  // Publishes an empty matrix, which removes node_id from the viewer.
+  void Remove(const NodeId& node_id);
+
+ private:
+  struct Matrix {
+    Matrix() : matrix(), close() {}
+    std::vector<NodeId> matrix, close;
+  };
+
+  NetworkViewerPublisher(const NetworkViewerPublisher&);
+  NetworkViewerPublisher& operator=(const NetworkViewerPublisher&);
+  void PublishLoop();
+  void SendPending(std::unique_lock<std::mutex>& lock);
+
+  const std::chrono::steady_clock::duration kUpdateInterval_;
+  boost::interprocess::message_queue message_queue_;
+  std::mutex mutex_;
+  std::condition_variable cond_var_;
+  bool stopping_;
+  std::map<NodeId, Matrix> pending_;
+  std::map<NodeId, std::string> sent_;  // only accessed by publish_thread_
+  std::thread publish_thread_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_NETWORK_VIEWER_PUBLISHER_H_
@@ -33,7 +33,8 @@ NodeInfo::NodeInfo()
       rank(),
       bucket(kInvalidBucket),
       nat_type(rudp::NatType::kUnknown),
-      dimension_list() {}
+      dimension_list(),
+      round_trip_time(0) {}
 
 NodeInfo::NodeInfo(const NodeInfo& other)
     : node_id(other.node_id),
@@ -42,7 +43,8 @@ NodeInfo::NodeInfo(const NodeInfo& other)
       rank(other.rank),
       bucket(other.bucket),
       nat_type(other.nat_type),
-      dimension_list(other.dimension_list) {}
+      dimension_list(other.dimension_list),
+      round_trip_time(other.round_trip_time) {}
 
 NodeInfo::NodeInfo(NodeInfo&& other)
     : node_id(std::move(other.node_id)),
@@ -51,7 +53,8 @@ NodeInfo::NodeInfo(NodeInfo&& other)
       rank(std::move(other.rank)),
       bucket(std::move(other.bucket)),
       nat_type(std::move(other.nat_type)),
-      dimension_list(std::move(other.dimension_list)) {}
+      dimension_list(std::move(other.dimension_list)),
+      round_trip_time(std::move(other.round_trip_time)) {}
 
 NodeInfo& NodeInfo::operator=(NodeInfo other) {
   swap(*this, other);
@@ -59,7 +62,11 @@ NodeInfo& NodeInfo::operator=(NodeInfo other) {
 }
 
 NodeInfo::NodeInfo(const serialised_type& serialised_message)
-    : connection_id(), public_key(), bucket(kInvalidBucket), nat_type(rudp::NatType::kUnknown) {
+    : connection_id(),
+      public_key(),
+      bucket(kInvalidBucket),
+      nat_type(rudp::NatType::kUnknown),
+      round_trip_time(0) {
   protobuf::NodeInfo proto_node_info;
   if (!proto_node_info.ParseFromString(serialised_message->string()))
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
@@ -99,6 +106,7 @@ void swap(NodeInfo& lhs, NodeInfo& rhs) MAIDSAFE_NOEXCEPT {
   swap(lhs.bucket, rhs.bucket);
   swap(lhs.nat_type, rhs.nat_type);
   swap(lhs.dimension_list, rhs.dimension_list);
+  swap(lhs.round_trip_time, rhs.round_trip_time);
 }
 
 }  // namespace routing
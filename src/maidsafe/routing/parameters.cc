@@ -37,13 +37,30 @@ uint16_t Parameters::routing_table_size_threshold(max_routing_table_size / 4);
 uint16_t Parameters::max_routing_table_size_for_client(8);
 uint16_t Parameters::max_client_routing_table_size(max_routing_table_size);
 uint16_t Parameters::bucket_target_size(1);
+bool Parameters::adaptive_routing_table_size(false);
+uint16_t Parameters::min_adaptive_routing_table_size(32);
+uint16_t Parameters::max_adaptive_routing_table_size(128);
+uint16_t Parameters::target_routing_hops(4);
+bool Parameters::proximity_routing(false);
+std::chrono::seconds Parameters::round_trip_time_ping_interval(30);
 std::chrono::steady_clock::duration Parameters::default_response_timeout(std::chrono::seconds(10));
 std::chrono::seconds Parameters::find_node_interval(10);
 std::chrono::seconds Parameters::recovery_time_lag(5);
 std::chrono::seconds Parameters::re_bootstrap_time_lag(10);
 std::chrono::seconds Parameters::find_close_node_interval(3);
+std::chrono::steady_clock::duration Parameters::zero_state_join_timeout(std::chrono::seconds(5));
+boost::filesystem::path Parameters::bootstrap_contact_quality_path;
+uint16_t Parameters::bootstrap_probe_count(0);
+std::chrono::steady_clock::duration Parameters::bootstrap_probe_stagger(
+    std::chrono::milliseconds(250));
+bool Parameters::pipelined_connect_handshake(false);
 uint16_t Parameters::find_node_repeats_per_num_requested(3);
+uint16_t Parameters::public_key_cache_size(256);
+std::chrono::system_clock::duration Parameters::public_key_cache_ttl(std::chrono::hours(1));
+boost::filesystem::path Parameters::public_key_cache_path;
 uint16_t Parameters::maximum_find_close_node_failures(10);
+uint16_t Parameters::node_lookup_alpha(3);
+std::chrono::steady_clock::duration Parameters::node_lookup_timeout(std::chrono::seconds(2));
 uint16_t Parameters::max_route_history(3);
 uint16_t Parameters::hops_to_live(50);
 uint16_t Parameters::accepted_distance_tolerance(1);
@@ -67,6 +84,20 @@ bool Parameters::append_maidsafe_local_endpoints(false);
 bool Parameters::append_local_live_port_endpoint(false);
 // TODO(Prakash): BEFORE_RELEASE enable caching after persona tests are passing
 bool Parameters::caching(true);
+bool Parameters::routing_layer_cache(false);
+uint32_t Parameters::max_cache_size_bytes(64 * 1024 * 1024);
+bool Parameters::cache_admission_filter(true);
+std::chrono::seconds Parameters::cache_summary_interval(30);
+uint16_t Parameters::cache_aware_routing_candidates(0);
+boost::filesystem::path Parameters::disk_cache_path;
+uint64_t Parameters::max_disk_cache_size(1024 * 1024 * 1024);
+boost::filesystem::path Parameters::routing_table_snapshot_path;
+std::chrono::seconds Parameters::routing_table_snapshot_interval(60);
+boost::filesystem::path Parameters::metrics_export_path;
+std::chrono::seconds Parameters::metrics_export_interval(15);
+double Parameters::message_trace_sample_rate(0.0);
+boost::filesystem::path Parameters::message_trace_path;
+std::chrono::milliseconds Parameters::network_viewer_update_interval(500);
 }  // namespace routing
 
 }  // namespace maidsafe
@@ -0,0 +1,141 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/public_key_cache.h"
+
+#include <string>
+
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+PublicKeyCache::PublicKeyCache(size_t max_size, std::chrono::system_clock::duration time_to_live)
+    : mutex_(), kMaxSize_(max_size), kTimeToLive_(time_to_live), lru_(), entries_() {}
+
+void PublicKeyCache::Add(const NodeId& node_id, const InternedPublicKey& public_key,
+                         TimePoint now) {
+  if (kMaxSize_ == 0 || !asymm::ValidateKey(public_key))
+    return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  Insert(node_id, public_key, now + kTimeToLive_);
+}
+
+bool PublicKeyCache::Get(const NodeId& node_id, InternedPublicKey& public_key, TimePoint now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(entries_.find(node_id));
+  if (itr == entries_.end())
+    return false;
+  if (itr->second.expiry <= now) {
+    lru_.erase(itr->second.lru_itr);
+    entries_.erase(itr);
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, itr->second.lru_itr);
+  public_key = itr->second.public_key;
+  return true;
+}
+
+void PublicKeyCache::Remove(const NodeId& node_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(entries_.find(node_id));
+  if (itr == entries_.end())
+    return;
+  lru_.erase(itr->second.lru_itr);
+  entries_.erase(itr);
+}
+
+size_t PublicKeyCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void PublicKeyCache::Load(const boost::filesystem::path& file_path, TimePoint now) {
+  protobuf::PublicKeyCache proto_cache;
+  try {
+    if (!proto_cache.ParseFromString(ReadFile(file_path).string())) {
+      LOG(kWarning) << "Failed to parse public key cache file " << file_path;
+      return;
+    }
+  }
+  catch (const std::exception& e) {
+    LOG(kVerbose) << "No public key cache file at " << file_path << ": " << e.what();
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Entries are saved most recently used first, so insert in reverse to restore that order.
+  for (int i(proto_cache.entries_size() - 1); i >= 0; --i) {
+    const auto& proto_entry(proto_cache.entries(i));
+    TimePoint expiry(std::chrono::seconds(proto_entry.expiry()));
+    if (expiry <= now || kMaxSize_ == 0)
+      continue;
+    try {
+      asymm::PublicKey public_key(asymm::DecodeKey(
+          asymm::EncodedPublicKey(NonEmptyString(proto_entry.public_key()))));
+      Insert(NodeId(proto_entry.node_id()), public_key, expiry);
+    }
+    catch (const std::exception& e) {
+      LOG(kWarning) << "Ignoring invalid public key cache entry: " << e.what();
+    }
+  }
+}
+
+void PublicKeyCache::Save(const boost::filesystem::path& file_path) const {
+  protobuf::PublicKeyCache proto_cache;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& node_id : lru_) {
+      const Entry& entry(entries_.at(node_id));
+      auto proto_entry(proto_cache.add_entries());
+      proto_entry->set_node_id(node_id.string());
+      proto_entry->set_public_key(asymm::EncodeKey(entry.public_key)->string());
+      proto_entry->set_expiry(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::seconds>(entry.expiry.time_since_epoch())
+              .count()));
+    }
+  }
+  if (!WriteFile(file_path, proto_cache.SerializeAsString()))
+    LOG(kWarning) << "Failed to write public key cache file " << file_path;
+}
+
+void PublicKeyCache::Insert(const NodeId& node_id, const InternedPublicKey& public_key,
+                            TimePoint expiry) {
+  auto itr(entries_.find(node_id));
+  if (itr != entries_.end()) {
+    lru_.splice(lru_.begin(), lru_, itr->second.lru_itr);
+  } else {
+    if (entries_.size() >= kMaxSize_) {
+      entries_.erase(lru_.back());
+      lru_.pop_back();
+    }
+    lru_.push_front(node_id);
+    itr = entries_.insert(std::make_pair(node_id, Entry())).first;
+    itr->second.lru_itr = lru_.begin();
+  }
+  itr->second.public_key = public_key;
+  itr->second.expiry = expiry;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,83 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_PUBLIC_KEY_CACHE_H_
+#define MAIDSAFE_ROUTING_PUBLIC_KEY_CACHE_H_
+
+#include <chrono>
+#include <list>
+#include <map>
+#include <mutex>
+
+#include "boost/filesystem/path.hpp"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+
+#include "maidsafe/routing/interned_public_key.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Public keys of peers which have already been validated through the upper layer's
+// RequestPublicKeyFunctor, so that a peer reconnecting shortly after dropping can be validated
+// locally.  Each key expires time_to_live after it was added, and once max_size keys are held the
+// least recently used is evicted.
+class PublicKeyCache {
+ public:
+  typedef std::chrono::system_clock::time_point TimePoint;
+
+  PublicKeyCache(size_t max_size, std::chrono::system_clock::duration time_to_live);
+  void Add(const NodeId& node_id, const InternedPublicKey& public_key,
+           TimePoint now = std::chrono::system_clock::now());
+  // Returns false if no unexpired key is held for node_id.  A hit copies the handle, not the key.
+  bool Get(const NodeId& node_id, InternedPublicKey& public_key,
+           TimePoint now = std::chrono::system_clock::now());
+  void Remove(const NodeId& node_id);
+  size_t size() const;
+  // Neither throws; a missing or corrupt file leaves the cache unchanged.
+  void Load(const boost::filesystem::path& file_path,
+            TimePoint now = std::chrono::system_clock::now());
+  void Save(const boost::filesystem::path& file_path) const;
+
+ private:
+  struct Entry {
+    Entry() : public_key(), expiry(), lru_itr() {}
+    InternedPublicKey public_key;
+    TimePoint expiry;
+    std::list<NodeId>::iterator lru_itr;
+  };
+
+  PublicKeyCache(const PublicKeyCache&);
+  PublicKeyCache& operator=(const PublicKeyCache&);
+  void Insert(const NodeId& node_id, const InternedPublicKey& public_key, TimePoint expiry);
+
+  mutable std::mutex mutex_;
+  const size_t kMaxSize_;
+  const std::chrono::system_clock::duration kTimeToLive_;
+  std::list<NodeId> lru_;  // most recently used first
+  std::map<NodeId, Entry> entries_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_PUBLIC_KEY_CACHE_H_
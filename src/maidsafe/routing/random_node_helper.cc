@@ -25,7 +25,7 @@ namespace maidsafe {
 namespace routing {
 
 NodeId RandomNodeHelper::Get() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   assert(node_ids_.size() <= kMaxSize_);
   if (node_ids_.empty())
     return NodeId();
@@ -34,7 +34,7 @@ NodeId RandomNodeHelper::Get() const {
 
 void RandomNodeHelper::Add(const NodeId& node_id) {
   assert(!node_id.IsZero());
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   if (std::find(node_ids_.begin(), node_ids_.end(), node_id) != node_ids_.end())
     return;
 
@@ -45,7 +45,7 @@ void RandomNodeHelper::Add(const NodeId& node_id) {
 
 void RandomNodeHelper::Remove(const NodeId& node_id) {
   assert(!node_id.IsZero());
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   auto itr(std::find(node_ids_.begin(), node_ids_.end(), node_id));
   if (itr != node_ids_.end())
     node_ids_.erase(itr);
@@ -24,13 +24,15 @@
 
 #include "maidsafe/common/node_id.h"
 
+#include "maidsafe/routing/instrumented_mutex.h"
+
 namespace maidsafe {
 
 namespace routing {
 
 class RandomNodeHelper {
  public:
-  RandomNodeHelper() : node_ids_(), mutex_(), kMaxSize_(100) {}
+  RandomNodeHelper() : node_ids_(), mutex_("random_node_helper"), kMaxSize_(100) {}
   NodeId Get() const;
   void Add(const NodeId& node_id);
   void Remove(const NodeId& node_id);
@@ -41,7 +43,7 @@ class RandomNodeHelper {
   RandomNodeHelper& operator=(const RandomNodeHelper&);
 
   std::vector<NodeId> node_ids_;
-  mutable std::mutex mutex_;
+  mutable InstrumentedMutex mutex_;
   const size_t kMaxSize_;
 };
 
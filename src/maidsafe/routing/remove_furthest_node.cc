@@ -118,6 +118,9 @@ void RemoveFurthestNode::RemoveResponse(protobuf::Message& message) {
 }
 
 void RemoveFurthestNode::RemoveNodeRequest() {
+  // The table's target may have grown with the network size estimate since this was triggered.
+  if (routing_table_.size() <= routing_table_.target().greedy_size)
+    return;
   NodeInfo furthest_node(routing_table_.GetRemovableNode(std::vector<std::string>()));
   if (furthest_node.node_id == NodeInfo().node_id)
     return;
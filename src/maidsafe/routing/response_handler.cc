@@ -18,6 +18,8 @@
 
 #include "maidsafe/routing/response_handler.h"
 
+#include <chrono>
+#include <map>
 #include <memory>
 #include <vector>
 #include <string>
@@ -56,19 +58,33 @@ typedef boost::asio::ip::udp::endpoint Endpoint;
 ResponseHandler::ResponseHandler(RoutingTable& routing_table,
                                  ClientRoutingTable& client_routing_table, NetworkUtils& network,
                                  GroupChangeHandler& group_change_handler)
-    : mutex_(), routing_table_(routing_table), client_routing_table_(client_routing_table),
-      network_(network), group_change_handler_(group_change_handler), request_public_key_functor_(),
-      unvalidated_matrix_updates_() {}
+    : mutex_("response_handler"), routing_table_(routing_table),
+      client_routing_table_(client_routing_table), network_(network),
+      group_change_handler_(group_change_handler), request_public_key_functor_(),
+      unvalidated_matrix_updates_(), early_connect_attempts_(),
+      public_key_cache_(Parameters::public_key_cache_size, Parameters::public_key_cache_ttl) {}
 
 ResponseHandler::~ResponseHandler() {}
 
 void ResponseHandler::Ping(protobuf::Message& message) {
   // Always direct, never pass on
 
-  // TODO(dirvine): do we need this and where and how can I update the response
   protobuf::PingResponse ping_response;
-  if (ping_response.ParseFromString(message.data(0))) {
-    // do stuff here
+  if (!ping_response.ParseFromString(message.data(0)))
+    return;
+  if (ping_response.has_cache_summary())
+    network_.UpdatePeerCacheSummary(NodeId(message.source_id()), ping_response.cache_summary());
+  protobuf::PingRequest ping_request;
+  if (ping_request.ParseFromString(ping_response.original_request()) &&
+      ping_request.has_timestamp()) {
+    const uint64_t kNow(GetTimeStamp());
+    if (ping_request.timestamp() <= kNow &&
+        std::chrono::milliseconds(kNow - ping_request.timestamp()) <
+            Parameters::default_response_timeout) {
+      routing_table_.UpdateRoundTripTime(
+          NodeId(message.source_id()),
+          std::chrono::milliseconds(kNow - ping_request.timestamp()));
+    }
   }
 }
 
@@ -86,9 +102,15 @@ void ResponseHandler::Connect(protobuf::Message& message) {
     return;
   }
 
+  EarlyConnectAttempt early_attempt;
+  bool early_connect_attempt(TakeEarlyConnectAttempt(
+      ConnectRequestId(message.id(), NodeId(connect_request.peer_id())), early_attempt));
+
   if (connect_response.answer() == protobuf::ConnectResponseType::kRejected) {
     LOG(kInfo) << "Peer rejected this node's connection request."
                << " id: " << message.id();
+    if (early_connect_attempt && !early_attempt.established)
+      network_.Remove(early_attempt.peer_connection_id);
     return;
   }
 
@@ -125,6 +147,20 @@ void ResponseHandler::Connect(protobuf::Message& message) {
     LOG(kVerbose) << "This node [" << DebugId(routing_table_.kNodeId())
                   << "] received connect response from " << DebugId(peer_node_id)
                   << " id: " << message.id();
+    if (early_connect_attempt) {
+      if (early_attempt.established ||
+          (early_attempt.peer_connection_id == peer_connection_id &&
+           early_attempt.peer_endpoint_pair.external == peer_endpoint_pair.external &&
+           early_attempt.peer_endpoint_pair.local == peer_endpoint_pair.local)) {
+        LOG(kVerbose) << "Already connecting to " << DebugId(peer_node_id)
+                      << " using its contact from FindNodes response.";
+        return;
+      }
+      // The endpoints the peer allocated for this node differ from those in its contact.
+      LOG(kVerbose) << "Restarting connection to " << DebugId(peer_node_id)
+                    << " with the endpoints from its connect response.";
+      network_.Remove(early_attempt.peer_connection_id);
+    }
 
     int result = AddToRudp(network_, routing_table_.kNodeId(), routing_table_.kConnectionId(),
                            peer_node_id, peer_connection_id, peer_endpoint_pair, true,  // requestor
@@ -183,13 +219,29 @@ void ResponseHandler::FindNodes(const protobuf::Message& message) {
 
   LOG(kVerbose) << find_node_result;
 
+  std::map<std::string, protobuf::Contact> contacts;
+  for (const auto& contact : find_nodes_response.contacts())
+    contacts[contact.node_id()] = contact;
+
   for (int i = 0; i < find_nodes_response.nodes_size(); ++i) {
-    if (!find_nodes_response.nodes(i).empty())
+    if (find_nodes_response.nodes(i).empty())
+      continue;
+    auto contact_itr(contacts.find(find_nodes_response.nodes(i)));
+    if (contact_itr == contacts.end() || contact_itr->second.connection_id().empty()) {
       CheckAndSendConnectRequest(NodeId(find_nodes_response.nodes(i)));
+      continue;
+    }
+    rudp::EndpointPair peer_endpoint_pair;
+    peer_endpoint_pair.external = GetEndpointFromProtobuf(contact_itr->second.public_endpoint());
+    peer_endpoint_pair.local = GetEndpointFromProtobuf(contact_itr->second.private_endpoint());
+    CheckAndSendConnectRequest(NodeId(find_nodes_response.nodes(i)), peer_endpoint_pair,
+                               NodeId(contact_itr->second.connection_id()));
   }
 }
 
-void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
+void ResponseHandler::SendConnectRequest(const NodeId peer_node_id,
+                                         const rudp::EndpointPair& peer_endpoint_pair,
+                                         const NodeId& peer_connection_id) {
   if (network_.bootstrap_connection_id().IsZero() && (routing_table_.size() == 0)) {
     LOG(kWarning) << "Need to re bootstrap !";
     return;
@@ -206,7 +258,7 @@ void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
 
   if (routing_table_.CheckNode(peer)) {
     LOG(kVerbose) << "CheckNode succeeded for node " << DebugId(peer.node_id);
-    rudp::EndpointPair this_endpoint_pair, peer_endpoint_pair;
+    rudp::EndpointPair this_endpoint_pair;
     rudp::NatType this_nat_type(rudp::NatType::kUnknown);
     int ret_val = network_.GetAvailableEndpoint(peer.node_id, peer_endpoint_pair,
                                                 this_endpoint_pair, this_nat_type);
@@ -237,6 +289,25 @@ void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
     protobuf::Message connect_rpc(rpcs::Connect(
         peer.node_id, this_endpoint_pair, routing_table_.kNodeId(), routing_table_.kConnectionId(),
         routing_table_.client_mode(), this_nat_type, relay_message, relay_connection_id));
+    // The bootstrap peer is excluded as it completes the existing bootstrap connection on receipt
+    // of the ConnectResponse.
+    if (!peer_connection_id.IsZero() && peer.node_id != network_.bootstrap_connection_id() &&
+        (!peer_endpoint_pair.external.address().is_unspecified() ||
+         !peer_endpoint_pair.local.address().is_unspecified())) {
+      if (AddToRudp(network_, routing_table_.kNodeId(), routing_table_.kConnectionId(),
+                    peer.node_id, peer_connection_id, peer_endpoint_pair, true,  // requestor
+                    routing_table_.client_mode()) == kSuccess) {
+        EarlyConnectAttempt attempt;
+        attempt.peer_connection_id = peer_connection_id;
+        attempt.peer_endpoint_pair = peer_endpoint_pair;
+        attempt.expiry = std::chrono::steady_clock::now() +
+                         std::chrono::milliseconds(
+                             Parameters::connect_rpc_prune_timeout.total_milliseconds());
+        std::lock_guard<InstrumentedMutex> lock(mutex_);
+        PruneEarlyConnectAttempts();
+        early_connect_attempts_[ConnectRequestId(connect_rpc.id(), peer.node_id)] = attempt;
+      }
+    }
     LOG(kVerbose) << "Sending Connect RPC to " << DebugId(peer.node_id)
                   << " message id : " << connect_rpc.id();
     if (send_to_bootstrap_connection)
@@ -287,13 +358,91 @@ void ResponseHandler::ConnectSuccessAcknowledgement(protobuf::Message& message)
   }
 }
 
+bool ResponseHandler::PipelinedConnectSuccess(protobuf::Message& message) {
+  protobuf::ConnectSuccess connect_success;
+  if (!connect_success.ParseFromString(message.data(0)))
+    return false;
+
+  NodeInfo peer;
+  peer.node_id = NodeId(connect_success.node_id());
+  peer.connection_id = NodeId(connect_success.connection_id());
+  if (!peer.connection_id.IsZero()) {
+    // A ConnectSuccess only arrives once the connection is up.
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    for (auto& attempt : early_connect_attempts_) {
+      if (attempt.second.peer_connection_id == peer.connection_id)
+        attempt.second.established = true;
+    }
+  }
+  // Both sides must have pipelined their ConnectSuccess; this node never does so on the bootstrap
+  // connection.  Taken whatever the peer sent, as only one ConnectSuccess arrives per connection.
+  bool sent_pipelined(!peer.connection_id.IsZero() &&
+                      network_.TakePipelinedConnectSuccessSent(peer.connection_id));
+  if (!Parameters::pipelined_connect_handshake || !connect_success.pipelined() || !sent_pipelined)
+    return false;
+  bool client_node(message.client_node());
+  message.Clear();  // message is sent directly to the peer
+  if (peer.node_id.IsZero() || peer.connection_id.IsZero()) {
+    LOG(kWarning) << "Invalid node_id / connection_id provided";
+    return true;
+  }
+
+  std::vector<NodeId> close_ids;
+  for (const auto& close_id : connect_success.close_ids()) {
+    if (!close_id.empty())
+      close_ids.push_back(NodeId(close_id));
+  }
+  LOG(kVerbose) << "Pipelined ConnectSuccess from " << DebugId(peer.node_id);
+  bool from_requestor(connect_success.requestor());
+  if (!client_node)
+    ValidateAndCompleteConnectionToNonClient(peer, from_requestor, close_ids, true);
+  else
+    ValidateAndCompleteConnectionToClient(peer, from_requestor, close_ids, true);
+  return true;
+}
+
+void ResponseHandler::ConnectionLost(const NodeId& connection_id) {
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
+  for (auto itr(early_connect_attempts_.begin()); itr != early_connect_attempts_.end();) {
+    if (itr->second.peer_connection_id == connection_id)
+      itr = early_connect_attempts_.erase(itr);
+    else
+      ++itr;
+  }
+}
+
+bool ResponseHandler::TakeEarlyConnectAttempt(const ConnectRequestId& request_id,
+                                              EarlyConnectAttempt& attempt) {
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
+  PruneEarlyConnectAttempts();
+  auto itr(early_connect_attempts_.find(request_id));
+  if (itr == early_connect_attempts_.end())
+    return false;
+  attempt = itr->second;
+  early_connect_attempts_.erase(itr);
+  return true;
+}
+
+void ResponseHandler::PruneEarlyConnectAttempts() {
+  // Attempts whose requests were lost or never answered have failed by now in rudp.
+  auto now(std::chrono::steady_clock::now());
+  for (auto itr(early_connect_attempts_.begin()); itr != early_connect_attempts_.end();) {
+    if (itr->second.expiry <= now)
+      itr = early_connect_attempts_.erase(itr);
+    else
+      ++itr;
+  }
+}
+
 void ResponseHandler::ValidateAndCompleteConnectionToClient(const NodeInfo& peer,
                                                             bool from_requestor,
-                                                            const std::vector<NodeId>& close_ids) {
+                                                            const std::vector<NodeId>& close_ids,
+                                                            bool pipelined) {
   if (ValidateAndAddToRoutingTable(network_, routing_table_, client_routing_table_, peer.node_id,
                                    peer.connection_id, asymm::PublicKey(), true)) {
     if (from_requestor) {
-      HandleSuccessAcknowledgementAsReponder(peer, true);
+      if (!pipelined)  // the requestor has had this node's close ids with its ConnectSuccess
+        HandleSuccessAcknowledgementAsReponder(peer, true);
     } else {
       HandleSuccessAcknowledgementAsRequestor(close_ids);
     }
@@ -301,44 +450,60 @@ void ResponseHandler::ValidateAndCompleteConnectionToClient(const NodeInfo& peer
 }
 
 void ResponseHandler::ValidateAndCompleteConnectionToNonClient(
-    const NodeInfo& peer, bool from_requestor, const std::vector<NodeId>& close_ids) {
+    const NodeInfo& peer, bool from_requestor, const std::vector<NodeId>& close_ids,
+    bool pipelined) {
   std::weak_ptr<ResponseHandler> response_handler_weak_ptr = shared_from_this();
-  if (request_public_key_functor_) {
-    auto validate_node([=](const asymm::PublicKey& key) {
-      LOG(kInfo) << "Validation callback called with public key for " << DebugId(peer.node_id);
-      if (std::shared_ptr<ResponseHandler> response_handler = response_handler_weak_ptr.lock()) {
-        std::vector<NodeInfo> matrix_update;
-        {
-          std::lock_guard<std::mutex> lock(mutex_);
-          auto matrix_update_itr(std::find_if(
-              std::begin(unvalidated_matrix_updates_), std::end(unvalidated_matrix_updates_),
-              [&](const std::pair<NodeId, std::vector<NodeInfo>>& pair) {
-                return pair.first == peer.node_id;
-              }));
-          if (matrix_update_itr != std::end(unvalidated_matrix_updates_)) {
-            matrix_update = matrix_update_itr->second;
-            unvalidated_matrix_updates_.erase(matrix_update_itr);
-          }
+  auto validate_node([=](const InternedPublicKey& key) {
+    LOG(kInfo) << "Validation callback called with public key for " << DebugId(peer.node_id);
+    if (std::shared_ptr<ResponseHandler> response_handler = response_handler_weak_ptr.lock()) {
+      std::vector<NodeInfo> matrix_update;
+      {
+        std::lock_guard<InstrumentedMutex> lock(mutex_);
+        auto matrix_update_itr(std::find_if(
+            std::begin(unvalidated_matrix_updates_), std::end(unvalidated_matrix_updates_),
+            [&](const std::pair<NodeId, std::vector<NodeInfo>>& pair) {
+              return pair.first == peer.node_id;
+            }));
+        if (matrix_update_itr != std::end(unvalidated_matrix_updates_)) {
+          matrix_update = matrix_update_itr->second;
+          unvalidated_matrix_updates_.erase(matrix_update_itr);
         }
-        if (ValidateAndAddToRoutingTable(response_handler->network_,
-                                         response_handler->routing_table_,
-                                         response_handler->client_routing_table_, peer.node_id,
-                                         peer.connection_id, key, false, matrix_update)) {
-          if (from_requestor) {
+      }
+      if (ValidateAndAddToRoutingTable(response_handler->network_,
+                                       response_handler->routing_table_,
+                                       response_handler->client_routing_table_, peer.node_id,
+                                       peer.connection_id, key, false, matrix_update)) {
+        if (from_requestor) {
+          if (!pipelined)
             response_handler->HandleSuccessAcknowledgementAsReponder(peer, false);
-          } else {
-            response_handler->HandleSuccessAcknowledgementAsRequestor(close_ids);
-          }
+        } else {
+          response_handler->HandleSuccessAcknowledgementAsRequestor(close_ids);
         }
       }
+    }
+  });
+
+  // Peers restored from a routing table snapshot, or reconnecting shortly after being validated,
+  // needn't be validated by the upper layer again.
+  InternedPublicKey cached_key;
+  if (public_key_cache_.Get(peer.node_id, cached_key)) {
+    LOG(kVerbose) << "Validating " << DebugId(peer.node_id) << " with cached public key.";
+    return validate_node(cached_key);
+  }
+  if (request_public_key_functor_) {
+    request_public_key_functor_(peer.node_id, [=](const asymm::PublicKey& public_key) {
+      InternedPublicKey key(public_key);
+      if (std::shared_ptr<ResponseHandler> response_handler = response_handler_weak_ptr.lock())
+        response_handler->public_key_cache_.Add(peer.node_id, key);
+      validate_node(key);
     });
-    request_public_key_functor_(peer.node_id, validate_node);
   }
 }
 
 void ResponseHandler::HandleSuccessAcknowledgementAsReponder(NodeInfo peer, bool client) {
   auto count =
-      (client ? Parameters::max_routing_table_size_for_client : Parameters::max_routing_table_size);
+      (client ? Parameters::max_routing_table_size_for_client
+              : routing_table_.vault_target().max_size);
   std::vector<NodeId> close_ids_for_peer(routing_table_.GetClosestNodes(peer.node_id, count));
   auto itr(std::find_if(close_ids_for_peer.begin(), close_ids_for_peer.end(),
                         [=](const NodeId & node_id)->bool {
@@ -363,14 +528,33 @@ void ResponseHandler::HandleSuccessAcknowledgementAsRequestor(
   }
 }
 
-void ResponseHandler::CheckAndSendConnectRequest(const NodeId& node_id) {
+void ResponseHandler::CheckAndSendConnectRequest(const NodeId& node_id,
+                                                 const rudp::EndpointPair& peer_endpoint_pair,
+                                                 const NodeId& peer_connection_id) {
   uint16_t limit(routing_table_.client_mode() ? Parameters::max_routing_table_size_for_client
-                                              : Parameters::greedy_fraction);
+                                              : routing_table_.target().greedy_size);
   if ((routing_table_.size() < limit) ||
       NodeId::CloserToTarget(
           node_id, routing_table_.GetNthClosestNode(routing_table_.kNodeId(), limit).node_id,
           routing_table_.kNodeId()))
-    SendConnectRequest(node_id);
+    SendConnectRequest(node_id, peer_endpoint_pair, peer_connection_id);
+}
+
+void ResponseHandler::ReconnectToPeers(const std::vector<RoutingTableSnapshot::Peer>& peers) {
+  for (const auto& peer : peers)
+    public_key_cache_.Add(peer.node_info.node_id, peer.node_info.public_key);
+  for (const auto& peer : peers) {
+    if (!peer.matrix_row.empty())
+      AddMatrixUpdateFromUnvalidatedPeer(peer.node_info.node_id, peer.matrix_row);
+  }
+  LOG(kInfo) << "[" << DebugId(routing_table_.kNodeId()) << "] reconnecting to " << peers.size()
+             << " peers from routing table snapshot.";
+  for (const auto& peer : peers) {
+    rudp::EndpointPair peer_endpoint_pair;
+    peer_endpoint_pair.external = peer.endpoint;
+    CheckAndSendConnectRequest(peer.node_info.node_id, peer_endpoint_pair,
+                               peer.node_info.connection_id);
+  }
 }
 
 void ResponseHandler::CloseNodeUpdateForClient(protobuf::Message& message) {
@@ -405,7 +589,7 @@ void ResponseHandler::CloseNodeUpdateForClient(protobuf::Message& message) {
 
 void ResponseHandler::AddMatrixUpdateFromUnvalidatedPeer(
     const NodeId& node_id, const std::vector<NodeInfo>& matrix_update) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   auto matrix_update_itr(std::find_if(
       std::begin(unvalidated_matrix_updates_), std::end(unvalidated_matrix_updates_),
       [&](const std::pair<NodeId, std::vector<NodeInfo>>& pair) {
@@ -433,6 +617,24 @@ void ResponseHandler::GetGroup(Timer<std::string>& timer, protobuf::Message& mes
   }
 }
 
+void ResponseHandler::FindNodesLookup(Timer<std::string>& timer,
+                                      const protobuf::Message& message) {
+  protobuf::FindNodesResponse find_nodes_response;
+  protobuf::FindNodesRequest find_nodes_request;
+  if (!message.has_id() || message.data_size() != 1 ||
+      !find_nodes_response.ParseFromString(message.data(0)) ||
+      !find_nodes_request.ParseFromString(find_nodes_response.original_request()) ||
+      !find_nodes_request.lookup())
+    return;
+  try {
+    timer.AddResponse(message.id(), message.data(0));
+  }
+  catch (const maidsafe_error& e) {
+    LOG(kError) << e.what();
+    return;
+  }
+}
+
 void ResponseHandler::set_request_public_key_functor(RequestPublicKeyFunctor request_public_key) {
   request_public_key_functor_ = request_public_key;
 }
@@ -441,6 +643,8 @@ RequestPublicKeyFunctor ResponseHandler::request_public_key_functor() const {
   return request_public_key_functor_;
 }
 
+PublicKeyCache& ResponseHandler::public_key_cache() { return public_key_cache_; }
+
 }  // namespace routing
 
 }  // namespace maidsafe
@@ -19,6 +19,9 @@
 #ifndef MAIDSAFE_ROUTING_RESPONSE_HANDLER_H_
 #define MAIDSAFE_ROUTING_RESPONSE_HANDLER_H_
 
+#include <chrono>
+#include <cstdint>
+#include <map>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -32,6 +35,9 @@
 #include "maidsafe/rudp/managed_connections.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/instrumented_mutex.h"
+#include "maidsafe/routing/public_key_cache.h"
+#include "maidsafe/routing/routing_table_snapshot.h"
 #include "maidsafe/routing/timer.h"
 
 namespace maidsafe {
@@ -60,32 +66,68 @@ class ResponseHandler : public std::enable_shared_from_this<ResponseHandler> {
   virtual void Connect(protobuf::Message& message);
   virtual void FindNodes(const protobuf::Message& message);
   virtual void ConnectSuccessAcknowledgement(protobuf::Message& message);
+  // Completes the connection if message is a ConnectSuccess from a pipelined handshake, in which
+  // case no acknowledgements are exchanged.  Returns false if the full handshake is being used.
+  bool PipelinedConnectSuccess(protobuf::Message& message);
+  // Forgets any connection started early to the peer with connection id 'connection_id'.
+  void ConnectionLost(const NodeId& connection_id);
   void set_request_public_key_functor(RequestPublicKeyFunctor request_public_key);
   RequestPublicKeyFunctor request_public_key_functor() const;
+  PublicKeyCache& public_key_cache();
   void GetGroup(Timer<std::string>& timer, protobuf::Message& message);
+  // Passes a FindNodes response which is part of an iterative lookup to the waiting task.
+  void FindNodesLookup(Timer<std::string>& timer, const protobuf::Message& message);
   void CloseNodeUpdateForClient(protobuf::Message& message);
   void AddMatrixUpdateFromUnvalidatedPeer(const NodeId& node_id,
                                           const std::vector<NodeInfo>& matrix_update);
+  // Sends Connect requests to all of the given peers at once.  Their public keys and group matrix
+  // rows are held until the connections complete, so no further lookups are needed to add them.
+  void ReconnectToPeers(const std::vector<RoutingTableSnapshot::Peer>& peers);
 
   friend class test::ResponseHandlerTest_BEH_ConnectAttempts_Test;
 
  private:
-  void SendConnectRequest(const NodeId peer_node_id);
-  void CheckAndSendConnectRequest(const NodeId& node_id);
+  // A connection started to a peer from its FindNodes contact, before the ConnectResponse to the
+  // Connect request sent with it arrives.
+  struct EarlyConnectAttempt {
+    EarlyConnectAttempt()
+        : peer_connection_id(), peer_endpoint_pair(), expiry(), established(false) {}
+    NodeId peer_connection_id;
+    rudp::EndpointPair peer_endpoint_pair;
+    std::chrono::steady_clock::time_point expiry;
+    bool established;  // the peer's ConnectSuccess has arrived on it
+  };
+  typedef std::pair<int32_t, NodeId> ConnectRequestId;  // the request's message id and peer id
+
+  // If the peer's endpoints and connection id are known, this node starts connecting to it as soon
+  // as the Connect request is sent rather than when the ConnectResponse arrives.
+  void SendConnectRequest(const NodeId peer_node_id,
+                          const rudp::EndpointPair& peer_endpoint_pair = rudp::EndpointPair(),
+                          const NodeId& peer_connection_id = NodeId());
+  void CheckAndSendConnectRequest(
+      const NodeId& node_id, const rudp::EndpointPair& peer_endpoint_pair = rudp::EndpointPair(),
+      const NodeId& peer_connection_id = NodeId());
+  // Removes and returns the unexpired early attempt for the Connect request, if there is one.
+  bool TakeEarlyConnectAttempt(const ConnectRequestId& request_id, EarlyConnectAttempt& attempt);
+  void PruneEarlyConnectAttempts();  // requires mutex_ to be held
   void HandleSuccessAcknowledgementAsRequestor(const std::vector<NodeId>& close_ids);
   void HandleSuccessAcknowledgementAsReponder(NodeInfo peer, bool client);
   void ValidateAndCompleteConnectionToClient(const NodeInfo& peer, bool from_requestor,
-                                             const std::vector<NodeId>& close_ids);
+                                             const std::vector<NodeId>& close_ids,
+                                             bool pipelined = false);
   void ValidateAndCompleteConnectionToNonClient(const NodeInfo& peer, bool from_requestor,
-                                                const std::vector<NodeId>& close_ids);
+                                                const std::vector<NodeId>& close_ids,
+                                                bool pipelined = false);
 
-  mutable std::mutex mutex_;
+  mutable InstrumentedMutex mutex_;
   RoutingTable& routing_table_;
   ClientRoutingTable& client_routing_table_;
   NetworkUtils& network_;
   GroupChangeHandler& group_change_handler_;
   RequestPublicKeyFunctor request_public_key_functor_;
   std::deque<std::pair<NodeId, std::vector<NodeInfo>>> unvalidated_matrix_updates_;
+  std::map<ConnectRequestId, EarlyConnectAttempt> early_connect_attempts_;
+  PublicKeyCache public_key_cache_;
 };
 
 }  // namespace routing
@@ -99,6 +99,8 @@ bool Routing::EstimateInGroup(const NodeId& sender_id, const NodeId& info_id) co
   return pimpl_->EstimateInGroup(sender_id, info_id);
 }
 
+uint64_t Routing::EstimateNetworkSize() const { return pimpl_->EstimateNetworkSize(); }
+
 std::future<std::vector<NodeId>> Routing::GetGroup(const NodeId& group_id) {
   return pimpl_->GetGroup(group_id);
 }
@@ -115,6 +117,10 @@ bool Routing::IsConnectedClient(const NodeId& node_id) {
   return pimpl_->IsConnectedClient(node_id);
 }
 
+CacheStatistics Routing::cache_statistics() { return pimpl_->cache_statistics(); }
+
+RoutingMetrics Routing::GetMetrics() { return pimpl_->GetMetrics(); }
+
 void UpdateNetworkHealth(int updated_health, int& current_health, std::mutex& mutex,
                          std::condition_variable& cond_var, const NodeId& this_node_id) {
   {
@@ -21,6 +21,8 @@
 #include <cstdint>
 #include <type_traits>
 
+#include "boost/filesystem/operations.hpp"
+
 #include "maidsafe/common/log.h"
 
 #include "maidsafe/rudp/managed_connections.h"
@@ -31,6 +33,8 @@
 #include "maidsafe/routing/bootstrap_file_operations.h"
 #include "maidsafe/routing/message.h"
 #include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/message_trace.h"
+#include "maidsafe/routing/metrics.h"
 #include "maidsafe/routing/node_info.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
@@ -90,13 +94,14 @@ protobuf::Message Routing::Impl::CreateNodeLevelMessage(const GroupToSingleRelay
 }
 
 Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys)
-    : network_status_mutex_(),
+    : network_status_mutex_("routing_network_status"),
+      network_status_condition_(),
       network_status_(kNotJoined),
       network_statistics_(node_id),
       routing_table_(client_mode, node_id, keys, network_statistics_),
       kNodeId_(node_id),
-      running_(true),
-      running_mutex_(),
+      lifecycle_(),
+      timers_mutex_("routing_timers"),
       functors_(),
       random_node_helper_(),
       // TODO(Prakash) : don't create client_routing_table for client nodes (wrap both)
@@ -109,7 +114,11 @@ Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys&
       timer_(asio_service_),
       re_bootstrap_timer_(asio_service_.service()),
       recovery_timer_(asio_service_.service()),
-      setup_timer_(asio_service_.service()) {
+      setup_timer_(asio_service_.service()),
+      cache_summary_timer_(asio_service_.service()),
+      snapshot_timer_(asio_service_.service()),
+      ping_timer_(asio_service_.service()),
+      metrics_timer_(asio_service_.service()) {
   message_handler_.reset(new MessageHandler(routing_table_, client_routing_table_, network_, timer_,
                                             remove_furthest_node_, group_change_handler_,
                                             network_statistics_));
@@ -120,13 +129,30 @@ Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys&
 Routing::Impl::~Impl() {
   LOG(kVerbose) << "~Impl " << DebugId(kNodeId_) << ", connection id "
                 << DebugId(routing_table_.kConnectionId());
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  running_ = false;
+  if (!routing_table_.client_mode() && !Parameters::routing_table_snapshot_path.empty())
+    DoSaveRoutingTableSnapshot();
+  if (!routing_table_.client_mode() && !Parameters::public_key_cache_path.empty())
+    message_handler_->public_key_cache().Save(PublicKeyCachePath());
+  lifecycle_.Stop();
 }
 
 void Routing::Impl::Join(const Functors& functors, const BootstrapContacts& bootstrap_contacts) {
   ConnectFunctors(functors);
-  if (!bootstrap_contacts.empty()) {
+  if (!routing_table_.client_mode() && !Parameters::public_key_cache_path.empty())
+    message_handler_->public_key_cache().Load(PublicKeyCachePath());
+  RoutingTableSnapshot snapshot(LoadRoutingTableSnapshot());
+  if (!snapshot.peers.empty()) {
+    // Try this node's previous peers first, as they are likely to still be online.
+    BootstrapContacts contacts;
+    for (const auto& peer : snapshot.peers) {
+      if (!peer.endpoint.address().is_unspecified())
+        contacts.push_back(peer.endpoint);
+    }
+    contacts.insert(contacts.end(), bootstrap_contacts.begin(), bootstrap_contacts.end());
+    LOG(kInfo) << "Doing a warm restart join with " << snapshot.peers.size()
+               << " peers from routing table snapshot";
+    DoJoin(contacts, snapshot.peers);
+  } else if (!bootstrap_contacts.empty()) {
     BootstrapFromTheseEndpoints(bootstrap_contacts);
   } else {
     LOG(kInfo) << "Doing a default join";
@@ -138,9 +164,11 @@ void Routing::Impl::ConnectFunctors(const Functors& functors) {
   functors_ = functors;
   routing_table_.InitialiseFunctors([this](int network_status_in) {
                                       {
-                                        std::lock_guard<std::mutex> lock(network_status_mutex_);
+                                        std::lock_guard<InstrumentedMutex> lock(
+                                            network_status_mutex_);
                                         network_status_ = network_status_in;
                                       }
+                                      network_status_condition_.notify_all();
                                       NotifyNetworkStatus(network_status_in);
                                     },
                                     [this](const NodeInfo & node, bool internal_rudp_only) {
@@ -149,8 +177,8 @@ void Routing::Impl::ConnectFunctors(const Functors& functors) {
                                     [this]() { remove_furthest_node_.RemoveNodeRequest(); },
                                     [this](const std::vector<NodeInfo> new_nodes,
                                            const std::vector<NodeInfo> old_nodes) {
-                                      std::lock_guard<std::mutex> lock(running_mutex_);
-                                      if (running_)
+                                      Lifecycle::Operation operation(lifecycle_);
+                                      if (operation)
                                         group_change_handler_.SendClosestNodesUpdateRpcs(new_nodes,
                                                                                          old_nodes);
                                     }, functors.matrix_changed);
@@ -174,6 +202,51 @@ void Routing::Impl::ConnectFunctors(const Functors& functors) {
 
   message_handler_->set_request_public_key_functor(functors.request_public_key);
   network_.set_new_bootstrap_contact_functor(functors.new_bootstrap_contact);
+
+  if (Parameters::routing_layer_cache && Parameters::cache_aware_routing_candidates != 0 &&
+      !routing_table_.client_mode()) {
+    Lifecycle::Operation operation(lifecycle_);
+    if (!operation)
+      return;
+    std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
+    cache_summary_timer_.expires_from_now(Parameters::cache_summary_interval);
+    cache_summary_timer_.async_wait([=](const boost::system::error_code& error_code) {
+      PublishCacheSummary(error_code);
+    });
+  }
+
+  if (!routing_table_.client_mode() && !Parameters::routing_table_snapshot_path.empty()) {
+    Lifecycle::Operation operation(lifecycle_);
+    if (!operation)
+      return;
+    std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
+    snapshot_timer_.expires_from_now(Parameters::routing_table_snapshot_interval);
+    snapshot_timer_.async_wait([=](const boost::system::error_code& error_code) {
+      SaveRoutingTableSnapshot(error_code);
+    });
+  }
+
+  if (Parameters::proximity_routing) {
+    Lifecycle::Operation operation(lifecycle_);
+    if (!operation)
+      return;
+    std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
+    ping_timer_.expires_from_now(Parameters::round_trip_time_ping_interval);
+    ping_timer_.async_wait([=](const boost::system::error_code& error_code) {
+      PingPeers(error_code);
+    });
+  }
+
+  if (!Parameters::metrics_export_path.empty()) {
+    Lifecycle::Operation operation(lifecycle_);
+    if (!operation)
+      return;
+    std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
+    metrics_timer_.expires_from_now(Parameters::metrics_export_interval);
+    metrics_timer_.async_wait([=](const boost::system::error_code& error_code) {
+      ExportMetrics(error_code);
+    });
+  }
 }
 
 void Routing::Impl::BootstrapFromTheseEndpoints(const BootstrapContacts& bootstrap_contacts) {
@@ -191,13 +264,17 @@ void Routing::Impl::BootstrapFromTheseEndpoints(const BootstrapContacts& bootstr
   DoJoin(bootstrap_contacts);
 }
 
-void Routing::Impl::DoJoin(const BootstrapContacts& bootstrap_contacts) {
+void Routing::Impl::DoJoin(const BootstrapContacts& bootstrap_contacts,
+                           const std::vector<RoutingTableSnapshot::Peer>& snapshot_peers) {
   int return_value(DoBootstrap(bootstrap_contacts));
   if (kSuccess != return_value)
     return NotifyNetworkStatus(return_value);
 
   assert(!network_.bootstrap_connection_id().IsZero() &&
          "Bootstrap connection id must be populated by now.");
+  // Connect to all the previous peers at once rather than waiting for FindNodes responses.
+  if (!snapshot_peers.empty())
+    message_handler_->ReconnectToPeers(snapshot_peers);
   FindClosestNode(boost::system::error_code(), 0);
   NotifyNetworkStatus(return_value);
 }
@@ -205,10 +282,13 @@ void Routing::Impl::DoJoin(const BootstrapContacts& bootstrap_contacts) {
 int Routing::Impl::DoBootstrap(const BootstrapContacts& bootstrap_contacts) {
   // FIXME race condition if a new connection appears at rudp -- rudp should handle this
   assert(routing_table_.size() == 0);
-  recovery_timer_.cancel();
-  setup_timer_.cancel();
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  if (!running_)
+  {
+    std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
+    recovery_timer_.cancel();
+    setup_timer_.cancel();
+  }
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
     return kNetworkShuttingDown;
   if (!network_.bootstrap_connection_id().IsZero()) {
     LOG(kInfo) << "Removing bootstrap connection to rebootstrap. Connection id : "
@@ -223,13 +303,11 @@ int Routing::Impl::DoBootstrap(const BootstrapContacts& bootstrap_contacts) {
 }
 
 void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code, int attempts) {
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return;
-  }
   if (error_code == boost::asio::error::operation_aborted)
     return;
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
 
   if (attempts == 0) {
     assert(!network_.bootstrap_connection_id().IsZero() && "Only after bootstrapping succeeds");
@@ -237,9 +315,7 @@ void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code,
            "Relay connection id should be set after bootstrapping succeeds");
   } else {
     if (routing_table_.size() > 0) {
-      std::lock_guard<std::mutex> lock(running_mutex_);
-      if (!running_)
-        return;
+      std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
       // Exit the loop & start recovery loop
       LOG(kVerbose) << "[" << DebugId(kNodeId_) << "] Added a node in routing table."
                     << " Terminating setup loop & Scheduling recovery loop.";
@@ -258,30 +334,15 @@ void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code,
     }
   }
 
-  int num_nodes_requested(1 + attempts / Parameters::find_node_repeats_per_num_requested);
-  protobuf::Message find_node_rpc(rpcs::FindNodes(kNodeId_, kNodeId_, num_nodes_requested, true,
-                                                  network_.this_node_relay_connection_id()));
   LOG(kVerbose) << "   [" << DebugId(kNodeId_) << "] (attempt " << attempts << ")"
-                << " requesting " << num_nodes_requested << " nodes"
-                << "   (id: " << find_node_rpc.id() << ")";
-
-  rudp::MessageSentFunctor message_sent_functor([=](int message_sent) {
-    if (message_sent == kSuccess)
-      LOG(kVerbose) << "   [" << DebugId(kNodeId_)
-                    << "] sent : " << MessageTypeString(find_node_rpc) << " to   "
-                    << DebugId(network_.bootstrap_connection_id())
-                    << "   (id: " << find_node_rpc.id() << ")";
-    else
-      LOG(kError) << "Failed to send FindNodes RPC to bootstrap connection id : "
-                  << DebugId(network_.bootstrap_connection_id());
-  });
-
+                << " starting lookup for closest nodes";
   ++attempts;
-  network_.SendToDirect(find_node_rpc, network_.bootstrap_connection_id(), message_sent_functor);
+  // Connect requests are sent to the nodes found as each FindNodes response arrives, so the
+  // routing table starts filling well before the lookup completes.  The setup timer only retries
+  // if this attempt fails to add any node.
+  LookupCloseNodes(std::vector<NodeId>(), Parameters::closest_nodes_size);
 
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  if (!running_)
-    return;
+  std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
   setup_timer_.expires_from_now(Parameters::find_close_node_interval);
   setup_timer_.async_wait([=](boost::system::error_code error_code_local) {
     if (error_code_local != boost::asio::error::operation_aborted)
@@ -317,7 +378,6 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
   rudp::EndpointPair this_endpoint_pair;
   peer_endpoint_pair.external = peer_endpoint_pair.local = peer_endpoint;
   this_endpoint_pair.external = this_endpoint_pair.local = local_endpoint;
-  Sleep(std::chrono::milliseconds(100));  // FIXME avoiding assert in rudp
   result = network_.GetAvailableEndpoint(peer_info.node_id, peer_endpoint_pair, this_endpoint_pair,
                                          nat_type);
   if (result != rudp::kBootstrapConnectionAlreadyExists) {
@@ -333,19 +393,22 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
 
   ValidateAndAddToRoutingTable(network_, routing_table_, client_routing_table_, peer_info.node_id,
                                peer_info.node_id, peer_info.public_key, false);
-  // Now poll for routing table size to have other zero state peer.
-  uint8_t poll_count(0);
-  do {
-    Sleep(std::chrono::milliseconds(100));
-  } while ((routing_table_.size() == 0) && (++poll_count < 50));
-  if (routing_table_.size() != 0) {
+  // Now wait for the other zero state peer to be added, which updates the network status.
+  bool joined(false);
+  {
+    InstrumentedUniqueLock lock(network_status_mutex_);
+    joined = network_status_condition_.wait_for(lock, Parameters::zero_state_join_timeout,
+                                                [this] { return routing_table_.size() != 0; });
+  }
+  if (joined) {
     LOG(kInfo) << "Node Successfully joined zero state network, with "
                << DebugId(network_.bootstrap_connection_id()) << ", Routing table size - "
                << routing_table_.size() << ", Node id : " << DebugId(kNodeId_);
 
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
+    Lifecycle::Operation operation(lifecycle_);
+    if (!operation)
       return kNetworkShuttingDown;
+    std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
     recovery_timer_.expires_from_now(Parameters::find_node_interval);
     recovery_timer_.async_wait([=](const boost::system::error_code & error_code) {
       if (error_code != boost::asio::error::operation_aborted)
@@ -394,6 +457,7 @@ void Routing::Impl::Send(const NodeId& destination_id, const std::string& data,
 }
 
 void Routing::Impl::SendMessage(const NodeId& destination_id, protobuf::Message& proto_message) {
+  StartMessageTrace(proto_message, kNodeId_);
   if (routing_table_.size() == 0) {  // Partial join state
     PartiallyJoinedSend(proto_message);
   } else {  // Normal node
@@ -417,10 +481,13 @@ void Routing::Impl::PartiallyJoinedSend(protobuf::Message& proto_message) {
   NodeId bootstrap_connection_id(network_.bootstrap_connection_id());
   assert(proto_message.has_relay_connection_id() && "did not set this_node_relay_connection_id");
   rudp::MessageSentFunctor message_sent([=](int result) {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
+    Lifecycle::Operation operation(lifecycle_);
+    if (!operation)
       return;
-    asio_service_.service().post([=]() {
+    Clock::Post(asio_service_.service(), [=]() {
+      Lifecycle::Operation operation(lifecycle_);
+      if (!operation)
+        return;
       if (rudp::kSuccess != result) {
         if (proto_message.id() != 0) {
           try {
@@ -500,10 +567,18 @@ GroupRangeStatus Routing::Impl::IsNodeIdInGroupRange(const NodeId& group_id,
 NodeId Routing::Impl::RandomConnectedNode() { return routing_table_.RandomConnectedNode(); }
 
 bool Routing::Impl::EstimateInGroup(const NodeId& sender_id, const NodeId& info_id) {
-  return ((routing_table_.size() > Parameters::routing_table_ready_to_response) &&
+  uint16_t ready_size(Parameters::routing_table_ready_to_response);
+  if (Parameters::adaptive_routing_table_size)
+    ready_size = std::min(ready_size,
+                          static_cast<uint16_t>(routing_table_.target().greedy_size * 9 / 10));
+  return ((routing_table_.size() > ready_size) &&
           network_statistics_.EstimateInGroup(sender_id, info_id));
 }
 
+uint64_t Routing::Impl::EstimateNetworkSize() const {
+  return network_statistics_.EstimateNetworkSize();
+}
+
 std::future<std::vector<NodeId>> Routing::Impl::GetGroup(const NodeId& group_id) {
   auto promise(std::make_shared<std::promise<std::vector<NodeId>>>());
   auto future(promise->get_future());
@@ -531,14 +606,25 @@ std::future<std::vector<NodeId>> Routing::Impl::GetGroup(const NodeId& group_id)
 }
 
 void Routing::Impl::OnMessageReceived(const std::string& message) {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  if (running_)
-    asio_service_.service().post([=]() { DoOnMessageReceived(message); });  // NOLINT (Fraser)
+  const auto kReceivedTime(std::chrono::steady_clock::now());
+  Lifecycle::Operation operation(lifecycle_);
+  if (operation)
+    Clock::Post(asio_service_.service(),
+                [=]() { DoOnMessageReceived(message, kReceivedTime); });  // NOLINT
 }
 
-void Routing::Impl::DoOnMessageReceived(const std::string& message) {
+void Routing::Impl::DoOnMessageReceived(const std::string& message,
+                                        std::chrono::steady_clock::time_point received_time) {
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
   protobuf::Message pb_message;
   if (pb_message.ParseFromString(message)) {
+    if (pb_message.has_trace()) {
+      AddMessageTraceHop(pb_message, kNodeId_,
+                         std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - received_time));
+    }
     bool relay_message(!pb_message.has_source_id());
     LOG(kVerbose) << "   [" << DebugId(kNodeId_) << "] rcvd : " << MessageTypeString(pb_message)
                   << " from " << (relay_message ? HexSubstr(pb_message.relay_id())
@@ -551,11 +637,6 @@ void Routing::Impl::DoOnMessageReceived(const std::string& message) {
       if (!source_id.IsZero())
         random_node_helper_.Add(source_id);
     }
-    {
-      std::lock_guard<std::mutex> lock(running_mutex_);
-      if (!running_)
-        return;
-    }
     message_handler_->HandleMessage(pb_message);
   } else {
     LOG(kWarning) << "Message received, failed to parse";
@@ -563,20 +644,19 @@ void Routing::Impl::DoOnMessageReceived(const std::string& message) {
 }
 
 void Routing::Impl::OnConnectionLost(const NodeId& lost_connection_id) {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  if (running_)
-    asio_service_.service().post([=]() { DoOnConnectionLost(lost_connection_id); });  // NOLINT
-                                                                                      // (Fraser)
+  Lifecycle::Operation operation(lifecycle_);
+  if (operation)
+    Clock::Post(asio_service_.service(),
+                [=]() { DoOnConnectionLost(lost_connection_id); });  // NOLINT (Fraser)
 }
 
 void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
   LOG(kVerbose) << DebugId(kNodeId_) << "  Routing::ConnectionLost with -----------"
                 << DebugId(lost_connection_id);
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return;
-  }
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
+  message_handler_->ConnectionLost(lost_connection_id);
 
   NodeInfo dropped_node;
   bool resend(
@@ -604,11 +684,6 @@ void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
       LOG(kWarning) << "[" << DebugId(kNodeId_) << "]"
                     << "Lost temporary connection with bootstrap node. connection id :"
                     << DebugId(lost_connection_id);
-      {
-        std::lock_guard<std::mutex> lock(running_mutex_);
-        if (!running_)
-          return;
-      }
       network_.clear_bootstrap_connection_info();
 
       if (routing_table_.size() == 0)
@@ -621,9 +696,7 @@ void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
   }
 
   if (resend) {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return;
+    std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
     // Close node lost, get more nodes
     LOG(kWarning) << "Lost close node, getting more.";
     recovery_timer_.expires_from_now(Parameters::recovery_time_lag);
@@ -652,9 +725,10 @@ void Routing::Impl::RemoveNode(const NodeInfo& node, bool internal_rudp_only) {
 
   bool resend(routing_table_.IsThisNodeInRange(node.node_id, Parameters::closest_nodes_size));
   if (resend) {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
+    Lifecycle::Operation operation(lifecycle_);
+    if (!operation)
       return;
+    std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
     // Close node removed by routing, get more nodes
     LOG(kWarning) << "[" << DebugId(kNodeId_)
                   << "] Removed close node, sending find node to get more nodes.";
@@ -672,21 +746,23 @@ bool Routing::Impl::ConfirmGroupMembers(const NodeId& node1, const NodeId& node2
 
 void Routing::Impl::ReSendFindNodeRequest(const boost::system::error_code& error_code,
                                           bool ignore_size) {
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (error_code == boost::asio::error::operation_aborted || !running_)
-      return;
-  }
+  if (error_code == boost::asio::error::operation_aborted)
+    return;
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
 
   if (routing_table_.size() == 0) {
     LOG(kError) << "[" << DebugId(kNodeId_) << "]'s' Routing table is empty."
                 << " Scheduling Re-Bootstrap .... !!!";
     ReBootstrap();
     return;
-  } else if (ignore_size || (routing_table_.size() < routing_table_.kThresholdSize())) {
+  }
+  const RoutingTableTarget kTarget(routing_table_.target());
+  if (ignore_size || (routing_table_.size() < kTarget.threshold_size)) {
     if (!ignore_size)
       LOG(kInfo) << "[" << DebugId(kNodeId_) << "] Routing table smaller than "
-                 << routing_table_.kThresholdSize()
+                 << kTarget.threshold_size
                  << " nodes.  Sending another FindNodes. Routing table size < "
                  << routing_table_.size() << " >";
     else
@@ -695,17 +771,15 @@ void Routing::Impl::ReSendFindNodeRequest(const boost::system::error_code& error
                  << routing_table_.size();
 
     int num_nodes_requested(0);
-    if (ignore_size && (routing_table_.size() > routing_table_.kThresholdSize()))
+    if (ignore_size && (routing_table_.size() > kTarget.threshold_size))
       num_nodes_requested = static_cast<int>(Parameters::closest_nodes_size);
     else
-      num_nodes_requested = static_cast<int>(Parameters::greedy_fraction);
+      num_nodes_requested = static_cast<int>(kTarget.greedy_size);
 
-    protobuf::Message find_node_rpc(rpcs::FindNodes(kNodeId_, kNodeId_, num_nodes_requested));
-    network_.SendToClosestNode(find_node_rpc);
+    LookupCloseNodes(routing_table_.GetClosestNodes(kNodeId_, Parameters::closest_nodes_size),
+                     num_nodes_requested);
 
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return;
+    std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
     recovery_timer_.expires_from_now(Parameters::find_node_interval);
     recovery_timer_.async_wait([=](boost::system::error_code error_code_local) {
       if (error_code != boost::asio::error::operation_aborted)
@@ -714,10 +788,193 @@ void Routing::Impl::ReSendFindNodeRequest(const boost::system::error_code& error
   }
 }
 
+void Routing::Impl::LookupCloseNodes(const std::vector<NodeId>& initial_peers,
+                                     int num_nodes_requested) {
+  auto lookup(std::make_shared<IterativeLookup>(
+      kNodeId_, kNodeId_, Parameters::node_lookup_alpha, Parameters::closest_nodes_size,
+      [=](const NodeId& peer_id, const NodeId& target_id,
+          const IterativeLookup::FindNodesResponseFunctor& response_functor) {
+        SendLookupFindNodes(peer_id, target_id, num_nodes_requested, response_functor);
+      },
+      [=](const std::vector<NodeId>& closest_nodes) {
+        Lifecycle::Operation operation(lifecycle_);
+        if (operation)
+          LOG(kVerbose) << "[" << DebugId(kNodeId_) << "] lookup found " << closest_nodes.size()
+                        << " close nodes.  Routing table size : " << routing_table_.size();
+      }));
+  lookup->Start(initial_peers);
+}
+
+void Routing::Impl::SendLookupFindNodes(
+    const NodeId& peer_id, const NodeId& target_id, int num_nodes_requested,
+    const IterativeLookup::FindNodesResponseFunctor& response_functor) {
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return response_functor(std::vector<NodeId>());
+  auto callback([response_functor](const std::string& response) {
+    std::vector<NodeId> nodes;
+    protobuf::FindNodesResponse find_nodes_response;
+    if (!response.empty() && find_nodes_response.ParseFromString(response)) {
+      try {
+        for (const auto& node : find_nodes_response.nodes())
+          nodes.push_back(NodeId(node));
+      }
+      catch (const std::exception& e) {
+        LOG(kError) << "Failed to parse FindNodes response : " << e.what();
+        nodes.clear();
+      }
+    }
+    response_functor(nodes);
+  });
+  // Until this node has close peers of its own, requests are relayed via the bootstrap connection.
+  bool relay_message((routing_table_.size() < Parameters::closest_nodes_size) &&
+                     !network_.bootstrap_connection_id().IsZero());
+  TaskId task_id(timer_.NewTaskId());
+  protobuf::Message find_node_rpc(rpcs::IterativeFindNodes(
+      peer_id, target_id, kNodeId_, num_nodes_requested, task_id, relay_message,
+      relay_message ? network_.this_node_relay_connection_id() : NodeId()));
+  timer_.AddTask(Parameters::node_lookup_timeout, callback, 1, task_id);
+  if (relay_message) {
+    network_.SendToDirect(find_node_rpc, network_.bootstrap_connection_id(),
+                          [=](int message_sent) {
+      if (message_sent != kSuccess)
+        LOG(kError) << "Failed to send FindNodes RPC to bootstrap connection id : "
+                    << DebugId(network_.bootstrap_connection_id());
+    });
+  } else {
+    network_.SendToClosestNode(find_node_rpc);
+  }
+}
+
+void Routing::Impl::PublishCacheSummary(const boost::system::error_code& error_code) {
+  if (error_code == boost::asio::error::operation_aborted)
+    return;
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
+  std::string cache_summary(message_handler_->cache_summary());
+  if (!cache_summary.empty()) {
+    for (const auto& node_id :
+         routing_table_.GetClosestNodes(kNodeId_, Parameters::closest_nodes_size)) {
+      NodeInfo node_info;
+      if (routing_table_.GetNodeInfo(node_id, node_info))
+        network_.SendToDirect(rpcs::Ping(node_id, kNodeId_.string(), cache_summary),
+                              node_info.node_id, node_info.connection_id);
+    }
+  }
+  std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
+  cache_summary_timer_.expires_from_now(Parameters::cache_summary_interval);
+  cache_summary_timer_.async_wait([=](const boost::system::error_code& error_code_local) {
+    PublishCacheSummary(error_code_local);
+  });
+}
+
+void Routing::Impl::PingPeers(const boost::system::error_code& error_code) {
+  if (error_code == boost::asio::error::operation_aborted)
+    return;
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
+  for (const auto& node_info : routing_table_.GetNodes())
+    network_.SendToDirect(rpcs::Ping(node_info.node_id, kNodeId_.string()), node_info.node_id,
+                          node_info.connection_id);
+  std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
+  ping_timer_.expires_from_now(Parameters::round_trip_time_ping_interval);
+  ping_timer_.async_wait([=](const boost::system::error_code& error_code_local) {
+    PingPeers(error_code_local);
+  });
+}
+
+fs::path Routing::Impl::PublicKeyCachePath() const {
+  return Parameters::public_key_cache_path / kNodeId_.ToStringEncoded(NodeId::EncodingType::kHex);
+}
+
+fs::path Routing::Impl::RoutingTableSnapshotPath() const {
+  return Parameters::routing_table_snapshot_path /
+         kNodeId_.ToStringEncoded(NodeId::EncodingType::kHex);
+}
+
+RoutingTableSnapshot Routing::Impl::LoadRoutingTableSnapshot() const {
+  if (routing_table_.client_mode() || Parameters::routing_table_snapshot_path.empty())
+    return RoutingTableSnapshot();
+  boost::system::error_code error_code;
+  if (!fs::exists(RoutingTableSnapshotPath(), error_code))
+    return RoutingTableSnapshot();
+  try {
+    RoutingTableSnapshot snapshot(ReadRoutingTableSnapshot(RoutingTableSnapshotPath()));
+    if (snapshot.node_id == kNodeId_)
+      return snapshot;
+    LOG(kWarning) << "Ignoring routing table snapshot belonging to " << DebugId(snapshot.node_id);
+  }
+  catch (const std::exception& e) {
+    LOG(kWarning) << "Ignoring unreadable routing table snapshot " << RoutingTableSnapshotPath()
+                  << " : " << e.what();
+  }
+  return RoutingTableSnapshot();
+}
+
+void Routing::Impl::SaveRoutingTableSnapshot(const boost::system::error_code& error_code) {
+  if (error_code == boost::asio::error::operation_aborted)
+    return;
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
+  DoSaveRoutingTableSnapshot();
+  std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
+  snapshot_timer_.expires_from_now(Parameters::routing_table_snapshot_interval);
+  snapshot_timer_.async_wait([=](const boost::system::error_code& error_code_local) {
+    SaveRoutingTableSnapshot(error_code_local);
+  });
+}
+
+void Routing::Impl::DoSaveRoutingTableSnapshot() {
+  std::vector<NodeInfo> nodes(routing_table_.GetNodes());
+  // Keep the previous snapshot while rejoining; it is more useful than an empty one.
+  if (nodes.empty())
+    return;
+  RoutingTableSnapshot snapshot;
+  snapshot.node_id = kNodeId_;
+  for (const auto& node : nodes) {
+    RoutingTableSnapshot::Peer peer;
+    peer.node_info = node;
+    peer.endpoint = network_.PeerEndpoint(node.connection_id);
+    routing_table_.GetMatrixRow(node.node_id, peer.matrix_row);
+    snapshot.peers.push_back(peer);
+  }
+  try {
+    WriteRoutingTableSnapshot(snapshot, RoutingTableSnapshotPath());
+    LOG(kVerbose) << "Saved routing table snapshot of " << snapshot.peers.size() << " peers.";
+  }
+  catch (const std::exception& e) {
+    LOG(kWarning) << "Failed to save routing table snapshot : " << e.what();
+  }
+}
+
+void Routing::Impl::ExportMetrics(const boost::system::error_code& error_code) {
+  if (error_code == boost::asio::error::operation_aborted)
+    return;
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
+  const std::string kHexId(kNodeId_.ToStringEncoded(NodeId::EncodingType::kHex));
+  try {
+    WritePrometheusFile(GetMetrics(), kHexId, Parameters::metrics_export_path / (kHexId + ".prom"));
+  }
+  catch (const std::exception& e) {
+    LOG(kWarning) << "Failed to export metrics : " << e.what();
+  }
+  std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
+  metrics_timer_.expires_from_now(Parameters::metrics_export_interval);
+  metrics_timer_.async_wait([=](const boost::system::error_code& error_code_local) {
+    ExportMetrics(error_code_local);
+  });
+}
+
 void Routing::Impl::ReBootstrap() {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  if (!running_)
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
     return;
+  std::lock_guard<InstrumentedMutex> lock(timers_mutex_);
   re_bootstrap_timer_.expires_from_now(Parameters::re_bootstrap_time_lag);
   re_bootstrap_timer_.async_wait([=](boost::system::error_code error_code_local) {
     if (error_code_local != boost::asio::error::operation_aborted)
@@ -728,13 +985,11 @@ void Routing::Impl::ReBootstrap() {
 void Routing::Impl::DoReBootstrap(const boost::system::error_code& error_code) {
   if (error_code == boost::asio::error::operation_aborted)
     return;
-  {
-    std::lock_guard<std::mutex> lock(running_mutex_);
-    if (!running_)
-      return;
-    if (routing_table_.size() != 0)
-      return;
-  }
+  Lifecycle::Operation operation(lifecycle_);
+  if (!operation)
+    return;
+  if (routing_table_.size() != 0)
+    return;
   LOG(kError) << "[" << DebugId(kNodeId_) << "]'s' Routing table is empty."
               << " ReBootstrapping ....";
   DoJoin(BootstrapContacts());
@@ -748,7 +1003,7 @@ void Routing::Impl::NotifyNetworkStatus(int return_code) const {
 NodeId Routing::Impl::kNodeId() const { return kNodeId_; }
 
 int Routing::Impl::network_status() {
-  std::lock_guard<std::mutex> lock(network_status_mutex_);
+  std::lock_guard<InstrumentedMutex> lock(network_status_mutex_);
   return network_status_;
 }
 
@@ -762,6 +1017,18 @@ bool Routing::Impl::IsConnectedClient(const NodeId& node_id) {
   return client_routing_table_.IsConnected(node_id);
 }
 
+CacheStatistics Routing::Impl::cache_statistics() { return message_handler_->cache_statistics(); }
+
+RoutingMetrics Routing::Impl::GetMetrics() {
+  RoutingMetrics metrics(routing_table_.metrics().Snapshot());
+  metrics.counters["routing_timer_timeouts_total"] = timer_.timeout_count();
+  CacheStatistics cache(cache_statistics());
+  metrics.counters["routing_cache_hits_total"] = cache.hits;
+  metrics.counters["routing_cache_misses_total"] = cache.misses;
+  AddLockMetrics(metrics);
+  return metrics;
+}
+
 // New API
 void Routing::Impl::AddDestinationTypeRelatedFields(protobuf::Message& proto_message,
                                                     std::true_type) {
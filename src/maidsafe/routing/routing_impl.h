@@ -19,12 +19,12 @@
 #ifndef MAIDSAFE_ROUTING_ROUTING_IMPL_H_
 #define MAIDSAFE_ROUTING_ROUTING_IMPL_H_
 
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 
-#include "boost/asio/steady_timer.hpp"
 #include "boost/asio/ip/udp.hpp"
 #include "boost/system/error_code.hpp"
 
@@ -35,7 +35,11 @@
 
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/clock.h"
 #include "maidsafe/routing/group_change_handler.h"
+#include "maidsafe/routing/instrumented_mutex.h"
+#include "maidsafe/routing/iterative_lookup.h"
+#include "maidsafe/routing/lifecycle.h"
 #include "maidsafe/routing/message_handler.h"
 #include "maidsafe/routing/network_utils.h"
 #include "maidsafe/routing/random_node_helper.h"
@@ -43,6 +47,7 @@
 #include "maidsafe/routing/routing_api.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/routing_table_snapshot.h"
 #include "maidsafe/routing/timer.h"
 
 namespace maidsafe {
@@ -128,6 +133,8 @@ class Routing::Impl {
 
   bool EstimateInGroup(const NodeId& sender_id, const NodeId& info_id);
 
+  uint64_t EstimateNetworkSize() const;
+
   std::future<std::vector<NodeId>> GetGroup(const NodeId& group_id);
 
   NodeId kNodeId() const;
@@ -139,6 +146,10 @@ class Routing::Impl {
   bool IsConnectedVault(const NodeId& node_id);
   bool IsConnectedClient(const NodeId& node_id);
 
+  CacheStatistics cache_statistics();
+
+  RoutingMetrics GetMetrics();
+
   friend class test::GenericNode;
 
  private:
@@ -148,14 +159,31 @@ class Routing::Impl {
 
   void ConnectFunctors(const Functors& functors);
   void BootstrapFromTheseEndpoints(const BootstrapContacts& bootstrap_contacts);
-  void DoJoin(const BootstrapContacts& bootstrap_contacts);
+  void DoJoin(const BootstrapContacts& bootstrap_contacts,
+              const std::vector<RoutingTableSnapshot::Peer>& snapshot_peers =
+                  std::vector<RoutingTableSnapshot::Peer>());
   int DoBootstrap(const BootstrapContacts& bootstrap_contacts);
   void ReBootstrap();
   void DoReBootstrap(const boost::system::error_code& error_code);
   void FindClosestNode(const boost::system::error_code& error_code, int attempts);
   void ReSendFindNodeRequest(const boost::system::error_code& error_code, bool ignore_size);
+  // Runs an iterative lookup for this node's own id, starting from initial_peers (or from the node
+  // closest to this one if initial_peers is empty).
+  void LookupCloseNodes(const std::vector<NodeId>& initial_peers, int num_nodes_requested);
+  void SendLookupFindNodes(const NodeId& peer_id, const NodeId& target_id, int num_nodes_requested,
+                           const IterativeLookup::FindNodesResponseFunctor& response_functor);
+  void PublishCacheSummary(const boost::system::error_code& error_code);
+  // Pings every routing table peer to measure its round trip time, for proximity routing.
+  void PingPeers(const boost::system::error_code& error_code);
+  boost::filesystem::path PublicKeyCachePath() const;
+  boost::filesystem::path RoutingTableSnapshotPath() const;
+  RoutingTableSnapshot LoadRoutingTableSnapshot() const;
+  void SaveRoutingTableSnapshot(const boost::system::error_code& error_code);
+  void DoSaveRoutingTableSnapshot();
+  void ExportMetrics(const boost::system::error_code& error_code);
   void OnMessageReceived(const std::string& message);
-  void DoOnMessageReceived(const std::string& message);
+  void DoOnMessageReceived(const std::string& message,
+                           std::chrono::steady_clock::time_point received_time);
   void OnConnectionLost(const NodeId& lost_connection_id);
   void DoOnConnectionLost(const NodeId& lost_connection_id);
   void RemoveNode(const NodeInfo& node, bool internal_rudp_only);
@@ -183,13 +211,16 @@ class Routing::Impl {
   void AddDestinationTypeRelatedFields(protobuf::Message& proto_message, std::true_type);
   void AddDestinationTypeRelatedFields(protobuf::Message& proto_message, std::false_type);
 
-  std::mutex network_status_mutex_;
+  InstrumentedMutex network_status_mutex_;
+  // Notified whenever the routing table reports a new network status.
+  InstrumentedConditionVariable network_status_condition_;
   int network_status_;
   NetworkStatistics network_statistics_;
   RoutingTable routing_table_;
   const NodeId kNodeId_;
-  bool running_;
-  std::mutex running_mutex_;
+  Lifecycle lifecycle_;
+  // Serialises arming the timers below, which is done from any thread.
+  InstrumentedMutex timers_mutex_;
   Functors functors_;
   RandomNodeHelper random_node_helper_;
   ClientRoutingTable client_routing_table_;
@@ -202,7 +233,8 @@ class Routing::Impl {
   AsioService asio_service_;
   NetworkUtils network_;
   Timer<std::string> timer_;
-  boost::asio::steady_timer re_bootstrap_timer_, recovery_timer_, setup_timer_;
+  SteadyTimer re_bootstrap_timer_, recovery_timer_, setup_timer_,
+      cache_summary_timer_, snapshot_timer_, ping_timer_, metrics_timer_;
 };
 
 template <>
@@ -25,7 +25,6 @@
 
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/utils.h"
-#include "maidsafe/common/tools/network_viewer.h"
 
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/node_info.h"
@@ -36,17 +35,65 @@ namespace maidsafe {
 
 namespace routing {
 
+namespace {
+
+int CommonLeadingBits(const NodeId& lhs, const NodeId& rhs) {
+  const std::string kLhs(lhs.string()), kRhs(rhs.string());
+  for (size_t i(0); i != kLhs.size(); ++i) {
+    uint8_t difference(static_cast<uint8_t>(kLhs[i] ^ kRhs[i]));
+    if (difference != 0) {
+      int bits(static_cast<int>(i) * 8);
+      while ((difference & 0x80) == 0) {
+        difference <<= 1;
+        ++bits;
+      }
+      return bits;
+    }
+  }
+  return static_cast<int>(kLhs.size()) * 8;
+}
+
+}  // unnamed namespace
+
+RoutingTableTarget VaultRoutingTableTarget(uint64_t network_size) {
+  RoutingTableTarget target = { Parameters::max_routing_table_size,
+                                Parameters::routing_table_size_threshold,
+                                Parameters::greedy_fraction, Parameters::bucket_target_size };
+  if (!Parameters::adaptive_routing_table_size || network_size == 0)
+    return target;
+
+  // Peers beyond the close nodes are spread over about log2(network_size / closest_nodes_size)
+  // buckets.  Greedy routing through a table holding k peers per bucket resolves about
+  // 1 + log2(k) bits of the distance to the target per hop.
+  uint16_t network_bits(0), close_bits(0);
+  while (((network_size - 1) >> network_bits) != 0)
+    ++network_bits;
+  while ((Parameters::closest_nodes_size >> (close_bits + 1)) != 0)
+    ++close_bits;
+  const uint16_t kBuckets(std::max(network_bits - close_bits, 1));
+  const uint16_t kHops(std::max(Parameters::target_routing_hops, static_cast<uint16_t>(1)));
+  const uint16_t kBitsPerHop(std::min((kBuckets + kHops - 1) / kHops, 16));
+  uint32_t size(Parameters::closest_nodes_size + (1U << (kBitsPerHop - 1)) * kBuckets);
+  size = std::max<uint32_t>(size, Parameters::min_adaptive_routing_table_size);
+  size = std::min<uint32_t>(size, Parameters::max_adaptive_routing_table_size);
+  size = std::max<uint32_t>(size, Parameters::closest_nodes_size);
+
+  target.max_size = static_cast<uint16_t>(size);
+  target.threshold_size = static_cast<uint16_t>(size / 4);
+  target.greedy_size = static_cast<uint16_t>(size * 3 / 4);
+  target.bucket_target_size = std::max(
+      Parameters::bucket_target_size,
+      static_cast<uint16_t>((size - Parameters::closest_nodes_size) / kBuckets));
+  return target;
+}
+
 RoutingTable::RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
                            NetworkStatistics& network_statistics)
     : kClientMode_(client_mode),
       kNodeId_(node_id),
       kConnectionId_(kClientMode_ ? NodeId(NodeId::kRandomId) : kNodeId_),
       kKeys_(keys),
-      kMaxSize_(kClientMode_ ? Parameters::max_routing_table_size_for_client
-                             : Parameters::max_routing_table_size),
-      kThresholdSize_(kClientMode_ ? Parameters::max_routing_table_size_for_client
-                                   : Parameters::routing_table_size_threshold),
-      mutex_(),
+      mutex_("routing_table"),
       furthest_closest_node_id_((NodeId(NodeId::kMaxId) ^ node_id)),
       remove_node_functor_(),
       network_status_functor_(),
@@ -54,29 +101,17 @@ RoutingTable::RoutingTable(bool client_mode, const NodeId& node_id, const asymm:
       connected_group_change_functor_(),
       nodes_(),
       group_matrix_(kNodeId_, client_mode),
-      ipc_message_queue_(),
-      network_statistics_(network_statistics) {
+      network_viewer_publisher_(),
+      network_statistics_(network_statistics),
+      metrics_() {
 #ifdef TESTING
-  try {
-    ipc_message_queue_.reset(new boost::interprocess::message_queue(
-        boost::interprocess::open_only, network_viewer::kMessageQueueName.c_str()));
-    if (static_cast<uint16_t>(ipc_message_queue_->get_max_msg_size()) <
-        (Parameters::closest_nodes_size + 1) * Parameters::closest_nodes_size * 2 * NodeId::kSize) {
-      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
-    }
-  }
-  catch (const std::exception&) {
-    ipc_message_queue_.reset();
-  }
+  network_viewer_publisher_ = NetworkViewerPublisher::Get();
 #endif
 }
 
 RoutingTable::~RoutingTable() {
-  if (ipc_message_queue_) {
-    network_viewer::MatrixRecord matrix_record(kNodeId_);
-    std::string serialised_matrix(matrix_record.Serialise());
-    ipc_message_queue_->try_send(serialised_matrix.c_str(), serialised_matrix.size(), 0);
-  }
+  if (network_viewer_publisher_)
+    network_viewer_publisher_->Remove(kNodeId_);
 }
 
 void RoutingTable::InitialiseFunctors(
@@ -126,25 +161,26 @@ bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove,
   NodeInfo removed_node;
   uint16_t routing_table_size(0);
   std::shared_ptr<MatrixChange> matrix_change;
+  const RoutingTableTarget kTarget(target());
 
   if (remove)
     SetBucketIndex(peer);
   std::vector<NodeId> unique_nodes;
   {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<InstrumentedMutex> lock(mutex_);
     auto found(Find(peer.node_id, lock));
     if (found.first) {
       LOG(kVerbose) << "Node " << DebugId(peer.node_id) << " already in routing table.";
       return false;
     }
 
-    if (MakeSpaceForNodeToBeAdded(peer, remove, removed_node, lock)) {
+    if (MakeSpaceForNodeToBeAdded(peer, remove, removed_node, kTarget, lock)) {
       if (remove) {
         assert(peer.bucket != NodeInfo::kInvalidBucket);
         nodes_.push_back(peer);
         old_connected_close_nodes = group_matrix_.GetConnectedPeers();
         matrix_change = UpdateCloseNodeChange(lock, peer, new_connected_close_nodes, matrix_update);
-        if (nodes_.size() > Parameters::greedy_fraction)
+        if (nodes_.size() > kTarget.greedy_size)
           remove_furthest_node = true;
         if (nodes_.size() >= Parameters::closest_nodes_size) {
           NthElementSortFromTarget(kNodeId_, Parameters::closest_nodes_size, lock);
@@ -158,6 +194,7 @@ bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove,
   }
 
   if (return_value && remove) {  // Firing functors on Add only
+    metrics_.Increment(MetricCounter::kRoutingTableAdds);
     UpdateNetworkStatus(routing_table_size);
 
     if (!removed_node.node_id.IsZero()) {
@@ -170,10 +207,11 @@ bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove,
     UpdateConnectedPeersMatrix(new_connected_close_nodes, old_connected_close_nodes);
 
     if ((matrix_change != nullptr) && !matrix_change->OldEqualsToNew()) {
+      metrics_.Increment(MetricCounter::kMatrixChanges);
       network_statistics_.UpdateLocalAverageDistance(unique_nodes);
       if (matrix_change_functor_)
         matrix_change_functor_(matrix_change);
-      IpcSendGroupMatrix();
+      PublishGroupMatrix();
     }
 
     if (peer.nat_type == rudp::NatType::kOther) {  // Usable as bootstrap endpoint
@@ -196,7 +234,7 @@ NodeInfo RoutingTable::DropNode(const NodeId& node_to_drop, bool routing_only) {
   std::shared_ptr<MatrixChange> matrix_change;
   std::vector<NodeId> unique_nodes;
   {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<InstrumentedMutex> lock(mutex_);
     auto found(Find(node_to_drop, lock));
     if (found.first) {
       dropped_node = *found.second;
@@ -221,13 +259,15 @@ NodeInfo RoutingTable::DropNode(const NodeId& node_to_drop, bool routing_only) {
   UpdateConnectedPeersMatrix(new_connected_close_nodes, old_connected_close_nodes);
 
   if ((matrix_change != nullptr) && !matrix_change->OldEqualsToNew()) {
+    metrics_.Increment(MetricCounter::kMatrixChanges);
     network_statistics_.UpdateLocalAverageDistance(unique_nodes);
     if (matrix_change_functor_)
       matrix_change_functor_(matrix_change);
-    IpcSendGroupMatrix();
+    PublishGroupMatrix();
   }
 
   if (!dropped_node.node_id.IsZero()) {
+    metrics_.Increment(MetricCounter::kRoutingTableDrops);
     assert(nodes_.size() <= std::numeric_limits<uint16_t>::max());
     UpdateNetworkStatus(static_cast<uint16_t>(nodes_.size()));
   }
@@ -249,7 +289,7 @@ bool RoutingTable::IsThisNodeGroupLeader(const NodeId& target_id, NodeInfo& conn
   if (NodeId::CloserToTarget(closest_peer_id, current_closest_id, target_id))
     current_closest_id = closest_peer_id;
 
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   group_matrix_.GetBetterNodeForSendingMessage(target_id, true, current_closest_id);
   if (current_closest_id != kNodeId_) {
     auto found(Find(current_closest_id, lock));
@@ -269,7 +309,7 @@ bool RoutingTable::IsThisNodeGroupLeader(const NodeId& target_id, NodeInfo& conn
   if (NodeId::CloserToTarget(closest_peer.node_id, current_closest.node_id, target_id))
     current_closest = closest_peer;
   {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<InstrumentedMutex> lock(mutex_);
     group_matrix_.GetBetterNodeForSendingMessage(target_id, exclude, true, current_closest);
     if (current_closest.node_id != kNodeId_) {
       auto found(Find(current_closest.node_id, lock));
@@ -299,7 +339,7 @@ bool RoutingTable::ClosestToId(const NodeId& target_id) {
   if (target_id == kNodeId_)
     return false;
 
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   if (nodes_.empty())  // should return false ?
     return true;
 
@@ -329,12 +369,12 @@ GroupRangeStatus RoutingTable::IsNodeIdInGroupRange(const NodeId& group_id,
   if (group_id == node_id)
     return GroupRangeStatus::kInRange;
 
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   return group_matrix_.IsNodeIdInGroupRange(group_id, node_id);
 }
 
 NodeId RoutingTable::RandomConnectedNode() {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
 // Commenting out assert as peer starts treating this node as joined as soon as it adds
 // it into its routing table.
 //  assert(nodes_.size() > Parameters::closest_nodes_size &&
@@ -349,19 +389,29 @@ NodeId RoutingTable::RandomConnectedNode() {
 }
 
 std::vector<NodeInfo> RoutingTable::GetMatrixNodes() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   return group_matrix_.GetUniqueNodes();
 }
 
+std::vector<NodeInfo> RoutingTable::GetNodes() const {
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
+  return nodes_;
+}
+
+bool RoutingTable::GetMatrixRow(const NodeId& peer_id, std::vector<NodeInfo>& row) {
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
+  return group_matrix_.GetRow(peer_id, row);
+}
+
 bool RoutingTable::IsConnected(const NodeId& node_id) {
   if (Contains(node_id))
     return true;
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   return group_matrix_.Contains(node_id);
 }
 
 bool RoutingTable::GetNodeInfo(const NodeId& node_id, NodeInfo& peer) const {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   auto found(Find(node_id, lock));
   if (found.first)
     peer = *found.second;
@@ -369,7 +419,7 @@ bool RoutingTable::GetNodeInfo(const NodeId& node_id, NodeInfo& peer) const {
 }
 
 bool RoutingTable::IsThisNodeInRange(const NodeId& target_id, const uint16_t range) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   if (nodes_.size() < range)
     return true;
   NthElementSortFromTarget(kNodeId_, range, lock);
@@ -401,12 +451,12 @@ bool RoutingTable::IsThisNodeClosestToIncludingMatrix(const NodeId& target_id,
     return false;
 
   NodeId connected_peer;
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
   return group_matrix_.IsThisNodeGroupLeader(target_id, connected_peer);  // use connected peer?
 }
 
 bool RoutingTable::Contains(const NodeId& node_id) const {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   return Find(node_id, lock).first;
 }
 
@@ -420,7 +470,7 @@ void RoutingTable::GroupUpdateFromConnectedPeer(const NodeId& peer,
   std::shared_ptr<MatrixChange> matrix_change;
   std::vector<NodeInfo> new_connected_peers, old_connected_peers;
   {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<InstrumentedMutex> lock(mutex_);
     std::vector<NodeId> old_unique_ids(group_matrix_.GetUniqueNodeIds());
     old_connected_peers = group_matrix_.GetConnectedPeers();
     if (std::find_if(old_connected_peers.begin(), old_connected_peers.end(),
@@ -434,8 +484,11 @@ void RoutingTable::GroupUpdateFromConnectedPeer(const NodeId& peer,
     matrix_change = group_matrix_.UpdateFromConnectedPeer(peer, nodes, old_unique_ids);
     new_connected_peers = group_matrix_.GetConnectedPeers();
   }
-  if (!matrix_change->OldEqualsToNew() && matrix_change_functor_)
-    matrix_change_functor_(matrix_change);
+  if (!matrix_change->OldEqualsToNew()) {
+    metrics_.Increment(MetricCounter::kMatrixChanges);
+    if (matrix_change_functor_)
+      matrix_change_functor_(matrix_change);
+  }
   UpdateConnectedPeersMatrix(new_connected_peers, old_connected_peers);
 }
 
@@ -452,7 +505,7 @@ void RoutingTable::UpdateConnectedPeersMatrix(const std::vector<NodeInfo>& new_c
 }
 
 std::shared_ptr<MatrixChange> RoutingTable::UpdateCloseNodeChange(
-    std::unique_lock<std::mutex>& lock, const NodeInfo& peer,
+    std::unique_lock<InstrumentedMutex>& lock, const NodeInfo& peer,
     std::vector<NodeInfo>& new_connected_nodes, const std::vector<NodeInfo>& matrix_update) {
   assert(lock.owns_lock());
   std::shared_ptr<MatrixChange> matrix_change;
@@ -491,7 +544,7 @@ void RoutingTable::SetBucketIndex(NodeInfo& node_info) const {
 }
 
 bool RoutingTable::CheckPublicKeyIsUnique(const NodeInfo& node,
-                                          std::unique_lock<std::mutex>& lock) const {
+                                          std::unique_lock<InstrumentedMutex>& lock) const {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   // If we already have a duplicate public key return false
@@ -520,13 +573,14 @@ bool RoutingTable::CheckPublicKeyIsUnique(const NodeInfo& node,
 
 bool RoutingTable::MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove,
                                              NodeInfo& removed_node,
-                                             std::unique_lock<std::mutex>& lock) {
+                                             const RoutingTableTarget& target,
+                                             std::unique_lock<InstrumentedMutex>& lock) {
   assert(lock.owns_lock());
 
   if (remove && !CheckPublicKeyIsUnique(node, lock))
     return false;
 
-  if (nodes_.size() < kMaxSize_)
+  if (nodes_.size() < target.max_size)
     return true;
 
   PartialSortFromTarget(kNodeId_, Parameters::closest_nodes_size, lock);
@@ -543,7 +597,7 @@ bool RoutingTable::MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove,
     return true;
   }
 
-  uint16_t size(Parameters::bucket_target_size + 1);
+  uint16_t size(target.bucket_target_size + 1);
   for (auto it = furthest_close_node_iter; it != nodes_.end(); ++it) {
     if (node.bucket >= (*it).bucket)  // Stop searching as it's worthless
       return false;
@@ -566,7 +620,7 @@ bool RoutingTable::MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove,
 }
 
 uint16_t RoutingTable::PartialSortFromTarget(const NodeId& target, uint16_t number,
-                                             std::unique_lock<std::mutex>& lock) {
+                                             std::unique_lock<InstrumentedMutex>& lock) {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   uint16_t count = std::min(number, static_cast<uint16_t>(nodes_.size()));
@@ -578,7 +632,7 @@ uint16_t RoutingTable::PartialSortFromTarget(const NodeId& target, uint16_t numb
 }
 
 void RoutingTable::NthElementSortFromTarget(const NodeId& target, uint16_t nth_element,
-                                            std::unique_lock<std::mutex>& lock) {
+                                            std::unique_lock<InstrumentedMutex>& lock) {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   assert((nodes_.size() >= nth_element) &&
@@ -603,7 +657,7 @@ NodeId RoutingTable::FurthestCloseNode() {
 }
 
 NodeInfo RoutingTable::GetClosestNode(const NodeId& target_id, bool ignore_exact_match) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   int sorted_count(PartialSortFromTarget(target_id, 2, lock));
   if (sorted_count == 0)
     return NodeInfo();
@@ -644,11 +698,21 @@ NodeInfo RoutingTable::GetNodeForSendingMessage(const NodeId& target_id,
                                                 const std::vector<std::string>& exclude,
                                                 bool ignore_exact_match) {
   NodeInfo current_peer(GetClosestNode(target_id, exclude, ignore_exact_match));
+  bool proximity_routing(false);
   if (current_peer.node_id != target_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    const NodeId kClosestPeerId(current_peer.node_id);
     group_matrix_.GetBetterNodeForSendingMessage(target_id, exclude, ignore_exact_match,
                                                  current_peer);
-  }
+    // Only used while the target is further from the closest peer than this node's close group
+    // extends, so that a peer which may itself be the destination is never passed over and the
+    // final hops still follow the group matrix and XOR closeness exactly.
+    proximity_routing = Parameters::proximity_routing && !kClosestPeerId.IsZero() &&
+                        current_peer.node_id == kClosestPeerId &&
+                        (kClosestPeerId ^ target_id) > (furthest_closest_node_id_ ^ kNodeId_);
+  }
+  if (proximity_routing)
+    current_peer = GetLowestLatencyNode(target_id, exclude, ignore_exact_match, current_peer);
   std::string excluded_ids;
   for (const auto& excluded_id : exclude) {
     excluded_ids.append("\t");
@@ -659,9 +723,54 @@ NodeInfo RoutingTable::GetNodeForSendingMessage(const NodeId& target_id,
   return current_peer;
 }
 
+// Only peers in the same half of the target's bucket as the closest peer are considered, i.e. those
+// sharing at least two more leading bits with it than it shares with the target.  These leave a
+// comparable distance to be resolved, whereas choosing anywhere in the bucket costs extra hops.
+NodeInfo RoutingTable::GetLowestLatencyNode(const NodeId& target_id,
+                                            const std::vector<std::string>& exclude,
+                                            bool ignore_exact_match, const NodeInfo& closest_peer) {
+  const int kCommonBits(CommonLeadingBits(closest_peer.node_id, target_id));
+  NodeInfo lowest_latency_peer(closest_peer);
+  for (const auto& node_info :
+       GetClosestNodeInfo(target_id, Parameters::closest_nodes_size, ignore_exact_match)) {
+    if (CommonLeadingBits(node_info.node_id, target_id) < kCommonBits)
+      break;
+    if (node_info.round_trip_time.count() == 0 ||
+        CommonLeadingBits(node_info.node_id, closest_peer.node_id) < kCommonBits + 2 ||
+        !NodeId::CloserToTarget(node_info.node_id, kNodeId_, target_id) ||
+        std::find(exclude.begin(), exclude.end(), node_info.node_id.string()) != exclude.end())
+      continue;
+    if (lowest_latency_peer.round_trip_time.count() == 0 ||
+        node_info.round_trip_time < lowest_latency_peer.round_trip_time)
+      lowest_latency_peer = node_info;
+  }
+  if (lowest_latency_peer.node_id != closest_peer.node_id) {
+    LOG(kVerbose) << "[" << DebugId(kNodeId_) << "] sending to "
+                  << DebugId(lowest_latency_peer.node_id) << " ("
+                  << lowest_latency_peer.round_trip_time.count() << " us) instead of "
+                  << DebugId(closest_peer.node_id) << " (" << closest_peer.round_trip_time.count()
+                  << " us)";
+  }
+  return lowest_latency_peer;
+}
+
+void RoutingTable::UpdateRoundTripTime(const NodeId& node_id,
+                                       std::chrono::microseconds round_trip_time) {
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
+  auto found(Find(node_id, lock));
+  if (!found.first)
+    return;
+  // Smoothed as for TCP's SRTT, with a gain of 1/8.
+  std::chrono::microseconds& smoothed(found.second->round_trip_time);
+  if (smoothed.count() == 0)
+    smoothed = round_trip_time;
+  else
+    smoothed += (round_trip_time - smoothed) / 8;
+}
+
 NodeInfo RoutingTable::GetRemovableNode(std::vector<std::string> attempted) {
   std::map<uint32_t, uint16_t> bucket_rank_map;
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   PartialSortFromTarget(kNodeId_, static_cast<uint16_t>(nodes_.size()), lock);
 
   auto const from_iterator(nodes_.begin() + Parameters::closest_nodes_size);
@@ -706,7 +815,7 @@ NodeInfo RoutingTable::GetRemovableNode(std::vector<std::string> attempted) {
 }
 
 void RoutingTable::GetNodesNeedingGroupUpdates(std::vector<NodeInfo>& nodes_needing_update) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   int sorted_count(PartialSortFromTarget(kNodeId_, Parameters::closest_nodes_size, lock));
   if (sorted_count == 0)
     return;
@@ -721,7 +830,7 @@ void RoutingTable::GetNodesNeedingGroupUpdates(std::vector<NodeInfo>& nodes_need
 
 NodeInfo RoutingTable::GetNthClosestNode(const NodeId& target_id, uint16_t node_number) {
   assert((node_number > 0) && "Node number starts with position 1");
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   if (nodes_.size() < node_number) {
     NodeInfo node_info;
     node_info.node_id = (NodeId(NodeId::kMaxId) ^ kNodeId_);
@@ -733,7 +842,7 @@ NodeInfo RoutingTable::GetNthClosestNode(const NodeId& target_id, uint16_t node_
 
 std::vector<NodeId> RoutingTable::GetClosestNodes(const NodeId& target_id, uint16_t number_to_get) {
   std::vector<NodeId> close_nodes;
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   int sorted_count(PartialSortFromTarget(target_id, number_to_get, lock));
 
   for (int i = 0; i != sorted_count; ++i)
@@ -769,7 +878,7 @@ std::vector<NodeId> RoutingTable::GetGroup(const NodeId& target_id) {
 std::vector<NodeInfo> RoutingTable::GetClosestNodeInfo(const NodeId& target_id,
                                                        uint16_t number_to_get,
                                                        bool ignore_exact_match) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<InstrumentedMutex> lock(mutex_);
   int sorted_count(PartialSortFromTarget(target_id, number_to_get + 1, lock));
   if (sorted_count == 0)
     return std::vector<NodeInfo>();
@@ -786,7 +895,7 @@ std::vector<NodeInfo> RoutingTable::GetClosestNodeInfo(const NodeId& target_id,
 }
 
 std::pair<bool, std::vector<NodeInfo>::iterator> RoutingTable::Find(
-    const NodeId& node_id, std::unique_lock<std::mutex>& lock) {
+    const NodeId& node_id, std::unique_lock<InstrumentedMutex>& lock) {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   auto itr(std::find_if(nodes_.begin(), nodes_.end(), [&node_id](const NodeInfo & node_info) {
@@ -796,7 +905,7 @@ std::pair<bool, std::vector<NodeInfo>::iterator> RoutingTable::Find(
 }
 
 std::pair<bool, std::vector<NodeInfo>::const_iterator> RoutingTable::Find(
-    const NodeId& node_id, std::unique_lock<std::mutex>& lock) const {
+    const NodeId& node_id, std::unique_lock<InstrumentedMutex>& lock) const {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   auto itr(std::find_if(nodes_.begin(), nodes_.end(), [&node_id](const NodeInfo & node_info) {
@@ -812,55 +921,47 @@ void RoutingTable::UpdateNetworkStatus(uint16_t size) const {
   if (!network_status_functor_)
     return;
 #endif
-  network_status_functor_(static_cast<int>(size) * 100 / kMaxSize_);
-  LOG(kVerbose) << DebugId(kNodeId_) << " Updating network status !!! " << (size * 100) / kMaxSize_;
+  const uint16_t kMaxSize(target().max_size);
+  network_status_functor_(std::min(static_cast<int>(size) * 100 / kMaxSize, 100));
+  LOG(kVerbose) << DebugId(kNodeId_) << " Updating network status !!! " << (size * 100) / kMaxSize;
 }
 
-size_t RoutingTable::size() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return nodes_.size();
+RoutingTableTarget RoutingTable::target() const {
+  if (!kClientMode_)
+    return vault_target();
+  RoutingTableTarget target = { Parameters::max_routing_table_size_for_client,
+                                Parameters::max_routing_table_size_for_client,
+                                Parameters::greedy_fraction, Parameters::bucket_target_size };
+  return target;
 }
 
-void RoutingTable::IpcSendGroupMatrix() const {
-  if (ipc_message_queue_) {
-    network_viewer::MatrixRecord matrix_record(kNodeId_);
-    std::vector<NodeInfo> matrix, close;
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      matrix = group_matrix_.GetUniqueNodes();
-      close = group_matrix_.GetConnectedPeers();
-    }
-    std::string printout("\tMatrix sent by: " + DebugId(kNodeId_) + "\n");
-    for (const auto& matrix_element : matrix) {
-      matrix_record.AddElement(matrix_element.node_id, network_viewer::ChildType::kMatrix);
-      printout += "\t\t" + DebugId(matrix_element.node_id) + " - kMatrix\n";
-    }
+RoutingTableTarget RoutingTable::vault_target() const {
+  return VaultRoutingTableTarget(
+      Parameters::adaptive_routing_table_size ? network_statistics_.EstimateNetworkSize() : 0);
+}
 
-    std::sort(std::begin(close), std::end(close),
-              [this](const NodeInfo & lhs, const NodeInfo & rhs) {
-      return NodeId::CloserToTarget(lhs.node_id, rhs.node_id, kNodeId_);
-    });
+size_t RoutingTable::size() const {
+  std::lock_guard<InstrumentedMutex> lock(mutex_);
+  return nodes_.size();
+}
 
-    size_t index(0);
-    size_t limit(std::min(static_cast<size_t>(Parameters::group_size), close.size()));
-    for (; index < limit; ++index) {
-      matrix_record.AddElement(close[index].node_id, network_viewer::ChildType::kGroup);
-      printout += "\t\t" + DebugId(close[index].node_id) + " - kGroup\n";
-    }
-    for (; index < close.size(); ++index) {
-      matrix_record.AddElement(close[index].node_id, network_viewer::ChildType::kClosest);
-      printout += "\t\t" + DebugId(close[index].node_id) + " - kClosest\n";
-    }
-    LOG(kInfo) << printout << '\n';
-    std::string serialised_matrix(matrix_record.Serialise());
-    ipc_message_queue_->try_send(serialised_matrix.c_str(), serialised_matrix.size(), 0);
+void RoutingTable::PublishGroupMatrix() const {
+  if (!network_viewer_publisher_)
+    return;
+  std::vector<NodeId> matrix, close;
+  {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    matrix = group_matrix_.GetUniqueNodeIds();
+    for (const auto& peer : group_matrix_.GetConnectedPeers())
+      close.push_back(peer.node_id);
   }
+  network_viewer_publisher_->Publish(kNodeId_, std::move(matrix), std::move(close));
 }
 
 std::string RoutingTable::PrintRoutingTable() {
   std::vector<NodeInfo> rt;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     std::sort(nodes_.begin(), nodes_.end(), [&](const NodeInfo & lhs, const NodeInfo & rhs) {
       return NodeId::CloserToTarget(lhs.node_id, rhs.node_id, kNodeId_);
     });
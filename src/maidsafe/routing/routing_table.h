@@ -19,6 +19,7 @@
 #ifndef MAIDSAFE_ROUTING_ROUTING_TABLE_H_
 #define MAIDSAFE_ROUTING_ROUTING_TABLE_H_
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -28,7 +29,6 @@
 
 #include "boost/asio/ip/udp.hpp"
 #include "boost/filesystem/path.hpp"
-#include "boost/interprocess/ipc/message_queue.hpp"
 
 #include "maidsafe/common/node_id.h"
 #include "maidsafe/common/rsa.h"
@@ -37,7 +37,10 @@
 
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/group_matrix.h"
+#include "maidsafe/routing/instrumented_mutex.h"
+#include "maidsafe/routing/metrics.h"
 #include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/network_viewer_publisher.h"
 #include "maidsafe/routing/parameters.h"
 
 namespace maidsafe {
@@ -67,6 +70,21 @@ struct NodeInfo;
 typedef std::function<void(std::vector<NodeInfo> /*new*/, std::vector<NodeInfo> /*old*/)>
                            ConnectedGroupChangeFunctor;
 
+// Sizes a routing table aims for.  Beyond its close nodes it holds up to bucket_target_size peers
+// per bucket before evicting from a bucket to make space, and up to max_size peers in total.  It
+// looks for more peers while smaller than threshold_size, and asks its furthest peers to drop it
+// while larger than greedy_size.
+struct RoutingTableTarget {
+  uint16_t max_size;
+  uint16_t threshold_size;
+  uint16_t greedy_size;
+  uint16_t bucket_target_size;
+};
+
+// Returns the static target from Parameters, or if Parameters::adaptive_routing_table_size is set
+// and network_size is non-zero, the target for a vault in a network of network_size vaults.
+RoutingTableTarget VaultRoutingTableTarget(uint64_t network_size);
+
 class RoutingTable {
  public:
   RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
@@ -99,6 +117,9 @@ class RoutingTable {
   void GroupUpdateFromUnvalidatedPeer(const NodeId& peer, const std::vector<NodeInfo>& nodes);
   NodeId RandomConnectedNode();
   std::vector<NodeInfo> GetMatrixNodes();
+  std::vector<NodeInfo> GetNodes() const;
+  // Returns false if peer_id doesn't have a row in the group matrix.
+  bool GetMatrixRow(const NodeId& peer_id, std::vector<NodeInfo>& row);
   bool IsConnected(const NodeId& node_id);
   // Returns default-constructed NodeId if routing table size is zero
   NodeInfo GetClosestNode(const NodeId& target_id, bool ignore_exact_match = false);
@@ -114,14 +135,20 @@ class RoutingTable {
   std::vector<NodeInfo> GetClosestMatrixNodes(const NodeId& target_id, uint16_t number_to_get);
   std::vector<NodeId> GetGroup(const NodeId& target_id);
   NodeInfo GetRemovableNode(std::vector<std::string> attempted = std::vector<std::string>());
+  // Folds a round trip time measured to a peer into that peer's smoothed round trip time.
+  void UpdateRoundTripTime(const NodeId& node_id, std::chrono::microseconds round_trip_time);
   void GetNodesNeedingGroupUpdates(std::vector<NodeInfo>& nodes_needing_update);
   size_t size() const;
-  uint16_t kThresholdSize() const { return kThresholdSize_; }
+  // Target for this table, adapted to the current network size estimate for a vault.
+  RoutingTableTarget target() const;
+  // Target for a vault's table in this network, e.g. to size the close ids sent to a vault peer.
+  RoutingTableTarget vault_target() const;
   NodeId kNodeId() const { return kNodeId_; }
   asymm::PrivateKey kPrivateKey() const { return kKeys_.private_key; }
   asymm::PublicKey kPublicKey() const { return kKeys_.public_key; }
   NodeId kConnectionId() const { return kConnectionId_; }
   bool client_mode() const { return kClientMode_; }
+  Metrics& metrics() { return metrics_; }
 
   friend class test::GenericNode;
   friend class GroupChangeHandler;
@@ -139,31 +166,35 @@ class RoutingTable {
   bool AddOrCheckNode(NodeInfo node, bool remove,
                       const std::vector<NodeInfo>& matrix_update = std::vector<NodeInfo>());
   void SetBucketIndex(NodeInfo& node_info) const;
-  bool CheckPublicKeyIsUnique(const NodeInfo& node, std::unique_lock<std::mutex>& lock) const;
+  bool CheckPublicKeyIsUnique(const NodeInfo& node,
+                              std::unique_lock<InstrumentedMutex>& lock) const;
   NodeInfo ResolveConnectionDuplication(const NodeInfo& new_duplicate_node, bool local_endpoint,
                                         NodeInfo& existing_node);
   std::shared_ptr<MatrixChange> UpdateCloseNodeChange(
-      std::unique_lock<std::mutex>& lock, const NodeInfo& peer,
+      std::unique_lock<InstrumentedMutex>& lock, const NodeInfo& peer,
       std::vector<NodeInfo>& new_connected_nodes,
       const std::vector<NodeInfo>& matrix_update = std::vector<NodeInfo>());
   bool MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove, NodeInfo& removed_node,
-                                 std::unique_lock<std::mutex>& lock);
+                                 const RoutingTableTarget& target,
+                                 std::unique_lock<InstrumentedMutex>& lock);
   uint16_t PartialSortFromTarget(const NodeId& target, uint16_t number,
-                                 std::unique_lock<std::mutex>& lock);
+                                 std::unique_lock<InstrumentedMutex>& lock);
   void NthElementSortFromTarget(const NodeId& target, uint16_t nth_element,
-                                std::unique_lock<std::mutex>& lock);
+                                std::unique_lock<InstrumentedMutex>& lock);
   NodeId FurthestCloseNode();
+  NodeInfo GetLowestLatencyNode(const NodeId& target_id, const std::vector<std::string>& exclude,
+                                bool ignore_exact_match, const NodeInfo& closest_peer);
   std::vector<NodeInfo> GetClosestNodeInfo(const NodeId& target_id, uint16_t number_to_get,
                                            bool ignore_exact_match = false);
   std::pair<bool, std::vector<NodeInfo>::iterator> Find(const NodeId& node_id,
-                                                        std::unique_lock<std::mutex>& lock);
+                                                        std::unique_lock<InstrumentedMutex>& lock);
   std::pair<bool, std::vector<NodeInfo>::const_iterator> Find(
-      const NodeId& node_id, std::unique_lock<std::mutex>& lock) const;
+      const NodeId& node_id, std::unique_lock<InstrumentedMutex>& lock) const;
   void UpdateNetworkStatus(uint16_t size) const;
   void UpdateConnectedPeersMatrix(const std::vector<NodeInfo>& new_connected_peers,
                                   const std::vector<NodeInfo>& old_connected_peers);
 
-  void IpcSendGroupMatrix() const;
+  void PublishGroupMatrix() const;
   std::string PrintRoutingTable();
   void PrintGroupMatrix();
 
@@ -171,9 +202,7 @@ class RoutingTable {
   const NodeId kNodeId_;
   const NodeId kConnectionId_;
   const asymm::Keys kKeys_;
-  const uint16_t kMaxSize_;
-  const uint16_t kThresholdSize_;
-  mutable std::mutex mutex_;
+  mutable InstrumentedMutex mutex_;
   NodeId furthest_closest_node_id_;
   std::function<void(const NodeInfo&, bool)> remove_node_functor_;
   NetworkStatusFunctor network_status_functor_;
@@ -182,8 +211,9 @@ class RoutingTable {
   MatrixChangedFunctor matrix_change_functor_;
   std::vector<NodeInfo> nodes_;
   GroupMatrix group_matrix_;
-  std::unique_ptr<boost::interprocess::message_queue> ipc_message_queue_;
+  std::shared_ptr<NetworkViewerPublisher> network_viewer_publisher_;
   NetworkStatistics& network_statistics_;
+  Metrics metrics_;
 };
 
 }  // namespace routing
@@ -0,0 +1,113 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/routing_table_snapshot.h"
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/utils.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+
+namespace routing {
+
+std::string SerialiseRoutingTableSnapshot(const RoutingTableSnapshot& snapshot) {
+  protobuf::RoutingTableSnapshot protobuf_snapshot;
+  protobuf_snapshot.set_node_id(snapshot.node_id.string());
+  for (const auto& peer : snapshot.peers) {
+    auto protobuf_peer(protobuf_snapshot.add_peers());
+    protobuf_peer->set_node_id(peer.node_info.node_id.string());
+    protobuf_peer->set_connection_id(peer.node_info.connection_id.string());
+    if (asymm::ValidateKey(peer.node_info.public_key))
+      protobuf_peer->set_public_key(asymm::EncodeKey(peer.node_info.public_key)->string());
+    if (!peer.endpoint.address().is_unspecified())
+      SetProtobufEndpoint(peer.endpoint, protobuf_peer->mutable_endpoint());
+    for (const auto& node_info : peer.matrix_row) {
+      auto basic_node_info(protobuf_peer->add_matrix_row());
+      basic_node_info->set_node_id(node_info.node_id.string());
+      basic_node_info->set_rank(node_info.rank);
+    }
+  }
+  std::string serialised_snapshot;
+  if (!protobuf_snapshot.SerializeToString(&serialised_snapshot)) {
+    LOG(kError) << "Failed to serialise routing table snapshot.";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::serialisation_error));
+  }
+  return serialised_snapshot;
+}
+
+RoutingTableSnapshot ParseRoutingTableSnapshot(const std::string& serialised_snapshot) {
+  protobuf::RoutingTableSnapshot protobuf_snapshot;
+  if (!protobuf_snapshot.ParseFromString(serialised_snapshot)) {
+    LOG(kError) << "Could not parse routing table snapshot.";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  }
+  RoutingTableSnapshot snapshot;
+  snapshot.node_id = NodeId(protobuf_snapshot.node_id());
+  for (const auto& protobuf_peer : protobuf_snapshot.peers()) {
+    RoutingTableSnapshot::Peer peer;
+    peer.node_info.node_id = NodeId(protobuf_peer.node_id());
+    peer.node_info.connection_id = NodeId(protobuf_peer.connection_id());
+    if (protobuf_peer.has_public_key()) {
+      peer.node_info.public_key = asymm::DecodeKey(
+          asymm::EncodedPublicKey(NonEmptyString(protobuf_peer.public_key())));
+    }
+    if (protobuf_peer.has_endpoint())
+      peer.endpoint = GetEndpointFromProtobuf(protobuf_peer.endpoint());
+    for (const auto& basic_node_info : protobuf_peer.matrix_row()) {
+      NodeInfo node_info;
+      node_info.node_id = NodeId(basic_node_info.node_id());
+      node_info.rank = basic_node_info.rank();
+      peer.matrix_row.push_back(node_info);
+    }
+    snapshot.peers.push_back(peer);
+  }
+  return snapshot;
+}
+
+RoutingTableSnapshot ReadRoutingTableSnapshot(const fs::path& snapshot_file_path) {
+  return ParseRoutingTableSnapshot(ReadFile(snapshot_file_path).string());
+}
+
+void WriteRoutingTableSnapshot(const RoutingTableSnapshot& snapshot,
+                               const fs::path& snapshot_file_path) {
+  // Write to a temporary file first so that a crash mid-write can't leave a truncated snapshot.
+  fs::path temp_path(snapshot_file_path.string() + ".tmp");
+  boost::system::error_code error_code;
+  if (!WriteFile(temp_path, SerialiseRoutingTableSnapshot(snapshot))) {
+    LOG(kError) << "Could not write routing table snapshot at : " << temp_path;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  fs::rename(temp_path, snapshot_file_path, error_code);
+  if (error_code) {
+    LOG(kError) << "Could not move routing table snapshot to " << snapshot_file_path << " : "
+                << error_code.message();
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
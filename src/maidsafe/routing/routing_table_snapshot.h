@@ -0,0 +1,65 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_ROUTING_TABLE_SNAPSHOT_H_
+#define MAIDSAFE_ROUTING_ROUTING_TABLE_SNAPSHOT_H_
+
+#include <string>
+#include <vector>
+
+#include "boost/asio/ip/udp.hpp"
+#include "boost/filesystem/path.hpp"
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/node_info.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// The last known contents of a node's routing table, used to reconnect to the same peers after a
+// restart rather than rebuilding the table from a single bootstrap connection.
+struct RoutingTableSnapshot {
+  struct Peer {
+    Peer() : node_info(), endpoint(), matrix_row() {}
+    NodeInfo node_info;
+    // Unspecified if the peer's endpoint wasn't known.
+    boost::asio::ip::udp::endpoint endpoint;
+    // The peer's row of the group matrix, excluding the peer itself.
+    std::vector<NodeInfo> matrix_row;
+  };
+
+  RoutingTableSnapshot() : node_id(), peers() {}
+  NodeId node_id;
+  std::vector<Peer> peers;
+};
+
+std::string SerialiseRoutingTableSnapshot(const RoutingTableSnapshot& snapshot);
+RoutingTableSnapshot ParseRoutingTableSnapshot(const std::string& serialised_snapshot);
+
+RoutingTableSnapshot ReadRoutingTableSnapshot(const boost::filesystem::path& snapshot_file_path);
+
+void WriteRoutingTableSnapshot(const RoutingTableSnapshot& snapshot,
+                               const boost::filesystem::path& snapshot_file_path);
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_ROUTING_TABLE_SNAPSHOT_H_
@@ -34,15 +34,17 @@ namespace routing {
 namespace rpcs {
 
 // This is maybe not required and might be removed
-protobuf::Message Ping(const NodeId& node_id, const std::string& identity) {
+protobuf::Message Ping(const NodeId& node_id, const std::string& identity,
+                       const std::string& cache_summary) {
   assert(!node_id.IsZero() && "Invalid node_id");
   assert(!identity.empty() && "Invalid identity");
   protobuf::Message message;
   protobuf::PingRequest ping_request;
   ping_request.set_ping(true);
-#ifdef TESTING
+  if (!cache_summary.empty())
+    ping_request.set_cache_summary(cache_summary);
+  // Returned in the response's original_request to measure the round trip time.
   ping_request.set_timestamp(GetTimeStamp());
-#endif
   message.set_destination_id(node_id.string());
   message.set_source_id(identity);
   message.set_routing_message(true);
@@ -168,9 +170,29 @@ protobuf::Message FindNodes(const NodeId& node_id, const NodeId& this_node_id,
   return message;
 }
 
+protobuf::Message IterativeFindNodes(const NodeId& peer_id, const NodeId& target_id,
+                                     const NodeId& this_node_id, int num_nodes_requested,
+                                     TaskId task_id, bool relay_message,
+                                     NodeId relay_connection_id) {
+  assert(!peer_id.IsZero() && "Invalid peer_id");
+  protobuf::Message message(FindNodes(target_id, this_node_id, num_nodes_requested,
+                                      relay_message, relay_connection_id));
+  protobuf::FindNodesRequest find_nodes;
+  find_nodes.ParseFromString(message.data(0));
+  find_nodes.set_lookup(true);
+  message.set_data(0, find_nodes.SerializeAsString());
+  message.set_destination_id(peer_id.string());
+  // A query to the target itself is answered by whichever node is closest to it.
+  message.set_direct(peer_id != target_id);
+  message.set_id(task_id);
+  assert(message.IsInitialized() && "Unintialised message");
+  return message;
+}
+
 protobuf::Message ConnectSuccess(const NodeId& node_id, const NodeId& this_node_id,
                                  const NodeId& this_connection_id, bool requestor,
-                                 bool client_node) {
+                                 bool client_node, bool pipelined,
+                                 const std::vector<NodeId>& close_ids) {
   assert(!node_id.IsZero() && "Invalid node_id");
   assert(!this_node_id.IsZero() && "Invalid my node_id");
   assert(!this_connection_id.IsZero() && "Invalid this_connection_id");
@@ -179,6 +201,11 @@ protobuf::Message ConnectSuccess(const NodeId& node_id, const NodeId& this_node_
   protobuf_connect_success.set_node_id(this_node_id.string());
   protobuf_connect_success.set_connection_id(this_connection_id.string());
   protobuf_connect_success.set_requestor(requestor);
+  if (pipelined) {
+    protobuf_connect_success.set_pipelined(true);
+    for (const auto& close_id : close_ids)
+      protobuf_connect_success.add_close_ids(close_id.string());
+  }
   message.set_destination_id(node_id.string());
   message.set_routing_message(true);
   message.add_data(protobuf_connect_success.SerializeAsString());
@@ -29,6 +29,7 @@
 #include "maidsafe/rudp/managed_connections.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/timer.h"
 
 namespace maidsafe {
 
@@ -40,7 +41,9 @@ class Message;
 
 namespace rpcs {
 
-protobuf::Message Ping(const NodeId& node_id, const std::string& identity);
+// cache_summary, if not empty, is a serialised BloomFilter of this node's cached chunk keys.
+protobuf::Message Ping(const NodeId& node_id, const std::string& identity,
+                       const std::string& cache_summary = std::string());
 
 protobuf::Message Connect(const NodeId& node_id, const rudp::EndpointPair& our_endpoint,
                           const NodeId& this_node_id, const NodeId& this_connection_id,
@@ -56,13 +59,21 @@ protobuf::Message FindNodes(const NodeId& node_id, const NodeId& this_node_id,
                             int num_nodes_requested, bool relay_message = false,
                             NodeId relay_connection_id = NodeId());
 
+// Request sent directly to peer_id as one step of an iterative lookup for target_id.  The response
+// carries task_id as its message id.
+protobuf::Message IterativeFindNodes(const NodeId& peer_id, const NodeId& target_id,
+                                     const NodeId& this_node_id, int num_nodes_requested,
+                                     TaskId task_id, bool relay_message = false,
+                                     NodeId relay_connection_id = NodeId());
+
 protobuf::Message ProxyConnect(const NodeId& node_id, const NodeId& this_node_id,
                                const rudp::EndpointPair& endpoint_pair, bool relay_message = false,
                                NodeId relay_connection_id = NodeId());
 
 protobuf::Message ConnectSuccess(const NodeId& node_id, const NodeId& this_node_id,
                                  const NodeId& this_connection_id, bool requestor,
-                                 bool client_node);
+                                 bool client_node, bool pipelined = false,
+                                 const std::vector<NodeId>& close_ids = std::vector<NodeId>());
 
 protobuf::Message ConnectSuccessAcknowledgement(const NodeId& node_id, const NodeId& this_node_id,
                                                 const NodeId& this_connection_id,
@@ -54,7 +54,8 @@ Service::Service(RoutingTable& routing_table, ClientRoutingTable& client_routing
     : routing_table_(routing_table),
       client_routing_table_(client_routing_table),
       network_(network),
-      request_public_key_functor_() {}
+      request_public_key_functor_(),
+      cache_summary_functor_() {}
 
 Service::~Service() {}
 
@@ -72,9 +73,16 @@ void Service::Ping(protobuf::Message& message) {
     LOG(kError) << "No Data.";
     return;
   }
+  if (ping_request.has_cache_summary())
+    network_.UpdatePeerCacheSummary(NodeId(message.source_id()), ping_request.cache_summary());
   ping_response.set_pong(true);
   ping_response.set_original_request(message.data(0));
   ping_response.set_original_signature(message.signature());
+  if (cache_summary_functor_) {
+    std::string cache_summary(cache_summary_functor_());
+    if (!cache_summary.empty())
+      ping_response.set_cache_summary(cache_summary);
+  }
 #ifdef TESTING
   ping_response.set_timestamp(GetTimeStamp());
 #endif
@@ -192,9 +200,19 @@ void Service::Connect(protobuf::Message& message) {
             !this_endpoint_pair.local.address().is_unspecified()) &&
            "Unspecified endpoint after GetAvailableEndpoint success.");
 
+    // In a pipelined handshake the requestor receives these with this node's ConnectSuccess.
+    std::vector<NodeId> close_ids_for_peer;
+    if (Parameters::pipelined_connect_handshake) {
+      close_ids_for_peer = routing_table_.GetClosestNodes(
+          peer_node.node_id, message.client_node() ? Parameters::max_routing_table_size_for_client
+                                                   : routing_table_.vault_target().max_size);
+      close_ids_for_peer.erase(std::remove(close_ids_for_peer.begin(), close_ids_for_peer.end(),
+                                           peer_node.node_id),
+                               close_ids_for_peer.end());
+    }
     int add_result(AddToRudp(network_, routing_table_.kNodeId(), routing_table_.kConnectionId(),
                              peer_node.node_id, peer_node.connection_id, peer_endpoint_pair, false,
-                             routing_table_.client_mode()));
+                             routing_table_.client_mode(), close_ids_for_peer));
     if (rudp::kSuccess == add_result) {
       connect_response.set_answer(protobuf::ConnectResponseType::kAccepted);
 
@@ -246,6 +264,21 @@ void Service::FindNodes(protobuf::Message& message) {
 
   for (const auto& node : nodes)
     found_nodes.add_nodes(node.string());
+  // Include the endpoints of connected peers, so the requester can start connecting to them
+  // without waiting for their responses to its Connect requests.
+  for (const auto& node : nodes) {
+    NodeInfo node_info;
+    if (!routing_table_.GetNodeInfo(node, node_info))
+      continue;
+    Endpoint endpoint(network_.PeerEndpoint(node_info.connection_id));
+    if (endpoint.address().is_unspecified())
+      continue;
+    protobuf::Contact* contact(found_nodes.add_contacts());
+    contact->set_node_id(node.string());
+    contact->set_connection_id(node_info.connection_id.string());
+    SetProtobufEndpoint(Endpoint(), contact->mutable_private_endpoint());
+    SetProtobufEndpoint(endpoint, contact->mutable_public_endpoint());
+  }
 
   LOG(kVerbose) << "Responding Find node with " << found_nodes.nodes_size() << " contacts.";
 
@@ -308,7 +341,8 @@ void Service::ConnectSuccessFromResponder(NodeInfo& peer, bool client) {
     return;
   }
   auto count =
-      (client ? Parameters::max_routing_table_size_for_client : Parameters::greedy_fraction);
+      (client ? Parameters::max_routing_table_size_for_client
+              : routing_table_.vault_target().greedy_size);
   std::vector<NodeId> close_ids_for_peer(routing_table_.GetClosestNodes(peer.node_id, count));
 
   auto itr(std::find_if(close_ids_for_peer.begin(), close_ids_for_peer.end(),
@@ -355,6 +389,10 @@ RequestPublicKeyFunctor Service::request_public_key_functor() const {
   return request_public_key_functor_;
 }
 
+void Service::set_cache_summary_functor(CacheSummaryFunctor cache_summary_functor) {
+  cache_summary_functor_ = cache_summary_functor;
+}
+
 }  // namespace routing
 
 }  // namespace maidsafe
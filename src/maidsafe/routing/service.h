@@ -19,7 +19,9 @@
 #ifndef MAIDSAFE_ROUTING_SERVICE_H_
 #define MAIDSAFE_ROUTING_SERVICE_H_
 
+#include <functional>
 #include <memory>
+#include <string>
 
 #include "maidsafe/routing/api_config.h"
 
@@ -35,6 +37,9 @@ class NetworkUtils;
 class ClientRoutingTable;
 class RoutingTable;
 
+// Returns a serialised summary of this node's cached chunks, or an empty string if there is none.
+typedef std::function<std::string()> CacheSummaryFunctor;
+
 class Service {
  public:
   Service(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
@@ -48,6 +53,7 @@ class Service {
   virtual void GetGroup(protobuf::Message& message);
   void set_request_public_key_functor(RequestPublicKeyFunctor request_public_key);
   RequestPublicKeyFunctor request_public_key_functor() const;
+  void set_cache_summary_functor(CacheSummaryFunctor cache_summary_functor);
 
  private:
   void ConnectSuccessFromRequester(NodeInfo& peer);
@@ -58,6 +64,7 @@ class Service {
   ClientRoutingTable& client_routing_table_;
   NetworkUtils& network_;
   RequestPublicKeyFunctor request_public_key_functor_;
+  CacheSummaryFunctor cache_summary_functor_;
 };
 
 }  // namespace routing
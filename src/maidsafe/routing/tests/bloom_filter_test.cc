@@ -0,0 +1,63 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <string>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/bloom_filter.h"
+
+namespace maidsafe {
+namespace routing {
+namespace test {
+
+TEST(BloomFilterTest, BEH_AddAndQuery) {
+  BloomFilter filter(BloomFilter::ForEntries(100));
+  EXPECT_TRUE(filter.empty());
+  EXPECT_FALSE(filter.ProbablyContains("key"));
+  for (int i(0); i != 100; ++i)
+    filter.Add("key" + std::to_string(i));
+  EXPECT_FALSE(filter.empty());
+  for (int i(0); i != 100; ++i)
+    EXPECT_TRUE(filter.ProbablyContains("key" + std::to_string(i)));
+  int false_positives(0);
+  for (int i(0); i != 10000; ++i) {
+    if (filter.ProbablyContains("other" + std::to_string(i)))
+      ++false_positives;
+  }
+  EXPECT_LT(false_positives, 300);
+}
+
+TEST(BloomFilterTest, BEH_Serialise) {
+  BloomFilter filter(1000, 5);
+  filter.Add("a");
+  filter.Add("b");
+  BloomFilter parsed(filter.Serialise());
+  EXPECT_TRUE(parsed.ProbablyContains("a"));
+  EXPECT_TRUE(parsed.ProbablyContains("b"));
+  EXPECT_EQ(filter.Serialise(), parsed.Serialise());
+
+  std::string serialised(filter.Serialise());
+  EXPECT_THROW(BloomFilter(serialised.substr(0, serialised.size() - 1)), std::exception);
+  EXPECT_THROW(BloomFilter(std::string("abc")), std::exception);
+}
+
+}  // namespace test
+}  // namespace routing
+}  // namespace maidsafe
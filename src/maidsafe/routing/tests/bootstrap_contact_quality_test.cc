@@ -0,0 +1,158 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/bootstrap_contact_quality.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+BootstrapContacts MakeContacts(size_t count) {
+  BootstrapContacts contacts;
+  for (size_t i(0); i != count; ++i)
+    contacts.push_back(BootstrapContact(GetLocalIp(), maidsafe::test::GetRandomPort()));
+  return contacts;
+}
+
+}  // unnamed namespace
+
+TEST(BootstrapContactQualityTest, BEH_Order) {
+  BootstrapContactQuality quality;
+  BootstrapContacts contacts(MakeContacts(5));
+  EXPECT_EQ(contacts, quality.Order(contacts));
+
+  // 0 always fails, 1 is unknown, 2 and 3 succeed with 3 faster, 4 usually fails.
+  quality.RecordFailure(contacts[0]);
+  quality.RecordFailure(contacts[0]);
+  quality.RecordSuccess(contacts[2], std::chrono::milliseconds(200));
+  quality.RecordSuccess(contacts[3], std::chrono::milliseconds(20));
+  quality.RecordSuccess(contacts[4], std::chrono::milliseconds(10));
+  quality.RecordFailure(contacts[4]);
+  quality.RecordFailure(contacts[4]);
+  BootstrapContacts expected;
+  expected.push_back(contacts[3]);
+  expected.push_back(contacts[2]);
+  expected.push_back(contacts[1]);
+  expected.push_back(contacts[4]);
+  expected.push_back(contacts[0]);
+  EXPECT_EQ(expected, quality.Order(contacts));
+
+  // After a week without a successful connect, contacts rank as unknown.
+  auto next_month(std::chrono::system_clock::now() + std::chrono::hours(24 * 30));
+  expected.clear();
+  expected.push_back(contacts[1]);
+  expected.push_back(contacts[2]);
+  expected.push_back(contacts[3]);
+  expected.push_back(contacts[4]);
+  expected.push_back(contacts[0]);
+  EXPECT_EQ(expected, quality.Order(contacts, next_month));
+}
+
+TEST(BootstrapContactQualityTest, BEH_SaveAndLoad) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestUtils"));
+  fs::path file_path(*test_path / "bootstrap.quality");
+  BootstrapContacts contacts(MakeContacts(3));
+  BootstrapContactQuality quality;
+  quality.RecordFailure(contacts[0]);
+  quality.RecordSuccess(contacts[1], std::chrono::milliseconds(50));
+  quality.RecordSuccess(contacts[2], std::chrono::milliseconds(5));
+  quality.Save(file_path);
+
+  BootstrapContactQuality loaded_quality;
+  loaded_quality.Load(file_path);
+  EXPECT_EQ(quality.Order(contacts), loaded_quality.Order(contacts));
+  EXPECT_EQ(contacts[2], loaded_quality.Order(contacts).front());
+
+  // Missing or corrupt files leave the store empty
+  BootstrapContactQuality empty_quality;
+  empty_quality.Load(*test_path / "missing");
+  ASSERT_TRUE(WriteFile(file_path, RandomString(100)));
+  empty_quality.Load(file_path);
+  EXPECT_EQ(contacts, empty_quality.Order(contacts));
+}
+
+TEST(BootstrapContactQualityTest, BEH_ProbeSkipsDeadContacts) {
+  // The first two contacts never answer, only failing after a long timeout.
+  const std::chrono::milliseconds kDeadTimeout(2000), kStagger(50);
+  BootstrapContacts contacts(MakeContacts(4));
+  BootstrapContactQuality quality;
+  std::vector<std::future<void>> outstanding_probes;
+  std::atomic<int> probe_count(0);
+  std::function<bool(const BootstrapContact&)> probe([&](const BootstrapContact& contact) {
+    ++probe_count;
+    if (contact == contacts[0] || contact == contacts[1]) {
+      std::this_thread::sleep_for(kDeadTimeout);
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return true;
+  });
+  auto start(std::chrono::steady_clock::now());
+  EXPECT_EQ(contacts[2], ProbeBootstrapContacts(contacts, 3, kStagger, probe, quality,
+                                                outstanding_probes));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, kDeadTimeout / 2);
+  EXPECT_EQ(3, probe_count);
+  EXPECT_EQ(2U, outstanding_probes.size());
+  for (auto& outstanding_probe : outstanding_probes)
+    outstanding_probe.get();
+  auto ordered(quality.Order(contacts));
+  EXPECT_EQ(contacts[2], ordered[0]);
+  EXPECT_EQ(contacts[3], ordered[1]);
+
+  // A failed probe starts the next one without waiting for the stagger, and finished probes are
+  // reaped
+  probe = [&](const BootstrapContact& contact) { return contact == contacts[3]; };
+  start = std::chrono::steady_clock::now();
+  EXPECT_EQ(contacts[3], ProbeBootstrapContacts(contacts, 1, kDeadTimeout, probe, quality,
+                                                outstanding_probes));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, kDeadTimeout / 2);
+  EXPECT_TRUE(outstanding_probes.empty());
+
+  // None answer
+  probe = [](const BootstrapContact&) { return false; };
+  outstanding_probes.clear();
+  EXPECT_TRUE(ProbeBootstrapContacts(contacts, 2, kStagger, probe, quality, outstanding_probes)
+                  .address().is_unspecified());
+  EXPECT_TRUE(outstanding_probes.empty());
+  EXPECT_TRUE(ProbeBootstrapContacts(BootstrapContacts(), 2, kStagger, probe, quality,
+                                     outstanding_probes).address().is_unspecified());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
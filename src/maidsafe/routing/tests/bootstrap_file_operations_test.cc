@@ -16,6 +16,8 @@
     See the Licences for the specific language governing permissions and limitations relating to
     use of the MaidSafe Software.                                                                 */
 
+#include <algorithm>
+#include <string>
 #include <vector>
 
 #include "boost/filesystem/operations.hpp"
@@ -32,6 +34,16 @@ namespace maidsafe {
 namespace routing {
 namespace test {
 
+namespace {
+
+// Random ports may repeat, which would make adding a contact a no-op.
+BootstrapContact UniqueBootstrapContact() {
+  static uint16_t port(maidsafe::test::GetRandomPort() % 1000 + 1025);
+  return BootstrapContact(maidsafe::GetLocalIp(), port++);
+}
+
+}  // unnamed namespace
+
 TEST(BootstrapFileOperationsTest, BEH_ReadWriteUpdate) {
   maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestUtils"));
   fs::path bootstrap_file_path(*test_path / "bootstrap");
@@ -43,7 +55,7 @@ TEST(BootstrapFileOperationsTest, BEH_ReadWriteUpdate) {
   // Write
   BootstrapContacts expected_bootstrap_contacts;
   for (int i(0); i < 100; ++i) {
-    BootstrapContact bootstrap_contact(maidsafe::GetLocalIp(), maidsafe::test::GetRandomPort());
+    BootstrapContact bootstrap_contact(UniqueBootstrapContact());
     bootstrap_contacts.push_back(bootstrap_contact);
     expected_bootstrap_contacts.insert(std::begin(expected_bootstrap_contacts), bootstrap_contact);
     EXPECT_NO_THROW(WriteBootstrapFile(bootstrap_contacts, bootstrap_file_path));
@@ -55,7 +67,7 @@ TEST(BootstrapFileOperationsTest, BEH_ReadWriteUpdate) {
 
   // Update add
   for (int i(0); i < 100; ++i) {
-    BootstrapContact bootstrap_contact(maidsafe::GetLocalIp(), maidsafe::test::GetRandomPort());
+    BootstrapContact bootstrap_contact(UniqueBootstrapContact());
     bootstrap_contacts.push_back(bootstrap_contact);
     expected_bootstrap_contacts.insert(std::begin(expected_bootstrap_contacts), bootstrap_contact);
     EXPECT_NO_THROW(UpdateBootstrapFile(bootstrap_contact, bootstrap_file_path, false));
@@ -66,7 +78,130 @@ TEST(BootstrapFileOperationsTest, BEH_ReadWriteUpdate) {
   }
 
   // Update remove
-  // TODO(Prakash)
+  for (int i(0); i < 100; i += 2) {
+    EXPECT_NO_THROW(UpdateBootstrapFile(expected_bootstrap_contacts.at(i / 2), bootstrap_file_path,
+                                        true));
+    expected_bootstrap_contacts.erase(std::begin(expected_bootstrap_contacts) + i / 2);
+    auto actual_bootstrap_contacts = ReadBootstrapFile(bootstrap_file_path);
+    ASSERT_EQ(expected_bootstrap_contacts.size(), actual_bootstrap_contacts.size());
+    EXPECT_TRUE(std::equal(actual_bootstrap_contacts.begin(),
+                           actual_bootstrap_contacts.end(),
+                           expected_bootstrap_contacts.begin()));
+  }
+
+  // Redundant updates write nothing
+  fs::path journal_path(BootstrapJournalPath(bootstrap_file_path));
+  uintmax_t journal_size(fs::exists(journal_path) ? fs::file_size(journal_path) : 0);
+  BootstrapContact missing_contact(UniqueBootstrapContact());
+  EXPECT_NO_THROW(UpdateBootstrapFile(missing_contact, bootstrap_file_path, true));
+  EXPECT_NO_THROW(UpdateBootstrapFile(expected_bootstrap_contacts.front(), bootstrap_file_path,
+                                      false));
+  EXPECT_EQ(journal_size, fs::exists(journal_path) ? fs::file_size(journal_path) : 0);
+  EXPECT_EQ(expected_bootstrap_contacts, ReadBootstrapFile(bootstrap_file_path));
+  EXPECT_THROW(UpdateBootstrapFile(BootstrapContact(), bootstrap_file_path, false),
+               std::exception);
+
+  // Rewriting discards the journal
+  EXPECT_NO_THROW(WriteBootstrapFile(BootstrapContacts(), bootstrap_file_path));
+  EXPECT_FALSE(fs::exists(BootstrapJournalPath(bootstrap_file_path)));
+  EXPECT_TRUE(ReadBootstrapFile(bootstrap_file_path).empty());
+}
+
+TEST(BootstrapFileOperationsTest, BEH_JournalCompaction) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestUtils"));
+  fs::path bootstrap_file_path(*test_path / "bootstrap");
+  fs::path journal_path(BootstrapJournalPath(bootstrap_file_path));
+  EXPECT_NO_THROW(WriteBootstrapFile(BootstrapContacts(), bootstrap_file_path));
+  BootstrapContacts expected_bootstrap_contacts;
+  uintmax_t largest_journal_size(0);
+  bool compacted(false);
+  // Churn: add contacts, removing the oldest once there are 50.
+  for (int i(0); i < 500; ++i) {
+    BootstrapContact bootstrap_contact(UniqueBootstrapContact());
+    expected_bootstrap_contacts.insert(std::begin(expected_bootstrap_contacts), bootstrap_contact);
+    EXPECT_NO_THROW(UpdateBootstrapFile(bootstrap_contact, bootstrap_file_path, false));
+    if (expected_bootstrap_contacts.size() > 50) {
+      EXPECT_NO_THROW(UpdateBootstrapFile(expected_bootstrap_contacts.back(), bootstrap_file_path,
+                                          true));
+      expected_bootstrap_contacts.pop_back();
+    }
+    uintmax_t journal_size(fs::exists(journal_path) ? fs::file_size(journal_path) : 0);
+    if (journal_size < largest_journal_size)
+      compacted = true;
+    largest_journal_size = std::max(largest_journal_size, journal_size);
+    // The journal never holds more records than the base holds contacts, beyond a small minimum.
+    EXPECT_GE(std::max(expected_bootstrap_contacts.size(), size_t(64)),
+              BootstrapFile(bootstrap_file_path).journal_record_count());
+  }
+  EXPECT_TRUE(compacted);
+  EXPECT_EQ(expected_bootstrap_contacts, ReadBootstrapFile(bootstrap_file_path));
+}
+
+TEST(BootstrapFileOperationsTest, BEH_JournalTornRecord) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestUtils"));
+  fs::path bootstrap_file_path(*test_path / "bootstrap");
+  BootstrapContacts bootstrap_contacts(
+      1, UniqueBootstrapContact());
+  // A file written without a journal is read as it stands.
+  EXPECT_NO_THROW(WriteBootstrapFile(bootstrap_contacts, bootstrap_file_path));
+  EXPECT_EQ(bootstrap_contacts, ReadBootstrapFile(bootstrap_file_path));
+
+  BootstrapContact bootstrap_contact(UniqueBootstrapContact());
+  EXPECT_NO_THROW(UpdateBootstrapFile(bootstrap_contact, bootstrap_file_path, false));
+  bootstrap_contacts.insert(std::begin(bootstrap_contacts), bootstrap_contact);
+  // Simulate a crash part way through appending a further record.
+  std::string journal;
+  ASSERT_TRUE(ReadFile(BootstrapJournalPath(bootstrap_file_path), &journal));
+  ASSERT_TRUE(WriteFile(BootstrapJournalPath(bootstrap_file_path),
+                        journal + journal.substr(0, journal.size() - 3)));
+  EXPECT_EQ(bootstrap_contacts, ReadBootstrapFile(bootstrap_file_path));
+  // Reading truncated the torn record, so later updates aren't hidden behind it.
+  EXPECT_EQ(journal.size(), fs::file_size(BootstrapJournalPath(bootstrap_file_path)));
+  bootstrap_contact = UniqueBootstrapContact();
+  EXPECT_NO_THROW(UpdateBootstrapFile(bootstrap_contact, bootstrap_file_path, false));
+  bootstrap_contacts.insert(std::begin(bootstrap_contacts), bootstrap_contact);
+  EXPECT_EQ(bootstrap_contacts, ReadBootstrapFile(bootstrap_file_path));
+  EXPECT_EQ(2U, BootstrapFile(bootstrap_file_path).journal_record_count());
+
+  // A complete record whose contents were corrupted is also detected by its checksum.
+  ASSERT_TRUE(ReadFile(BootstrapJournalPath(bootstrap_file_path), &journal));
+  journal[journal.size() - 1] ^= 0x01;
+  ASSERT_TRUE(WriteFile(BootstrapJournalPath(bootstrap_file_path), journal));
+  bootstrap_contacts.erase(std::begin(bootstrap_contacts));
+  EXPECT_EQ(bootstrap_contacts, ReadBootstrapFile(bootstrap_file_path));
+  EXPECT_EQ(1U, BootstrapFile(bootstrap_file_path).journal_record_count());
+}
+
+TEST(BootstrapFileOperationsTest, BEH_BootstrapFile) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestUtils"));
+  fs::path bootstrap_file_path(*test_path / "bootstrap");
+  BootstrapContacts expected_bootstrap_contacts;
+  {
+    BootstrapFile bootstrap_file(bootstrap_file_path);
+    EXPECT_TRUE(bootstrap_file.Contacts().empty());
+    for (int i(0); i < 200; ++i) {
+      BootstrapContact bootstrap_contact(UniqueBootstrapContact());
+      EXPECT_TRUE(bootstrap_file.Add(bootstrap_contact));
+      EXPECT_FALSE(bootstrap_file.Add(bootstrap_contact));
+      EXPECT_TRUE(bootstrap_file.Contains(bootstrap_contact));
+      expected_bootstrap_contacts.insert(std::begin(expected_bootstrap_contacts),
+                                         bootstrap_contact);
+      EXPECT_LE(bootstrap_file.journal_record_count(), std::max(size_t(64), size_t(i + 1)));
+    }
+    EXPECT_TRUE(bootstrap_file.Remove(expected_bootstrap_contacts.back()));
+    EXPECT_FALSE(bootstrap_file.Remove(expected_bootstrap_contacts.back()));
+    EXPECT_FALSE(bootstrap_file.Contains(expected_bootstrap_contacts.back()));
+    expected_bootstrap_contacts.pop_back();
+    EXPECT_EQ(expected_bootstrap_contacts, bootstrap_file.Contacts());
+    EXPECT_THROW(bootstrap_file.Add(BootstrapContact()), std::exception);
+  }
+  EXPECT_EQ(expected_bootstrap_contacts, ReadBootstrapFile(bootstrap_file_path));
+  BootstrapFile bootstrap_file(bootstrap_file_path);
+  EXPECT_EQ(expected_bootstrap_contacts, bootstrap_file.Contacts());
+  bootstrap_file.Compact();
+  EXPECT_EQ(0U, bootstrap_file.journal_record_count());
+  EXPECT_FALSE(fs::exists(BootstrapJournalPath(bootstrap_file_path)));
+  EXPECT_EQ(expected_bootstrap_contacts, ReadBootstrapFile(bootstrap_file_path));
 }
 
 }  // namespace test
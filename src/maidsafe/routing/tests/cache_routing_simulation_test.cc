@@ -0,0 +1,227 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// In-process simulation of greedy XOR routing with on-path caching, measuring how many hops
+// cacheable GETs save when nodes use their peers' advertised cache summaries to pick a next hop.
+// Each node's next hop is chosen by its own RoutingTable and NetworkUtils::CacheAwareNextHop, as
+// in NetworkUtils::RecursiveSendOn.  Since the routing table's group matrix already takes most GETs
+// to the holder in one or two hops, the saving measured here is negligible, which is why
+// Parameters::cache_aware_routing_candidates defaults to zero.
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/bloom_filter.h"
+#include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/in_memory_transport.h"
+#include "maidsafe/routing/lru_cache.h"
+#include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/network_utils.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/tests/test_utils.h"
+
+namespace maidsafe {
+namespace routing {
+namespace test {
+
+namespace {
+
+struct SimulatedNode {
+  explicit SimulatedNode(const NodeInfo& node_info_in)
+      : node_info(node_info_in),
+        network_statistics(node_info.node_id),
+        routing_table(false, node_info.node_id, asymm::GenerateKeyPair(), network_statistics),
+        client_routing_table(node_info.node_id),
+        network(routing_table, client_routing_table),
+        cache(20, 1024 * 1024, 1) {}
+  NodeInfo node_info;
+  NetworkStatistics network_statistics;
+  RoutingTable routing_table;
+  ClientRoutingTable client_routing_table;
+  NetworkUtils network;
+  LruCache cache;
+};
+
+}  // unnamed namespace
+
+class CacheRoutingSimulation {
+ public:
+  CacheRoutingSimulation(size_t node_count, size_t item_count)
+      : in_memory_network_(NetworkConditions(), 1),
+        nodes_(),
+        items_(),
+        rng_(7),
+        redirects_(0),
+        redirect_hits_(0) {
+    // NetworkUtils is only used to choose next hops, so its transport never connects.
+    SetTransportFactory(in_memory_network_.transport_factory());
+    for (size_t i(0); i != node_count; ++i)
+      nodes_.push_back(std::unique_ptr<SimulatedNode>(new SimulatedNode(MakeNode())));
+    SetTransportFactory(nullptr);
+    for (size_t i(0); i != item_count; ++i)
+      items_.push_back(NodeId(NodeId::kRandomId));
+    for (auto& node : nodes_) {
+      for (const auto& peer : nodes_) {
+        if (peer != node)
+          node->routing_table.AddNode(peer->node_info);
+      }
+    }
+  }
+
+  // Returns the mean number of hops taken by request_count Zipf-distributed GETs.
+  double Run(bool cache_aware, size_t request_count, double zipf_exponent) {
+    redirects_ = redirect_hits_ = 0;
+    for (auto& node : nodes_) {
+      node->cache.Clear();
+      // Empty summaries advertise nothing, leaving the routing table's choice of next hop.
+      for (const auto& peer : nodes_) {
+        if (peer != node)
+          node->network.UpdatePeerCacheSummary(peer->node_info.node_id,
+                                               BloomFilter(8, 1).Serialise());
+      }
+    }
+    std::vector<double> weights;
+    for (size_t rank(1); rank <= items_.size(); ++rank)
+      weights.push_back(1.0 / std::pow(static_cast<double>(rank), zipf_exponent));
+    std::mt19937 rng(rng_);
+    std::discrete_distribution<size_t> item_distribution(weights.begin(), weights.end());
+    std::uniform_int_distribution<size_t> node_distribution(0, nodes_.size() - 1);
+    uint64_t total_hops(0);
+    for (size_t request(0); request != request_count; ++request) {
+      if (cache_aware && request % 100 == 0)
+        PublishSummaries();
+      total_hops += Get(node_distribution(rng), items_[item_distribution(rng)]);
+    }
+    return static_cast<double>(total_hops) / request_count;
+  }
+
+  // Number of hops for which CacheAwareNextHop chose a different peer than the routing table, and
+  // how many of those peers really held a cached copy.
+  size_t redirects() const { return redirects_; }
+  size_t redirect_hits() const { return redirect_hits_; }
+
+ private:
+  void PublishSummaries() {
+    for (auto& node : nodes_) {
+      BloomFilter summary(BloomFilter::ForEntries(20));
+      for (const auto& key : node->cache.Keys())
+        summary.Add(key);
+      const std::string kSerialisedSummary(summary.Serialise());
+      for (auto& peer : nodes_) {
+        if (peer != node)
+          peer->network.UpdatePeerCacheSummary(node->node_info.node_id, kSerialisedSummary);
+      }
+    }
+  }
+
+  SimulatedNode* Find(const NodeId& node_id) const {
+    for (const auto& node : nodes_) {
+      if (node->node_info.node_id == node_id)
+        return node.get();
+    }
+    return nullptr;
+  }
+
+  // Returns nullptr if 'current' is the closest node to the item it knows of, i.e. its holder.
+  SimulatedNode* NextHop(SimulatedNode& current, const protobuf::Message& message) {
+    const NodeId kTarget(message.destination_id());
+    NodeInfo peer(current.routing_table.GetNodeForSendingMessage(
+        kTarget, std::vector<std::string>()));
+    if (peer.node_id.IsZero() ||
+        !NodeId::CloserToTarget(peer.node_id, current.node_info.node_id, kTarget))
+      return nullptr;
+    NodeInfo chosen(current.network.CacheAwareNextHop(message, peer, std::vector<std::string>()));
+    SimulatedNode* next(Find(chosen.node_id));
+    if (next && chosen.node_id != peer.node_id) {
+      ++redirects_;
+      std::string value;
+      if (next->cache.Get(message.data(0), value))
+        ++redirect_hits_;
+    }
+    return next;
+  }
+
+  size_t Get(size_t source, const NodeId& item) {
+    protobuf::Message message;
+    message.set_destination_id(item.string());
+    message.add_data(item.string());
+    std::vector<SimulatedNode*> path;
+    SimulatedNode* current(nodes_[source].get());
+    size_t hops(0);
+    std::string value;
+    for (;;) {
+      SimulatedNode* next(NextHop(*current, message));
+      if (!next)
+        break;  // current is the holder
+      ++hops;
+      current = next;
+      if (current->cache.Get(item.string(), value))
+        break;
+      path.push_back(current);
+    }
+    // The response is cached by the intermediate nodes it passes back through.
+    for (SimulatedNode* node : path) {
+      if (node != current)
+        node->cache.Put(item.string(), item.string());
+    }
+    return hops;
+  }
+
+  InMemoryNetwork in_memory_network_;
+  std::vector<std::unique_ptr<SimulatedNode>> nodes_;
+  std::vector<NodeId> items_;
+  std::mt19937 rng_;
+  size_t redirects_, redirect_hits_;
+};
+
+TEST(CacheRoutingSimulationTest, FUNC_ZipfHopReduction) {
+  // Small routing tables, so that GETs take several hops in a network of this size.
+  const uint16_t kMaxRoutingTableSize(Parameters::max_routing_table_size);
+  const uint16_t kCacheAwareRoutingCandidates(Parameters::cache_aware_routing_candidates);
+  Parameters::max_routing_table_size = 16;
+  Parameters::cache_aware_routing_candidates = 3;
+  CacheRoutingSimulation simulation(300, 2000);
+  const size_t kRequestCount(20000);
+  double baseline_hops(simulation.Run(false, kRequestCount, 1.0));
+  EXPECT_EQ(0U, simulation.redirects());
+  double cache_aware_hops(simulation.Run(true, kRequestCount, 1.0));
+  Parameters::max_routing_table_size = kMaxRoutingTableSize;
+  Parameters::cache_aware_routing_candidates = kCacheAwareRoutingCandidates;
+  std::cout << "Mean hops per GET with on-path caching: " << baseline_hops
+            << ", with cache-aware next hop: " << cache_aware_hops << " ("
+            << 100.0 * (baseline_hops - cache_aware_hops) / baseline_hops << "% fewer); "
+            << simulation.redirect_hits() << " of " << simulation.redirects()
+            << " redirected hops reached a cached copy\n";
+  // Summaries are published every 100 GETs, so some are stale by the time they're used.
+  EXPECT_GT(simulation.redirects(), 0U);
+  EXPECT_GE(simulation.redirect_hits() * 10, simulation.redirects() * 8);
+}
+
+}  // namespace test
+}  // namespace routing
+}  // namespace maidsafe
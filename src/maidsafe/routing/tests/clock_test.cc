@@ -0,0 +1,104 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "boost/asio/error.hpp"
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/timer.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(ClockTest, BEH_VirtualTimersFireInDeadlineOrder) {
+  Clock::EnableVirtualTime();
+  {
+    AsioService asio_service(2);
+    std::mutex mutex;
+    std::vector<int> fired;
+    auto handler([&](int seconds) {
+      return [&, seconds](const boost::system::error_code& error_code) {
+        std::lock_guard<std::mutex> lock(mutex);
+        fired.push_back(error_code == boost::asio::error::operation_aborted ? -seconds : seconds);
+      };
+    });
+    SteadyTimer timer_30(asio_service.service(), std::chrono::seconds(30));
+    SteadyTimer timer_10(asio_service.service(), std::chrono::seconds(10));
+    SteadyTimer timer_20(asio_service.service(), std::chrono::seconds(20));
+    SteadyTimer cancelled_timer(asio_service.service(), std::chrono::seconds(15));
+    timer_30.async_wait(handler(30));
+    timer_10.async_wait(handler(10));
+    timer_20.async_wait(handler(20));
+    cancelled_timer.async_wait(handler(15));
+
+    const Clock::time_point kStart(Clock::now());
+    const auto kRealStart(std::chrono::steady_clock::now());
+    EXPECT_EQ(1U, cancelled_timer.cancel());
+    ASSERT_TRUE(Clock::AdvanceToNextDeadline());
+    EXPECT_EQ(std::chrono::seconds(10), Clock::now() - kStart);
+    Clock::Advance(std::chrono::hours(1));
+    EXPECT_EQ(std::chrono::seconds(3610), Clock::now() - kStart);
+    EXPECT_FALSE(Clock::AdvanceToNextDeadline());
+    EXPECT_LT(std::chrono::steady_clock::now() - kRealStart, std::chrono::seconds(5));
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(std::vector<int>({-15, 10, 20, 30}), fired);
+    asio_service.Stop();
+  }
+  Clock::DisableVirtualTime();
+}
+
+TEST(ClockTest, BEH_VirtualTimeTaskTimeout) {
+  Clock::EnableVirtualTime();
+  {
+    AsioService asio_service(2);
+    {
+      Timer<std::string> timer(asio_service);
+      int failed_response_count(0);
+      timer.AddTask(std::chrono::seconds(10), [&](std::string response) {
+                      EXPECT_TRUE(response.empty());
+                      ++failed_response_count;
+                    }, 2, timer.NewTaskId());
+      Clock::Advance(std::chrono::seconds(9));
+      EXPECT_EQ(0, failed_response_count);
+      EXPECT_EQ(0U, timer.timeout_count());
+      // The response functors are dispatched by the handler of the task's timer
+      Clock::Advance(std::chrono::seconds(1));
+      EXPECT_EQ(2, failed_response_count);
+      EXPECT_EQ(1U, timer.timeout_count());
+    }
+    asio_service.Stop();
+  }
+  Clock::DisableVirtualTime();
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,255 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/disk_cache.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+namespace routing {
+namespace test {
+
+namespace {
+
+const uint32_t kSegmentSize(64 * 1024);
+// Each record is a 16 byte header followed by the key and the value.
+const size_t kRecordHeaderSize(16);
+
+std::string Key(size_t index) {
+  std::string key(std::to_string(index));
+  return std::string(8 - key.size(), '0') + key;
+}
+
+}  // unnamed namespace
+
+TEST(DiskCacheTest, BEH_PutAndGet) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestDiskCache"));
+  DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+  DiskCache::Value value;
+  EXPECT_FALSE(cache.Get("key", value));
+  EXPECT_TRUE(cache.Put("key", "value"));
+  EXPECT_TRUE(cache.Contains("key"));
+  ASSERT_TRUE(cache.Get("key", value));
+  EXPECT_EQ("value", value.string());
+  EXPECT_TRUE(cache.Put("key", "other value"));
+  // The earlier view still refers to the original record.
+  EXPECT_EQ("value", value.string());
+  ASSERT_TRUE(cache.Get("key", value));
+  EXPECT_EQ("other value", value.string());
+  EXPECT_EQ(1U, cache.entry_count());
+  EXPECT_FALSE(cache.Put("too big", std::string(kSegmentSize, 'a')));
+}
+
+TEST(DiskCacheTest, BEH_Restart) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestDiskCache"));
+  std::vector<std::string> values;
+  {
+    DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+    for (size_t i(0); i != 200; ++i) {
+      values.push_back(RandomString(1000));
+      EXPECT_TRUE(cache.Put(Key(i), values.back()));
+    }
+    EXPECT_LT(1U, cache.segment_count());
+  }
+  DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+  EXPECT_EQ(values.size(), cache.entry_count());
+  DiskCache::Value value;
+  for (size_t i(0); i != values.size(); ++i) {
+    ASSERT_TRUE(cache.Get(Key(i), value));
+    EXPECT_EQ(values[i], value.string());
+  }
+  // New records are appended after the recovered ones.
+  EXPECT_TRUE(cache.Put(Key(0), "new value"));
+  ASSERT_TRUE(cache.Get(Key(1), value));
+  EXPECT_EQ(values[1], value.string());
+}
+
+TEST(DiskCacheTest, BEH_SizeLimit) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestDiskCache"));
+  DiskCache cache(*test_path, 4 * kSegmentSize, kSegmentSize);
+  for (size_t i(0); i != 1000; ++i)
+    EXPECT_TRUE(cache.Put(Key(i), RandomString(1000)));
+  EXPECT_EQ(4U, cache.segment_count());
+  // The oldest records were dropped along with their segments, the newest remain.
+  EXPECT_FALSE(cache.Contains(Key(0)));
+  EXPECT_TRUE(cache.Contains(Key(999)));
+  EXPECT_GT(1000U, cache.entry_count());
+}
+
+TEST(DiskCacheTest, BEH_CrashConsistency) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestDiskCache"));
+  const size_t kValueSize(100), kRecordCount(10);
+  const size_t kRecordSize(kRecordHeaderSize + Key(0).size() + kValueSize);
+  {
+    DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+    for (size_t i(0); i != kRecordCount; ++i)
+      EXPECT_TRUE(cache.Put(Key(i), std::string(kValueSize, 'a')));
+  }
+
+  // Simulate a write torn by a crash: flip a byte in the value of the last record.
+  fs::path segment_path(*test_path / "segment_0");
+  {
+    std::fstream segment(segment_path.string().c_str(),
+                         std::ios::in | std::ios::out | std::ios::binary);
+    segment.seekp((kRecordCount - 1) * kRecordSize + kRecordSize - 1);
+    segment.put('b');
+  }
+  {
+    DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+    EXPECT_EQ(kRecordCount - 1, cache.entry_count());
+    EXPECT_TRUE(cache.Contains(Key(kRecordCount - 2)));
+    EXPECT_FALSE(cache.Contains(Key(kRecordCount - 1)));
+    // A shorter record now overwrites the torn one.
+    EXPECT_TRUE(cache.Put("short", "value"));
+  }
+  {
+    DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+    EXPECT_EQ(kRecordCount, cache.entry_count());
+    DiskCache::Value value;
+    ASSERT_TRUE(cache.Get("short", value));
+    EXPECT_EQ("value", value.string());
+  }
+
+  // Simulate a crash before the header of a record reached the disk.
+  {
+    std::fstream segment(segment_path.string().c_str(),
+                         std::ios::in | std::ios::out | std::ios::binary);
+    segment.seekp(2 * kRecordSize);
+    segment.write(std::string(kRecordHeaderSize, '\0').data(), kRecordHeaderSize);
+  }
+  DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+  EXPECT_EQ(2U, cache.entry_count());
+  EXPECT_TRUE(cache.Contains(Key(1)));
+  EXPECT_FALSE(cache.Contains(Key(2)));
+}
+
+TEST(DiskCacheTest, BEH_IncompleteSegment) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestDiskCache"));
+  {
+    DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+    EXPECT_TRUE(cache.Put(Key(0), "value"));
+  }
+  // Simulate crashes while creating a segment, before and after it was renamed into place.
+  std::ofstream((*test_path / "new_segment_1").string().c_str(), std::ios::binary);
+  std::ofstream((*test_path / "segment_2").string().c_str(), std::ios::binary);
+  {
+    DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+    EXPECT_EQ(1U, cache.segment_count());
+    EXPECT_TRUE(cache.Contains(Key(0)));
+    EXPECT_FALSE(fs::exists(*test_path / "new_segment_1"));
+    EXPECT_FALSE(fs::exists(*test_path / "segment_2"));
+    // Too big to share the recovered segment, so a new one is created.
+    EXPECT_TRUE(cache.Put(Key(1), std::string(kSegmentSize - 100, 'a')));
+  }
+  DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+  EXPECT_EQ(2U, cache.entry_count());
+}
+
+TEST(DiskCacheTest, BEH_SegmentCreationFailure) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestDiskCache"));
+  DiskCache cache(*test_path, 1024 * 1024, kSegmentSize);
+  EXPECT_TRUE(cache.Put(Key(0), "value"));
+  // A directory in the way of the next segment's file stands in for a full disk.
+  ASSERT_TRUE(fs::create_directory(*test_path / "new_segment_1"));
+  EXPECT_FALSE(cache.Put(Key(1), std::string(kSegmentSize - 50, 'a')));
+  // Writes stay disabled, even those which would fit in the existing segment.
+  EXPECT_FALSE(cache.Put(Key(2), "value"));
+  EXPECT_EQ(1U, cache.segment_count());
+  DiskCache::Value value;
+  ASSERT_TRUE(cache.Get(Key(0), value));
+  EXPECT_EQ("value", value.string());
+}
+
+TEST(DiskCacheTest, BEH_Compaction) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestDiskCache"));
+  DiskCache cache(*test_path, 64 * kSegmentSize, kSegmentSize);
+  const size_t kKeyCount(5);
+  ASSERT_TRUE(cache.Put(Key(0), "first"));
+  DiskCache::Value first_value;
+  ASSERT_TRUE(cache.Get(Key(0), first_value));
+
+  // Repeatedly overwriting a few keys leaves the sealed segments almost entirely dead.
+  std::vector<std::string> values(kKeyCount);
+  for (size_t i(0); i != 1000; ++i) {
+    values[i % kKeyCount] = RandomString(1000);
+    ASSERT_TRUE(cache.Put(Key(i % kKeyCount), values[i % kKeyCount]));
+  }
+  // A segment being compacted remains the victim until all its records have been moved.
+  auto compactable([&cache]() -> bool {
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+    return static_cast<bool>(cache.CompactionVictim());
+  });
+  auto deadline(std::chrono::steady_clock::now() + std::chrono::seconds(10));
+  while ((cache.segment_count() > 2 || compactable()) &&
+         std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_GE(2U, cache.segment_count());
+  EXPECT_FALSE(compactable());
+
+  EXPECT_EQ(kKeyCount, cache.entry_count());
+  DiskCache::Value value;
+  for (size_t i(0); i != kKeyCount; ++i) {
+    ASSERT_TRUE(cache.Get(Key(i), value));
+    EXPECT_EQ(values[i], value.string());
+  }
+  // The view taken before compaction remains valid until released, after which the compacted
+  // segment's file is removed.
+  EXPECT_EQ("first", first_value.string());
+  EXPECT_TRUE(fs::exists(*test_path / "segment_0"));
+  first_value = DiskCache::Value();
+  EXPECT_FALSE(fs::exists(*test_path / "segment_0"));
+}
+
+TEST(DiskCacheTest, FUNC_ReadThroughput) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestDiskCache"));
+  const size_t kEntryCount(20000), kValueSize(1024), kReadCount(200000);
+  DiskCache cache(*test_path, 64 * 1024 * 1024);
+  const std::string kValue(RandomString(kValueSize));
+  for (size_t i(0); i != kEntryCount; ++i)
+    ASSERT_TRUE(cache.Put(Key(i), kValue));
+
+  DiskCache::Value value;
+  size_t bytes_read(0);
+  auto start(std::chrono::steady_clock::now());
+  for (size_t i(0); i != kReadCount; ++i) {
+    ASSERT_TRUE(cache.Get(Key(RandomUint32() % kEntryCount), value));
+    bytes_read += value.size();
+  }
+  auto elapsed(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count());
+  EXPECT_EQ(kReadCount * kValueSize, bytes_read);
+  std::cout << kReadCount << " reads of " << kValueSize << " byte values took "
+            << elapsed / 1000 << " ms ("
+            << (elapsed == 0 ? 0 : static_cast<double>(bytes_read) / elapsed) << " MB/s)\n";
+}
+
+}  // namespace test
+}  // namespace routing
+}  // namespace maidsafe
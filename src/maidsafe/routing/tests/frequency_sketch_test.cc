@@ -0,0 +1,62 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <string>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/frequency_sketch.h"
+
+namespace maidsafe {
+namespace routing {
+namespace test {
+
+TEST(FrequencySketchTest, BEH_Estimate) {
+  FrequencySketch sketch(100);
+  EXPECT_EQ(0, sketch.Estimate("hot"));
+  for (int i(0); i != 5; ++i)
+    sketch.Increment("hot");
+  sketch.Increment("cold");
+  EXPECT_GE(sketch.Estimate("hot"), 5);
+  EXPECT_GE(sketch.Estimate("cold"), 1);
+  EXPECT_GT(sketch.Estimate("hot"), sketch.Estimate("cold"));
+
+  for (int i(0); i != 100; ++i)
+    sketch.Increment("hot");
+  EXPECT_EQ(FrequencySketch::kMaxCount, sketch.Estimate("hot"));
+
+  sketch.Clear();
+  EXPECT_EQ(0, sketch.Estimate("hot"));
+}
+
+TEST(FrequencySketchTest, BEH_Aging) {
+  FrequencySketch sketch(10);
+  for (int i(0); i != 8; ++i)
+    sketch.Increment("key");
+  EXPECT_EQ(8, sketch.Estimate("key"));
+  // Each increment of a distinct key counts towards the sample; once it is reached the counters
+  // are halved.
+  size_t remaining(sketch.kSampleSize_ - sketch.increments_);
+  for (size_t i(0); i != remaining; ++i)
+    sketch.Increment("other" + std::to_string(i));
+  EXPECT_EQ(4, sketch.Estimate("key"));
+}
+
+}  // namespace test
+}  // namespace routing
+}  // namespace maidsafe
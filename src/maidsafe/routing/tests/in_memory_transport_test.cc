@@ -0,0 +1,225 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+#include "maidsafe/rudp/return_codes.h"
+
+#include "maidsafe/routing/in_memory_transport.h"
+#include "maidsafe/routing/return_codes.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+typedef boost::asio::ip::udp::endpoint Endpoint;
+
+const std::chrono::seconds kTimeout(5);
+
+// A transport with the messages and lost connections it has seen.
+struct TestPeer {
+  explicit TestPeer(InMemoryNetwork& network)
+      : node_id(NodeId::kRandomId),
+        transport(network.MakeTransport()),
+        mutex(),
+        cond_var(),
+        messages(),
+        lost_peers() {}
+
+  int Bootstrap(const std::vector<Endpoint>& bootstrap_endpoints, NodeId& bootstrap_peer,
+                Endpoint local_endpoint = Endpoint()) {
+    rudp::NatType nat_type(rudp::NatType::kUnknown);
+    return transport->Bootstrap(
+        bootstrap_endpoints,
+        [this](const std::string& message) {
+          std::lock_guard<std::mutex> lock(mutex);
+          messages.push_back(message);
+          cond_var.notify_all();
+        },
+        [this](const NodeId& peer_id) {
+          std::lock_guard<std::mutex> lock(mutex);
+          lost_peers.push_back(peer_id);
+          cond_var.notify_all();
+        },
+        node_id, nullptr, nullptr, bootstrap_peer, nat_type, local_endpoint);
+  }
+
+  bool WaitForMessages(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cond_var.wait_for(lock, kTimeout, [&] { return messages.size() >= count; });
+  }
+
+  bool WaitForLostPeers(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cond_var.wait_for(lock, kTimeout, [&] { return lost_peers.size() >= count; });
+  }
+
+  int SendAndWait(const NodeId& peer_id, const std::string& message) {
+    std::promise<int> result;
+    transport->Send(peer_id, message, [&](int sent) { result.set_value(sent); });
+    auto future(result.get_future());
+    return future.wait_for(kTimeout) == std::future_status::ready ? future.get() : kTimedOut;
+  }
+
+  NodeId node_id;
+  std::unique_ptr<Transport> transport;
+  std::mutex mutex;
+  std::condition_variable cond_var;
+  std::vector<std::string> messages;
+  std::vector<NodeId> lost_peers;
+};
+
+Endpoint LocalEndpoint(uint16_t port) {
+  return Endpoint(boost::asio::ip::address_v4::loopback(), port);
+}
+
+// Joins 'peer_a' and 'peer_b' as zero state nodes, and bootstraps 'peer_c' from 'peer_a'.
+void SetUpPeers(TestPeer& peer_a, TestPeer& peer_b, TestPeer& peer_c) {
+  NodeId bootstrap_peer_a, bootstrap_peer_b, bootstrap_peer_c;
+  auto zero_state_a(std::async(std::launch::async, [&] {
+    return peer_a.Bootstrap(std::vector<Endpoint>(1, LocalEndpoint(5001)), bootstrap_peer_a,
+                            LocalEndpoint(5000));
+  }));
+  EXPECT_EQ(kSuccess, peer_b.Bootstrap(std::vector<Endpoint>(1, LocalEndpoint(5000)),
+                                       bootstrap_peer_b, LocalEndpoint(5001)));
+  EXPECT_EQ(kSuccess, zero_state_a.get());
+  EXPECT_EQ(peer_b.node_id, bootstrap_peer_a);
+  EXPECT_EQ(peer_a.node_id, bootstrap_peer_b);
+  EXPECT_EQ(kSuccess, peer_c.Bootstrap(std::vector<Endpoint>(1, LocalEndpoint(5000)),
+                                       bootstrap_peer_c));
+  EXPECT_EQ(peer_a.node_id, bootstrap_peer_c);
+}
+
+}  // unnamed namespace
+
+TEST(InMemoryTransportTest, BEH_BootstrapAndSend) {
+  InMemoryNetwork network(NetworkConditions(), 2);
+  TestPeer peer_a(network), peer_b(network), peer_c(network);
+  SetUpPeers(peer_a, peer_b, peer_c);
+
+  EXPECT_EQ(kSuccess, peer_c.SendAndWait(peer_a.node_id, "c to a"));
+  EXPECT_EQ(kSuccess, peer_a.SendAndWait(peer_c.node_id, "a to c"));
+  ASSERT_TRUE(peer_a.WaitForMessages(1));
+  ASSERT_TRUE(peer_c.WaitForMessages(1));
+  EXPECT_EQ("c to a", peer_a.messages.front());
+  EXPECT_EQ("a to c", peer_c.messages.front());
+  EXPECT_EQ(2U, network.messages_delivered());
+
+  // Nothing can be sent without a connection
+  EXPECT_EQ(rudp::kInvalidConnection, peer_c.SendAndWait(peer_b.node_id, "c to b"));
+
+  NodeId bootstrap_peer;
+  TestPeer isolated_peer(network);
+  EXPECT_EQ(kNoOnlineBootstrapContacts,
+            isolated_peer.Bootstrap(std::vector<Endpoint>(1, LocalEndpoint(6000)),
+                                    bootstrap_peer));
+}
+
+TEST(InMemoryTransportTest, BEH_AddExchangesValidationData) {
+  InMemoryNetwork network(NetworkConditions(), 2);
+  TestPeer peer_a(network), peer_b(network), peer_c(network);
+  SetUpPeers(peer_a, peer_b, peer_c);
+
+  rudp::EndpointPair endpoint_pair_b, endpoint_pair_c;
+  rudp::NatType nat_type;
+  ASSERT_EQ(kSuccess, peer_b.transport->GetAvailableEndpoint(peer_c.node_id, rudp::EndpointPair(),
+                                                             endpoint_pair_b, nat_type));
+  EXPECT_EQ(rudp::kConnectAttemptAlreadyRunning,
+            peer_b.transport->GetAvailableEndpoint(peer_c.node_id, rudp::EndpointPair(),
+                                                   endpoint_pair_b, nat_type));
+  ASSERT_EQ(kSuccess, peer_c.transport->GetAvailableEndpoint(peer_b.node_id, endpoint_pair_b,
+                                                             endpoint_pair_c, nat_type));
+  EXPECT_FALSE(endpoint_pair_b.external.address().is_unspecified());
+
+  // The validation data is only exchanged once both ends have added the connection
+  EXPECT_EQ(kSuccess, peer_b.transport->Add(peer_c.node_id, endpoint_pair_c, "from b"));
+  EXPECT_EQ(rudp::kUnvalidatedConnectionAlreadyExists,
+            peer_b.transport->GetAvailableEndpoint(peer_c.node_id, endpoint_pair_c,
+                                                   endpoint_pair_b, nat_type));
+  Endpoint new_bootstrap_endpoint;
+  EXPECT_EQ(rudp::kInvalidConnection,
+            peer_b.transport->MarkConnectionAsValid(peer_c.node_id, new_bootstrap_endpoint));
+  EXPECT_EQ(kSuccess, peer_c.transport->Add(peer_b.node_id, endpoint_pair_b, "from c"));
+  ASSERT_TRUE(peer_b.WaitForMessages(1));
+  ASSERT_TRUE(peer_c.WaitForMessages(1));
+  EXPECT_EQ("from c", peer_b.messages.front());
+  EXPECT_EQ("from b", peer_c.messages.front());
+  EXPECT_EQ(kSuccess,
+            peer_b.transport->MarkConnectionAsValid(peer_c.node_id, new_bootstrap_endpoint));
+  EXPECT_EQ(endpoint_pair_c.local, new_bootstrap_endpoint);
+  EXPECT_EQ(rudp::kConnectionAlreadyExists,
+            peer_b.transport->GetAvailableEndpoint(peer_c.node_id, endpoint_pair_c,
+                                                   endpoint_pair_b, nat_type));
+
+  // Adding to a bootstrap connection sends the validation data straight away
+  EXPECT_EQ(rudp::kBootstrapConnectionAlreadyExists,
+            peer_a.transport->GetAvailableEndpoint(peer_c.node_id, endpoint_pair_c,
+                                                   endpoint_pair_b, nat_type));
+  EXPECT_EQ(kSuccess, peer_a.transport->Add(peer_c.node_id, endpoint_pair_c, "from a"));
+  ASSERT_TRUE(peer_c.WaitForMessages(2));
+  EXPECT_EQ("from a", peer_c.messages.back());
+}
+
+TEST(InMemoryTransportTest, BEH_LossAndConnectionLoss) {
+  NetworkConditions conditions;
+  conditions.min_latency = std::chrono::milliseconds(1);
+  conditions.max_latency = std::chrono::milliseconds(5);
+  InMemoryNetwork network(conditions, 2);
+  std::unique_ptr<TestPeer> peer_a(new TestPeer(network)), peer_b(new TestPeer(network)),
+      peer_c(new TestPeer(network));
+  SetUpPeers(*peer_a, *peer_b, *peer_c);
+
+  auto start(std::chrono::steady_clock::now());
+  EXPECT_EQ(kSuccess, peer_c->SendAndWait(peer_a->node_id, "delayed"));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, conditions.min_latency);
+
+  conditions.loss_rate = 1.0;
+  network.set_conditions(conditions);
+  EXPECT_EQ(rudp::kSendFailure, peer_c->SendAndWait(peer_a->node_id, "lost"));
+  EXPECT_EQ(1U, network.messages_lost());
+  ASSERT_TRUE(peer_a->WaitForMessages(1));
+  EXPECT_EQ(1U, peer_a->messages.size());
+
+  // Removing a connection, or destroying the transport, is seen by the peer
+  peer_c->transport->Remove(peer_a->node_id);
+  ASSERT_TRUE(peer_a->WaitForLostPeers(1));
+  EXPECT_EQ(peer_c->node_id, peer_a->lost_peers.front());
+  EXPECT_TRUE(peer_c->lost_peers.empty());
+  peer_b.reset();
+  ASSERT_TRUE(peer_a->WaitForLostPeers(2));
+  EXPECT_EQ(2U, peer_a->lost_peers.size());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,84 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/instrumented_mutex.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(InstrumentedMutexTest, BEH_LockWithConditionVariable) {
+  InstrumentedMutex mutex("instrumented_mutex_test_condition");
+  InstrumentedConditionVariable cond_var;
+  bool ready(false);
+  std::thread thread([&] {
+    std::lock_guard<InstrumentedMutex> lock(mutex);
+    ready = true;
+    cond_var.notify_one();
+  });
+  {
+    InstrumentedUniqueLock lock(mutex);
+    EXPECT_TRUE(cond_var.wait_for(lock, std::chrono::seconds(10), [&] { return ready; }));
+  }
+  thread.join();
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(InstrumentedMutexTest, BEH_LockMetrics) {
+  const std::string kLabel("{lock=\"instrumented_mutex_test_metrics\"}");
+  InstrumentedMutex mutex("instrumented_mutex_test_metrics");
+  std::thread thread;
+  {
+    std::lock_guard<InstrumentedMutex> lock(mutex);
+    thread = std::thread([&] { std::lock_guard<InstrumentedMutex> lock(mutex); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  thread.join();
+
+  RoutingMetrics metrics;
+  AddLockMetrics(metrics);
+#ifdef ROUTING_LOCK_PROFILING
+  EXPECT_EQ(2U, metrics.counters["routing_lock_acquisitions_total" + kLabel]);
+  EXPECT_EQ(1U, metrics.counters["routing_lock_contentions_total" + kLabel]);
+  LatencyHistogram wait(metrics.histograms["routing_lock_wait_seconds" + kLabel]);
+  EXPECT_EQ(2U, wait.count);
+  EXPECT_GE(wait.Percentile(1.0), std::chrono::milliseconds(10));
+  LatencyHistogram hold(metrics.histograms["routing_lock_hold_seconds" + kLabel]);
+  EXPECT_EQ(2U, hold.count);
+  EXPECT_GE(hold.sum, std::chrono::milliseconds(100));
+#else
+  EXPECT_TRUE(metrics.counters.empty());
+  EXPECT_TRUE(metrics.histograms.empty());
+#endif
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,76 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/interned_public_key.h"
+#include "maidsafe/routing/node_info.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(InternedPublicKeyTest, BEH_EqualKeysShared) {
+  const size_t kInitialCount(InternedPublicKey::InternedCount());
+  asymm::Keys keys(asymm::GenerateKeyPair()), other_keys(asymm::GenerateKeyPair());
+  {
+    InternedPublicKey public_key(keys.public_key), copy(public_key);
+    InternedPublicKey equal_key;
+    equal_key = asymm::DecodeKey(asymm::EncodeKey(keys.public_key));
+    InternedPublicKey other_key(other_keys.public_key);
+    EXPECT_EQ(kInitialCount + 2, InternedPublicKey::InternedCount());
+    EXPECT_EQ(&public_key.get(), &copy.get());
+    EXPECT_EQ(&public_key.get(), &equal_key.get());
+    EXPECT_NE(&public_key.get(), &other_key.get());
+    EXPECT_TRUE(asymm::MatchingKeys(public_key, keys.public_key));
+    EXPECT_TRUE(asymm::MatchingKeys(other_key, other_keys.public_key));
+  }
+  EXPECT_EQ(kInitialCount, InternedPublicKey::InternedCount());
+  // A key interned again after being released is held afresh.
+  InternedPublicKey public_key(keys.public_key);
+  EXPECT_EQ(kInitialCount + 1, InternedPublicKey::InternedCount());
+  EXPECT_TRUE(asymm::MatchingKeys(public_key, keys.public_key));
+}
+
+TEST(InternedPublicKeyTest, BEH_DefaultKeyInvalid) {
+  const size_t kInitialCount(InternedPublicKey::InternedCount());
+  InternedPublicKey public_key;
+  EXPECT_FALSE(asymm::ValidateKey(public_key));
+  public_key = asymm::PublicKey();
+  EXPECT_FALSE(asymm::ValidateKey(public_key));
+  EXPECT_EQ(kInitialCount, InternedPublicKey::InternedCount());
+}
+
+TEST(InternedPublicKeyTest, BEH_NodeInfoCopiesShareKey) {
+  NodeInfo node_info;
+  node_info.public_key = asymm::GenerateKeyPair().public_key;
+  NodeInfo copy(node_info);
+  EXPECT_EQ(&node_info.public_key.get(), &copy.public_key.get());
+  NodeInfo moved(std::move(copy));
+  EXPECT_EQ(&node_info.public_key.get(), &moved.public_key.get());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,235 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/iterative_lookup.h"
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+namespace routing {
+namespace test {
+
+namespace {
+
+int CommonLeadingBits(const NodeId& lhs, const NodeId& rhs) {
+  const std::string kLhs(lhs.string()), kRhs(rhs.string());
+  for (size_t i(0); i != kLhs.size(); ++i) {
+    uint8_t difference(static_cast<uint8_t>(kLhs[i] ^ kRhs[i]));
+    if (difference != 0) {
+      int bits(static_cast<int>(i) * 8);
+      while ((difference & 0x80) == 0) {
+        difference <<= 1;
+        ++bits;
+      }
+      return bits;
+    }
+  }
+  return static_cast<int>(kLhs.size()) * 8;
+}
+
+std::vector<NodeId> SortedByDistance(std::vector<NodeId> nodes, const NodeId& target) {
+  std::sort(nodes.begin(), nodes.end(), [&](const NodeId& lhs, const NodeId& rhs) {
+    return NodeId::CloserToTarget(lhs, rhs, target);
+  });
+  return nodes;
+}
+
+// Network of nodes with Kademlia-like tables, answering FindNodes requests one round trip at a
+// time: all requests sent during a round are answered at the start of the next.
+class LookupSimulation {
+ public:
+  explicit LookupSimulation(size_t node_count) : ids_(), tables_(), unresponsive_(), pending_() {
+    for (size_t i(0); i != node_count; ++i)
+      ids_.push_back(NodeId(NodeId::kRandomId));
+    // The closest nodes plus up to two nodes from each bucket.
+    for (const auto& id : ids_) {
+      std::vector<NodeId> others(ids_);
+      others.erase(std::find(others.begin(), others.end(), id));
+      others = SortedByDistance(others, id);
+      std::vector<int> bucket_counts(NodeId::kSize * 8 + 1, 0);
+      std::vector<NodeId> table;
+      for (size_t j(0); j != others.size(); ++j) {
+        int bucket(CommonLeadingBits(id, others[j]));
+        if (j < Parameters::closest_nodes_size || bucket_counts[bucket] < 2) {
+          table.push_back(others[j]);
+          ++bucket_counts[bucket];
+        }
+      }
+      tables_[id] = table;
+    }
+  }
+
+  const std::vector<NodeId>& ids() const { return ids_; }
+  void SetUnresponsive(const NodeId& node_id) { unresponsive_.insert(node_id); }
+
+  IterativeLookup::FindNodesFunctor FindNodesFunctor() {
+    return [this](const NodeId& peer_id, const NodeId& target_id,
+                  const IterativeLookup::FindNodesResponseFunctor& response_functor) {
+      pending_.push_back([=] { response_functor(Respond(peer_id, target_id)); });
+    };
+  }
+
+  // Delivers responses until none are outstanding, returning the number of round trips taken.
+  int Run() {
+    int rounds(0);
+    while (!pending_.empty()) {
+      ++rounds;
+      std::deque<std::function<void()>> round;
+      round.swap(pending_);
+      for (auto& response : round)
+        response();
+    }
+    return rounds;
+  }
+
+ private:
+  std::vector<NodeId> Respond(NodeId peer_id, const NodeId& target_id) const {
+    if (ids_.empty())
+      return std::vector<NodeId>();
+    if (peer_id == target_id)  // routed to the closest node
+      peer_id = SortedByDistance(ids_, target_id).front();
+    if (unresponsive_.count(peer_id) != 0 || tables_.count(peer_id) == 0)
+      return std::vector<NodeId>();
+    std::vector<NodeId> nodes(1, peer_id);
+    auto closest(SortedByDistance(tables_.at(peer_id), target_id));
+    closest.resize(std::min(closest.size(), size_t(Parameters::closest_nodes_size - 1)));
+    nodes.insert(nodes.end(), closest.begin(), closest.end());
+    return nodes;
+  }
+
+  std::vector<NodeId> ids_;
+  std::map<NodeId, std::vector<NodeId>> tables_;
+  std::set<NodeId> unresponsive_;
+  std::deque<std::function<void()>> pending_;
+};
+
+struct LookupResult {
+  LookupResult() : finished(false), closest_nodes(), request_count(0), rounds(0) {}
+  bool finished;
+  std::vector<NodeId> closest_nodes;
+  size_t request_count;
+  int rounds;
+};
+
+LookupResult RunLookup(LookupSimulation& simulation, const NodeId& target_id,
+                       const std::vector<NodeId>& initial_peers) {
+  LookupResult result;
+  auto lookup(std::make_shared<IterativeLookup>(
+      target_id, target_id, Parameters::node_lookup_alpha, Parameters::closest_nodes_size,
+      simulation.FindNodesFunctor(), [&](const std::vector<NodeId>& closest_nodes) {
+        EXPECT_FALSE(result.finished);
+        result.finished = true;
+        result.closest_nodes = closest_nodes;
+      }));
+  lookup->Start(initial_peers);
+  result.rounds = simulation.Run();
+  result.request_count = lookup->request_count();
+  return result;
+}
+
+std::vector<NodeId> ExpectedClosest(const std::vector<NodeId>& ids, const NodeId& target_id) {
+  auto expected(SortedByDistance(ids, target_id));
+  expected.resize(Parameters::closest_nodes_size);
+  return expected;
+}
+
+}  // unnamed namespace
+
+TEST(IterativeLookupTest, BEH_FindsClosestNodes) {
+  LookupSimulation simulation(500);
+  for (int i(0); i != 20; ++i) {
+    NodeId target_id(NodeId::kRandomId);
+    auto result(RunLookup(simulation, target_id,
+                          std::vector<NodeId>(1, simulation.ids().at(RandomUint32() % 500))));
+    ASSERT_TRUE(result.finished);
+    EXPECT_EQ(ExpectedClosest(simulation.ids(), target_id), result.closest_nodes);
+  }
+}
+
+TEST(IterativeLookupTest, BEH_EmptySeed) {
+  LookupSimulation simulation(200);
+  NodeId target_id(NodeId::kRandomId);
+  auto result(RunLookup(simulation, target_id, std::vector<NodeId>()));
+  ASSERT_TRUE(result.finished);
+  EXPECT_EQ(ExpectedClosest(simulation.ids(), target_id), result.closest_nodes);
+
+  // No node answers
+  LookupSimulation empty_simulation(0);
+  result = RunLookup(empty_simulation, target_id, std::vector<NodeId>());
+  ASSERT_TRUE(result.finished);
+  EXPECT_TRUE(result.closest_nodes.empty());
+  EXPECT_EQ(1U, result.request_count);
+}
+
+TEST(IterativeLookupTest, BEH_UnresponsivePeers) {
+  LookupSimulation simulation(300);
+  NodeId target_id(NodeId::kRandomId);
+  auto closest(SortedByDistance(simulation.ids(), target_id));
+  // The two closest nodes and every tenth other node fail to respond.
+  std::vector<NodeId> responsive;
+  for (size_t i(0); i != closest.size(); ++i) {
+    if (i < 2 || i % 10 == 5)
+      simulation.SetUnresponsive(closest[i]);
+    else
+      responsive.push_back(closest[i]);
+  }
+  auto result(RunLookup(simulation, target_id, std::vector<NodeId>(1, responsive.back())));
+  ASSERT_TRUE(result.finished);
+  EXPECT_EQ(ExpectedClosest(responsive, target_id), result.closest_nodes);
+}
+
+TEST(IterativeLookupTest, FUNC_RoundTripsScaleLogarithmically) {
+  for (size_t node_count : {64, 256, 1024}) {
+    LookupSimulation simulation(node_count);
+    const int kLookups(20);
+    size_t total_requests(0);
+    int total_rounds(0);
+    for (int i(0); i != kLookups; ++i) {
+      NodeId target_id(NodeId::kRandomId);
+      auto result(RunLookup(
+          simulation, target_id,
+          std::vector<NodeId>(1, simulation.ids().at(RandomUint32() % node_count))));
+      ASSERT_TRUE(result.finished);
+      EXPECT_EQ(ExpectedClosest(simulation.ids(), target_id), result.closest_nodes);
+      total_requests += result.request_count;
+      total_rounds += result.rounds;
+    }
+    double mean_rounds(static_cast<double>(total_rounds) / kLookups);
+    std::cout << node_count << " nodes: mean " << static_cast<double>(total_requests) / kLookups
+              << " requests in " << mean_rounds << " round trips per lookup\n";
+    EXPECT_LT(mean_rounds, 2.0 * std::log2(static_cast<double>(node_count)));
+  }
+}
+
+}  // namespace test
+}  // namespace routing
+}  // namespace maidsafe
@@ -0,0 +1,90 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/lifecycle.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(LifecycleTest, BEH_StopWaitsForOperations) {
+  Lifecycle lifecycle;
+  EXPECT_TRUE(lifecycle.running());
+  std::atomic<bool> started(false), finished(false);
+  std::thread thread([&] {
+    Lifecycle::Operation operation(lifecycle);
+    ASSERT_TRUE(static_cast<bool>(operation));
+    {
+      Lifecycle::Operation nested_operation(lifecycle);
+      EXPECT_TRUE(static_cast<bool>(nested_operation));
+    }
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    finished = true;
+  });
+  while (!started)
+    std::this_thread::yield();
+  lifecycle.Stop();
+  EXPECT_TRUE(finished);
+  EXPECT_FALSE(lifecycle.running());
+  Lifecycle::Operation refused_operation(lifecycle);
+  EXPECT_FALSE(static_cast<bool>(refused_operation));
+  thread.join();
+}
+
+TEST(LifecycleTest, BEH_ConcurrentOperations) {
+  Lifecycle lifecycle;
+  std::atomic<int> in_flight(0);
+  std::atomic<bool> overlapped(false);
+  std::vector<std::thread> threads;
+  for (int i(0); i != 4; ++i) {
+    threads.push_back(std::thread([&] {
+      for (;;) {
+        Lifecycle::Operation operation(lifecycle);
+        if (!operation)
+          return;
+        if (++in_flight > 1)
+          overlapped = true;
+        std::this_thread::yield();
+        --in_flight;
+      }
+    }));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  lifecycle.Stop();
+  EXPECT_EQ(0, in_flight);
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_TRUE(overlapped);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
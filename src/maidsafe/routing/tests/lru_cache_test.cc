@@ -0,0 +1,166 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/lru_cache.h"
+
+namespace maidsafe {
+namespace routing {
+namespace test {
+
+TEST(LruCacheTest, BEH_PutAndGet) {
+  LruCache cache(10, 1024, 1);
+  std::string value;
+  EXPECT_FALSE(cache.Get("key", value));
+  EXPECT_TRUE(cache.Put("key", "value"));
+  EXPECT_TRUE(cache.Contains("key"));
+  EXPECT_TRUE(cache.Get("key", value));
+  EXPECT_EQ("value", value);
+  EXPECT_TRUE(cache.Put("key", "other value"));
+  EXPECT_TRUE(cache.Get("key", value));
+  EXPECT_EQ("other value", value);
+
+  auto statistics(cache.GetStatistics());
+  EXPECT_EQ(2U, statistics.hits);
+  EXPECT_EQ(1U, statistics.misses);
+  EXPECT_EQ(2U, statistics.insertions);
+  EXPECT_EQ(0U, statistics.evictions);
+  EXPECT_EQ(1U, statistics.entry_count);
+  EXPECT_EQ(std::string("key").size() + std::string("other value").size(),
+            statistics.size_in_bytes);
+}
+
+TEST(LruCacheTest, BEH_EntryLimit) {
+  const size_t kMaxEntries(5);
+  LruCache cache(kMaxEntries, 1024 * 1024, 1);
+  for (size_t i(0); i != kMaxEntries; ++i)
+    EXPECT_TRUE(cache.Put(std::to_string(i), RandomString(10)));
+  std::string value;
+  // Touch the oldest entry so that "1" becomes the least recently used.
+  EXPECT_TRUE(cache.Get("0", value));
+  EXPECT_TRUE(cache.Put("new", RandomString(10)));
+  EXPECT_TRUE(cache.Contains("0"));
+  EXPECT_FALSE(cache.Contains("1"));
+  EXPECT_TRUE(cache.Contains("new"));
+  auto statistics(cache.GetStatistics());
+  EXPECT_EQ(kMaxEntries, statistics.entry_count);
+  EXPECT_EQ(1U, statistics.evictions);
+}
+
+TEST(LruCacheTest, BEH_ByteLimit) {
+  LruCache cache(100, 100, 1);
+  EXPECT_FALSE(cache.Put("too big", std::string(100, 'a')));
+  EXPECT_TRUE(cache.Put("a", std::string(39, 'a')));
+  EXPECT_TRUE(cache.Put("b", std::string(39, 'b')));
+  EXPECT_TRUE(cache.Put("c", std::string(39, 'c')));
+  EXPECT_FALSE(cache.Contains("a"));
+  EXPECT_TRUE(cache.Contains("b"));
+  EXPECT_TRUE(cache.Contains("c"));
+  auto statistics(cache.GetStatistics());
+  EXPECT_EQ(80U, statistics.size_in_bytes);
+  EXPECT_EQ(1U, statistics.evictions);
+  cache.Clear();
+  EXPECT_EQ(0U, cache.GetStatistics().entry_count);
+  EXPECT_EQ(0U, cache.GetStatistics().size_in_bytes);
+}
+
+TEST(LruCacheTest, BEH_Admission) {
+  std::string preferred("hot");
+  LruCache cache(2, 1024, 1, [&preferred](const std::string& candidate, const std::string&) {
+    return candidate == preferred;
+  });
+  EXPECT_TRUE(cache.Put("a", "a"));
+  EXPECT_TRUE(cache.Put("b", "b"));
+  // Full, so "cold" must beat the least-recently-used entry "a" and fails to.
+  EXPECT_FALSE(cache.Put("cold", "cold"));
+  EXPECT_TRUE(cache.Contains("a"));
+  EXPECT_FALSE(cache.Contains("cold"));
+  EXPECT_TRUE(cache.Put("hot", "hot"));
+  EXPECT_FALSE(cache.Contains("a"));
+  EXPECT_TRUE(cache.Contains("hot"));
+  // Replacing an existing entry with a value which fits in the space it frees needs no admission.
+  EXPECT_TRUE(cache.Put("b", "new b"));
+
+  std::string value;
+  EXPECT_TRUE(cache.Get("hot", value));
+  EXPECT_FALSE(cache.Get("cold", value));
+  auto statistics(cache.GetStatistics());
+  EXPECT_EQ(1U, statistics.rejections);
+  EXPECT_EQ(1U, statistics.evictions);
+  EXPECT_EQ(3U, statistics.bytes_served);
+  EXPECT_DOUBLE_EQ(0.5, statistics.hit_ratio());
+}
+
+TEST(LruCacheTest, BEH_RejectedReplacementKeepsValue) {
+  std::string preferred;
+  LruCache cache(2, 20, 1, [&preferred](const std::string& candidate, const std::string&) {
+    return candidate == preferred;
+  });
+  EXPECT_TRUE(cache.Put("a", "a"));
+  EXPECT_TRUE(cache.Put("b", "b"));
+  // The larger value of "b" only fits by evicting "a", over which it isn't admitted.
+  EXPECT_FALSE(cache.Put("b", std::string(18, 'b')));
+  std::string value;
+  EXPECT_TRUE(cache.Get("b", value));
+  EXPECT_EQ("b", value);
+  EXPECT_TRUE(cache.Contains("a"));
+  EXPECT_EQ(4U, cache.GetStatistics().size_in_bytes);
+
+  preferred = "b";
+  EXPECT_TRUE(cache.Put("b", std::string(18, 'b')));
+  EXPECT_TRUE(cache.Get("b", value));
+  EXPECT_EQ(std::string(18, 'b'), value);
+  EXPECT_FALSE(cache.Contains("a"));
+  auto statistics(cache.GetStatistics());
+  EXPECT_EQ(1U, statistics.rejections);
+  EXPECT_EQ(19U, statistics.size_in_bytes);
+}
+
+TEST(LruCacheTest, FUNC_ConcurrentAccess) {
+  const size_t kMaxEntries(64), kThreadCount(8), kIterations(1000);
+  LruCache cache(kMaxEntries, 1024 * 1024, 8);
+  std::vector<std::thread> threads;
+  for (size_t i(0); i != kThreadCount; ++i) {
+    threads.push_back(std::thread([&cache, i, kIterations] {
+      std::string value;
+      for (size_t j(0); j != kIterations; ++j) {
+        std::string key(std::to_string((i * kIterations + j) % 200));
+        if (!cache.Get(key, value))
+          cache.Put(key, key);
+        else
+          EXPECT_EQ(key, value);
+      }
+    }));
+  }
+  for (auto& thread : threads)
+    thread.join();
+  auto statistics(cache.GetStatistics());
+  EXPECT_EQ(kThreadCount * kIterations, statistics.hits + statistics.misses);
+  EXPECT_GE(kMaxEntries, statistics.entry_count);
+  EXPECT_GE(statistics.insertions - statistics.evictions, statistics.entry_count);
+}
+
+}  // namespace test
+}  // namespace routing
+}  // namespace maidsafe
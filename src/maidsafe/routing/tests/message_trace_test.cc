@@ -0,0 +1,139 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <chrono>
+#include <string>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/message_trace.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(MessageTraceTest, BEH_RecordHops) {
+  protobuf::Message message;
+  message.set_request(true);
+  NodeId source(NodeId::kRandomId), hop(NodeId::kRandomId);
+
+  // Unsampled messages stay untraced
+  double sample_rate(Parameters::message_trace_sample_rate);
+  Parameters::message_trace_sample_rate = 0.0;
+  StartMessageTrace(message, source);
+  EXPECT_FALSE(message.has_trace());
+  AddMessageTraceHop(message, hop, std::chrono::microseconds(10));
+  EXPECT_FALSE(message.has_trace());
+
+  Parameters::message_trace_sample_rate = 1.0;
+  StartMessageTrace(message, source);
+  Parameters::message_trace_sample_rate = sample_rate;
+  ASSERT_TRUE(message.has_trace());
+  SetMessageTraceForwarded(message, source);
+  AddMessageTraceHop(message, hop, std::chrono::microseconds(250));
+  message.set_request(false);
+  AddMessageTraceHop(message, source, std::chrono::microseconds(0));
+
+  MessageTrace trace(GetMessageTrace(message, "delivered"));
+  EXPECT_EQ(message.trace().trace_id(), trace.trace_id);
+  ASSERT_EQ(3U, trace.hops.size());
+  EXPECT_EQ(HexEncode(source.string().substr(0, 4)), trace.hops[0].node);
+  EXPECT_EQ(HexEncode(hop.string().substr(0, 4)), trace.hops[1].node);
+  EXPECT_NE(0U, trace.hops[0].forwarded);
+  EXPECT_LE(trace.hops[0].received, trace.hops[0].forwarded);
+  EXPECT_EQ(0U, trace.hops[1].forwarded);
+  EXPECT_EQ(250U, trace.hops[1].queueing_delay);
+  EXPECT_TRUE(trace.hops[1].request);
+  EXPECT_FALSE(trace.hops[2].request);
+
+  // Only this node's latest hop is stamped as forwarded
+  SetMessageTraceForwarded(message, source);
+  EXPECT_EQ(trace.hops[0].forwarded, message.trace().hops(0).forwarded());
+  EXPECT_NE(0U, message.trace().hops(2).forwarded());
+}
+
+TEST(MessageTraceTest, BEH_SerialiseAndParse) {
+  MessageTrace trace;
+  trace.trace_id = 0x0123456789abcdefULL;
+  trace.outcome = "dropped";
+  for (int i(0); i != 3; ++i) {
+    MessageTrace::Hop hop;
+    hop.node = HexEncode(RandomString(4));
+    hop.received = 1400000000000000ULL + i * 1000;
+    hop.forwarded = (i == 2 ? 0 : hop.received + 300);
+    hop.queueing_delay = 20 * i;
+    hop.request = (i != 2);
+    trace.hops.push_back(hop);
+  }
+  std::string line(SerialiseMessageTrace(trace));
+  EXPECT_EQ(0U, line.find("0123456789abcdef dropped "));
+  MessageTrace parsed(ParseMessageTrace(line));
+  EXPECT_EQ(trace.trace_id, parsed.trace_id);
+  EXPECT_EQ(trace.outcome, parsed.outcome);
+  ASSERT_EQ(trace.hops.size(), parsed.hops.size());
+  for (size_t i(0); i != trace.hops.size(); ++i) {
+    EXPECT_EQ(trace.hops[i].node, parsed.hops[i].node);
+    EXPECT_EQ(trace.hops[i].received, parsed.hops[i].received);
+    EXPECT_EQ(trace.hops[i].forwarded, parsed.hops[i].forwarded);
+    EXPECT_EQ(trace.hops[i].queueing_delay, parsed.hops[i].queueing_delay);
+    EXPECT_EQ(trace.hops[i].request, parsed.hops[i].request);
+  }
+  EXPECT_THROW(ParseMessageTrace(""), std::exception);
+  EXPECT_THROW(ParseMessageTrace(line + " abcd:1:2"), std::exception);
+}
+
+TEST(MessageTraceTest, BEH_TraceLog) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestMessageTrace"));
+  boost::filesystem::path file_path(*test_path / "node.trace");
+  MessageTraceLog trace_log(file_path);
+  protobuf::Message message;
+  message.set_request(true);
+  trace_log.Record(message, "delivered");  // untraced
+  EXPECT_FALSE(boost::filesystem::exists(file_path));
+
+  double sample_rate(Parameters::message_trace_sample_rate);
+  Parameters::message_trace_sample_rate = 1.0;
+  StartMessageTrace(message, NodeId(NodeId::kRandomId));
+  Parameters::message_trace_sample_rate = sample_rate;
+  trace_log.Record(message, "delivered");
+  AddMessageTraceHop(message, NodeId(NodeId::kRandomId), std::chrono::microseconds(5));
+  trace_log.Record(message, "dropped");
+
+  auto traces(ReadMessageTraces(file_path));
+  ASSERT_EQ(2U, traces.size());
+  EXPECT_EQ("delivered", traces[0].outcome);
+  EXPECT_EQ(1U, traces[0].hops.size());
+  EXPECT_EQ("dropped", traces[1].outcome);
+  EXPECT_EQ(2U, traces[1].hops.size());
+  EXPECT_EQ(traces[0].trace_id, traces[1].trace_id);
+
+  MessageTraceLog disabled_log((boost::filesystem::path()));
+  disabled_log.Record(message, "delivered");
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,142 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/metrics.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(MetricsTest, BEH_CountersMergedAcrossThreads) {
+  Metrics metrics;
+  const int kThreadCount(8), kIncrements(10000);
+  std::vector<std::thread> threads;
+  for (int i(0); i != kThreadCount; ++i) {
+    threads.push_back(std::thread([&] {
+      for (int j(0); j != kIncrements; ++j) {
+        metrics.Increment(MetricCounter::kMessagesForwarded);
+        metrics.MessageReceived(static_cast<int32_t>(MessageType::kPing));
+      }
+    }));
+  }
+  for (auto& thread : threads)
+    thread.join();
+  metrics.MessageSent(static_cast<int32_t>(MessageType::kNodeLevel));
+  metrics.MessageSent(-7);
+
+  RoutingMetrics snapshot(metrics.Snapshot());
+  EXPECT_EQ(kThreadCount * kIncrements, snapshot.counters["routing_messages_forwarded_total"]);
+  EXPECT_EQ(kThreadCount * kIncrements,
+            snapshot.counters["routing_messages_received_total{type=\"ping\"}"]);
+  EXPECT_EQ(0U, snapshot.counters["routing_messages_sent_total{type=\"ping\"}"]);
+  EXPECT_EQ(1U, snapshot.counters["routing_messages_sent_total{type=\"node_level\"}"]);
+  EXPECT_EQ(1U, snapshot.counters["routing_messages_sent_total{type=\"unknown\"}"]);
+  EXPECT_EQ(0U, snapshot.counters["routing_send_drops_total"]);
+}
+
+TEST(MetricsTest, BEH_LatencyBuckets) {
+  // Every value lies within its bucket, and each bucket's bound is within 1/8 of the value.
+  uint64_t previous_bound(0);
+  for (size_t bucket(0); bucket != Metrics::kBucketCount; ++bucket) {
+    uint64_t bound(LatencyBucketUpperBound(bucket));
+    if (bucket != 0) {
+      EXPECT_GT(bound, previous_bound);
+    }
+    EXPECT_EQ(bucket, LatencyBucket(bound));
+    EXPECT_EQ(bucket, LatencyBucket(previous_bound + (bucket == 0 ? 0 : 1)));
+    EXPECT_LE(bound - previous_bound, std::max<uint64_t>(1, bound / 8));
+    previous_bound = bound;
+  }
+  EXPECT_EQ(Metrics::kBucketCount - 1, LatencyBucket(std::numeric_limits<uint64_t>::max()));
+
+  Metrics metrics;
+  for (int i(1); i <= 100; ++i)
+    metrics.RecordLatency(MetricHistogram::kSendLatency, std::chrono::milliseconds(i));
+  LatencyHistogram histogram(metrics.Snapshot().histograms["routing_send_latency_seconds"]);
+  EXPECT_EQ(100U, histogram.count);
+  EXPECT_EQ(std::chrono::microseconds(5050000), histogram.sum);
+  auto median(histogram.Percentile(0.5).count());
+  EXPECT_GE(median, 50000);
+  EXPECT_LE(median, 50000 * 9 / 8);
+  auto p99(histogram.Percentile(0.99).count());
+  EXPECT_GE(p99, 99000);
+  EXPECT_LE(p99, 99000 * 9 / 8);
+  EXPECT_EQ(0, LatencyHistogram().Percentile(0.5).count());
+}
+
+TEST(MetricsTest, BEH_PrometheusExport) {
+  Metrics metrics;
+  metrics.Increment(MetricCounter::kSendRetries);
+  metrics.MessageReceived(static_cast<int32_t>(MessageType::kFindNodes));
+  metrics.RecordLatency(MetricHistogram::kMessageHandling, std::chrono::microseconds(3));
+  metrics.RecordLatency(MetricHistogram::kMessageHandling, std::chrono::microseconds(1000));
+  std::string text(PrometheusText(metrics.Snapshot(), "ab"));
+  EXPECT_NE(std::string::npos, text.find("# TYPE routing_send_retries_total counter\n"
+                                         "routing_send_retries_total{node=\"ab\"} 1\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("routing_messages_received_total{node=\"ab\",type=\"find_nodes\"} 1\n"));
+  const std::string kReceivedType("# TYPE routing_messages_received_total counter");
+  EXPECT_EQ(text.find(kReceivedType), text.rfind(kReceivedType));
+  EXPECT_NE(std::string::npos, text.find("# TYPE routing_message_handling_seconds histogram\n"
+                                         "routing_message_handling_seconds_bucket{node=\"ab\","
+                                         "le=\"3e-06\"} 1\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("routing_message_handling_seconds_bucket{node=\"ab\",le=\"+Inf\"} 2\n"));
+  EXPECT_NE(std::string::npos, text.find("routing_message_handling_seconds_count{node=\"ab\"} 2\n"));
+
+  RoutingMetrics labelled;
+  labelled.histograms["routing_lock_wait_seconds{lock=\"a\"}"].count = 1;
+  labelled.histograms["routing_lock_wait_seconds{lock=\"b\"}"].count = 2;
+  std::string labelled_text(PrometheusText(labelled, "ab"));
+  const std::string kWaitType("# TYPE routing_lock_wait_seconds histogram");
+  EXPECT_EQ(labelled_text.find(kWaitType), labelled_text.rfind(kWaitType));
+  EXPECT_NE(std::string::npos, labelled_text.find("routing_lock_wait_seconds_bucket{node=\"ab\","
+                                                  "lock=\"b\",le=\"+Inf\"} 2\n"));
+  EXPECT_NE(std::string::npos,
+            labelled_text.find("routing_lock_wait_seconds_count{node=\"ab\",lock=\"a\"} 1\n"));
+
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestMetrics"));
+  fs::path file_path(*test_path / "ab.prom");
+  WritePrometheusFile(metrics.Snapshot(), "ab", file_path);
+  EXPECT_EQ(text, ReadFile(file_path).string());
+  EXPECT_FALSE(fs::exists(file_path.string() + ".tmp"));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
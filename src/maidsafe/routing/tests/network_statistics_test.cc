@@ -16,9 +16,10 @@
     See the Licences for the specific language governing permissions and limitations relating to
     use of the MaidSafe Software.                                                                 */
 
+#include <algorithm>
 #include <bitset>
+#include <cstdint>
 #include <memory>
-#include <numeric>
 #include <vector>
 
 #include "maidsafe/common/node_id.h"
@@ -34,54 +35,89 @@ namespace maidsafe {
 namespace routing {
 namespace test {
 
+namespace {
+
+uint64_t LeadingBits(const NodeId& node_id) {
+  uint64_t leading_bits(0);
+  for (size_t i(0); i != sizeof(leading_bits); ++i)
+    leading_bits = (leading_bits << 8) | static_cast<uint8_t>(node_id.string()[i]);
+  return leading_bits;
+}
+
+}  // unnamed namespace
+
 TEST(NetworkStatisticsTest, BEH_AverageDistance) {
   NodeId node_id(NodeId::kRandomId);
-  NodeId average(node_id);
   NetworkStatistics network_statistics(node_id);
-  network_statistics.network_distance_data_.average_distance = average;
-  network_statistics.UpdateNetworkAverageDistance(average);
-  EXPECT_EQ(network_statistics.network_distance_data_.average_distance, average);
-
-  node_id = NodeId();
-  network_statistics.network_distance_data_.total_distance = crypto::BigInt::Zero();
-  network_statistics.network_distance_data_.average_distance = NodeId();
-  average = node_id;
-  network_statistics.UpdateNetworkAverageDistance(node_id);
-  EXPECT_EQ(network_statistics.network_distance_data_.average_distance, average);
+  network_statistics.UpdateNetworkAverageDistance(NodeId());
+  EXPECT_EQ(0U, network_statistics.network_distance_data_.sample_count);
+  EXPECT_EQ(0U, network_statistics.EstimateNetworkSize());
 
-  node_id = NodeId(NodeId::kMaxId);
-  network_statistics.network_distance_data_.total_distance =
-      crypto::BigInt((node_id.ToStringEncoded(NodeId::EncodingType::kHex) + 'h').c_str()) *
-      network_statistics.network_distance_data_.contributors_count;
-  average = node_id;
   network_statistics.UpdateNetworkAverageDistance(node_id);
-  EXPECT_EQ(network_statistics.network_distance_data_.average_distance, average);
-
-  network_statistics.network_distance_data_.contributors_count = 0;
-  network_statistics.network_distance_data_.total_distance = crypto::BigInt::Zero();
-
-  std::vector<NodeId> distances_as_node_id;
-  std::vector<crypto::BigInt> distances_as_bigint;
-  uint32_t kCount(RandomUint32() % 1000 + 9000);
-  for (uint32_t i(0); i < kCount; ++i) {
-    NodeId node_id(NodeId::kRandomId);
-    distances_as_node_id.push_back(node_id);
-    distances_as_bigint.push_back(
-        crypto::BigInt((node_id.ToStringEncoded(NodeId::EncodingType::kHex) + 'h').c_str()));
+  EXPECT_EQ(LeadingBits(node_id), network_statistics.network_distance_data_.average_distance);
+
+  network_statistics.UpdateNetworkAverageDistance(NodeId(NodeId::kMaxId));
+  EXPECT_EQ(2U, network_statistics.network_distance_data_.sample_count);
+
+  // The first samples are averaged equally.
+  NetworkStatistics averaging_statistics(node_id);
+  double total(0);
+  const int kWarmUpCount(16);
+  for (int i(0); i != kWarmUpCount; ++i) {
+    NodeId distance(NodeId::kRandomId);
+    total += static_cast<double>(LeadingBits(distance));
+    averaging_statistics.UpdateNetworkAverageDistance(distance);
   }
+  EXPECT_NEAR(total / kWarmUpCount,
+              static_cast<double>(averaging_statistics.network_distance_data_.average_distance),
+              total * 1e-6);
+
+  // Then older samples are forgotten.
+  NodeId distance(NodeId::kRandomId);
+  for (int i(0); i != 20 * kWarmUpCount; ++i)
+    averaging_statistics.UpdateNetworkAverageDistance(distance);
+  EXPECT_NEAR(static_cast<double>(LeadingBits(distance)),
+              static_cast<double>(averaging_statistics.network_distance_data_.average_distance),
+              static_cast<double>(LeadingBits(distance)) * 1e-3);
+
+  // This node's own group distance is added once per kWarmUpCount peer samples, however often it
+  // is recalculated.
+  std::vector<NodeId> unique_nodes;
+  for (int i(0); i != Parameters::group_size; ++i)
+    unique_nodes.push_back(NodeId(NodeId::kRandomId));
+  averaging_statistics.UpdateLocalAverageDistance(unique_nodes);
+  uint64_t average(averaging_statistics.network_distance_data_.average_distance);
+  for (int i(0); i != 10; ++i)
+    averaging_statistics.UpdateLocalAverageDistance(unique_nodes);
+  EXPECT_EQ(average, averaging_statistics.network_distance_data_.average_distance);
+  for (int i(0); i != kWarmUpCount; ++i)
+    averaging_statistics.UpdateNetworkAverageDistance(distance);
+  average = averaging_statistics.network_distance_data_.average_distance;
+  averaging_statistics.UpdateLocalAverageDistance(unique_nodes);
+  EXPECT_NE(average, averaging_statistics.network_distance_data_.average_distance);
+}
 
-  crypto::BigInt total(std::accumulate(distances_as_bigint.begin(), distances_as_bigint.end(),
-                                       crypto::BigInt::Zero()));
-
-  for (const auto& node_id : distances_as_node_id)
-    network_statistics.UpdateNetworkAverageDistance(node_id);
-
-  crypto::BigInt matrix_average_as_bigint(
-      (network_statistics.network_distance_data_.average_distance.ToStringEncoded(
-           NodeId::EncodingType::kHex) +
-       'h').c_str());
-
-  EXPECT_EQ(total / kCount, matrix_average_as_bigint);
+TEST(NetworkStatisticsTest, BEH_EstimateNetworkSize) {
+  for (size_t network_size : { 100, 1000, 10000 }) {
+    std::vector<NodeId> node_ids;
+    for (size_t i(0); i != network_size; ++i)
+      node_ids.push_back(NodeId(NodeId::kRandomId));
+    NetworkStatistics network_statistics(node_ids.front());
+    // Each of a sample of nodes reports the distance to the furthest member of its group.
+    for (size_t i(0); i != 50; ++i) {
+      std::vector<NodeId> distances;
+      for (const auto& node_id : node_ids) {
+        if (node_id != node_ids[i])
+          distances.push_back(node_id ^ node_ids[i]);
+      }
+      std::nth_element(distances.begin(), distances.begin() + Parameters::group_size - 1,
+                       distances.end());
+      network_statistics.UpdateNetworkAverageDistance(distances[Parameters::group_size - 1]);
+    }
+    uint64_t estimate(network_statistics.EstimateNetworkSize());
+    EXPECT_GT(estimate, network_size / 2) << "Network size " << network_size;
+    EXPECT_LT(estimate, network_size * 2) << "Network size " << network_size;
+  }
 }
 
 TEST(NetworkStatisticsTest, BEH_IsIdInGroupRange) {
@@ -0,0 +1,132 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/interprocess/ipc/message_queue.hpp"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+#include "maidsafe/common/tools/network_viewer.h"
+
+#include "maidsafe/routing/network_viewer_publisher.h"
+
+namespace bi = boost::interprocess;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+const size_t kMaxMessageSize(16 * 1024);
+
+std::string SerialisedMatrix(const NodeId& node_id, const NodeId& matrix_node,
+                             const NodeId& close_node) {
+  network_viewer::MatrixRecord matrix_record(node_id);
+  matrix_record.AddElement(matrix_node, network_viewer::ChildType::kMatrix);
+  matrix_record.AddElement(close_node, network_viewer::ChildType::kGroup);
+  return matrix_record.Serialise();
+}
+
+std::vector<std::string> ReceiveAll(bi::message_queue& message_queue) {
+  std::vector<std::string> messages;
+  std::string message(kMaxMessageSize, 0);
+  bi::message_queue::size_type received_size(0);
+  unsigned int priority(0);
+  while (message_queue.try_receive(&message[0], message.size(), received_size, priority))
+    messages.push_back(message.substr(0, received_size));
+  return messages;
+}
+
+}  // unnamed namespace
+
+TEST(NetworkViewerPublisherTest, BEH_CoalesceAndSkipUnchanged) {
+  const std::string kQueueName("routing_viewer_test_" + RandomAlphaNumericString(8));
+  bi::message_queue::remove(kQueueName.c_str());
+  bi::message_queue message_queue(bi::create_only, kQueueName.c_str(), 32, kMaxMessageSize);
+  const NodeId kNodeId(NodeId::kRandomId), kCloseNode(NodeId::kRandomId);
+  std::vector<NodeId> matrix_nodes;
+  for (int i(0); i != 3; ++i)
+    matrix_nodes.push_back(NodeId(NodeId::kRandomId));
+  const std::string kLatest(SerialisedMatrix(kNodeId, matrix_nodes.back(), kCloseNode));
+  {
+    NetworkViewerPublisher publisher(kQueueName, std::chrono::milliseconds(200));
+    for (const auto& matrix_node : matrix_nodes)
+      publisher.Publish(kNodeId, std::vector<NodeId>(1, matrix_node),
+                        std::vector<NodeId>(1, kCloseNode));
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    publisher.Publish(kNodeId, std::vector<NodeId>(1, matrix_nodes.back()),
+                      std::vector<NodeId>(1, kCloseNode));
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    publisher.Remove(kNodeId);
+  }
+  std::vector<std::string> messages(ReceiveAll(message_queue));
+  bi::message_queue::remove(kQueueName.c_str());
+
+  // The first matrix may be sent before the others are published, but the latest is sent once,
+  // followed by the empty matrix which removes the node.
+  ASSERT_GE(messages.size(), 2U);
+  EXPECT_LE(messages.size(), 3U);
+  EXPECT_EQ(kLatest, messages[messages.size() - 2]);
+  EXPECT_EQ(network_viewer::MatrixRecord(kNodeId).Serialise(), messages.back());
+  if (messages.size() == 3U)
+    EXPECT_NE(kLatest, messages.front());
+}
+
+TEST(NetworkViewerPublisherTest, BEH_RateLimited) {
+  const std::string kQueueName("routing_viewer_test_" + RandomAlphaNumericString(8));
+  bi::message_queue::remove(kQueueName.c_str());
+  bi::message_queue message_queue(bi::create_only, kQueueName.c_str(), 32, kMaxMessageSize);
+  const NodeId kNodeId(NodeId::kRandomId), kCloseNode(NodeId::kRandomId);
+  const std::chrono::milliseconds kUpdateInterval(500);
+  NetworkViewerPublisher publisher(kQueueName, kUpdateInterval);
+  const auto kStart(std::chrono::steady_clock::now());
+  for (int i(0); i != 150; ++i) {
+    publisher.Publish(kNodeId, std::vector<NodeId>(1, NodeId(NodeId::kRandomId)),
+                      std::vector<NodeId>(1, kCloseNode));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::vector<std::string> messages(ReceiveAll(message_queue));
+  auto elapsed(std::chrono::steady_clock::now() - kStart);
+  bi::message_queue::remove(kQueueName.c_str());
+
+  // Sends are at least kUpdateInterval apart however long publishing took, rather than one per
+  // changed matrix.
+  EXPECT_GE(messages.size(), 1U);
+  EXPECT_LE(messages.size(), static_cast<size_t>(1 + elapsed / kUpdateInterval));
+}
+
+TEST(NetworkViewerPublisherTest, BEH_QueueNotOpen) {
+  EXPECT_THROW(NetworkViewerPublisher("routing_viewer_test_" + RandomAlphaNumericString(8),
+                                      std::chrono::milliseconds(100)),
+               std::exception);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
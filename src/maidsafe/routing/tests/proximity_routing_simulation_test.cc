@@ -0,0 +1,183 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// In-process simulation of routing over a latency matrix of vaults spread across several regions,
+// comparing end-to-end latency and hop count with and without proximity routing.  Each vault's
+// next hop is chosen by its own RoutingTable::GetNodeForSendingMessage, as in
+// NetworkUtils::RecursiveSendOn, with the round trip time to each of its peers known.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/tests/test_utils.h"
+
+namespace maidsafe {
+namespace routing {
+namespace test {
+
+namespace {
+
+struct SimulatedNode {
+  SimulatedNode(const NodeInfo& node_info_in, size_t region_in, double access_ms_in)
+      : node_info(node_info_in),
+        region(region_in),
+        access_ms(access_ms_in),
+        network_statistics(node_info.node_id),
+        routing_table(false, node_info.node_id, asymm::GenerateKeyPair(), network_statistics) {}
+  NodeInfo node_info;
+  size_t region;
+  double access_ms;  // latency of the node's own link
+  NetworkStatistics network_statistics;
+  RoutingTable routing_table;
+};
+
+class ProximityRoutingSimulation {
+ public:
+  ProximityRoutingSimulation(size_t node_count, size_t region_count)
+      : nodes_(), region_latency_ms_(region_count, std::vector<double>(region_count, 0.0)),
+        rng_(13) {
+    std::uniform_real_distribution<double> inter_region(20.0, 150.0), access(0.5, 5.0);
+    for (size_t i(0); i != region_count; ++i) {
+      region_latency_ms_[i][i] = 1.0;
+      for (size_t j(0); j != i; ++j)
+        region_latency_ms_[i][j] = region_latency_ms_[j][i] = inter_region(rng_);
+    }
+    std::uniform_int_distribution<size_t> region(0, region_count - 1);
+    for (size_t i(0); i != node_count; ++i) {
+      nodes_.push_back(std::unique_ptr<SimulatedNode>(
+          new SimulatedNode(MakeNode(), region(rng_), access(rng_))));
+    }
+    // Each routing table keeps the peers its own policy accepts, with their round trip times.
+    for (auto& node : nodes_) {
+      for (const auto& peer : nodes_) {
+        if (peer != node)
+          node->routing_table.AddNode(peer->node_info);
+      }
+      for (const auto& peer : nodes_) {
+        if (peer != node) {
+          node->routing_table.UpdateRoundTripTime(
+              peer->node_info.node_id,
+              std::chrono::microseconds(static_cast<int64_t>(2000.0 * Latency(*node, *peer))));
+        }
+      }
+    }
+  }
+
+  struct Result {
+    double hops;
+    double latency_ms;
+    double delivered;  // fraction of lookups ending at the node closest to the target
+  };
+
+  Result Run(bool proximity_routing, size_t lookup_count) {
+    const bool kProximityRouting(Parameters::proximity_routing);
+    Parameters::proximity_routing = proximity_routing;
+    Result result = { 0.0, 0.0, 0.0 };
+    std::mt19937 rng(rng_);
+    std::uniform_int_distribution<size_t> node_distribution(0, nodes_.size() - 1);
+    for (size_t lookup(0); lookup != lookup_count; ++lookup) {
+      SimulatedNode* current(nodes_[node_distribution(rng)].get());
+      const NodeId kTarget(nodes_[node_distribution(rng)]->node_info.node_id ^
+                           NodeId(NodeId::kRandomId) ^ NodeId(NodeId::kRandomId));
+      for (;;) {
+        SimulatedNode* next(NextHop(*current, kTarget));
+        if (!next)
+          break;
+        result.hops += 1.0;
+        result.latency_ms += Latency(*current, *next);
+        current = next;
+      }
+      if (current == Closest(kTarget))
+        result.delivered += 1.0;
+    }
+    result.hops /= static_cast<double>(lookup_count);
+    result.latency_ms /= static_cast<double>(lookup_count);
+    result.delivered /= static_cast<double>(lookup_count);
+    Parameters::proximity_routing = kProximityRouting;
+    return result;
+  }
+
+ private:
+  double Latency(const SimulatedNode& from, const SimulatedNode& to) const {
+    return region_latency_ms_[from.region][to.region] + from.access_ms + to.access_ms;
+  }
+
+  // Returns nullptr if current is the closest node to the target it knows of.
+  SimulatedNode* NextHop(SimulatedNode& current, const NodeId& target) const {
+    NodeInfo peer(current.routing_table.GetNodeForSendingMessage(target,
+                                                                 std::vector<std::string>()));
+    if (peer.node_id.IsZero() ||
+        !NodeId::CloserToTarget(peer.node_id, current.node_info.node_id, target))
+      return nullptr;
+    return Find(peer.node_id);
+  }
+
+  SimulatedNode* Find(const NodeId& node_id) const {
+    for (const auto& node : nodes_) {
+      if (node->node_info.node_id == node_id)
+        return node.get();
+    }
+    return nullptr;
+  }
+
+  SimulatedNode* Closest(const NodeId& target) const {
+    SimulatedNode* closest(nodes_.front().get());
+    for (const auto& node : nodes_) {
+      if (NodeId::CloserToTarget(node->node_info.node_id, closest->node_info.node_id, target))
+        closest = node.get();
+    }
+    return closest;
+  }
+
+  std::vector<std::unique_ptr<SimulatedNode>> nodes_;
+  std::vector<std::vector<double>> region_latency_ms_;
+  std::mt19937 rng_;
+};
+
+}  // unnamed namespace
+
+TEST(ProximityRoutingSimulationTest, FUNC_LatencyAndHops) {
+  ProximityRoutingSimulation simulation(500, 8);
+  const size_t kLookupCount(5000);
+  auto xor_routing(simulation.Run(false, kLookupCount));
+  auto proximity_routing(simulation.Run(true, kLookupCount));
+  std::cout << "XOR routing: " << xor_routing.hops << " hops, " << xor_routing.latency_ms
+            << " ms;  proximity routing: " << proximity_routing.hops << " hops, "
+            << proximity_routing.latency_ms << " ms ("
+            << 100.0 * (xor_routing.latency_ms - proximity_routing.latency_ms) /
+                   xor_routing.latency_ms << "% lower latency)\n";
+  EXPECT_GT(xor_routing.delivered, 0.99);
+  EXPECT_GT(proximity_routing.delivered, 0.99);
+  EXPECT_LT(proximity_routing.latency_ms, xor_routing.latency_ms);
+  EXPECT_LE(proximity_routing.hops, xor_routing.hops);
+}
+
+}  // namespace test
+}  // namespace routing
+}  // namespace maidsafe
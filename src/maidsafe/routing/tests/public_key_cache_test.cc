@@ -0,0 +1,130 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <chrono>
+#include <vector>
+
+#include "boost/filesystem/path.hpp"
+
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/public_key_cache.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(PublicKeyCacheTest, BEH_AddGetExpire) {
+  const std::chrono::minutes kTimeToLive(10);
+  PublicKeyCache cache(4, kTimeToLive);
+  NodeId node_id(NodeId::kRandomId);
+  asymm::PublicKey public_key(asymm::GenerateKeyPair().public_key);
+  InternedPublicKey cached_key;
+  auto now(std::chrono::system_clock::now());
+  EXPECT_FALSE(cache.Get(node_id, cached_key, now));
+
+  // Invalid keys aren't cached.
+  cache.Add(node_id, asymm::PublicKey(), now);
+  EXPECT_FALSE(cache.Get(node_id, cached_key, now));
+
+  cache.Add(node_id, public_key, now);
+  EXPECT_EQ(1U, cache.size());
+  EXPECT_TRUE(cache.Get(node_id, cached_key, now + kTimeToLive / 2));
+  EXPECT_TRUE(asymm::MatchingKeys(public_key, cached_key));
+  // A hit shares the interned key rather than copying it.
+  InternedPublicKey interned_key(public_key);
+  EXPECT_EQ(&interned_key.get(), &cached_key.get());
+  EXPECT_FALSE(cache.Get(node_id, cached_key, now + kTimeToLive));
+  EXPECT_EQ(0U, cache.size());
+
+  // Re-adding renews the expiry.
+  cache.Add(node_id, public_key, now);
+  cache.Add(node_id, public_key, now + kTimeToLive / 2);
+  EXPECT_EQ(1U, cache.size());
+  EXPECT_TRUE(cache.Get(node_id, cached_key, now + kTimeToLive));
+  cache.Remove(node_id);
+  EXPECT_FALSE(cache.Get(node_id, cached_key, now));
+}
+
+TEST(PublicKeyCacheTest, BEH_LeastRecentlyUsedEviction) {
+  PublicKeyCache cache(3, std::chrono::hours(1));
+  asymm::PublicKey public_key(asymm::GenerateKeyPair().public_key);
+  InternedPublicKey cached_key;
+  std::vector<NodeId> node_ids;
+  for (int i(0); i != 4; ++i)
+    node_ids.push_back(NodeId(NodeId::kRandomId));
+  for (int i(0); i != 3; ++i)
+    cache.Add(node_ids[i], public_key);
+  EXPECT_TRUE(cache.Get(node_ids[0], cached_key));
+  cache.Add(node_ids[3], public_key);
+  EXPECT_EQ(3U, cache.size());
+  EXPECT_TRUE(cache.Get(node_ids[0], cached_key));
+  EXPECT_FALSE(cache.Get(node_ids[1], cached_key));
+  EXPECT_TRUE(cache.Get(node_ids[2], cached_key));
+  EXPECT_TRUE(cache.Get(node_ids[3], cached_key));
+
+  PublicKeyCache disabled_cache(0, std::chrono::hours(1));
+  disabled_cache.Add(node_ids[0], public_key);
+  EXPECT_FALSE(disabled_cache.Get(node_ids[0], cached_key));
+}
+
+TEST(PublicKeyCacheTest, BEH_SaveLoad) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestPublicKeyCache"));
+  boost::filesystem::path file_path(*test_path / "public_key_cache");
+  const std::chrono::minutes kTimeToLive(10);
+  asymm::PublicKey public_key(asymm::GenerateKeyPair().public_key);
+  InternedPublicKey cached_key;
+  std::vector<NodeId> node_ids;
+  for (int i(0); i != 3; ++i)
+    node_ids.push_back(NodeId(NodeId::kRandomId));
+  auto now(std::chrono::system_clock::now());
+  {
+    PublicKeyCache cache(4, kTimeToLive);
+    cache.Load(file_path);  // missing file
+    EXPECT_EQ(0U, cache.size());
+    cache.Add(node_ids[0], public_key, now - kTimeToLive / 2);
+    cache.Add(node_ids[1], public_key, now);
+    cache.Add(node_ids[2], public_key, now);
+    EXPECT_TRUE(cache.Get(node_ids[1], cached_key, now));
+    cache.Save(file_path);
+  }
+  // Only the most recently used keys are kept when loading into a smaller cache.
+  PublicKeyCache small_cache(1, kTimeToLive);
+  small_cache.Load(file_path, now);
+  EXPECT_EQ(1U, small_cache.size());
+  EXPECT_TRUE(small_cache.Get(node_ids[1], cached_key, now));
+  EXPECT_TRUE(asymm::MatchingKeys(public_key, cached_key));
+
+  // Keys which have expired since being saved are dropped, and the rest keep their expiry.
+  PublicKeyCache cache(4, kTimeToLive);
+  cache.Load(file_path, now + kTimeToLive * 3 / 4);
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_FALSE(cache.Get(node_ids[0], cached_key, now + kTimeToLive * 3 / 4));
+  EXPECT_TRUE(cache.Get(node_ids[2], cached_key, now + kTimeToLive * 3 / 4));
+  EXPECT_FALSE(cache.Get(node_ids[2], cached_key, now + kTimeToLive + std::chrono::seconds(1)));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -140,6 +140,19 @@ class ResponseHandlerTest : public testing::Test {
     return connect_ack;
   }
 
+  protobuf::ConnectSuccess ComposeConnectSuccess(
+      const NodeId& node_id, const NodeId& connection_id, bool requestor, bool pipelined,
+      const std::vector<std::string>& close_ids = std::vector<std::string>()) {
+    protobuf::ConnectSuccess connect_success;
+    connect_success.set_node_id(node_id.string());
+    connect_success.set_connection_id(connection_id.string());
+    connect_success.set_requestor(requestor);
+    connect_success.set_pipelined(pipelined);
+    for (const auto& close_id : close_ids)
+      connect_success.add_close_ids(close_id);
+    return connect_success;
+  }
+
   protobuf::PingResponse ComposePingResponse(const std::string& ori_ping_request) {
     protobuf::PingResponse ping_response;
     ping_response.set_pong(true);
@@ -279,6 +292,100 @@ TEST_F(ResponseHandlerTest, BEH_FindNodes) {
   response_handler_.FindNodes(message);
 }
 
+TEST_F(ResponseHandlerTest, BEH_FindNodesWithContacts) {
+  NodeInfo node_info = MakeNodeInfoAndKeys().node_info;
+  routing_table_.AddNode(node_info);
+
+  // Connecting to nodes with contacts starts before their connect responses arrive
+  std::vector<NodeId> nodes;
+  for (int i(0); i < 3; ++i)
+    nodes.push_back(NodeId(RandomString(64)));
+  protobuf::FindNodesRequest find_nodes;
+  find_nodes.set_num_nodes_requested(static_cast<int32_t>(nodes.size()));
+  find_nodes.set_target_node(routing_table_.kNodeId().string());
+  protobuf::FindNodesResponse find_nodes_response(
+      ComposeFindNodesResponse(find_nodes.SerializeAsString(), nodes.size(), nodes));
+  SetProtobufContact(find_nodes_response.add_contacts(), nodes.at(0), true);
+  SetProtobufContact(find_nodes_response.add_contacts(), nodes.at(1), true);
+  protobuf::Message message(ComposeMsg(find_nodes_response.SerializeAsString()));
+  std::vector<protobuf::Message> connect_rpcs;
+  EXPECT_CALL(network_, GetAvailableEndpoint(testing::_, testing::_, testing::_, testing::_))
+      .Times(3)
+      .WillRepeatedly(testing::WithArgs<2, 3>(testing::Invoke(
+           boost::bind(&ResponseHandlerTest::GetAvailableEndpoint, this, _1, _2, kSuccess))));
+  EXPECT_CALL(network_, Add(testing::_, testing::_, testing::_))
+      .Times(2)
+      .WillRepeatedly(testing::Return(kSuccess));
+  EXPECT_CALL(network_, SendToClosestNode(testing::_))
+      .Times(3)
+      .WillRepeatedly(testing::Invoke(
+           [&](const protobuf::Message& connect_rpc) { connect_rpcs.push_back(connect_rpc); }));
+  response_handler_.FindNodes(message);
+  ASSERT_EQ(3U, connect_rpcs.size());
+
+  // The response to connect_rpc, from the peer with the given contact.
+  auto connect_response_message([&](const protobuf::Message& connect_rpc,
+                                    const protobuf::Contact& contact) {
+    protobuf::ConnectRequest connect;
+    connect.ParseFromString(connect_rpc.data(0));
+    protobuf::ConnectResponse connect_response(ComposeConnectResponse(
+        protobuf::ConnectResponseType::kAccepted, connect.SerializeAsString(),
+        NodeId(contact.node_id()), true));
+    *connect_response.mutable_contact() = contact;
+    protobuf::Message response(ComposeMsg(connect_response.SerializeAsString()));
+    response.set_id(connect_rpc.id());
+    return response;
+  });
+
+  // No further add to RUDP once a connect response with the same endpoints arrives
+  EXPECT_CALL(network_, Add(testing::_, testing::_, testing::_)).Times(0);
+  message = connect_response_message(connect_rpcs.at(0), find_nodes_response.contacts(0));
+  response_handler_.Connect(message);
+  testing::Mock::VerifyAndClearExpectations(&network_);
+
+  // The endpoints from the connect response are used if they differ from those of the contact
+  protobuf::Contact moved_contact(find_nodes_response.contacts(1));
+  SetProtobufEndpoint(boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(),
+                                                     maidsafe::test::GetRandomPort()),
+                      moved_contact.mutable_public_endpoint());
+  EXPECT_CALL(network_, Add(NodeId(moved_contact.connection_id()), testing::_, testing::_))
+      .WillOnce(testing::Return(kSuccess));
+  message = connect_response_message(connect_rpcs.at(1), moved_contact);
+  response_handler_.Connect(message);
+  testing::Mock::VerifyAndClearExpectations(&network_);
+
+  // Nodes without contacts are added on receipt of the connect response as before
+  protobuf::Contact contact;
+  SetProtobufContact(&contact, nodes.at(2), true);
+  EXPECT_CALL(network_, Add(testing::_, testing::_, testing::_))
+      .WillOnce(testing::Return(kSuccess));
+  message = connect_response_message(connect_rpcs.at(2), contact);
+  response_handler_.Connect(message);
+  testing::Mock::VerifyAndClearExpectations(&network_);
+
+  // An attempt whose connection was lost doesn't stop a later response from connecting
+  NodeId lost_node(RandomString(64));
+  find_nodes_response.clear_nodes();
+  find_nodes_response.add_nodes(lost_node.string());
+  find_nodes_response.clear_contacts();
+  SetProtobufContact(find_nodes_response.add_contacts(), lost_node, true);
+  EXPECT_CALL(network_, GetAvailableEndpoint(testing::_, testing::_, testing::_, testing::_))
+      .WillOnce(testing::WithArgs<2, 3>(testing::Invoke(
+           boost::bind(&ResponseHandlerTest::GetAvailableEndpoint, this, _1, _2, kSuccess))));
+  EXPECT_CALL(network_, Add(testing::_, testing::_, testing::_))
+      .WillOnce(testing::Return(kSuccess));
+  EXPECT_CALL(network_, SendToClosestNode(testing::_)).WillOnce(testing::Invoke(
+      [&](const protobuf::Message& connect_rpc) { connect_rpcs.push_back(connect_rpc); }));
+  message = ComposeMsg(find_nodes_response.SerializeAsString());
+  response_handler_.FindNodes(message);
+  testing::Mock::VerifyAndClearExpectations(&network_);
+  response_handler_.ConnectionLost(NodeId(find_nodes_response.contacts(0).connection_id()));
+  EXPECT_CALL(network_, Add(testing::_, testing::_, testing::_))
+      .WillOnce(testing::Return(kSuccess));
+  message = connect_response_message(connect_rpcs.back(), find_nodes_response.contacts(0));
+  response_handler_.Connect(message);
+}
+
 TEST_F(ResponseHandlerTest, BEH_Connect) {
   protobuf::Message message;
   // Incorrect ConnectResponse msg
@@ -439,6 +546,70 @@ TEST_F(ResponseHandlerTest, BEH_ConnectSuccessAcknowledgement) {
   response_handler->ConnectSuccessAcknowledgement(message);
 }
 
+TEST_F(ResponseHandlerTest, BEH_PipelinedConnectSuccess) {
+  std::shared_ptr<ResponseHandler> response_handler(std::make_shared<ResponseHandler>(
+      routing_table_, client_routing_table_, network_, group_change_handler_));
+  response_handler->set_request_public_key_functor(
+      boost::bind(&ResponseHandlerTest::RequestPublicKey, this, _1, _2));
+  NodeId connection_id(RandomString(64));
+  bool pipelined_connect_handshake(Parameters::pipelined_connect_handshake);
+  Parameters::pipelined_connect_handshake = true;
+
+  // Full handshake, left to Service::ConnectSuccess
+  protobuf::Message message(ComposeMsg(
+      ComposeConnectSuccess(NodeId(RandomString(64)), connection_id, true, false)
+          .SerializeAsString()));
+  EXPECT_FALSE(response_handler->PipelinedConnectSuccess(message));
+  EXPECT_TRUE(message.IsInitialized());
+
+  // This node didn't send a pipelined ConnectSuccess on the connection
+  message = ComposeMsg(ComposeConnectSuccess(NodeId(RandomString(64)), connection_id, true, true)
+                           .SerializeAsString());
+  EXPECT_FALSE(response_handler->PipelinedConnectSuccess(message));
+
+  // Pipelined handshakes disabled on this node
+  network_.MarkPipelinedConnectSuccessSent(connection_id);
+  Parameters::pipelined_connect_handshake = false;
+  EXPECT_FALSE(response_handler->PipelinedConnectSuccess(message));
+  Parameters::pipelined_connect_handshake = true;
+  EXPECT_FALSE(network_.TakePipelinedConnectSuccessSent(connection_id));
+
+  // Bootstrap connection always uses the full handshake
+  NodeId bootstrap_connection_id(RandomString(64));
+  network_.SetBootstrapConnectionId(bootstrap_connection_id);
+  message = ComposeMsg(ComposeConnectSuccess(NodeId(RandomString(64)), bootstrap_connection_id,
+                                             true, true).SerializeAsString());
+  EXPECT_FALSE(response_handler->PipelinedConnectSuccess(message));
+
+  // From requestor, completed without acknowledging
+  network_.MarkPipelinedConnectSuccessSent(connection_id);
+  message = ComposeMsg(ComposeConnectSuccess(NodeId(RandomString(64)), connection_id, true, true)
+                           .SerializeAsString());
+  EXPECT_CALL(network_, MarkConnectionAsValid(testing::_)).WillOnce(testing::Return(kSuccess));
+  EXPECT_CALL(network_, SendToDirect(testing::_, testing::_, testing::_)).Times(0);
+  EXPECT_TRUE(response_handler->PipelinedConnectSuccess(message));
+  EXPECT_FALSE(message.IsInitialized());
+  EXPECT_EQ(1U, routing_table_.size());
+
+  // From responder, connecting to all of its close ids at once
+  std::vector<std::string> close_ids;
+  size_t num_close_ids(4);
+  for (size_t i(0); i < num_close_ids; ++i)
+    close_ids.push_back(RandomString(64));
+  network_.MarkPipelinedConnectSuccessSent(connection_id);
+  message = ComposeMsg(ComposeConnectSuccess(NodeId(RandomString(64)), connection_id, false, true,
+                                             close_ids).SerializeAsString());
+  EXPECT_CALL(network_, MarkConnectionAsValid(testing::_)).WillOnce(testing::Return(kSuccess));
+  EXPECT_CALL(network_, GetAvailableEndpoint(testing::_, testing::_, testing::_, testing::_))
+      .Times(static_cast<int>(num_close_ids))
+      .WillRepeatedly(testing::WithArgs<2, 3>(testing::Invoke(
+           boost::bind(&ResponseHandlerTest::GetAvailableEndpoint, this, _1, _2, kSuccess))));
+  EXPECT_CALL(network_, SendToClosestNode(testing::_)).Times(static_cast<int>(num_close_ids));
+  EXPECT_TRUE(response_handler->PipelinedConnectSuccess(message));
+  EXPECT_EQ(2U, routing_table_.size());
+  Parameters::pipelined_connect_handshake = pipelined_connect_handshake;
+}
+
 TEST_F(ResponseHandlerTest, BEH_Ping) {
   protobuf::Message message;
   // Incorrect Ping msg
@@ -20,6 +20,7 @@
 #include <atomic>
 #include <chrono>
 #include <future>
+#include <iostream>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -126,6 +127,46 @@ TEST(APITest, BEH_API_ZeroState) {
   LOG(kInfo) << "done!!!";
 }
 
+TEST(APITest, FUNC_API_ZeroStateSeedNetworkStartup) {
+  // Each zero state pair previously slept for at least 200 ms while joining, polling its routing
+  // table at 100 ms intervals.
+  const int kPairCount(8);
+  const std::chrono::milliseconds kPreviousMinimumPairStartup(200);
+  Functors functors;
+  functors.network_status = [](int) {};  // NOLINT
+  functors.message_and_caching.message_received = no_ops_message_received_functor;
+  functors.request_public_key = [](const NodeId&, GivePublicKeyFunctor) {};  // NOLINT
+  std::vector<std::unique_ptr<Routing>> routings;
+  std::chrono::steady_clock::duration total_startup(std::chrono::steady_clock::duration::zero());
+  for (int i(0); i != kPairCount; ++i) {
+    auto pmid1(MakePmid()), pmid2(MakePmid());
+    NodeInfoAndPrivateKey node1(MakeNodeInfoAndKeysWithPmid(pmid1));
+    NodeInfoAndPrivateKey node2(MakeNodeInfoAndKeysWithPmid(pmid2));
+    routings.push_back(std::unique_ptr<Routing>(new Routing(pmid1)));
+    routings.push_back(std::unique_ptr<Routing>(new Routing(pmid2)));
+    Routing& routing1(*routings.at(routings.size() - 2));
+    Routing& routing2(*routings.back());
+    Endpoint endpoint1(maidsafe::GetLocalIp(), maidsafe::test::GetRandomPort()),
+        endpoint2(maidsafe::GetLocalIp(), maidsafe::test::GetRandomPort());
+    auto start(std::chrono::steady_clock::now());
+    auto a1 = boost::async(boost::launch::async, [&] {
+      return routing1.ZeroStateJoin(functors, endpoint1, endpoint2, node2.node_info);
+    });
+    auto a2 = boost::async(boost::launch::async, [&] {
+      return routing2.ZeroStateJoin(functors, endpoint2, endpoint1, node1.node_info);
+    });
+    EXPECT_EQ(kSuccess, a2.get());
+    EXPECT_EQ(kSuccess, a1.get());
+    total_startup += std::chrono::steady_clock::now() - start;
+  }
+  auto mean_startup(std::chrono::duration_cast<std::chrono::milliseconds>(total_startup) /
+                    kPairCount);
+  std::cout << "Started " << kPairCount << " zero state pairs, mean " << mean_startup.count()
+            << " ms per pair (previously at least " << kPreviousMinimumPairStartup.count()
+            << " ms)\n";
+  EXPECT_LT(mean_startup, kPreviousMinimumPairStartup);
+}
+
 TEST(APITest, DISABLED_BEH_API_ZeroStateWithDuplicateNode) {
   rudp::Parameters::bootstrap_connection_lifespan = boost::posix_time::seconds(5);
   auto pmid1(MakePmid()), pmid2(MakePmid()), pmid3(MakePmid());
@@ -16,10 +16,16 @@
     See the Licences for the specific language governing permissions and limitations relating to
     use of the MaidSafe Software.                                                                 */
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 #include <vector>
 
+#include "boost/filesystem/operations.hpp"
 #include "boost/progress.hpp"
 
+#include "maidsafe/common/test.h"
+
 #include "maidsafe/rudp/nat_type.h"
 
 #include "maidsafe/routing/tests/routing_network.h"
@@ -669,6 +675,40 @@ TEST_F(RoutingNetworkTest, FUNC_ClientJoinWhenClosestVaultAlsoBehindSymmetricNat
   env_->AddNode(sym_node2, true);
 }
 
+TEST_F(RoutingNetworkTest, FUNC_WarmRestart) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestSnapshot"));
+  auto pmid(MakePmid());
+  NodeId node_id(pmid.name());
+  auto time_to_full_routing_table([&]()->std::chrono::milliseconds {
+    auto start(std::chrono::steady_clock::now());
+    env_->AddNode(pmid);
+    auto node(env_->nodes_.at(env_->NodeIndex(node_id)));
+    size_t full_size(std::min(static_cast<size_t>(env_->ClientIndex() - 1),
+                              static_cast<size_t>(Parameters::greedy_fraction)));
+    while (node->RoutingTable().size() < full_size &&
+           std::chrono::steady_clock::now() - start < std::chrono::minutes(2))
+      Sleep(std::chrono::milliseconds(50));
+    EXPECT_LE(full_size, node->RoutingTable().size());
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+  });
+
+  auto cold_start_time(time_to_full_routing_table());
+  // The snapshot is written when the node is destroyed.
+  Parameters::routing_table_snapshot_path = *test_path;
+  EXPECT_TRUE(env_->RemoveNode(node_id));
+  EXPECT_TRUE(boost::filesystem::exists(
+      *test_path / node_id.ToStringEncoded(NodeId::EncodingType::kHex)));
+  EXPECT_TRUE(env_->WaitForHealthToStabilise());
+
+  auto warm_start_time(time_to_full_routing_table());
+  Parameters::routing_table_snapshot_path.clear();
+  EXPECT_TRUE(env_->RemoveNode(node_id));
+  std::cout << "Time to full routing table - cold start: " << cold_start_time.count()
+            << " ms, warm start: " << warm_start_time.count() << " ms\n";
+  EXPECT_LT(warm_start_time, cold_start_time);
+}
+
 }  // namespace test
 
 }  // namespace routing
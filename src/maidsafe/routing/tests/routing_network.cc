@@ -380,14 +380,14 @@ void GenericNode::PrintRoutingTable() {
              << (IsClient() ? " (Client)" : " (Vault) :")
              << "Routing table size: " << routing_->pimpl_->routing_table_.nodes_.size();
   {
-    std::lock_guard<std::mutex> lock(routing_->pimpl_->routing_table_.mutex_);
+    std::lock_guard<InstrumentedMutex> lock(routing_->pimpl_->routing_table_.mutex_);
     for (const auto& node_info : routing_->pimpl_->routing_table_.nodes_) {
       LOG(kInfo) << "\tNodeId : " << HexSubstr(node_info.node_id.string());
     }
   }
   LOG(kInfo) << "[" << HexSubstr(node_info_plus_->node_info.node_id.string())
              << "]'s Non-RoutingTable : ";
-  std::lock_guard<std::mutex> lock(routing_->pimpl_->client_routing_table_.mutex_);
+  std::lock_guard<InstrumentedMutex> lock(routing_->pimpl_->client_routing_table_.mutex_);
   for (const auto& node_info : routing_->pimpl_->client_routing_table_.nodes_) {
     LOG(kInfo) << "\tNodeId : " << HexSubstr(node_info.node_id.string());
   }
@@ -395,7 +395,7 @@ void GenericNode::PrintRoutingTable() {
 
 std::vector<NodeId> GenericNode::ReturnRoutingTable() {
   std::vector<NodeId> routing_nodes;
-  std::lock_guard<std::mutex> lock(routing_->pimpl_->routing_table_.mutex_);
+  std::lock_guard<InstrumentedMutex> lock(routing_->pimpl_->routing_table_.mutex_);
   for (const auto& node_info : routing_->pimpl_->routing_table_.nodes_)
     routing_nodes.push_back(node_info.node_id);
   return routing_nodes;
@@ -438,8 +438,8 @@ void GenericNode::SetHealth(int health) {
 }
 
 void GenericNode::PostTaskToAsioService(std::function<void()> functor) {
-  std::lock_guard<std::mutex> lock(routing_->pimpl_->running_mutex_);
-  if (routing_->pimpl_->running_)
+  Lifecycle::Operation operation(routing_->pimpl_->lifecycle_);
+  if (operation)
     routing_->pimpl_->asio_service_.service().post(functor);
 }
 
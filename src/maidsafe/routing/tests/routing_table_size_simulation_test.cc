@@ -0,0 +1,179 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// In-process simulation of greedy XOR routing in networks of up to 100k vaults, comparing the hop
+// count and the number of connections each vault holds under the static and the adaptive routing
+// table targets.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_table.h"
+
+namespace maidsafe {
+namespace routing {
+namespace test {
+
+namespace {
+
+// Ids are truncated to their leading 64 bits, which is ample to tell 100k vaults apart.
+class RoutingTableSizeSimulation {
+ public:
+  explicit RoutingTableSizeSimulation(size_t node_count) : ids_(), rng_(11) {
+    std::uniform_int_distribution<uint64_t> distribution;
+    while (ids_.size() != node_count)
+      ids_.push_back(distribution(rng_));
+    std::sort(ids_.begin(), ids_.end());
+    ids_.erase(std::unique(ids_.begin(), ids_.end()), ids_.end());
+  }
+
+  struct Result {
+    double hops;
+    double connections;
+    double delivered;  // fraction of lookups ending at the vault closest to the target
+  };
+
+  Result Run(const RoutingTableTarget& target, size_t lookup_count) {
+    Result result = { 0.0, 0.0, 0.0 };
+    std::uniform_int_distribution<size_t> node_distribution(0, ids_.size() - 1);
+    std::uniform_int_distribution<uint64_t> id_distribution;
+    std::mt19937_64 rng(rng_);
+    for (size_t lookup(0); lookup != lookup_count; ++lookup) {
+      size_t current(node_distribution(rng));
+      const uint64_t kTarget(id_distribution(rng));
+      for (;;) {
+        std::vector<size_t> table(Table(current, target));
+        result.connections += static_cast<double>(table.size());
+        size_t next(current);
+        for (size_t peer : table) {
+          if ((ids_[peer] ^ kTarget) < (ids_[next] ^ kTarget))
+            next = peer;
+        }
+        if (next == current)
+          break;
+        current = next;
+        result.hops += 1.0;
+      }
+      if (current == Closest(kTarget))
+        result.delivered += 1.0;
+    }
+    result.connections /= result.hops + static_cast<double>(lookup_count);
+    result.hops /= static_cast<double>(lookup_count);
+    result.delivered /= static_cast<double>(lookup_count);
+    return result;
+  }
+
+ private:
+  // Range of indices of ids sharing exactly common_bits leading bits with ids_[node].
+  std::pair<size_t, size_t> Bucket(size_t node, int common_bits) const {
+    const int kShift(63 - common_bits);
+    const uint64_t kLow(((ids_[node] >> kShift) ^ 1) << kShift);
+    const uint64_t kHigh(kLow | ((uint64_t(1) << kShift) - 1));
+    return std::make_pair(
+        static_cast<size_t>(std::lower_bound(ids_.begin(), ids_.end(), kLow) - ids_.begin()),
+        static_cast<size_t>(std::upper_bound(ids_.begin(), ids_.end(), kHigh) - ids_.begin()));
+  }
+
+  // The closest nodes, then bucket_target_size peers from each other bucket topped up evenly to
+  // fill max_size.  Peers are chosen at random, but the same ones each time the node is visited.
+  std::vector<size_t> Table(size_t node, const RoutingTableTarget& target) const {
+    std::vector<size_t> table;
+    int common_bits(63);
+    for (; common_bits >= 0 && table.size() < Parameters::closest_nodes_size; --common_bits) {
+      auto bucket(Bucket(node, common_bits));
+      std::vector<size_t> members;
+      for (size_t i(bucket.first); i != bucket.second; ++i)
+        members.push_back(i);
+      const uint64_t kId(ids_[node]);
+      std::sort(members.begin(), members.end(), [&](size_t lhs, size_t rhs) {
+        return (ids_[lhs] ^ kId) < (ids_[rhs] ^ kId);
+      });
+      for (size_t i(0); i != members.size() && table.size() < Parameters::closest_nodes_size; ++i)
+        table.push_back(members[i]);
+    }
+    if (common_bits < 0)
+      return table;
+    const size_t kRemaining(target.max_size > table.size() ? target.max_size - table.size() : 0);
+    const size_t kPerBucket(std::max<size_t>(target.bucket_target_size,
+                                             kRemaining / (common_bits + 1)));
+    std::mt19937 rng(static_cast<uint32_t>(node));
+    for (int bits(0); bits <= common_bits && table.size() < target.max_size; ++bits) {
+      auto bucket(Bucket(node, bits));
+      const size_t kCount(std::min(bucket.second - bucket.first, kPerBucket));
+      std::uniform_int_distribution<size_t> distribution(bucket.first, bucket.second - 1);
+      const size_t kBucketStart(table.size());
+      while (table.size() - kBucketStart != kCount && table.size() < target.max_size) {
+        size_t peer(distribution(rng));
+        if (std::find(table.begin() + kBucketStart, table.end(), peer) == table.end())
+          table.push_back(peer);
+      }
+    }
+    return table;
+  }
+
+  size_t Closest(uint64_t target) const {
+    size_t best(0);
+    for (size_t i(1); i != ids_.size(); ++i) {
+      if ((ids_[i] ^ target) < (ids_[best] ^ target))
+        best = i;
+    }
+    return best;
+  }
+
+  std::vector<uint64_t> ids_;
+  std::mt19937_64 rng_;
+};
+
+}  // unnamed namespace
+
+TEST(RoutingTableSizeSimulationTest, FUNC_HopsVersusConnections) {
+  const bool kAdaptive(Parameters::adaptive_routing_table_size);
+  const size_t kLookupCount(2000);
+  std::vector<RoutingTableSizeSimulation::Result> static_results, adaptive_results;
+  for (size_t network_size : { 1000, 10000, 100000 }) {
+    RoutingTableSizeSimulation simulation(network_size);
+    Parameters::adaptive_routing_table_size = false;
+    static_results.push_back(simulation.Run(VaultRoutingTableTarget(network_size), kLookupCount));
+    Parameters::adaptive_routing_table_size = true;
+    const RoutingTableTarget kTarget(VaultRoutingTableTarget(network_size));
+    adaptive_results.push_back(simulation.Run(kTarget, kLookupCount));
+    std::cout << network_size << " vaults - static table: " << static_results.back().hops
+              << " hops, " << static_results.back().connections << " connections;  adaptive table ("
+              << kTarget.max_size << " max, " << kTarget.bucket_target_size
+              << " per bucket): " << adaptive_results.back().hops << " hops, "
+              << adaptive_results.back().connections << " connections\n";
+    EXPECT_GT(static_results.back().delivered, 0.99);
+    EXPECT_GT(adaptive_results.back().delivered, 0.99);
+  }
+  Parameters::adaptive_routing_table_size = kAdaptive;
+
+  // Small networks need fewer connections, large ones fewer hops.
+  EXPECT_LT(adaptive_results.front().connections, static_results.front().connections);
+  EXPECT_LT(adaptive_results.back().hops, static_results.back().hops);
+}
+
+}  // namespace test
+}  // namespace routing
+}  // namespace maidsafe
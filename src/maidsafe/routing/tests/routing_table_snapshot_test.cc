@@ -0,0 +1,87 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <string>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/routing_table_snapshot.h"
+#include "maidsafe/routing/tests/test_utils.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+namespace routing {
+namespace test {
+
+TEST(RoutingTableSnapshotTest, BEH_ReadWrite) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestUtils"));
+  fs::path snapshot_file_path(*test_path / "snapshot");
+  EXPECT_THROW(ReadRoutingTableSnapshot(snapshot_file_path), std::exception);
+
+  RoutingTableSnapshot snapshot;
+  snapshot.node_id = NodeId(NodeId::kRandomId);
+  for (int i(0); i < 10; ++i) {
+    RoutingTableSnapshot::Peer peer;
+    peer.node_info = MakeNode();
+    peer.node_info.connection_id = NodeId(NodeId::kRandomId);
+    // Leave the endpoint of some peers unknown.
+    if (i % 3 != 0)
+      peer.endpoint = boost::asio::ip::udp::endpoint(GetLocalIp(), maidsafe::test::GetRandomPort());
+    for (int j(0); j < i % 4; ++j) {
+      NodeInfo node_info;
+      node_info.node_id = NodeId(NodeId::kRandomId);
+      node_info.rank = j;
+      peer.matrix_row.push_back(node_info);
+    }
+    snapshot.peers.push_back(peer);
+  }
+  EXPECT_NO_THROW(WriteRoutingTableSnapshot(snapshot, snapshot_file_path));
+  EXPECT_FALSE(fs::exists(snapshot_file_path.string() + ".tmp"));
+
+  RoutingTableSnapshot read_snapshot(ReadRoutingTableSnapshot(snapshot_file_path));
+  EXPECT_EQ(snapshot.node_id, read_snapshot.node_id);
+  ASSERT_EQ(snapshot.peers.size(), read_snapshot.peers.size());
+  for (size_t i(0); i != snapshot.peers.size(); ++i) {
+    const auto& expected(snapshot.peers[i]), &actual(read_snapshot.peers[i]);
+    EXPECT_EQ(expected.node_info.node_id, actual.node_info.node_id);
+    EXPECT_EQ(expected.node_info.connection_id, actual.node_info.connection_id);
+    EXPECT_TRUE(asymm::MatchingKeys(expected.node_info.public_key, actual.node_info.public_key));
+    EXPECT_EQ(expected.endpoint, actual.endpoint);
+    ASSERT_EQ(expected.matrix_row.size(), actual.matrix_row.size());
+    for (size_t j(0); j != expected.matrix_row.size(); ++j) {
+      EXPECT_EQ(expected.matrix_row[j].node_id, actual.matrix_row[j].node_id);
+      EXPECT_EQ(expected.matrix_row[j].rank, actual.matrix_row[j].rank);
+    }
+  }
+
+  // Overwriting replaces the previous snapshot.
+  snapshot.peers.resize(2);
+  EXPECT_NO_THROW(WriteRoutingTableSnapshot(snapshot, snapshot_file_path));
+  EXPECT_EQ(2U, ReadRoutingTableSnapshot(snapshot_file_path).peers.size());
+
+  EXPECT_THROW(ParseRoutingTableSnapshot(RandomString(100)), std::exception);
+}
+
+}  // namespace test
+}  // namespace routing
+}  // namespace maidsafe
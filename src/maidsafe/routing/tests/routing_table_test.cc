@@ -17,7 +17,10 @@
     use of the MaidSafe Software.                                                                 */
 
 #include <bitset>
+#include <chrono>
+#include <limits>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "maidsafe/common/log.h"
@@ -88,6 +91,136 @@ TEST(RoutingTableTest, FUNC_AddTooManyNodes) {
   EXPECT_EQ(routing_table.size(), Parameters::max_routing_table_size);
 }
 
+TEST(RoutingTableTest, BEH_AdaptiveTarget) {
+  const bool kAdaptive(Parameters::adaptive_routing_table_size);
+  Parameters::adaptive_routing_table_size = false;
+  RoutingTableTarget target(VaultRoutingTableTarget(100000));
+  EXPECT_EQ(Parameters::max_routing_table_size, target.max_size);
+  EXPECT_EQ(Parameters::routing_table_size_threshold, target.threshold_size);
+  EXPECT_EQ(Parameters::greedy_fraction, target.greedy_size);
+  EXPECT_EQ(Parameters::bucket_target_size, target.bucket_target_size);
+
+  Parameters::adaptive_routing_table_size = true;
+  target = VaultRoutingTableTarget(0);
+  EXPECT_EQ(Parameters::max_routing_table_size, target.max_size);
+  RoutingTableTarget previous(VaultRoutingTableTarget(1));
+  EXPECT_EQ(Parameters::min_adaptive_routing_table_size, previous.max_size);
+  for (uint64_t network_size(2); network_size < 100000000; network_size *= 3) {
+    target = VaultRoutingTableTarget(network_size);
+    EXPECT_GE(target.max_size, previous.max_size);
+    EXPECT_GE(target.max_size, Parameters::min_adaptive_routing_table_size);
+    EXPECT_LE(target.max_size, Parameters::max_adaptive_routing_table_size);
+    EXPECT_LT(target.threshold_size, target.greedy_size);
+    EXPECT_LT(target.greedy_size, target.max_size);
+    EXPECT_GE(target.bucket_target_size, Parameters::bucket_target_size);
+    previous = target;
+  }
+  EXPECT_EQ(Parameters::max_adaptive_routing_table_size, previous.max_size);
+  Parameters::adaptive_routing_table_size = kAdaptive;
+}
+
+TEST(RoutingTableTest, FUNC_AdaptiveMaxSize) {
+  const bool kAdaptive(Parameters::adaptive_routing_table_size);
+  Parameters::adaptive_routing_table_size = true;
+  NodeId node_id(NodeId::kRandomId);
+  NetworkStatistics network_statistics(node_id);
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair(), network_statistics);
+  EXPECT_EQ(Parameters::max_routing_table_size, routing_table.target().max_size);
+
+  // Report the average group distance of a network of about 1000 vaults.
+  const uint64_t kAverageDistance(std::numeric_limits<uint64_t>::max() / 1001 *
+                                  Parameters::group_size);
+  std::string distance(NodeId::kSize, 0);
+  for (int i(0); i != 8; ++i)
+    distance[i] = static_cast<char>(kAverageDistance >> (56 - 8 * i));
+  network_statistics.UpdateNetworkAverageDistance(NodeId(distance));
+  const RoutingTableTarget kTarget(routing_table.target());
+  EXPECT_EQ(VaultRoutingTableTarget(network_statistics.EstimateNetworkSize()).max_size,
+            kTarget.max_size);
+  EXPECT_LT(kTarget.max_size, Parameters::max_routing_table_size);
+
+  for (uint16_t i = 0; routing_table.size() < kTarget.max_size; ++i)
+    EXPECT_TRUE(routing_table.AddNode(MakeNode()));
+  for (uint16_t i = 0; i < 100; ++i) {
+    NodeInfo node(MakeNode());
+    if (routing_table.CheckNode(node)) {
+      EXPECT_TRUE(routing_table.AddNode(node));
+    }
+  }
+  EXPECT_EQ(kTarget.max_size, routing_table.size());
+  Parameters::adaptive_routing_table_size = kAdaptive;
+}
+
+namespace {
+
+NodeId FlipBits(const NodeId& node_id, const std::vector<int>& bits) {
+  std::string raw_id(node_id.string());
+  for (int bit : bits)
+    raw_id[bit / 8] = static_cast<char>(raw_id[bit / 8] ^ (0x80 >> (bit % 8)));
+  return NodeId(raw_id);
+}
+
+NodeInfo MakeNodeWithId(const NodeId& node_id) {
+  NodeInfo node(MakeNode());
+  node.node_id = node_id;
+  node.connection_id = node_id;
+  return node;
+}
+
+}  // unnamed namespace
+
+TEST(RoutingTableTest, BEH_ProximityRouting) {
+  const bool kProximityRouting(Parameters::proximity_routing);
+  NodeId node_id(NodeId::kRandomId);
+  NetworkStatistics network_statistics(node_id);
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair(), network_statistics);
+  for (int i(0); i != Parameters::closest_nodes_size; ++i) {
+    NodeInfo close_node(MakeNodeWithId(FlipBits(node_id, std::vector<int>(1, 400 + i))));
+    ASSERT_TRUE(routing_table.AddNode(close_node));
+  }
+
+  // Both peers share 20 leading bits with the far target; the second is further from it.
+  const NodeId kTarget(FlipBits(node_id, std::vector<int>(1, 0)));
+  const NodeId kCloserPeer(FlipBits(kTarget, std::vector<int>(1, 20)));
+  std::vector<int> further_bits(1, 20);
+  further_bits.push_back(100);
+  const NodeId kFurtherPeer(FlipBits(kTarget, further_bits));
+  const NodeId kOtherLevelPeer(FlipBits(kTarget, std::vector<int>(1, 19)));
+  // Shares 20 leading bits with the target too, but is in the other half of its bucket.
+  std::vector<int> other_half_bits(1, 20);
+  other_half_bits.push_back(21);
+  const NodeId kOtherHalfPeer(FlipBits(kTarget, other_half_bits));
+  ASSERT_TRUE(routing_table.AddNode(MakeNodeWithId(kCloserPeer)));
+  ASSERT_TRUE(routing_table.AddNode(MakeNodeWithId(kFurtherPeer)));
+  ASSERT_TRUE(routing_table.AddNode(MakeNodeWithId(kOtherLevelPeer)));
+  ASSERT_TRUE(routing_table.AddNode(MakeNodeWithId(kOtherHalfPeer)));
+
+  routing_table.UpdateRoundTripTime(kCloserPeer, std::chrono::milliseconds(100));
+  routing_table.UpdateRoundTripTime(kFurtherPeer, std::chrono::milliseconds(40));
+  routing_table.UpdateRoundTripTime(kFurtherPeer, std::chrono::milliseconds(8));
+  routing_table.UpdateRoundTripTime(kOtherLevelPeer, std::chrono::milliseconds(1));
+  routing_table.UpdateRoundTripTime(kOtherHalfPeer, std::chrono::milliseconds(1));
+  NodeInfo node_info;
+  ASSERT_TRUE(routing_table.GetNodeInfo(kFurtherPeer, node_info));
+  EXPECT_EQ(std::chrono::microseconds(36000), node_info.round_trip_time);
+
+  const std::vector<std::string> kNoExclusions;
+  Parameters::proximity_routing = false;
+  EXPECT_EQ(kCloserPeer,
+            routing_table.GetNodeForSendingMessage(kTarget, kNoExclusions, false).node_id);
+  Parameters::proximity_routing = true;
+  EXPECT_EQ(kFurtherPeer,
+            routing_table.GetNodeForSendingMessage(kTarget, kNoExclusions, false).node_id);
+  EXPECT_EQ(kCloserPeer,
+            routing_table.GetNodeForSendingMessage(
+                kTarget, std::vector<std::string>(1, kFurtherPeer.string()), false).node_id);
+  // Destinations within this node's close group are reached by XOR closeness alone.
+  const NodeId kCloseTarget(FlipBits(node_id, std::vector<int>(1, 511)));
+  EXPECT_EQ(routing_table.GetClosestNode(kCloseTarget).node_id,
+            routing_table.GetNodeForSendingMessage(kCloseTarget, kNoExclusions, false).node_id);
+  Parameters::proximity_routing = kProximityRouting;
+}
+
 TEST(RoutingTableTest, BEH_PopulateAndDepopulateGroupCheckGroupChange) {
   NodeId node_id(NodeId::kRandomId);
   NetworkStatistics network_statistics(node_id);
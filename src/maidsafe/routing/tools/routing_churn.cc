@@ -0,0 +1,400 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+// Drives vaults joining and leaving a simulated network, and reports for each event how long the
+// group matrices of the vaults it affects took to converge, the ClosestNodesUpdate, FindNodes and
+// Connect messages sent meanwhile, and the duplicate or stale matrix change notifications.  The
+// network runs in virtual time unless --real-time is given.  An event isn't started until the
+// previous one has converged or timed out, so the given rates are maxima.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "boost/program_options.hpp"
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/benchmarks/simulated_network.h"
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/matrix_change.h"
+#include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/parameters.h"
+
+namespace po = boost::program_options;
+
+namespace {
+
+typedef maidsafe::NodeId NodeId;
+typedef maidsafe::routing::Clock Clock;
+typedef maidsafe::routing::Parameters Parameters;
+typedef maidsafe::routing::test::SimulatedNetwork SimulatedNetwork;
+
+const std::chrono::milliseconds kPollInterval(10);
+const size_t kMessageTypeCount(3);
+const char* const kMessageTypes[kMessageTypeCount] = {"closest_nodes_update", "find_nodes",
+                                                      "connect"};
+
+struct EventResult {
+  EventResult()
+      : index(0),
+        join(false),
+        vault_id(),
+        time(0.0),
+        affected_count(0),
+        converged(false),
+        convergence_time(0.0),
+        message_counts(),
+        matrix_changes(0),
+        duplicate_matrix_changes(0),
+        stale_matrix_changes(0) {}
+  size_t index;
+  bool join;
+  NodeId vault_id;
+  double time;  // seconds since the network was built
+  size_t affected_count;
+  bool converged;
+  double convergence_time;  // milliseconds
+  uint64_t message_counts[kMessageTypeCount];
+  uint64_t matrix_changes, duplicate_matrix_changes, stale_matrix_changes;
+};
+
+// Follows each vault's group matrix as reported by its matrix change notifications.  A notification
+// is a duplicate if it changes nothing already reported, and stale if it adds a departed vault.
+class MatrixChangeMonitor {
+ public:
+  MatrixChangeMonitor()
+      : mutex_(), matrices_(), departed_(), changes_(0), duplicates_(0), stale_(0) {}
+
+  void OnMatrixChanged(const NodeId& vault_id,
+                       std::shared_ptr<maidsafe::routing::MatrixChange> matrix_change) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::set<NodeId>& matrix(matrices_[vault_id]);
+    bool changed(false), stale(false);
+    for (const auto& node_id : matrix_change->new_nodes()) {
+      changed = matrix.insert(node_id).second || changed;
+      stale = stale || departed_.count(node_id) != 0;
+    }
+    for (const auto& node_id : matrix_change->lost_nodes())
+      changed = matrix.erase(node_id) != 0 || changed;
+    ++changes_;
+    if (!changed)
+      ++duplicates_;
+    if (stale)
+      ++stale_;
+  }
+
+  void VaultLeft(const NodeId& vault_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    departed_.insert(vault_id);
+    matrices_.erase(vault_id);
+  }
+
+  // Counts of notifications since the last call.
+  void TakeCounts(EventResult& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.matrix_changes = changes_;
+    result.duplicate_matrix_changes = duplicates_;
+    result.stale_matrix_changes = stale_;
+    changes_ = duplicates_ = stale_ = 0;
+  }
+
+ private:
+  MatrixChangeMonitor(const MatrixChangeMonitor&);
+  MatrixChangeMonitor& operator=(const MatrixChangeMonitor&);
+
+  std::mutex mutex_;
+  std::map<NodeId, std::set<NodeId>> matrices_;
+  std::set<NodeId> departed_;
+  uint64_t changes_, duplicates_, stale_;
+};
+
+// A vault affected by an event, with the peers which should be closest to it afterwards.
+struct AffectedVault {
+  NodeId vault_id;
+  std::vector<NodeId> expected_closest;
+  bool converged;
+};
+
+std::vector<NodeId> VaultIds(SimulatedNetwork& network) {
+  std::vector<NodeId> vault_ids;
+  for (size_t i(0); i != network.size(); ++i)
+    vault_ids.push_back(network.vault_id(i));
+  return vault_ids;
+}
+
+std::vector<NodeId> ClosestTo(std::vector<NodeId> vault_ids, const NodeId& target) {
+  vault_ids.erase(std::remove(vault_ids.begin(), vault_ids.end(), target), vault_ids.end());
+  size_t count(std::min(vault_ids.size(), static_cast<size_t>(Parameters::closest_nodes_size)));
+  std::partial_sort(vault_ids.begin(), vault_ids.begin() + count, vault_ids.end(),
+                    [&](const NodeId& lhs, const NodeId& rhs) {
+    return NodeId::CloserToTarget(lhs, rhs, target);
+  });
+  vault_ids.resize(count);
+  return vault_ids;
+}
+
+// The vaults with 'subject' among their closest peers, and 'subject' itself if it is in the
+// network.  Afterwards each should have its closest peers in its group matrix and not 'departed'.
+std::vector<AffectedVault> AffectedVaults(const std::vector<NodeId>& vault_ids_before,
+                                          const std::vector<NodeId>& vault_ids_after,
+                                          const NodeId& subject) {
+  std::vector<AffectedVault> affected_vaults;
+  const std::vector<NodeId>& vault_ids(vault_ids_before.size() > vault_ids_after.size()
+                                           ? vault_ids_before
+                                           : vault_ids_after);
+  for (const auto& vault_id : vault_ids) {
+    if (vault_id == subject) {
+      if (vault_ids_after.size() > vault_ids_before.size())
+        affected_vaults.push_back(AffectedVault{vault_id, ClosestTo(vault_ids_after, vault_id),
+                                                false});
+      continue;
+    }
+    size_t closer_count(0);
+    for (const auto& other_id : vault_ids) {
+      if (other_id != vault_id && other_id != subject &&
+          NodeId::CloserToTarget(other_id, subject, vault_id))
+        ++closer_count;
+    }
+    if (closer_count < Parameters::closest_nodes_size)
+      affected_vaults.push_back(AffectedVault{vault_id, ClosestTo(vault_ids_after, vault_id),
+                                              false});
+  }
+  return affected_vaults;
+}
+
+bool HasConverged(SimulatedNetwork& network, size_t index, const AffectedVault& affected_vault,
+                  const NodeId& departed) {
+  std::set<NodeId> matrix;
+  for (const auto& node_info : network.vault(index).ClosestNodes())
+    matrix.insert(node_info.node_id);
+  if (matrix.count(departed) != 0)
+    return false;
+  for (const auto& node_id : affected_vault.expected_closest) {
+    if (matrix.count(node_id) == 0)
+      return false;
+  }
+  return true;
+}
+
+void SumMessageCounts(SimulatedNetwork& network, uint64_t (&counts)[kMessageTypeCount]) {
+  for (size_t i(0); i != kMessageTypeCount; ++i) {
+    counts[i] = network.SumCounter(std::string("routing_messages_sent_total{type=\"") +
+                                   kMessageTypes[i] + "\"}");
+  }
+}
+
+double Seconds(const Clock::duration& duration) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+}
+
+EventResult RunEvent(SimulatedNetwork& network, MatrixChangeMonitor& monitor, bool join,
+                     std::mt19937& generator, const Clock::duration& timeout) {
+  EventResult result;
+  result.join = join;
+  const std::vector<NodeId> kVaultIdsBefore(VaultIds(network));
+  uint64_t counts_before[kMessageTypeCount];
+  NodeId departed;
+  if (join) {
+    SumMessageCounts(network, counts_before);
+    monitor.TakeCounts(result);
+    network.AddVault();
+    result.vault_id = network.vault_id(network.size() - 1);
+  } else {
+    size_t index(std::uniform_int_distribution<size_t>(0, network.size() - 1)(generator));
+    departed = result.vault_id = network.vault_id(index);
+    monitor.VaultLeft(departed);
+    network.RemoveVault(index);
+    SumMessageCounts(network, counts_before);
+    monitor.TakeCounts(result);
+  }
+  const Clock::time_point kStart(Clock::now());
+
+  std::vector<AffectedVault> affected_vaults(
+      AffectedVaults(kVaultIdsBefore, VaultIds(network), result.vault_id));
+  result.affected_count = affected_vaults.size();
+  size_t converged_count(0);
+  while (converged_count != affected_vaults.size() && Clock::now() - kStart < timeout) {
+    network.Run(kPollInterval);
+    std::map<NodeId, size_t> indices;
+    for (size_t i(0); i != network.size(); ++i)
+      indices[network.vault_id(i)] = i;
+    for (auto& affected_vault : affected_vaults) {
+      if (!affected_vault.converged &&
+          HasConverged(network, indices[affected_vault.vault_id], affected_vault, departed)) {
+        affected_vault.converged = true;
+        ++converged_count;
+      }
+    }
+  }
+  result.converged = converged_count == affected_vaults.size();
+  result.convergence_time = Seconds(Clock::now() - kStart) * 1000.0;
+
+  uint64_t counts_after[kMessageTypeCount];
+  SumMessageCounts(network, counts_after);
+  for (size_t i(0); i != kMessageTypeCount; ++i)
+    result.message_counts[i] = counts_after[i] - counts_before[i];
+  monitor.TakeCounts(result);
+  return result;
+}
+
+void WriteCsv(const std::vector<EventResult>& results, std::ostream& output) {
+  output << "event,type,vault,time_s,affected,converged,convergence_ms";
+  for (const auto& type : kMessageTypes)
+    output << ',' << type;
+  output << ",matrix_changes,duplicate_matrix_changes,stale_matrix_changes\n";
+  for (const auto& result : results) {
+    output << result.index << ',' << (result.join ? "join" : "leave") << ','
+           << maidsafe::DebugId(result.vault_id) << ',' << result.time << ','
+           << result.affected_count << ',' << (result.converged ? 1 : 0) << ','
+           << result.convergence_time;
+    for (const auto& count : result.message_counts)
+      output << ',' << count;
+    output << ',' << result.matrix_changes << ',' << result.duplicate_matrix_changes << ','
+           << result.stale_matrix_changes << '\n';
+  }
+}
+
+void WriteJson(const std::vector<EventResult>& results, std::ostream& output) {
+  output << "[\n";
+  for (size_t i(0); i != results.size(); ++i) {
+    const EventResult& result(results[i]);
+    output << "  {\"event\": " << result.index << ", \"type\": \""
+           << (result.join ? "join" : "leave") << "\", \"vault\": \""
+           << maidsafe::DebugId(result.vault_id) << "\", \"time_s\": " << result.time
+           << ", \"affected\": " << result.affected_count
+           << ", \"converged\": " << (result.converged ? "true" : "false")
+           << ", \"convergence_ms\": " << result.convergence_time;
+    for (size_t j(0); j != kMessageTypeCount; ++j)
+      output << ", \"" << kMessageTypes[j] << "\": " << result.message_counts[j];
+    output << ", \"matrix_changes\": " << result.matrix_changes
+           << ", \"duplicate_matrix_changes\": " << result.duplicate_matrix_changes
+           << ", \"stale_matrix_changes\": " << result.stale_matrix_changes << '}'
+           << (i + 1 == results.size() ? "\n" : ",\n");
+  }
+  output << "]\n";
+}
+
+}  // unnamed namespace
+
+int main(int argc, char* argv[]) {
+  try {
+    size_t vault_count(100), event_count(100);
+    double join_rate(6.0), leave_rate(6.0), loss_rate(0.0);
+    unsigned int timeout(120), min_latency(5), max_latency(50), seed(0);
+    std::string output_path;
+    po::options_description options("Options");
+    options.add_options()("help,h", "Print this help message")(
+        "vaults", po::value<size_t>(&vault_count)->default_value(vault_count),
+        "Vaults in the network before the first event")(
+        "events", po::value<size_t>(&event_count)->default_value(event_count),
+        "Number of joins and leaves")(
+        "join-rate", po::value<double>(&join_rate)->default_value(join_rate),
+        "Joins per minute")(
+        "leave-rate", po::value<double>(&leave_rate)->default_value(leave_rate),
+        "Leaves per minute")(
+        "timeout", po::value<unsigned int>(&timeout)->default_value(timeout),
+        "Seconds to wait for each event to converge")(
+        "min-latency", po::value<unsigned int>(&min_latency)->default_value(min_latency),
+        "Minimum message latency in milliseconds")(
+        "max-latency", po::value<unsigned int>(&max_latency)->default_value(max_latency),
+        "Maximum message latency in milliseconds")(
+        "loss-rate", po::value<double>(&loss_rate)->default_value(loss_rate),
+        "Fraction of messages lost")(
+        "seed", po::value<unsigned int>(&seed)->default_value(seed),
+        "Seed of the event schedule")(
+        "real-time", "Run in real rather than virtual time")(
+        "json", "Write JSON rather than CSV")(
+        "output,o", po::value<std::string>(&output_path), "File to write, rather than stdout");
+    po::variables_map variables_map;
+    po::store(po::parse_command_line(argc, argv, options), variables_map);
+    po::notify(variables_map);
+    if (variables_map.count("help") || join_rate + leave_rate <= 0.0) {
+      std::cout << "Usage: routing_churn [options]\n" << options;
+      return 0;
+    }
+
+    if (!variables_map.count("real-time"))
+      Clock::EnableVirtualTime();
+    maidsafe::routing::NetworkConditions conditions;
+    conditions.min_latency = std::chrono::milliseconds(min_latency);
+    conditions.max_latency = std::chrono::milliseconds(std::max(min_latency, max_latency));
+    conditions.loss_rate = loss_rate;
+    std::vector<EventResult> results;
+    {
+      SimulatedNetwork network(conditions);
+      MatrixChangeMonitor monitor;
+      network.set_matrix_changed_functor([&](
+          const NodeId& vault_id, std::shared_ptr<maidsafe::routing::MatrixChange> change) {
+        monitor.OnMatrixChanged(vault_id, change);
+      });
+      std::cerr << "Building a network of " << vault_count << " vaults" << std::endl;
+      if (!network.Grow(vault_count)) {
+        std::cout << "Error: Failed to build the network." << std::endl;
+        return 1;
+      }
+
+      std::mt19937 generator(seed);
+      std::exponential_distribution<double> gap((join_rate + leave_rate) / 60.0);
+      std::bernoulli_distribution is_join(join_rate / (join_rate + leave_rate));
+      const Clock::time_point kStart(Clock::now());
+      Clock::time_point next_event_time(kStart);
+      for (size_t i(0); i != event_count; ++i) {
+        next_event_time += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(gap(generator)));
+        if (Clock::now() < next_event_time)
+          network.Run(next_event_time - Clock::now());
+        // Keep enough vaults to fill a close group
+        bool join(is_join(generator) || network.size() <= Parameters::closest_nodes_size + 1U);
+        const double kTime(Seconds(Clock::now() - kStart));
+        results.push_back(
+            RunEvent(network, monitor, join, generator, std::chrono::seconds(timeout)));
+        results.back().index = i;
+        results.back().time = kTime;
+        std::cerr << "Event " << i << (join ? " join " : " leave ")
+                  << (results.back().converged ? "converged in " : "timed out after ")
+                  << results.back().convergence_time << " ms" << std::endl;
+      }
+    }
+    Clock::DisableVirtualTime();
+
+    std::ofstream output_file;
+    if (!output_path.empty())
+      output_file.open(output_path);
+    std::ostream& output(output_path.empty() ? std::cout : output_file);
+    if (variables_map.count("json"))
+      WriteJson(results, output);
+    else
+      WriteCsv(results, output);
+  }
+  catch (const std::exception& e) {
+    std::cout << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,227 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+// Reassembles the message traces collected by nodes in Parameters::message_trace_path, and reports
+// the slowest hops, the nodes where messages queue longest and any routing loops.  Each hop's
+// processing time is measured on one clock; transit times between hops span two nodes' clocks, so
+// are only as accurate as their synchronisation.
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>  // NOLINT
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "boost/program_options.hpp"
+
+#include "maidsafe/routing/message_trace.h"
+
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+
+namespace {
+
+typedef maidsafe::routing::MessageTrace MessageTrace;
+
+struct SlowSegment {
+  SlowSegment() : microseconds(0), trace_id(0), description() {}
+  int64_t microseconds;
+  uint64_t trace_id;
+  std::string description;
+};
+
+struct QueueingStats {
+  QueueingStats() : count(0), total(0), maximum(0) {}
+  uint64_t count, total, maximum;
+};
+
+std::vector<MessageTrace> ReadTraces(const std::vector<std::string>& paths) {
+  std::vector<MessageTrace> traces;
+  for (const auto& path : paths) {
+    std::vector<fs::path> files;
+    if (fs::is_directory(path)) {
+      for (fs::directory_iterator itr(path); itr != fs::directory_iterator(); ++itr) {
+        if (itr->path().extension() == ".trace")
+          files.push_back(itr->path());
+      }
+    } else {
+      files.push_back(path);
+    }
+    for (const auto& file : files) {
+      auto file_traces(maidsafe::routing::ReadMessageTraces(file));
+      traces.insert(traces.end(), file_traces.begin(), file_traces.end());
+    }
+  }
+  return traces;
+}
+
+bool IsPrefix(const MessageTrace& shorter, const MessageTrace& longer) {
+  if (shorter.hops.size() > longer.hops.size())
+    return false;
+  for (size_t i(0); i != shorter.hops.size(); ++i) {
+    if (shorter.hops[i].node != longer.hops[i].node ||
+        shorter.hops[i].received != longer.hops[i].received)
+      return false;
+  }
+  return true;
+}
+
+// A request delivered to a node is recorded there, and again as the start of its response's trace.
+// Only the longest record of each path is kept; a group message keeps one record per branch.
+std::vector<MessageTrace> Reassemble(std::vector<MessageTrace> traces) {
+  std::sort(traces.begin(), traces.end(), [](const MessageTrace& lhs, const MessageTrace& rhs) {
+    return lhs.trace_id != rhs.trace_id ? lhs.trace_id < rhs.trace_id
+                                        : lhs.hops.size() > rhs.hops.size();
+  });
+  std::vector<MessageTrace> paths;
+  for (const auto& trace : traces) {
+    bool covered(false);
+    for (auto itr(paths.rbegin()); itr != paths.rend() && itr->trace_id == trace.trace_id; ++itr)
+      covered = covered || IsPrefix(trace, *itr);
+    if (!covered)
+      paths.push_back(trace);
+  }
+  return paths;
+}
+
+// A node appearing twice on the same leg of the path (request or response).
+bool HasLoop(const MessageTrace& trace) {
+  std::set<std::pair<std::string, bool>> seen;
+  for (const auto& hop : trace.hops) {
+    if (!seen.insert(std::make_pair(hop.node, hop.request)).second)
+      return true;
+  }
+  return false;
+}
+
+void PrintTrace(const MessageTrace& trace) {
+  std::cout << std::hex << std::setw(16) << std::setfill('0') << trace.trace_id << std::dec
+            << std::setfill(' ') << "  " << trace.outcome << "  " << trace.hops.size() << " hops"
+            << (HasLoop(trace) ? "  LOOP" : "") << '\n';
+  for (size_t i(0); i != trace.hops.size(); ++i) {
+    const auto& hop(trace.hops[i]);
+    std::cout << "    " << hop.node << (hop.request ? "  request " : "  response")
+              << "  queued " << std::setw(8) << hop.queueing_delay << " us";
+    if (hop.forwarded != 0) {
+      std::cout << "  handled " << std::setw(8)
+                << static_cast<int64_t>(hop.forwarded - hop.received) << " us";
+      if (i + 1 != trace.hops.size())
+        std::cout << "  transit " << std::setw(8)
+                  << static_cast<int64_t>(trace.hops[i + 1].received - hop.forwarded) << " us";
+    }
+    std::cout << '\n';
+  }
+}
+
+void Analyse(const std::vector<MessageTrace>& paths, size_t top, bool verbose) {
+  std::vector<SlowSegment> segments;
+  std::map<std::string, QueueingStats> queueing;
+  size_t delivered(0), loops(0);
+  for (const auto& trace : paths) {
+    if (verbose)
+      PrintTrace(trace);
+    if (trace.outcome == "delivered")
+      ++delivered;
+    if (HasLoop(trace))
+      ++loops;
+    for (size_t i(0); i != trace.hops.size(); ++i) {
+      const auto& hop(trace.hops[i]);
+      auto& stats(queueing[hop.node]);
+      ++stats.count;
+      stats.total += hop.queueing_delay;
+      stats.maximum = std::max<uint64_t>(stats.maximum, hop.queueing_delay);
+      if (hop.forwarded == 0)
+        continue;
+      SlowSegment handled;
+      handled.microseconds = static_cast<int64_t>(hop.forwarded - hop.received);
+      handled.trace_id = trace.trace_id;
+      handled.description = "handling at " + hop.node;
+      segments.push_back(handled);
+      if (i + 1 != trace.hops.size()) {
+        SlowSegment transit;
+        transit.microseconds = static_cast<int64_t>(trace.hops[i + 1].received - hop.forwarded);
+        transit.trace_id = trace.trace_id;
+        transit.description = "transit " + hop.node + " -> " + trace.hops[i + 1].node;
+        segments.push_back(transit);
+      }
+    }
+  }
+
+  std::cout << paths.size() << " traced paths, " << delivered << " delivered, "
+            << paths.size() - delivered << " dropped, " << loops << " with routing loops\n";
+
+  std::sort(segments.begin(), segments.end(), [](const SlowSegment& lhs, const SlowSegment& rhs) {
+    return lhs.microseconds > rhs.microseconds;
+  });
+  std::cout << "\nSlowest hops:\n";
+  for (size_t i(0); i != std::min(top, segments.size()); ++i) {
+    std::cout << "  " << std::setw(10) << segments[i].microseconds << " us  "
+              << segments[i].description << "  (trace " << std::hex << segments[i].trace_id
+              << std::dec << ")\n";
+  }
+
+  std::vector<std::pair<std::string, QueueingStats>> by_mean(queueing.begin(), queueing.end());
+  std::sort(by_mean.begin(), by_mean.end(),
+            [](const std::pair<std::string, QueueingStats>& lhs,
+               const std::pair<std::string, QueueingStats>& rhs) {
+    return lhs.second.total * rhs.second.count > rhs.second.total * lhs.second.count;
+  });
+  std::cout << "\nLongest queueing by node:\n";
+  for (size_t i(0); i != std::min(top, by_mean.size()); ++i) {
+    const auto& stats(by_mean[i].second);
+    std::cout << "  " << by_mean[i].first << "  mean " << std::setw(8) << stats.total / stats.count
+              << " us  max " << std::setw(8) << stats.maximum << " us  over " << stats.count
+              << " hops\n";
+  }
+}
+
+}  // unnamed namespace
+
+int main(int argc, char* argv[]) {
+  try {
+    size_t top(10);
+    po::options_description options("Options");
+    options.add_options()("help,h", "Print this help message")(
+        "verbose,v", "Print every reassembled trace")(
+        "top,n", po::value<size_t>(&top)->default_value(top), "Number of entries in each report")(
+        "paths", po::value<std::vector<std::string>>(), "Trace files or directories of them");
+    po::positional_options_description positional;
+    positional.add("paths", -1);
+    po::variables_map variables_map;
+    po::store(po::command_line_parser(argc, argv).options(options).positional(positional).run(),
+              variables_map);
+    po::notify(variables_map);
+    if (variables_map.count("help") || !variables_map.count("paths")) {
+      std::cout << "Usage: routing_trace [options] <trace file or directory>...\n" << options;
+      return 0;
+    }
+    auto paths(Reassemble(ReadTraces(variables_map["paths"].as<std::vector<std::string>>())));
+    Analyse(paths, top, variables_map.count("verbose") != 0);
+  }
+  catch (const std::exception& e) {
+    std::cout << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
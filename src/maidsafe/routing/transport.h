@@ -0,0 +1,106 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_TRANSPORT_H_
+#define MAIDSAFE_ROUTING_TRANSPORT_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "boost/asio/ip/udp.hpp"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/rudp/managed_connections.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// The connections a node holds to its peers.  The semantics, including return codes, are those of
+// rudp::ManagedConnections, which is the transport used unless a simulation replaces it.
+class Transport {
+ public:
+  virtual ~Transport() {}
+  virtual int Bootstrap(const std::vector<boost::asio::ip::udp::endpoint>& bootstrap_endpoints,
+                        const rudp::MessageReceivedFunctor& message_received_functor,
+                        const rudp::ConnectionLostFunctor& connection_lost_functor,
+                        const NodeId& this_node_id,
+                        std::shared_ptr<asymm::PrivateKey> private_key,
+                        std::shared_ptr<asymm::PublicKey> public_key,
+                        NodeId& chosen_bootstrap_peer, rudp::NatType& nat_type,
+                        boost::asio::ip::udp::endpoint local_endpoint) = 0;
+  virtual int GetAvailableEndpoint(const NodeId& peer_id,
+                                   const rudp::EndpointPair& peer_endpoint_pair,
+                                   rudp::EndpointPair& this_endpoint_pair,
+                                   rudp::NatType& this_nat_type) = 0;
+  virtual int Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
+                  const std::string& validation_data) = 0;
+  virtual int MarkConnectionAsValid(const NodeId& peer_id,
+                                    boost::asio::ip::udp::endpoint& new_bootstrap_endpoint) = 0;
+  virtual void Remove(const NodeId& peer_id) = 0;
+  virtual void Send(const NodeId& peer_id, const std::string& message,
+                    const rudp::MessageSentFunctor& message_sent_functor) = 0;
+};
+
+class RudpTransport : public Transport {
+ public:
+  RudpTransport();
+  virtual int Bootstrap(const std::vector<boost::asio::ip::udp::endpoint>& bootstrap_endpoints,
+                        const rudp::MessageReceivedFunctor& message_received_functor,
+                        const rudp::ConnectionLostFunctor& connection_lost_functor,
+                        const NodeId& this_node_id,
+                        std::shared_ptr<asymm::PrivateKey> private_key,
+                        std::shared_ptr<asymm::PublicKey> public_key,
+                        NodeId& chosen_bootstrap_peer, rudp::NatType& nat_type,
+                        boost::asio::ip::udp::endpoint local_endpoint);
+  virtual int GetAvailableEndpoint(const NodeId& peer_id,
+                                   const rudp::EndpointPair& peer_endpoint_pair,
+                                   rudp::EndpointPair& this_endpoint_pair,
+                                   rudp::NatType& this_nat_type);
+  virtual int Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
+                  const std::string& validation_data);
+  virtual int MarkConnectionAsValid(const NodeId& peer_id,
+                                    boost::asio::ip::udp::endpoint& new_bootstrap_endpoint);
+  virtual void Remove(const NodeId& peer_id);
+  virtual void Send(const NodeId& peer_id, const std::string& message,
+                    const rudp::MessageSentFunctor& message_sent_functor);
+
+ private:
+  RudpTransport(const RudpTransport&);
+  RudpTransport& operator=(const RudpTransport&);
+
+  rudp::ManagedConnections managed_connections_;
+};
+
+typedef std::function<std::unique_ptr<Transport>()> TransportFactory;
+
+// Replaces the factory used to create the transport of each node constructed from then on, e.g. to
+// run many nodes over a simulated network in one process.  A null factory restores rudp.
+void SetTransportFactory(TransportFactory transport_factory);
+
+std::unique_ptr<Transport> MakeTransport();
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_TRANSPORT_H_
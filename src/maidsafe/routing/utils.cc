@@ -41,14 +41,21 @@ namespace routing {
 
 int AddToRudp(NetworkUtils& network, const NodeId& this_node_id, const NodeId& this_connection_id,
               const NodeId& peer_id, const NodeId& peer_connection_id,
-              rudp::EndpointPair peer_endpoint_pair, bool requestor, bool client) {
+              rudp::EndpointPair peer_endpoint_pair, bool requestor, bool client,
+              const std::vector<NodeId>& close_ids) {
   LOG(kVerbose) << "AddToRudp. peer_id : " << DebugId(peer_id)
                 << " , connection id : " << DebugId(peer_connection_id);
-  protobuf::Message connect_success(
-      rpcs::ConnectSuccess(peer_id, this_node_id, this_connection_id, requestor, client));
+  bool pipelined(Parameters::pipelined_connect_handshake &&
+                 peer_connection_id != network.bootstrap_connection_id());
+  protobuf::Message connect_success(rpcs::ConnectSuccess(peer_id, this_node_id, this_connection_id,
+                                                         requestor, client, pipelined, close_ids));
+  // Marked before adding, as the peer's ConnectSuccess can arrive before Add returns.
+  if (pipelined)
+    network.MarkPipelinedConnectSuccessSent(peer_connection_id);
   int result =
       network.Add(peer_connection_id, peer_endpoint_pair, connect_success.SerializeAsString());
   if (result != rudp::kSuccess) {
+    network.TakePipelinedConnectSuccessSent(peer_connection_id);
     LOG(kError) << "rudp add failed for peer node [" << DebugId(peer_id)
                 << "]. Connection id : " << DebugId(peer_connection_id) << ". result : " << result;
   } else {
@@ -61,7 +68,7 @@ int AddToRudp(NetworkUtils& network, const NodeId& this_node_id, const NodeId& t
 bool ValidateAndAddToRoutingTable(NetworkUtils& network, RoutingTable& routing_table,
                                   ClientRoutingTable& client_routing_table,
                                   const NodeId& peer_id, const NodeId& connection_id,
-                                  const asymm::PublicKey& public_key, bool client,
+                                  const InternedPublicKey& public_key, bool client,
                                   const std::vector<NodeInfo>& matrix_update) {
   if (network.MarkConnectionAsValid(connection_id) != kSuccess) {
     LOG(kError) << "[" << DebugId(routing_table.kNodeId()) << "] "
@@ -53,13 +53,17 @@ class NetworkUtils;
 class ClientRoutingTable;
 class RoutingTable;
 
+// If Parameters::pipelined_connect_handshake is set, the ConnectSuccess sent as rudp validation data
+// asks the peer to complete the connection as soon as it arrives, and carries the responder's
+// close_ids for the requestor.  The bootstrap connection always uses the full handshake.
 int AddToRudp(NetworkUtils& network, const NodeId& this_node_id, const NodeId& this_connection_id,
               const NodeId& peer_id, const NodeId& peer_connection_id,
-              rudp::EndpointPair peer_endpoint_pair, bool requestor, bool client);
+              rudp::EndpointPair peer_endpoint_pair, bool requestor, bool client,
+              const std::vector<NodeId>& close_ids = std::vector<NodeId>());
 
 bool ValidateAndAddToRoutingTable(
     NetworkUtils& network, RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
-    const NodeId& peer_id, const NodeId& connection_id, const asymm::PublicKey& public_key,
+    const NodeId& peer_id, const NodeId& connection_id, const InternedPublicKey& public_key,
     bool client, const std::vector<NodeInfo>& matrix_update = std::vector<NodeInfo>());
 
 void HandleSymmetricNodeAdd(RoutingTable& routing_table, const NodeId& peer_id,